@@ -40,6 +40,7 @@ typedef struct ee_fieldListApache_s ee_fieldListApache_t;
  */
 struct ee_fieldListApache_s {
 	es_str_t *name;		/**< field name */
+	unsigned nameHash;	/**< hash of the field name */
 	ee_fieldListApache_t *next;	/**< list housekeeping, next node (or NULL) */
 };
 
@@ -0,0 +1,270 @@
+/**
+ * @file binary.h
+ * @brief Binary event representation (for spooling and IPC).
+ *
+ * The textual encoders are meant for humans and foreign systems. When
+ * libee-based programs hand events to each other (or to disk queues),
+ * re-parsing JSON is pure overhead. The binary format is compact,
+ * versioned and can be walked directly in the buffer it is stored in.
+ *
+ * A record is laid out as follows (all multi-byte integers inside the
+ * payload are unsigned LEB128 varints, which we call "varint" below):
+ *
+ * @verbatim
+   header (fixed, 8 bytes)
+     'E' 'B'          magic
+     version          currently EE_BIN_VERSION
+     flags            reserved, must be 0
+     length           payload length, 4 bytes little endian
+   payload
+     nNames           varint, size of the name dictionary
+     nNames times     varint length, name bytes
+     nTags            varint
+     nTags times      varint name ID
+     nFields          varint
+     nFields times    varint name ID, varint nVals, nVals values
+   value
+     type             one byte, EE_BIN_VAL_*
+     string           varint length, bytes
+     number           zig-zag encoded varint
+     double           IEEE 754 bits, 8 bytes little endian
+     network address  one byte EE_NET_*, one byte prefix length,
+                      4, 16 or 6 address bytes (see ee_netAddrLen())
+   @endverbatim
+ *
+ * Name IDs are indexes into the record's name dictionary, which holds
+ * each tag and field name only once. Records are self-contained, so a
+ * spool file may be read starting at any record boundary. The header
+ * length is fixed (and not a varint) so that records can be skipped
+ * without looking at the payload at all.
+ *//*
+ *
+ * Libee - An Event Expression Library inspired by CEE
+ * Copyright 2012 by Rainer Gerhards and Adiscon GmbH.
+ *
+ * This file is part of libee.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * A copy of the LGPL v2.1 can be found in the file "COPYING" in this distribution.
+ */
+#ifndef LIBEE_BINARY_H_INCLUDED
+#define	LIBEE_BINARY_H_INCLUDED
+#include <string.h>
+
+#define EE_BIN_MAGIC0	'E'
+#define EE_BIN_MAGIC1	'B'
+#define EE_BIN_VERSION	1
+#define EE_BIN_HDRLEN	8	/**< size of the fixed record header */
+
+#define EE_BIN_VAL_STR	1	/**< value is a string */
+#define EE_BIN_VAL_NBR	2	/**< value is a (signed) number */
+#define EE_BIN_VAL_NET	3	/**< value is a network address */
+#define EE_BIN_VAL_DBL	4	/**< value is a floating point number */
+
+/**
+ * A parsed binary record.
+ * This does not contain any copies, just pointers into the buffer
+ * holding the record. All pointers are valid only as long as that
+ * buffer is. When ee_binParseRecord() has filled this structure, the
+ * full record has been checked for consistency, so the sections can be
+ * walked without any further bounds checks (but the ee_binGet*()
+ * functions nevertheless do them, so there is no need to care).
+ */
+struct ee_binrec {
+	unsigned char *buf;	/**< start of record (header) */
+	size_t len;		/**< total length of record, including header */
+	unsigned char *end;	/**< first byte after the record */
+	unsigned nNames;	/**< number of entries in name dictionary */
+	unsigned char *names;	/**< first entry of name dictionary */
+	unsigned nTags;		/**< number of tags */
+	unsigned char *tags;	/**< first tag entry */
+	unsigned nFields;	/**< number of fields */
+	unsigned char *fields;	/**< first field entry */
+};
+
+
+/**
+ * A value, resolved in place.
+ */
+struct ee_binvalue {
+	unsigned char type;	/**< EE_BIN_VAL_* */
+	unsigned char *str;	/**< string start inside the record (strings only) */
+	es_size_t len;		/**< string length (strings only) */
+	long long number;	/**< the number (numbers only) */
+	double dbl;		/**< the number (doubles only) */
+	struct ee_netaddr net;	/**< the address (network addresses only) */
+};
+
+
+/**
+ * Read a varint.
+ *
+ * @param[in/out] pp current read position, advanced
+ * @param[in] end end of buffer
+ * @param[out] val value read
+ *
+ * @return 0 on success, EE_INVLDFMT if the buffer ended prematurely
+ *         or the varint is overlong
+ */
+static inline int
+ee_binGetVarint(unsigned char **pp, unsigned char *end, unsigned long long *val)
+{
+	unsigned char *p = *pp;
+	unsigned long long v = 0;
+	unsigned shift = 0;
+
+	do {
+		if(p == end || shift > 63)
+			return EE_INVLDFMT;
+		v |= (unsigned long long) (*p & 0x7f) << shift;
+		shift += 7;
+	} while(*p++ & 0x80);
+	*val = v;
+	*pp = p;
+	return 0;
+}
+
+
+/**
+ * Read a length-prefixed byte sequence (a string), in place.
+ *
+ * @param[in/out] pp current read position, advanced
+ * @param[in] end end of buffer
+ * @param[out] str start of the string inside the buffer
+ * @param[out] len length of the string
+ *
+ * @return 0 on success, EE_INVLDFMT otherwise
+ */
+static inline int
+ee_binGetStr(unsigned char **pp, unsigned char *end, unsigned char **str, es_size_t *len)
+{
+	unsigned long long l;
+	int r;
+
+	if((r = ee_binGetVarint(pp, end, &l)) != 0)
+		return r;
+	if(l > (unsigned long long) (end - *pp))
+		return EE_INVLDFMT;
+	*str = *pp;
+	*len = (es_size_t) l;
+	*pp += l;
+	return 0;
+}
+
+
+/**
+ * Decode a zig-zag encoded number.
+ */
+static inline long long
+ee_binUnZigZag(unsigned long long v)
+{
+	return (long long) (v >> 1) ^ -(long long) (v & 1);
+}
+
+
+/**
+ * Read a value, in place.
+ *
+ * @param[in/out] pp current read position, advanced
+ * @param[in] end end of buffer
+ * @param[out] val value read
+ *
+ * @return 0 on success, EE_INVLDFMT otherwise
+ */
+static inline int
+ee_binGetValue(unsigned char **pp, unsigned char *end, struct ee_binvalue *val)
+{
+	unsigned long long v;
+	int len;
+	int r;
+
+	if(*pp == end)
+		return EE_INVLDFMT;
+	val->type = *(*pp)++;
+	if(val->type == EE_BIN_VAL_STR) {
+		r = ee_binGetStr(pp, end, &val->str, &val->len);
+	} else if(val->type == EE_BIN_VAL_NBR) {
+		if((r = ee_binGetVarint(pp, end, &v)) == 0)
+			val->number = ee_binUnZigZag(v);
+	} else if(val->type == EE_BIN_VAL_DBL) {
+		if(end - *pp < 8)
+			return EE_INVLDFMT;
+		for(v = 0, len = 7 ; len >= 0 ; --len)
+			v = (v << 8) | (*pp)[len];
+		memcpy(&val->dbl, &v, sizeof(double));
+		*pp += 8;
+		r = 0;
+	} else if(val->type == EE_BIN_VAL_NET) {
+		if(end - *pp < 2 || (len = ee_netAddrLen((*pp)[0])) == 0 || end - *pp < 2 + len)
+			return EE_INVLDFMT;
+		val->net.type = (*pp)[0];
+		val->net.prefixLen = (*pp)[1];
+		memcpy(val->net.addr, *pp + 2, len);
+		*pp += 2 + len;
+		r = 0;
+	} else {
+		r = EE_INVLDFMT;
+	}
+	return r;
+}
+
+
+/**
+ * Obtain the length of the record that starts at the given buffer,
+ * without parsing it. This is meant for skipping over records in
+ * spool files.
+ *
+ * @param[in] buf buffer with record
+ * @param[in] lenBuf number of bytes available in buffer
+ * @param[out] len total record length (including header)
+ *
+ * @return 0 on success, EE_EOF if the header is incomplete, EE_INVLDFMT
+ *         if the buffer does not contain a (supported) record
+ */
+int ee_binRecordLen(unsigned char *buf, size_t lenBuf, size_t *len);
+
+
+/**
+ * Parse a binary record in place.
+ * The record is fully validated. Nothing is copied and no memory is
+ * allocated.
+ *
+ * @param[in] buf buffer with record
+ * @param[in] lenBuf number of bytes available in buffer (may be larger
+ *            than the record)
+ * @param[out] rec parsed record
+ *
+ * @return 0 on success, EE_EOF if the buffer contains only part of a
+ *         record, EE_INVLDFMT if the record is malformed
+ */
+int ee_binParseRecord(unsigned char *buf, size_t lenBuf, struct ee_binrec *rec);
+
+
+/**
+ * Obtain a name from the record's name dictionary, in place.
+ * Note that this needs to walk the dictionary. If many names need to
+ * be resolved, it is better to walk the dictionary once.
+ *
+ * @param[in] rec parsed record
+ * @param[in] id name ID
+ * @param[out] name start of name inside record
+ * @param[out] len length of name
+ *
+ * @return 0 on success, EE_NOTFOUND if there is no such ID
+ */
+int ee_binGetName(struct ee_binrec *rec, unsigned id, unsigned char **name, es_size_t *len);
+
+#endif /* #ifndef LIBEE_BINARY_H_INCLUDED */
@@ -0,0 +1,137 @@
+/**
+ * @file csv.h
+ * The CSV/TSV decoder.
+ *
+ * @class ee_csv csv.h
+ *
+ * This decodes CSV as of RFC4180 (or TSV, or any other single-character
+ * delimiter) into events. The columns are mapped to fields via a column
+ * list, which uses the same syntax as the one of ee_fmtEventToCSV(), so
+ * the output of that encoder can be read back. The column list is
+ * compiled once, when the decoder is created.
+ *
+ * Quoted fields may contain delimiters and line breaks, a quote inside
+ * them is written as two quotes. Optionally, the backslash escapes
+ * created by ee_fmtEventToCSV() (e.g. \\" or \\n) are decoded, too.
+ * Empty columns, as well as columns not in the column list, do not
+ * create fields.
+ *
+ * Fields are split by searching for the delimiter or quote character
+ * with memchr(), which is vectorized by the C library, or, if two
+ * characters need to be found, eight bytes at a time (SWAR).
+ *//*
+ *
+ * Libee - An Event Expression Library inspired by CEE
+ * Copyright 2012 by Rainer Gerhards and Adiscon GmbH.
+ *
+ * This file is part of libee.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * A copy of the LGPL v2.1 can be found in the file "COPYING" in this distribution.
+ */
+#ifndef LIBEE_CSV_H_INCLUDED
+#define	LIBEE_CSV_H_INCLUDED
+#include <libestr.h>
+
+/** decode backslash escapes inside quoted fields (as created by
+ *  ee_fmtEventToCSV()) */
+#define EE_CSV_BACKSLASH_ESC	0x01
+
+/**
+ * The CSV decoder object. It holds the compiled column list and
+ * the configuration, so it can be used for any number of records.
+ */
+struct ee_csv {
+	unsigned objID;		/**< a magic number to prevent some memory adressing errors */
+	ee_ctx ctx;		/**< associated library context */
+	unsigned nCols;		/**< number of columns */
+	es_str_t **names;	/**< field names of the columns */
+	unsigned *nameHashes;	/**< hashes of the field names */
+	struct ee_fieldset *layout; /**< layout of the events (one slot per
+				 *   column), NULL if the names are not unique */
+	unsigned char delim;	/**< delimiter, e.g. ',' or '\\t' */
+	unsigned flags;		/**< EE_CSV_* flags */
+};
+
+/**
+ * Constructor for the ee_csv object.
+ *
+ * @memberof ee_csv
+ * @public
+ *
+ * @param[in] ctx library context
+ * @param[in] colSpec field names of the columns, in column order
+ *            (comma- or space-delimited list, as for ee_fmtEventToCSV())
+ * @param[in] delim the delimiter, usually ',' (CSV) or '\\t' (TSV)
+ * @param[in] flags EE_CSV_* flags
+ *
+ * @return new decoder or NULL if the column list is invalid or an
+ *         error occured
+ */
+struct ee_csv* ee_newCSV(ee_ctx ctx, es_str_t *colSpec, char delim, unsigned flags);
+
+/**
+ * Destructor for the ee_csv object.
+ *
+ * @memberof ee_csv
+ * @public
+ *
+ * @param[in] csv object to be destructed
+ */
+void ee_deleteCSV(struct ee_csv *csv);
+
+/**
+ * Create an event from a single CSV record.
+ *
+ * @memberof ee_csv
+ * @public
+ *
+ * @param[in] csv the decoder
+ * @param[in] str the record (without trailing line break)
+ *
+ * @return new event or NULL if the record is incomplete (it ends
+ *         inside a quoted field) or an error occured
+ */
+struct ee_event* ee_newEventFromCSV(struct ee_csv *csv, es_str_t *str);
+
+/**
+ * Decode CSV records into CEE structures. Records that continue on
+ * the next line (line breaks inside quoted fields) are supported.
+ *
+ * The interface is heavily callback-based, just like the other
+ * decoders (see apache.h).
+ *
+ * @memberof ee_csv
+ * @public
+ *
+ * @param[in] ctx library context to use, must be the one the decoder
+ *            was created with
+ * @param[in] cbGetLine get next line to be processed. Returns
+ *            0 if all went well, EE_EOF at end of file and something
+ *            else otherwise.
+ * @param[in] cbNewEvt callback for function that receives newly created
+ *            events. It must return 0 on success and something else otherwise.
+ * @param[out] errStr printable error message, provided only if an error
+ *             occurs. If so, the caller must delete the provided pointer.
+ * @param[in] csv the decoder configuration
+ * @returns 0 on success, EE_EINVAL if ctx is not the context of the
+ *          decoder, something else otherwise
+ */
+int ee_csvDec(ee_ctx ctx, int (*cbGetLine)(es_str_t **ln),
+	      int (*cbNewEvt)(struct ee_event *event),
+	      es_str_t **errMsg, struct ee_csv *csv);
+
+#endif /* #ifndef LIBEE_CSV_H_INCLUDED */
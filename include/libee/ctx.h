@@ -31,6 +31,7 @@
  */
 #ifndef LIBEE_EE_H_INCLUDED
 #define	LIBEE_EE_H_INCLUDED
+#include "libee/timestamp.h"
 
 /* some configuration-defined values (TODO: autoconf!)
  */
@@ -38,6 +39,9 @@
 	/**< default size for tag buckets (extensible) */
 #define EE_DFLT_FIELD_BCKT_SIZE	11
 	/**< default size for field buckets (extensible) */
+#define EE_FIELDBUCKET_HASH_MIN	8
+	/**< number of fields from which on a field bucket builds a hash
+	 *   index upon lookup (below that, a list scan is faster) */
 
 #define ObjID_None		0xFDFD0000
 #define ObjID_CTX		0xFDFD0001
@@ -49,6 +53,17 @@
 #define ObjID_EVENT		0xFDFD0007
 #define ObjID_VALUE		0xFDFD0008
 #define ObjID_VALNODE		0xFDFD0009
+#define ObjID_FIELDREF		0xFDFD000A
+#define ObjID_SPOOL		0xFDFD000B
+#define ObjID_PARSER		0xFDFD000C
+#define ObjID_RECOGNIZER	0xFDFD000D
+#define ObjID_KV		0xFDFD000E
+#define ObjID_CSV		0xFDFD000F
+#define ObjID_FILTER		0xFDFD0010
+#define ObjID_NORMALIZER	0xFDFD0011
+#define ObjID_LITMATCHER	0xFDFD0012
+#define ObjID_FIELDSET		0xFDFD0013
+#define ObjID_TAGSET		0xFDFD0014
 #define ObjID_DELETED		0xFDFDFFFF
 
 /**
@@ -64,16 +79,100 @@ enum ee_compLevel {
 
 #define EE_CTX_FLAG_ENC_ULTRACOMPACT 1
 #define EE_CTX_FLAG_INCLUDE_FLAT_TAGS 2
+#define EE_CTX_FLAG_RFC3164_CACHE 4
+
+/* debug levels, see ee_setDebugLevel() */
+#define EE_DBG_ERR	1	/**< errors, e.g. malformed input */
+#define EE_DBG_INFO	2	/**< noteworthy, but normal events */
+#define EE_DBG_TRACE	3	/**< details of processing (very verbose) */
+
+/**
+ * The primitive parsers for which statistics are kept. The names match
+ * the ee_parse* functions; use ee_getStatsParserName() to obtain the
+ * name under which the parser is registered.
+ */
+enum ee_statsParser {
+	ee_stp_RFC3164Date = 0,
+	ee_stp_RFC5424Date,
+	ee_stp_ISODate,
+	ee_stp_Time24hr,
+	ee_stp_Time12hr,
+	ee_stp_IPv4,
+	ee_stp_IPv6,
+	ee_stp_MAC,
+	ee_stp_CIDR,
+	ee_stp_Number,
+	ee_stp_QuotedString,
+	ee_stp_CharTo,
+	ee_stp_Word,
+	EE_STATS_NPARSERS	/**< number of parsers, must be last */
+};
+
+/**
+ * Statistics counters of a library context. These are only maintained
+ * if libee was configured with --enable-stats; otherwise, the code to
+ * maintain them is not even compiled in. See ee_getStats().
+ */
+struct ee_stats {
+	unsigned long long eventsCreated;	/**< events constructed (including clones) */
+	unsigned long long eventsDeleted;	/**< events destructed */
+	unsigned long long fieldsAlloced;	/**< fields constructed */
+	unsigned long long valuesAlloced;	/**< values constructed */
+	unsigned long long bytesCopied;		/**< bytes copied from input into value
+						 *   strings by parsers and decoders */
+	unsigned long long eventsDecoded;	/**< events created by decoders */
+	unsigned long long decodeNs;		/**< time spent decoding them (without
+						 *   callbacks), in nanoseconds */
+	unsigned long long eventsEncoded;	/**< events formatted by encoders */
+	unsigned long long encodeNs;		/**< time spent encoding them, in nanoseconds */
+	unsigned long long encBufGrows;		/**< encodings whose output outgrew the
+						 *   initial buffer */
+	unsigned long long eventsFiltered;	/**< events rejected by the filter */
+	struct {
+		unsigned long long hits;	/**< calls that matched */
+		unsigned long long misses;	/**< calls that did not match */
+	} parsers[EE_STATS_NPARSERS];		/**< per primitive parser */
+};
+
+/**
+ * A compiled projection set: the names of the fields the decoders are
+ * to create. See ee_setProjection().
+ */
+struct ee_projection {
+	unsigned nNames;		/**< number of names */
+	unsigned long long filter;	/**< bit (hash % 64) is set for each name,
+					 *   permits to reject most names quickly */
+	unsigned *hashes;		/**< hashes of the names */
+	es_str_t **names;		/**< the names */
+};
+
+struct ee_filter;
 
 struct ee_ctx_s {
 	unsigned objID;	/**< a magic number to prevent some memory adressing errors */
 	void (*dbgCB)(void *cookie, char *msg, size_t lenMsg);
 					/**< user-provided debug output callback */
 	void *dbgCookie;		/**< cookie to be passed to debug callback */
+	int dbgLevel;			/**< max level of messages passed to callback */
 	enum ee_compLevel compLevel;	/**< our compliance level */
 	unsigned short flags;		/**< flags modifying behavior */
 	int fieldBucketSize;		/**< default size for field buckets */
 	int tagBucketSize;		/**< default size for field buckets */
+	struct ee_parser *parsers;	/**< registered parsers */
+	struct ee_fieldset *fieldsets;	/**< registered event types */
+	struct ee_projection *projection; /**< fields to decode, NULL for all */
+	struct ee_filter *filter;	/**< events to decode, NULL for all */
+	struct {
+		unsigned char prefix[15];	/**< "Mmm dd hh:mm:ss" */
+		char bValid;
+		struct ee_timestamp ts;
+	} rfc3164Cache;			/**< last RFC3164 timestamp parsed */
+	struct {
+		unsigned char prefix[13];	/**< "YYYY-MM-DDThh" */
+		char bValid;
+		time_t hourStamp;		/**< epoch of that hour */
+	} rfc5424Cache;			/**< calendar memo for RFC5424 timestamps */
+	struct ee_stats stats;		/**< statistics (if enabled) */
 };
 
 
@@ -155,6 +254,77 @@ void ee_setFlags(ee_ctx ctx, unsigned int flags);
  */
 unsigned int ee_getFlags(ee_ctx ctx);
 
+/**
+ * Set the projection set of a context. If set, the decoders only create
+ * the fields listed. All other fields are skipped over, without creating
+ * any field or value objects for them. Field names are matched exactly,
+ * for structured input (JSON) these are the full names (e.g. "a.b").
+ * Tags are not affected.
+ *
+ * @memberof ee_ctx
+ * @public
+ *
+ * @param ctx The context to modify
+ * @param names comma-delimited list of field names (e.g. "host,msg")
+ *              or NULL to decode all fields (the default)
+ *
+ * @return 0 on success, something else otherwise
+ */
+int ee_setProjection(ee_ctx ctx, char *names);
+
+/**
+ * Set the filter of a context. If set, the decoders only create events
+ * that match the filter and abandon all others as early as possible.
+ * See filter.h for the expression syntax.
+ *
+ * @memberof ee_ctx
+ * @public
+ *
+ * @param ctx The context to modify
+ * @param expr filter expression or NULL to decode all events (the default)
+ *
+ * @return 0 on success, EE_INVLDFMT if the expression is invalid,
+ *         something else otherwise
+ */
+int ee_setFilter(ee_ctx ctx, char *expr);
+
+/**
+ * Obtain the statistics counters of a context.
+ *
+ * @memberof ee_ctx
+ * @public
+ *
+ * @param ctx The context to query
+ * @param[out] stats receives a copy of the counters
+ *
+ * @return 0 on success, EE_NOTFOUND if libee was built without
+ *         statistics support (--enable-stats)
+ */
+int ee_getStats(ee_ctx ctx, struct ee_stats *stats);
+
+/**
+ * Reset the statistics counters of a context to zero.
+ *
+ * @memberof ee_ctx
+ * @public
+ *
+ * @param ctx The context to modify
+ */
+void ee_resetStats(ee_ctx ctx);
+
+/**
+ * Obtain the name of a parser in struct ee_stats.
+ *
+ * @memberof ee_ctx
+ * @public
+ *
+ * @param parser index into the parser statistics
+ *
+ * @return registered name of the parser (e.g. "ipv4") or NULL if
+ *         the index is invalid
+ */
+char *ee_getStatsParserName(enum ee_statsParser parser);
+
 
 /**
  * Set encoding mode to ultra compact.
@@ -173,6 +343,24 @@ ee_setEncUltraCompact(ee_ctx ctx)
 	ctx->flags |= EE_CTX_FLAG_ENC_ULTRACOMPACT;
 }
 
+/**
+ * Enable the RFC3164 timestamp cache.
+ * Consecutive log lines very often carry the same timestamp (all lines
+ * received within the same second). If the cache is enabled, the
+ * RFC3164 date parser remembers the last timestamp it parsed and does
+ * not parse again if the next one is the same.
+ *
+ * @memberof ee_ctx
+ * @public
+ *
+ * @param ctx context to modify
+ */
+static inline void
+ee_setRFC3164Cache(ee_ctx ctx)
+{
+	ctx->flags |= EE_CTX_FLAG_RFC3164_CACHE;
+}
+
 /**
  * Set a debug message handler (callback).
  *
@@ -210,6 +398,22 @@ ee_setEncUltraCompact(ee_ctx ctx)
  */
 int ee_setDebugCB(ee_ctx ctx, void (*cb)(void*, char*, size_t), void *cookie);
 
+/**
+ * Set the debug level. Only messages up to that level are formatted and
+ * passed to the debug callback. The default is EE_DBG_TRACE, that is
+ * all messages.
+ *
+ * If libee was configured with --disable-diagnostics, no debug messages
+ * are generated at all.
+ *
+ * @memberof ee_ctx
+ * @public
+ *
+ * @param[in] ctx The library context
+ * @param[in] level one of EE_DBG_ERR, EE_DBG_INFO, EE_DBG_TRACE
+ */
+void ee_setDebugLevel(ee_ctx ctx, int level);
+
 /* internal functions */
 void ee_dbgprintf(ee_ctx ctx, char *fmt, ...) __attribute__((format(printf, 2, 3)));
 
@@ -65,6 +65,80 @@ struct ee_event* ee_newEvent(ee_ctx ctx);
  */
 struct ee_event* ee_newEventFromJSON(ee_ctx ctx, char *json);
 
+/**
+ * Create an event from its binary representation.
+ * The record is parsed directly inside the buffer, only the final
+ * event objects are allocated. See binary.h for the format.
+ *
+ * @memberof ee_event
+ * @public
+ *
+ * @param[in] ctx associated library context
+ * @param[in] buf buffer holding the record
+ * @param[in] lenBuf number of bytes in buffer (may hold more than
+ *            one record)
+ * @param[out] lenUsed if non-NULL, receives the number of bytes the
+ *             record occupied, that is the offset of the next record
+ *
+ * @return new event or NULL if the record is invalid or incomplete or
+ *         an error occured
+ */
+struct ee_event* ee_newEventFromBinary(ee_ctx ctx, unsigned char *buf, size_t lenBuf, size_t *lenUsed);
+
+/**
+ * Create an event from RFC5424 STRUCTURED-DATA, e.g. as created by
+ * ee_fmtEventToRFC5424(). See syslog.h for the details.
+ *
+ * @memberof ee_event
+ * @public
+ *
+ * @param[in] ctx associated library context
+ * @param[in] str the structured data
+ *
+ * @return new event or NULL if the structured data is invalid or
+ *         an error occured
+ */
+struct ee_event* ee_newEventFromRFC5424(ee_ctx ctx, es_str_t *str);
+
+/**
+ * Create an empty event of the type described by a fieldset. The event
+ * is bound to the layout of the fieldset and carries its tags. See
+ * fieldset.h for the details.
+ *
+ * @memberof ee_event
+ * @public
+ *
+ * @param[in] fieldset the fieldset (compiled if this was not yet done)
+ *
+ * @return new event or NULL if an error occured
+ */
+struct ee_event* ee_newEventFromFieldset(struct ee_fieldset *fieldset);
+
+/**
+ * Clone an event.
+ *
+ * The clone uses structural sharing: it references the very same
+ * tag bucket, fields and values as the original event, so cloning is
+ * O(1) and does not allocate anything but the new event object.
+ * Shared objects are copied on write when either event is modified
+ * via ee_addTagToEvent(), ee_addFieldToEvent(), ee_addStrFieldToEvent()
+ * or a field obtained by ee_getEventFieldForUpdate(). A field must be
+ * obtained that way before it is changed: fields from ee_getEventField()
+ * may be shared, and ee_addValueToField() and ee_replaceValueInField()
+ * refuse to change a shared field. So modification
+ * cost is proportional only to the delta. This is primarily meant for
+ * fan-out, where one event is routed to multiple outputs which do some
+ * individual enrichment.
+ *
+ * @memberof ee_event
+ * @public
+ *
+ * @param[in] event event to clone
+ *
+ * @return new event or NULL if an error occured
+ */
+struct ee_event* ee_cloneEvent(struct ee_event *event);
+
 /**
  * Destructor for the ee_event object.
  *
@@ -82,15 +156,20 @@ void ee_deleteEvent(struct ee_event *event);
  * A complete tag bucket is assigned to the event. Any previously
  * assigned tags are DISCARDED.
  *
+ * The event takes over one reference to the bucket. So in order to
+ * share a bucket between many events (e.g. all events from one source),
+ * pass ee_addRefTagbucket(tagbucket) to each of them. Shared buckets are
+ * never modified: if one of the events later has a tag added, it
+ * receives a private copy of the bucket (copy-on-write).
+ *
  * @memberof ee_event
  * @public
  *
  * @param event event where tag shall be added
  * @param tagbucket  already-created tag bucket to be assigned to event.
- * 		The caller ceases control of this bucket. In particular,
- * 		we may destruct it at any time. If the caller intends to
- * 		continue access the tagbucket, it must properly create
- * 		a duplicate.
+ * 		The caller ceases control of the reference passed in.
+ * 		If the caller intends to continue access the tagbucket,
+ * 		it must hold an additional reference (ee_addRefTagbucket()).
  *
  * @return	0 on success, something else otherwise.
  */
@@ -101,7 +180,9 @@ int ee_assignTagbucketToEvent(struct ee_event *event, struct ee_tagbucket *tagbu
  * Add a tag to the event.
  *
  * The tag is provided as a string. If no tag bucket exists when
- * this method is called, one is created. 
+ * this method is called, one is created. If the event's tag bucket
+ * is shared with other events, the event receives a private copy
+ * of it before the tag is added, so the other events are not affected.
  *
  * <b>This is part of the ezAPI for libee</b>
  *
@@ -142,6 +223,8 @@ int ee_addStrFieldToEvent(struct ee_event *event, char *fieldname, es_str_t *val
 
 /**
  * Add an already constructed field to the event. 
+ * If the event's field bucket is shared with a clone, the event
+ * receives a private copy of the bucket first.
  *
  * @memberof ee_event
  * @public
@@ -164,11 +247,33 @@ int ee_addFieldToEvent(struct ee_event *event, struct ee_field *field);
  * @param[in] str name of field
  *
  * @return	NULL if field was not found (or an error occured);
- *              pointer to the field otherwise
+ *              pointer to the field otherwise. The field must be
+ *              considered read-only, as it may be shared with cloned
+ *              events. Use ee_getEventFieldForUpdate() in order to
+ *              modify it.
  */
 struct ee_field* ee_getEventField(struct ee_event *event, es_str_t *name);
 
 
+/**
+ * Obtain a modifiable field with specified name from given event.
+ * If the field (or the event's field bucket) is shared with a cloned
+ * event, a private copy is created first. The returned field can
+ * then be modified, e.g. via ee_replaceValueInField(), without
+ * affecting any other event.
+ *
+ * @memberof ee_event
+ * @public
+ *
+ * @param event event to search
+ * @param[in] str name of field
+ *
+ * @return	NULL if field was not found (or an error occured);
+ *              pointer to the field otherwise
+ */
+struct ee_field* ee_getEventFieldForUpdate(struct ee_event *event, es_str_t *name);
+
+
 /**
  * Obtain the string representaton of a field with specified name
  * from given event. The string representation is build in the current
@@ -192,6 +297,118 @@ int ee_getEventFieldAsString(struct ee_event *event,
 		es_str_t *name, es_str_t **strVal);
 
 
+/**
+ * Obtain a field from given event via a precompiled field reference.
+ * This is the fast equivalent of ee_getEventField().
+ *
+ * @memberof ee_event
+ * @public
+ *
+ * @param event event to search
+ * @param[in] ref compiled field reference (see ee_compileFieldPath())
+ *
+ * @return	NULL if field was not found (or an error occured);
+ *              pointer to the field otherwise. Note that there is no
+ *              field object for "event.tags".
+ */
+struct ee_field* ee_getEventFieldByRef(struct ee_event *event, ee_fieldref ref);
+
+
+/**
+ * Obtain the string representaton of a field from given event via a
+ * precompiled field reference. This is the fast equivalent of
+ * ee_getEventFieldAsString(), see there for details.
+ *
+ * @memberof ee_event
+ * @public
+ *
+ * @param event event to search
+ * @param[in] ref compiled field reference (see ee_compileFieldPath())
+ * @param[out] strVal output string with field representation
+ *
+ * @return	0 (EE_OK), if everything went well, EE_NOTFOUND if the
+ * 		field could not be found and something else for other
+ * 		errors.
+ */
+int ee_getEventFieldAsStringByRef(struct ee_event *event, ee_fieldref ref,
+		es_str_t **strVal);
+
+
+/**
+ * Obtain the field of a slot from an event created via
+ * ee_newEventFromFieldset(). This is a direct access without any
+ * search.
+ *
+ * @memberof ee_event
+ * @public
+ *
+ * @param event event to search
+ * @param[in] slot slot number (see ee_getFieldsetSlot())
+ *
+ * @return	NULL if the slot is empty or the event is not bound to a
+ *              fieldset; pointer to the field otherwise
+ */
+struct ee_field* ee_getEventFieldBySlot(struct ee_event *event, unsigned slot);
+
+
+/**
+ * Add a value to the field of a slot of an event created via
+ * ee_newEventFromFieldset(). The field is created if the slot is
+ * empty.
+ *
+ * @memberof ee_event
+ * @public
+ *
+ * @param[in] event the event to modify
+ * @param[in] slot slot number (see ee_getFieldsetSlot())
+ * @param[in] value value to add; it is owned by the event on success
+ *
+ * @return 0 on success, EE_TOOMANYVALUES if the field already has the
+ *         maximum number of values of its fieldtype, EE_EINVAL if the
+ *         event is not bound to a fieldset, something else otherwise
+ */
+int ee_addValueToEventSlot(struct ee_event *event, unsigned slot, struct ee_value *value);
+
+
+/**
+ * Add a value given as text to the field of a slot. The text is
+ * converted by the parser of the fieldtype, so the value is typed (see
+ * ee_newValueFromFieldtype()). Otherwise, this is the same as
+ * ee_addValueToEventSlot().
+ *
+ * @memberof ee_event
+ * @public
+ *
+ * @param[in] event the event to modify
+ * @param[in] slot slot number (see ee_getFieldsetSlot())
+ * @param[in] buf the text
+ * @param[in] len length of buf
+ *
+ * @return 0 on success, EE_WRONGPARSER if the text does not match the
+ *         type of the field, something else otherwise (see
+ *         ee_addValueToEventSlot())
+ */
+int ee_addStrToEventSlot(struct ee_event *event, unsigned slot, unsigned char *buf,
+			 es_size_t len);
+
+
+/**
+ * Check the number of values of all fields of an event created via
+ * ee_newEventFromFieldset() against the cardinality of their
+ * fieldtypes.
+ *
+ * @memberof ee_event
+ * @public
+ *
+ * @param[in] event the event to check
+ *
+ * @return 0 if all fields are valid, EE_NOTFOUND if a field has fewer
+ *         values than required, EE_TOOMANYVALUES if it has more than
+ *         permitted, EE_EINVAL if the event is not bound to a fieldset
+ */
+int ee_validateEvent(struct ee_event *event);
+
+
 /**
  * Check if an event is classified via a specific tag.
  *
@@ -302,4 +519,23 @@ int ee_fmtEventToXML(struct ee_event *event, es_str_t **str);
  */
 int ee_fmtEventToCSV(struct ee_event *event, es_str_t **str, es_str_t *extraData);
 
+
+/**
+ * Format an event in libee's binary format.
+ *
+ * This method takes an event and creates its binary representation,
+ * which is meant for spooling and for handing events over to other
+ * libee-based processes. See binary.h for the format. Note that only
+ * string and number values are supported.
+ *
+ * @memberof ee_event
+ * @public
+ *
+ * @param event event to format
+ * @param[out] str pointer to string with binary representation, caller must destruct
+
+ * @return	0 on success, something else otherwise.
+ */
+int ee_fmtEventToBinary(struct ee_event *event, es_str_t **str);
+
 #endif /* #ifndef LIBEE_EVENT_H_INCLUDED */
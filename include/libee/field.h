@@ -44,15 +44,21 @@
  * most common case is exactly one value. To support this effciently, we
  * store the first value directly within the structure and the 2nd+ in
  * a linked list.
+ *
+ * Fields are reference counted, so that cloned events can share them.
+ * A field referenced more than once is immutable. Use
+ * ee_getEventFieldForUpdate() to obtain a modifiable field from an event.
  */
 struct ee_field {
 	unsigned objID;		/**< magic number to identify the object */
 	ee_ctx ctx;		/**< associated library context */
 	es_str_t *name;		/**< the field name */
+	unsigned nameHash;	/**< hash of the name (for fast lookups) */
 	unsigned char nVals;	/**< number of values */
 	struct ee_value *val;	/**< value assigned to this field */
 	struct ee_valnode *valroot;	/**< list for 2nd+ values */
 	struct ee_valnode *valtail;	/**< tail of the value list (for fast insert) */
+	unsigned refCount;	/**< number of references held */
 };
 
 /**
@@ -83,8 +89,61 @@ struct ee_field* ee_newField(ee_ctx ctx);
  */
 struct ee_field* ee_newFieldFromNV(ee_ctx ctx, char *name, struct ee_value *val);
 
+/**
+ * Add an additional reference to the field.
+ *
+ * @memberof ee_field
+ * @public
+ *
+ * @param[in] field the field to add ref for
+ *
+ * @return address of ref-added field (for convenience)
+ */
+static inline struct ee_field*
+ee_addRefField(struct ee_field *field)
+{
+	field->refCount++;
+	return field;
+}
+
+
+/**
+ * Check if a field is shared, that is referenced more than once.
+ * A shared field must not be modified.
+ *
+ * @memberof ee_field
+ * @public
+ *
+ * @param[in] field the field to check
+ *
+ * @return 0 if not shared, something else otherwise
+ */
+static inline int
+ee_FieldIsShared(struct ee_field *field)
+{
+	return field->refCount > 1;
+}
+
+
+/**
+ * Create a private copy of a field.
+ * The copy has its own name and value list, but shares the (immutable)
+ * values themselves with the original field. So this is cheap even
+ * for large values.
+ *
+ * @memberof ee_field
+ * @public
+ *
+ * @param[in] field field to copy
+ *
+ * @return new field or NULL if an error occured
+ */
+struct ee_field* ee_dupField(struct ee_field *field);
+
 /**
  * Destructor for the ee_field object.
+ * This drops one reference, the field is destructed when the last
+ * reference is gone.
  *
  * @memberof ee_field
  * @public
@@ -126,14 +185,17 @@ int ee_nameField(struct ee_field *field, es_str_t *name);
  * @param[in] ctx library context
  * @param[in] val value to add to field
  *
- * @return 0 on success, something else otherwise
+ * @return 0 on success, EE_EINVAL if the field is shared, something
+ *         else otherwise
  */
 int ee_addValueToField(struct ee_field *field, struct ee_value *val);
 
 
 /**
  * Replace value in the field
- * Replace value at index n with new value val.
+ * Replace value at index n with new value val. The field must not be
+ * shared (see ee_getEventFieldForUpdate()). The old value is released, but if it is still referenced
+ * by a field of some other (cloned) event, it remains valid there.
  *
  * @memberof ee_field
  * @public
@@ -142,7 +204,8 @@ int ee_addValueToField(struct ee_field *field, struct ee_value *val);
  * @param[in] val new value
  * @param[in] n index of value to update
  *
- * @return 0 on success, something else otherwise
+ * @return 0 on success, EE_EINVAL if the field is shared, something
+ *         else otherwise
  */
 int ee_replaceValueInField(struct ee_field *field, struct ee_value *val, unsigned int n);
 
@@ -158,7 +221,8 @@ int ee_replaceValueInField(struct ee_field *field, struct ee_value *val, unsigne
  * @param[in] field field to update
  * @param[in] str string to add
  *
- * @return 0 on success, something else otherwise
+ * @return 0 on success, EE_EINVAL if the field is shared, something
+ *         else otherwise
  */
 int ee_addStrValueToField(struct ee_field *field, es_str_t *str);
 
@@ -37,6 +37,14 @@ struct ee_fieldbucket_listnode {
 	struct ee_fieldbucket_listnode *next;
 };
 
+/**
+ * Internal structure to represent a slot of the fieldbucket hash index.
+ */
+struct ee_fieldbucket_hashent {
+	unsigned hash;		/**< hash of the field name */
+	struct ee_field *field;	/**< field, NULL if slot is empty */
+};
+
 /**
  * The fieldbucket object, a container to store fields and their values.
  * Note that fields are stored inside a linked list in the field bucket.
@@ -46,6 +54,19 @@ struct ee_fieldbucket_listnode {
  * However, the cure is simple: as soon as we need random access, we add
  * a hashtable, and store key/pointer to listnode (or so) in it. That
  * way, we have some overhead, but otherwise the best of both worlds.
+ * This is what we now do: the hash index is built when the bucket
+ * reaches EE_FIELDBUCKET_HASH_MIN fields, and maintained from then on,
+ * so lookups never modify the bucket. If a field with the same name is present
+ * multiple times, the index (like the list search) finds the first one.
+ *
+ * A bucket may be bound to the layout of a fieldset (see fieldset.h).
+ * Then fields of the fieldset go into the list node of their slot, which
+ * is linked into the list when it is used, and lookups use the name index
+ * of the fieldset instead of the hash index.
+ *
+ * Field buckets are reference counted, so that cloned events can share
+ * them. Like for tag buckets, a shared field bucket is immutable and
+ * must be copied before it is modified (see ee_dupFieldbucket()).
  */
 struct ee_fieldbucket {
 	unsigned objID;
@@ -53,6 +74,13 @@ struct ee_fieldbucket {
 	ee_ctx ctx;		/**< associated library context */
 	struct ee_fieldbucket_listnode *root; /**< root of our field list */
 	struct ee_fieldbucket_listnode *tail; /**< list tail to speed up adding nodes */
+	unsigned refCount;	/**< number of references held */
+	unsigned nFields;	/**< number of fields in list */
+	struct ee_fieldbucket_hashent *htab; /**< hash index (NULL if not built) */
+	unsigned htabSize;	/**< size of hash index (always a power of two) */
+	struct ee_fieldset *layout; /**< fieldset the bucket is bound to, NULL if none */
+	struct ee_fieldbucket_listnode *slots; /**< one list node per slot of the
+				 *   layout, allocated together with the bucket */
 };
 
 /**
@@ -67,8 +95,71 @@ struct ee_fieldbucket {
  */
 struct ee_fieldbucket* ee_newFieldbucket(ee_ctx ctx);
 
+/**
+ * Constructor for a fieldbucket bound to the layout of a fieldset.
+ *
+ * @memberof ee_fieldbucket
+ * @public
+ *
+ * @param[in] fieldset the fieldset (compiled if this was not yet done)
+ *
+ * @return new fieldbucket or NULL if an error occured
+ */
+struct ee_fieldbucket* ee_newFieldbucketFromFieldset(struct ee_fieldset *fieldset);
+
+/**
+ * Add an additional reference to the fieldbucket.
+ *
+ * @memberof ee_fieldbucket
+ * @public
+ *
+ * @param[in] fieldbucket the fieldbucket to add ref for
+ *
+ * @return address of ref-added fieldbucket (for convenience)
+ */
+static inline struct ee_fieldbucket*
+ee_addRefFieldbucket(struct ee_fieldbucket *fieldbucket)
+{
+	fieldbucket->refCount++;
+	return fieldbucket;
+}
+
+/**
+ * Check if a fieldbucket is shared, that is referenced more than once.
+ * A shared bucket must not be modified.
+ *
+ * @memberof ee_fieldbucket
+ * @public
+ *
+ * @param[in] fieldbucket the fieldbucket to check
+ *
+ * @return 0 if not shared, something else otherwise
+ */
+static inline int
+ee_FieldbucketIsShared(struct ee_fieldbucket *fieldbucket)
+{
+	return fieldbucket->refCount > 1;
+}
+
+/**
+ * Create a private copy of a fieldbucket.
+ * Only the bucket's list is copied, the fields themselves are
+ * shared with the original bucket (they are copied on write
+ * via ee_getBucketFieldForUpdate()).
+ *
+ * @memberof ee_fieldbucket
+ * @public
+ *
+ * @param[in] fieldbucket the fieldbucket to copy
+ *
+ * @return newly created object or NULL if an error occured
+ */
+struct ee_fieldbucket* ee_dupFieldbucket(struct ee_fieldbucket *fieldbucket);
+
 /**
  * Destructor for the ee_fieldbucket object.
+ * This drops one reference. The bucket (including all fields it
+ * references) is only destructed when the last reference is gone.
  *
  * @memberof ee_fieldbucket
  * @public
@@ -94,6 +185,41 @@ void ee_deleteFieldbucket(struct ee_fieldbucket *fieldbucket);
 int ee_addFieldToBucket(struct ee_fieldbucket *fieldbucket, struct ee_field *field);
 
 
+/**
+ * Add a field to a slot of a bucket bound to a fieldset. The field
+ * must have the name of the slot's fieldtype. If the slot is already
+ * used, the field is added like any other.
+ *
+ * @memberof ee_fieldbucket
+ * @public
+ *
+ * @param[in] bucket	the bucket to modify
+ * @param[in] slot	slot number
+ * @param[in] field	field to be added
+ *
+ * @return 0 on success, something else otherwise
+ */
+int ee_addFieldToSlot(struct ee_fieldbucket *fieldbucket, unsigned slot, struct ee_field *field);
+
+
+/**
+ * Obtain the field of a slot of a bucket bound to a fieldset.
+ *
+ * @memberof ee_fieldbucket
+ * @public
+ *
+ * @param bucket bucket to search
+ * @param[in] slot slot number
+ *
+ * @return	NULL if the slot is empty; pointer to the field otherwise
+ */
+static inline struct ee_field*
+ee_getBucketFieldBySlot(struct ee_fieldbucket *bucket, unsigned slot)
+{
+	return bucket->slots[slot].field;
+}
+
+
 /**
  * Obtain a field with specified name from given bucket.
  *
@@ -108,4 +234,39 @@ int ee_addFieldToBucket(struct ee_fieldbucket *fieldbucket, struct ee_field *fie
  */
 struct ee_field* ee_getBucketField(struct ee_fieldbucket *bucket, es_str_t *name);
 
+/**
+ * Obtain a field with specified name from given bucket, where the
+ * name's hash has already been computed by the caller (this is used
+ * by precompiled field references).
+ *
+ * @memberof ee_fieldbucket
+ * @private
+ *
+ * @param bucket bucket to search
+ * @param[in] str name of field
+ * @param[in] hash ee_hashName() of name
+ *
+ * @return	NULL if field was not found (or an error occured);
+ *              pointer to the field otherwise
+ */
+struct ee_field* ee_getBucketFieldHashed(struct ee_fieldbucket *bucket, es_str_t *name,
+		unsigned hash);
+
+/**
+ * Obtain a modifiable field with specified name from given bucket.
+ * If the field is shared with some other bucket, it is replaced by a
+ * private copy inside this bucket (copy-on-write). The bucket itself
+ * must not be shared.
+ *
+ * @memberof ee_fieldbucket
+ * @public
+ *
+ * @param bucket bucket to search
+ * @param[in] str name of field
+ *
+ * @return	NULL if field was not found (or an error occured);
+ *              pointer to the (unshared) field otherwise
+ */
+struct ee_field* ee_getBucketFieldForUpdate(struct ee_fieldbucket *bucket, es_str_t *name);
+
 #endif /* #ifndef LIBEE_FIELDBUCKET_H_INCLUDED */
@@ -0,0 +1,80 @@
+/**
+ * @file fieldref.h
+ * @brief Precompiled references to event fields.
+ * @class ee_fieldref fieldref.h
+ *
+ * Applications like rsyslog evaluate the same small set of field names
+ * (in templates and filters) over and over again for each event. A
+ * field reference is the compiled form of such a name: everything that
+ * can be done without the actual event at hand (checking for special
+ * names, hashing) is done once, at compile time. Looking up a field via
+ * a reference is then a direct probe into the event's field bucket.
+ *//*
+ *
+ * Libee - An Event Expression Library inspired by CEE
+ * Copyright 2012 by Rainer Gerhards and Adiscon GmbH.
+ *
+ * This file is part of libee.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * A copy of the LGPL v2.1 can be found in the file "COPYING" in this distribution.
+ */
+#ifndef LIBEE_FIELDREF_H_INCLUDED
+#define	LIBEE_FIELDREF_H_INCLUDED
+
+/**
+ * The fieldref object.
+ */
+struct ee_fieldref_s {
+	unsigned objID;		/**< a magic number to prevent some memory adressing errors */
+	ee_ctx ctx;		/**< associated library context */
+	enum {
+		ee_fieldref_field = 0,	/**< regular field inside the fieldbucket */
+		ee_fieldref_tags = 1	/**< the pseudo-field "event.tags" */
+	} kind;			/**< what kind of entity is referenced */
+	es_str_t *name;		/**< the field name */
+	unsigned hash;		/**< precomputed hash of the name */
+};
+
+/**
+ * The field reference handle.
+ */
+typedef struct ee_fieldref_s* ee_fieldref;
+
+/**
+ * Compile a field path into a field reference.
+ *
+ * @memberof ee_fieldref
+ * @public
+ *
+ * @param[in] ctx library context
+ * @param[in] name field name (C-string), e.g. "event.tags" or "src.ip"
+ *
+ * @return new field reference or NULL if an error occured
+ */
+ee_fieldref ee_compileFieldPath(ee_ctx ctx, char *name);
+
+/**
+ * Destructor for the ee_fieldref object.
+ *
+ * @memberof ee_fieldref
+ * @public
+ *
+ * @param[in] ref the field reference to be discarded
+ */
+void ee_deleteFieldref(ee_fieldref ref);
+
+#endif /* #ifndef LIBEE_FIELDREF_H_INCLUDED */
@@ -3,6 +3,26 @@
  * @brief The CEE FieldSet Object.
  * @class ee_fieldset fieldset.h
  *
+ * A fieldset describes an event type: the fields its events have (as
+ * fieldtypes, see fieldtype.h) and the tags they carry (see tagset.h).
+ * Once all fieldtypes are added, the fieldset is compiled into a fixed
+ * layout, where each fieldtype has a slot.
+ *
+ * Events created via ee_newEventFromFieldset() are bound to the layout.
+ * Their field bucket has one pre-allocated list node per slot, so adding
+ * a field to its slot needs no allocation, and fields are found by slot
+ * number (ee_getEventFieldBySlot()) without any search. Lookups by name
+ * use the index of the fieldset, which is built once for all events,
+ * instead of a per-event hash index. Values can be added as text, which
+ * the parser of the fieldtype converts into a typed value, and the
+ * number of values is checked against the cardinality of the fieldtype.
+ * Fields that are not part of the fieldset can still be added; they are
+ * handled like in other events.
+ *
+ * Event types may be registered with the library context, which then
+ * owns them, so that they can be looked up by name. Fieldsets are
+ * reference counted; each event bound to one holds a reference.
+ *
  *//*
  *
  * Libee - An Event Expression Library inspired by CEE
@@ -29,12 +49,30 @@
 #ifndef LIBEE_FIELDSET_H_INCLUDED
 #define	LIBEE_FIELDSET_H_INCLUDED
 
+/**
+ * A slot of the fieldset name index.
+ */
+struct ee_fieldset_hashent {
+	unsigned hash;		/**< hash of the field name */
+	unsigned slot;		/**< slot of the field */
+	struct ee_fieldtype *type; /**< fieldtype, NULL if entry is empty */
+};
+
 /**
  * The CEE FieldSet Object.
  * @extends ee_obj
  */
 struct ee_fieldset {
-	struct ee_obj o;	/*<< @protected base object */
+	struct ee_obj o;	/*<< @protected base object, o.name is the
+				 *   name of the event type */
+	unsigned refCount;	/**< number of references held */
+	unsigned nSlots;	/**< number of fieldtypes */
+	unsigned sizeSlots;	/**< number of fieldtypes allocated */
+	struct ee_fieldtype **types; /**< fieldtypes by slot */
+	struct ee_fieldset_hashent *htab; /**< name index (NULL if not compiled) */
+	unsigned htabSize;	/**< size of name index (always a power of two) */
+	struct ee_tagset *tagset; /**< tags of the events, NULL if none */
+	struct ee_fieldset *next; /**< next registered fieldset */
 };
 
 /**
@@ -43,12 +81,34 @@ struct ee_fieldset {
  * @memberof ee_fieldset
  * @public
  *
- * @return new library context or NULL if an error occured
+ * @param[in] ctx library context
+ * @param[in] name name of the event type
+ *
+ * @return new fieldset or NULL if an error occured
  */
-struct ee_fieldset* ee_newFieldset(void);
+struct ee_fieldset* ee_newFieldset(ee_ctx ctx, char *name);
+
+/**
+ * Add an additional reference to the fieldset.
+ *
+ * @memberof ee_fieldset
+ * @public
+ *
+ * @param[in] fieldset the fieldset to add ref for
+ *
+ * @return address of ref-added fieldset (for convenience)
+ */
+static inline struct ee_fieldset*
+ee_addRefFieldset(struct ee_fieldset *fieldset)
+{
+	fieldset->refCount++;
+	return fieldset;
+}
 
 /**
  * Destructor for the ee_fieldset object.
+ * This drops one reference. The fieldset (including its fieldtypes and
+ * tagset) is only destructed when the last reference is gone.
  *
  * @memberof ee_fieldset
  * @public
@@ -57,5 +117,119 @@ struct ee_fieldset* ee_newFieldset(void);
  */
 void ee_deleteFieldset(struct ee_fieldset *fieldset);
 
+/**
+ * Add a fieldtype. Its slot is the number of fieldtypes added before.
+ * This is only possible before the fieldset is compiled.
+ *
+ * @memberof ee_fieldset
+ * @public
+ *
+ * @param[in] fieldset the fieldset
+ * @param[in] fieldtype the fieldtype, which is now owned by the fieldset
+ *            (on success only)
+ *
+ * @return 0 on success, EE_EINVAL if the fieldset is already compiled or
+ *         there already is a fieldtype of the same name, something else
+ *         otherwise
+ */
+int ee_addFieldtypeToSet(struct ee_fieldset *fieldset, struct ee_fieldtype *fieldtype);
+
+/**
+ * Assign the tags that all events of the fieldset carry. A tagset
+ * assigned before is discarded.
+ *
+ * @memberof ee_fieldset
+ * @public
+ *
+ * @param[in] fieldset the fieldset
+ * @param[in] tagset the tagset, which is now owned by the fieldset
+ */
+void ee_assignTagsetToFieldset(struct ee_fieldset *fieldset, struct ee_tagset *tagset);
+
+/**
+ * Compile the fieldset, that is build its name index. Afterwards, no
+ * more fieldtypes can be added. Compiling a compiled fieldset does
+ * nothing.
+ *
+ * @memberof ee_fieldset
+ * @public
+ *
+ * @param[in] fieldset the fieldset
+ *
+ * @return 0 on success, something else otherwise
+ */
+int ee_compileFieldset(struct ee_fieldset *fieldset);
+
+/**
+ * Find the slot of a field, given its name and the name's hash.
+ * The fieldset must be compiled.
+ *
+ * @memberof ee_fieldset
+ * @public
+ *
+ * @param[in] fieldset the fieldset
+ * @param[in] name field name
+ * @param[in] len length of name
+ * @param[in] hash ee_hashName() of name
+ *
+ * @return slot number or -1 if the field is not part of the fieldset
+ */
+int ee_findFieldsetSlot(struct ee_fieldset *fieldset, unsigned char *name,
+			es_size_t len, unsigned hash);
+
+/**
+ * Find the slot of a field by name. The fieldset must be compiled.
+ * Callers that access fields repeatedly should do this once and then
+ * use the slot number.
+ *
+ * @memberof ee_fieldset
+ * @public
+ *
+ * @param[in] fieldset the fieldset
+ * @param[in] name field name (C-string)
+ *
+ * @return slot number or -1 if the field is not part of the fieldset
+ */
+int ee_getFieldsetSlot(struct ee_fieldset *fieldset, char *name);
+
+/**
+ * Register a fieldset with the library context. It is compiled if this
+ * was not yet done. The context takes over the reference of the caller
+ * and releases it in ee_exitCtx().
+ *
+ * @memberof ee_fieldset
+ * @public
+ *
+ * @param[in] ctx library context
+ * @param[in] fieldset the fieldset
+ *
+ * @return 0 on success, EE_EINVAL if an event type of the same name is
+ *         already registered, something else otherwise
+ */
+int ee_registerFieldset(ee_ctx ctx, struct ee_fieldset *fieldset);
+
+/**
+ * Find a registered fieldset.
+ *
+ * @memberof ee_fieldset
+ * @public
+ *
+ * @param[in] ctx library context
+ * @param[in] name name of the event type
+ *
+ * @return the fieldset or NULL if there is none of this name
+ */
+struct ee_fieldset* ee_findFieldset(ee_ctx ctx, char *name);
+
+/**
+ * Release all registered fieldsets. Called when the context is
+ * destructed.
+ *
+ * @memberof ee_fieldset
+ * @private
+ *
+ * @param[in] ctx library context
+ */
+void ee_deleteFieldsets(ee_ctx ctx);
 
 #endif /* #ifndef LIBEE_FIELDSET_H_INCLUDED */
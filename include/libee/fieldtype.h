@@ -36,12 +36,21 @@
  * 
  * In v0.5 of the interim CEE spec, this was called a "Field".
  *
+ * A fieldtype declares the name of a field, the type of its values and
+ * how many values it may have. The type is a parser of the registry
+ * (see parser.h), which converts text into typed values. Fieldtypes are
+ * combined into fieldsets, which describe the fields of an event type.
+ *
  * @extends ee_obj
  */
 struct ee_fieldtype {
 	struct ee_obj o;	/*<< the base object */
-	struct ee_tagset *fromTagSet;
-	struct ee_fieldtypeset *fieldtypeSet;
+	es_str_t *name;		/**< field name */
+	unsigned nameHash;	/**< hash of the field name */
+	struct ee_parser *parser; /**< parser for values given as text,
+				 *   NULL if values are strings */
+	unsigned char minVals;	/**< minimum number of values */
+	unsigned char maxVals;	/**< maximum number of values, 0 if not limited */
 };
 
 /**
@@ -50,9 +59,20 @@ struct ee_fieldtype {
  * @memberof ee_fieldtype
  * @public
  *
- * @return new library context or NULL if an error occured
+ * @param[in] ctx library context
+ * @param[in] name field name
+ * @param[in] type name of the parser for the values (e.g. "ipv4") or
+ *            NULL for strings. Parsers that need extra data are not
+ *            supported.
+ * @param[in] minVals minimum number of values (0 if the field is optional)
+ * @param[in] maxVals maximum number of values (0 if not limited, at
+ *            most 255)
+ *
+ * @return new fieldtype or NULL if an error occured (including an
+ *         unknown type)
  */
-struct ee_fieldtype* ee_newFieldtype(void);
+struct ee_fieldtype* ee_newFieldtype(ee_ctx ctx, char *name, char *type,
+				     unsigned minVals, unsigned maxVals);
 
 /**
  * Destructor for the ee_fieldtype object.
@@ -64,5 +84,22 @@ struct ee_fieldtype* ee_newFieldtype(void);
  */
 void ee_deleteFieldtype(struct ee_fieldtype *fieldtype);
 
+/**
+ * Create a value of the fieldtype from text. The text must match the
+ * type in full.
+ *
+ * @memberof ee_fieldtype
+ * @public
+ *
+ * @param[in] fieldtype the fieldtype
+ * @param[in] buf the text
+ * @param[in] len length of buf
+ * @param[out] value the new value
+ *
+ * @return 0 on success, EE_WRONGPARSER if the text does not match the
+ *         type, something else otherwise
+ */
+int ee_newValueFromFieldtype(struct ee_fieldtype *fieldtype, unsigned char *buf,
+			     es_size_t len, struct ee_value **value);
 
 #endif /* #ifndef LIBEE_FIELDTYPE_H_INCLUDED */
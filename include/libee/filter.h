@@ -0,0 +1,188 @@
+/**
+ * @file filter.h
+ * @brief Event filters, evaluated by the decoders.
+ * @class ee_filter filter.h
+ *
+ * A filter is a list of terms, separated by whitespace, which must all
+ * be true for an event to be accepted. Terms are:
+ *
+ * @verbatim
+   name=value        field is equal to value
+   name!=value       field is not equal to value
+   name^=value       field starts with value
+   name={a,b,c}      field is equal to one of a, b, c
+   name<n, name<=n, name>n, name>=n
+                     field is a number and compares as given to n
+   #tag              event has the tag
+   !#tag             event does not have the tag
+   @endverbatim
+ *
+ * Values may be quoted ("a b"), inside quotes a backslash escapes the
+ * next character. A field term must be true for each occurence of the
+ * field, and is true for an occurence if any of its values matches; if
+ * the field does not exist, it is false (so "sev!=debug" requires field
+ * "sev" to be present).
+ *
+ * The filter is set on the library context (ee_setFilter()). The
+ * decoders evaluate each field term as soon as the field is complete
+ * and abandon the event as soon as a term is false, without creating
+ * the rest of the event. Rejected events are not passed to the
+ * callback, ee_newEventFrom*() return NULL for them. Fields do not need
+ * to be in the projection set to be checked. The binary decoder
+ * does not filter, as binary records are usually written after
+ * filtering.
+ *//*
+ *
+ * Libee - An Event Expression Library inspired by CEE
+ * Copyright 2012 by Rainer Gerhards and Adiscon GmbH.
+ *
+ * This file is part of libee.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * A copy of the LGPL v2.1 can be found in the file "COPYING" in this distribution.
+ */
+#ifndef LIBEE_FILTER_H_INCLUDED
+#define	LIBEE_FILTER_H_INCLUDED
+#include <libestr.h>
+
+/** maximum number of terms in a filter */
+#define EE_FILTER_MAX_TERMS 64
+
+/** term types */
+enum ee_filterOp {
+	ee_fop_EQ,	/**< equal */
+	ee_fop_NE,	/**< not equal */
+	ee_fop_PREFIX,	/**< starts with */
+	ee_fop_IN,	/**< equal to one of a set */
+	ee_fop_LT,	/**< numerically less than */
+	ee_fop_LE,	/**< numerically less than or equal */
+	ee_fop_GT,	/**< numerically greater than */
+	ee_fop_GE,	/**< numerically greater than or equal */
+	ee_fop_TAG,	/**< event has tag */
+	ee_fop_NOTAG	/**< event does not have tag */
+};
+
+/**
+ * A term of a filter.
+ */
+struct ee_filterTerm {
+	enum ee_filterOp op;	/**< what to check */
+	es_str_t *name;		/**< field name (tag name for tag terms) */
+	unsigned nameHash;	/**< hash of the field name */
+	unsigned nVals;		/**< number of values (more than one only for IN) */
+	es_str_t **vals;	/**< values to compare to */
+	double number;		/**< value for numerical compares */
+};
+
+/**
+ * The compiled filter.
+ */
+struct ee_filter {
+	unsigned objID;		/**< a magic number to prevent some memory adressing errors */
+	unsigned nTerms;	/**< number of terms */
+	struct ee_filterTerm *terms;	/**< the terms */
+	unsigned long long fieldTerms;	/**< bit i is set if term i is a field term */
+	unsigned long long hashFilter;	/**< bit (hash % 64) is set for each field
+					 *   name, permits to reject most names quickly */
+};
+
+/**
+ * The state of the filter while an event is decoded.
+ */
+struct ee_filterState {
+	unsigned long long matched;	/**< bit i is set if term i was true
+					 *   for the current field */
+	unsigned long long seen;	/**< bit i is set if term i was true
+					 *   for all occurences of its field */
+};
+
+/**
+ * Compile a filter expression.
+ *
+ * @memberof ee_filter
+ * @public
+ *
+ * @param[in] expr the filter expression (see above)
+ *
+ * @return new filter or NULL if the expression is invalid or an error
+ *         occured
+ */
+struct ee_filter* ee_newFilter(char *expr);
+
+/**
+ * Destructor for the ee_filter object.
+ *
+ * @memberof ee_filter
+ * @public
+ *
+ * @param[in] filter object to be destructed
+ */
+void ee_deleteFilter(struct ee_filter *filter);
+
+/* internal functions, for use by the decoders. The filter of the
+ * context is used, all of them may only be called if there is one.
+ */
+
+/**
+ * Obtain the terms that check a field.
+ *
+ * @return bit i is set if term i checks the field
+ */
+unsigned long long ee_filterTerms(ee_ctx ctx, unsigned char *name, es_size_t len, unsigned hash);
+
+/**
+ * Evaluate the terms for one value of a field. The value is passed
+ * as buffer, so that decoders need not create a string for it.
+ */
+void ee_filterValue(ee_ctx ctx, struct ee_filterState *state, unsigned long long terms,
+		    unsigned char *buf, es_size_t len);
+
+/**
+ * Evaluate the terms for all values of a field and check that they
+ * are true. This is the same as calling ee_filterValue() for all values
+ * and then ee_filterFieldDone().
+ *
+ * @return 0 if the terms are true, EE_FILTERED otherwise
+ */
+int ee_filterField(ee_ctx ctx, struct ee_filterState *state, unsigned long long terms,
+		   struct ee_field *field);
+
+/**
+ * Check that the terms for a field are true, after all its values were
+ * evaluated. This must be called once for each occurence of the field,
+ * as the terms are evaluated anew for the next one.
+ *
+ * @return 0 if they are true, EE_FILTERED otherwise
+ */
+static inline int
+ee_filterFieldDone(struct ee_filterState *state, unsigned long long terms)
+{
+	if(terms & ~state->matched)
+		return EE_FILTERED;
+	state->matched &= ~terms;
+	state->seen |= terms;
+	return 0;
+}
+
+/**
+ * Check the remaining terms (absent fields and tags) for the complete
+ * event.
+ *
+ * @return 0 if the event is accepted, EE_FILTERED otherwise
+ */
+int ee_filterEvent(ee_ctx ctx, struct ee_filterState *state, struct ee_event *event);
+
+#endif /* #ifndef LIBEE_FILTER_H_INCLUDED */
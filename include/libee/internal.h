@@ -25,6 +25,8 @@
 #ifndef LIBEE_INTERNAL_H_INCLUDED
 
 #define	LIBEE_INTERNAL_H_INCLUDED
+#include <string.h>
+
 #define CHKR(x) \
 	if((r = (x)) != 0) goto done
 
@@ -34,4 +36,191 @@
 		goto done; \
 	}
 
+/**
+ * Check if a field is in the projection set of the context, that is if
+ * decoders shall create it. hash must be ee_hashName() of the name.
+ */
+static inline int
+ee_isProjected(ee_ctx ctx, unsigned char *name, es_size_t len, unsigned hash)
+{
+	struct ee_projection *proj = ctx->projection;
+	unsigned i;
+
+	if(proj == NULL)
+		return 1;
+	if(!(proj->filter & (1ull << (hash % 64))))
+		return 0;
+	for(i = 0 ; i < proj->nNames ; ++i)
+		if(   proj->hashes[i] == hash && es_strlen(proj->names[i]) == len
+		   && !memcmp(es_getBufAddr(proj->names[i]), name, len))
+			return 1;
+	return 0;
+}
+
+/* Diagnostics. DBGPRINTF() is lazy: the message is only formatted (and
+ * its arguments evaluated) if a debug callback is set and the level is
+ * enabled. CHKOBJ() validates the magic number of an object and fails
+ * with -1. With --disable-diagnostics, both compile to nothing (the
+ * "if(0)" just keeps the done label in use).
+ */
+#ifdef DISABLE_DIAGNOSTICS
+#define DBGPRINTF(ctx, level, ...) ((void)0)
+#define CHKOBJ(obj, id) \
+	if(0) goto done
+#else
+#define DBGPRINTF(ctx, level, ...) \
+	do { \
+		if((ctx)->dbgCB != NULL && (level) <= (ctx)->dbgLevel) \
+			ee_dbgprintf((ctx), __VA_ARGS__); \
+	} while(0)
+#define CHKOBJ(obj, id) \
+	if((obj)->objID != (id)) { \
+		r = -1; \
+		goto done; \
+	}
+#endif
+
+/**
+ * Hash function for field names (FNV-1a). Used by the field bucket
+ * index as well as by compiled field references.
+ */
+static inline unsigned
+ee_hashName(unsigned char *name, es_size_t len)
+{
+	unsigned h = 2166136261u;
+	es_size_t i;
+
+	for(i = 0 ; i < len ; ++i) {
+		h ^= name[i];
+		h *= 16777619u;
+	}
+	return h;
+}
+
+/* SWAR helpers for the decoders, to check eight bytes at once.
+ * SWAR_HASBYTE(x, c) is non-zero if any byte of x equals c.
+ */
+#define SWAR_ONES	0x0101010101010101ULL
+#define SWAR_HIGHS	0x8080808080808080ULL
+#define SWAR_HASZERO(x)	(((x) - SWAR_ONES) & ~(x) & SWAR_HIGHS)
+#define SWAR_HASBYTE(x, c) SWAR_HASZERO((x) ^ (SWAR_ONES * (c)))
+
+/**
+ * Append a part of a buffer to a (possibly not yet existing) value
+ * string. Decoders use this to assemble values that contain escapes.
+ * If valstr is NULL, the value is skipped and nothing is done.
+ */
+static inline int
+ee_addToValStr(es_str_t **valstr, unsigned char *buf, es_size_t len)
+{
+	int r = 0;
+
+	if(valstr == NULL) /* value is skipped */
+		goto done;
+	if(*valstr == NULL) {
+		CHKN(*valstr = es_newStrFromBuf((char*) buf, len));
+	} else if(len > 0) {
+		r = es_addBuf(valstr, (char*) buf, len);
+	}
+
+done:
+	return r;
+}
+
+/**
+ * Decode a JSON object into a new event. This is ee_newEventFromJSON()
+ * with a return code, so that the JSON decoder can tell filtered
+ * events from errors.
+ *
+ * @return 0 on success, EE_FILTERED if the filter rejected the event,
+ *         something else otherwise
+ */
+int ee_decodeJSON(ee_ctx ctx, char *str, struct ee_event **event);
+
+/**
+ * Set up the locale used for number conversion. Called by ee_initCtx(),
+ * so it is done before any number is converted.
+ */
+void ee_initNumLocale(void);
+
+/**
+ * strtod(), but always with '.' as decimal point, whatever LC_NUMERIC
+ * the application has set.
+ */
+double ee_strtod(char *str, char **end);
+
+/* Statistics counters (see struct ee_stats). If not enabled, the
+ * macros expand to no-ops, so there is no cost at all. All of them
+ * (but STATS_TIMER_DECL) are statements.
+ */
+#ifdef ENABLE_STATS
+#include <time.h>
+
+static inline unsigned long long
+ee_statsNow(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (unsigned long long) ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+#define STATS_INC(ctx, ctr) ((ctx)->stats.ctr++)
+#define STATS_ADD(ctx, ctr, n) ((ctx)->stats.ctr += (n))
+#define STATS_TIMER_DECL unsigned long long statsStart;
+#define STATS_TIMER_START statsStart = ee_statsNow()
+#define STATS_TIMER_STOP(ctx, ctr) ((ctx)->stats.ctr += ee_statsNow() - statsStart)
+#define STATS_PARSER(ctx, idx, r) \
+	do { \
+		if((r) == 0) \
+			(ctx)->stats.parsers[idx].hits++; \
+		else if((r) == EE_WRONGPARSER) \
+			(ctx)->stats.parsers[idx].misses++; \
+	} while(0)
+/* all encoders start with a 256 byte buffer, anything larger means
+ * it had to be regrown (probably more than once)
+ */
+#define STATS_ENCODED(ctx, str) \
+	do { \
+		if((str) != NULL) { \
+			(ctx)->stats.eventsEncoded++; \
+			if((str)->lenBuf > 256) \
+				(ctx)->stats.encBufGrows++; \
+		} \
+	} while(0)
+#else
+#define STATS_INC(ctx, ctr) ((void)0)
+#define STATS_ADD(ctx, ctr, n) ((void)0)
+#define STATS_TIMER_DECL
+#define STATS_TIMER_START ((void)0)
+#define STATS_TIMER_STOP(ctx, ctr) ((void)0)
+#define STATS_PARSER(ctx, idx, r) ((void)0)
+#define STATS_ENCODED(ctx, str) ((void)0)
+#endif
+
+/* Static tracepoints (USDT, provider "libee"), for use with perf,
+ * bpftrace, SystemTap and the like. They cost a nop each if no tracer
+ * is attached. Available probes and their arguments are:
+ *
+ * event_new(event)                  after an event was constructed
+ * event_delete(event)               before an event is destructed
+ * decode_start(format, lnNbr)       decoder starts to process a line
+ * decode_done(format, lnNbr, r)     ... and is done with it (r is the
+ *                                   return code, callbacks excluded)
+ * encode_start(format, event)       encoder is called
+ * encode_done(format, event, r)     ... and returns r
+ *
+ * format is a string like "json" or "apache".
+ */
+#ifdef ENABLE_USDT
+#include <sys/sdt.h>
+#define TRACE1(name, a) DTRACE_PROBE1(libee, name, a)
+#define TRACE2(name, a, b) DTRACE_PROBE2(libee, name, a, b)
+#define TRACE3(name, a, b, c) DTRACE_PROBE3(libee, name, a, b, c)
+#else
+#define TRACE1(name, a) ((void)0)
+#define TRACE2(name, a, b) ((void)0)
+#define TRACE3(name, a, b, c) ((void)0)
+#endif
+
 #endif /* #ifndef EE_H_INCLUDED */
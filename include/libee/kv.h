@@ -0,0 +1,162 @@
+/**
+ * @file kv.h
+ * The key=value (logfmt) decoder.
+ *
+ * @class ee_kv kv.h
+ *
+ * This decodes lines of key=value pairs, as written by many
+ * applications, e.g.
+ *
+ * @verbatim
+   ts=2012-05-02T10:00:00Z level=info msg="user logged in" user=joe
+   @endverbatim
+ *
+ * Each pair becomes a string field of the event. The characters that
+ * separate pairs (default: space and tab), that separate the key from
+ * the value (default: '=') and that quote values (default: '"') can be
+ * configured. Inside a quoted value, a backslash escapes the next
+ * character (\\n and \\t are newline and tab). A key without separator
+ * and value (e.g. "debug") results in a field with an empty value.
+ *
+ * Keys and values are located by scanning for the bytes of a
+ * delimiter set, using a 256-bit table. If SSE2 is available at
+ * compile time and the set is small, 16 bytes are checked at once.
+ *//*
+ *
+ * Libee - An Event Expression Library inspired by CEE
+ * Copyright 2012 by Rainer Gerhards and Adiscon GmbH.
+ *
+ * This file is part of libee.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * A copy of the LGPL v2.1 can be found in the file "COPYING" in this distribution.
+ */
+#ifndef LIBEE_KV_H_INCLUDED
+#define	LIBEE_KV_H_INCLUDED
+#include <libestr.h>
+
+/** maximum number of characters in a delimiter set */
+#define EE_KV_MAX_DELIMS 16
+
+/**
+ * A set of delimiter characters.
+ */
+struct ee_kv_delims {
+	unsigned char map[32];	/**< bitmap of the characters in the set */
+	unsigned char nChars;	/**< number of characters in the set */
+	unsigned char chars[EE_KV_MAX_DELIMS]; /**< the characters (for SIMD scanning) */
+};
+
+/**
+ * The key=value decoder object. It holds the configuration only,
+ * so it can be used for any number of lines.
+ */
+struct ee_kv {
+	unsigned objID;		/**< a magic number to prevent some memory adressing errors */
+	ee_ctx ctx;		/**< associated library context */
+	struct ee_kv_delims pairSeps;	/**< separate the pairs */
+	struct ee_kv_delims kvSeps;	/**< separate key and value */
+	struct ee_kv_delims quotes;	/**< quote values */
+	struct ee_kv_delims keyEnd;	/**< end a key: pair or key/value separators */
+	struct ee_kv_delims quoteEnd;	/**< special inside a quoted value:
+					 *   quote characters and backslash */
+};
+
+/**
+ * Constructor for the ee_kv object. The new decoder uses the logfmt
+ * defaults.
+ *
+ * @memberof ee_kv
+ * @public
+ *
+ * @param[in] ctx library context
+ *
+ * @return new decoder or NULL if an error occured
+ */
+struct ee_kv* ee_newKV(ee_ctx ctx);
+
+/**
+ * Destructor for the ee_kv object.
+ *
+ * @memberof ee_kv
+ * @public
+ *
+ * @param[in] kv object to be destructed
+ */
+void ee_deleteKV(struct ee_kv *kv);
+
+/**
+ * Configure the separators and quote characters. Each parameter is a
+ * C-string holding the set of characters (each of them has the same
+ * meaning). The sets must not be empty or overlap, a backslash is not
+ * permitted.
+ *
+ * @memberof ee_kv
+ * @public
+ *
+ * @param[in] kv the decoder
+ * @param[in] pairSeps characters that separate pairs, NULL to keep the
+ *            current setting
+ * @param[in] kvSeps characters that separate key and value, NULL to
+ *            keep the current setting
+ * @param[in] quotes quote characters, NULL to keep the current setting
+ *
+ * @return 0 on success, EE_EINVAL if the sets are invalid (the decoder
+ *         is unchanged in this case)
+ */
+int ee_setKVSeparators(struct ee_kv *kv, char *pairSeps, char *kvSeps, char *quotes);
+
+/**
+ * Create an event from a line of key=value pairs.
+ *
+ * @memberof ee_kv
+ * @public
+ *
+ * @param[in] kv the decoder
+ * @param[in] str the line
+ *
+ * @return new event or NULL if the line is invalid (an unterminated
+ *         quoted value) or an error occured
+ */
+struct ee_event* ee_newEventFromKV(struct ee_kv *kv, es_str_t *str);
+
+/**
+ * Decode lines of key=value pairs into CEE structures.
+ *
+ * The interface is heavily callback-based, just like the other
+ * decoders (see apache.h).
+ *
+ * @memberof ee_kv
+ * @public
+ *
+ * @param[in] ctx library context to use, must be the one the decoder
+ *            was created with
+ * @param[in] cbGetLine get next line to be processed. Returns
+ *            0 if all went well, EE_EOF at end of file and something
+ *            else otherwise.
+ * @param[in] cbNewEvt callback for function that receives newly created
+ *            events. It must return 0 on success and something else otherwise.
+ * @param[out] errStr printable error message, provided only if an error
+ *             occurs. If so, the caller must delete the provided pointer.
+ * @param[in] kv the decoder configuration
+ * @returns 0 on success, EE_EINVAL if ctx is not the context of the
+ *          decoder, something else otherwise
+ */
+int ee_kvDec(ee_ctx ctx, int (*cbGetLine)(es_str_t **ln),
+	     int (*cbNewEvt)(struct ee_event *event),
+	     es_str_t **errMsg, struct ee_kv *kv);
+
+#endif /* #ifndef LIBEE_KV_H_INCLUDED */
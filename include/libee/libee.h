@@ -159,8 +159,12 @@
 #include "libee/timestamp.h"
 #include "libee/value.h"
 #include "libee/fieldtype.h"
+#include "libee/tagset.h"
+#include "libee/fieldset.h"
 #include "libee/field.h"
 #include "libee/fieldbucket.h"
+#include "libee/fieldref.h"
+#include "libee/parser.h"
 #include "libee/primitivetype.h"
 #include "libee/tagbucket.h"
 #include "libee/event.h"
@@ -177,6 +181,7 @@
 #define EE_WRONGPARSER -7
 #define EE_EINVAL -8 		/* invalid value provided on API */
 #define EE_NOTFOUND -9 		/* some object could not be found */
+#define EE_FILTERED -10		/* event was rejected by the filter */
 
 /* some important constants */
 #define LIBEE_CEE_MAX_VALS_PER_FIELD 255
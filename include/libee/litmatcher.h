@@ -0,0 +1,171 @@
+/**
+ * @file litmatcher.h
+ * @brief Find a set of literal strings in a buffer, in a single pass.
+ * @class ee_litmatcher litmatcher.h
+ *
+ * The literal matcher is an Aho-Corasick automaton. All literals are
+ * compiled into one trie with failure links, so a buffer is scanned
+ * byte by byte exactly once, no matter how many literals there are.
+ * The result of a scan is the set of literals that occur anywhere in
+ * the buffer. The normalizer uses it to rule out all rules whose
+ * literal text is not part of a message before any parser is called.
+ *
+ * The trie root has a full transition table, as do all states with
+ * many transitions; other states keep a short list. The matcher keeps
+ * the result of the last scan itself, so a matcher must not be used
+ * by multiple threads concurrently.
+ *//*
+ *
+ * Libee - An Event Expression Library inspired by CEE
+ * Copyright 2012 by Rainer Gerhards and Adiscon GmbH.
+ *
+ * This file is part of libee.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * A copy of the LGPL v2.1 can be found in the file "COPYING" in this distribution.
+ */
+#ifndef LIBEE_LITMATCHER_H_INCLUDED
+#define	LIBEE_LITMATCHER_H_INCLUDED
+#include <libestr.h>
+
+/**
+ * A transition of the automaton (only used by states without table).
+ */
+struct ee_litmatcherEdge {
+	unsigned char c;	/**< input byte */
+	unsigned target;	/**< state to go to */
+	unsigned next;		/**< next transition of the same state, 0 if none */
+};
+
+/**
+ * A state of the automaton. State 0 is the root.
+ */
+struct ee_litmatcherState {
+	unsigned fail;		/**< state to continue with if there is no transition */
+	unsigned out;		/**< next state on the failure chain that ends
+				 *   a literal, 0 if none */
+	int lit;		/**< literal that ends here, -1 if none */
+	unsigned edges;		/**< first transition, 0 if none */
+	unsigned nEdges;	/**< number of transitions */
+	unsigned *table;	/**< transition table for all 256 bytes or NULL */
+};
+
+/**
+ * The literal matcher object.
+ */
+struct ee_litmatcher {
+	unsigned objID;		/**< a magic number to prevent some memory adressing errors */
+	ee_ctx ctx;		/**< associated library context */
+	unsigned nStates;	/**< number of states */
+	unsigned sizeStates;	/**< number of states allocated */
+	struct ee_litmatcherState *states; /**< the states */
+	unsigned nEdges;	/**< number of transitions (including the unused first one) */
+	unsigned sizeEdges;	/**< number of transitions allocated */
+	struct ee_litmatcherEdge *edges; /**< the transitions */
+	unsigned nLits;		/**< number of literals */
+	int bCompiled;		/**< failure links are up to date */
+	unsigned gen;		/**< number of the last scan */
+	unsigned *found;	/**< per literal, number of the last scan that found it */
+};
+
+/**
+ * Constructor for the ee_litmatcher object. The new matcher has
+ * no literals.
+ *
+ * @memberof ee_litmatcher
+ * @public
+ *
+ * @param[in] ctx library context
+ *
+ * @return new matcher or NULL if an error occured
+ */
+struct ee_litmatcher* ee_newLitmatcher(ee_ctx ctx);
+
+/**
+ * Destructor for the ee_litmatcher object.
+ *
+ * @memberof ee_litmatcher
+ * @public
+ *
+ * @param[in] matcher object to be destructed
+ */
+void ee_deleteLitmatcher(struct ee_litmatcher *matcher);
+
+/**
+ * Add a literal. Literals are numbered from 0 in the order they are
+ * added. If the same literal was already added, its number is returned
+ * and nothing changes. Otherwise, the matcher must be compiled again
+ * before it can be used.
+ *
+ * @memberof ee_litmatcher
+ * @public
+ *
+ * @param[in] matcher the matcher
+ * @param[in] buf the literal
+ * @param[in] len length of the literal, must not be 0
+ * @param[out] id number of the literal
+ *
+ * @return 0 on success, something else otherwise
+ */
+int ee_addLiteralToMatcher(struct ee_litmatcher *matcher, unsigned char *buf,
+			   es_size_t len, unsigned *id);
+
+/**
+ * Compile the matcher, that is compute the failure links of all states.
+ * This must be done after literals have been added and before the next
+ * scan.
+ *
+ * @memberof ee_litmatcher
+ * @public
+ *
+ * @param[in] matcher the matcher
+ *
+ * @return 0 on success, something else otherwise
+ */
+int ee_compileLitmatcher(struct ee_litmatcher *matcher);
+
+/**
+ * Find all literals that occur in a buffer. Use ee_literalFound() to
+ * obtain the result. The cost of a scan is linear in the length of the
+ * buffer plus the number of different literals found.
+ *
+ * @memberof ee_litmatcher
+ * @public
+ *
+ * @param[in] matcher the (compiled) matcher
+ * @param[in] buf buffer to scan
+ * @param[in] len length of buf
+ */
+void ee_scanLiterals(struct ee_litmatcher *matcher, unsigned char *buf, es_size_t len);
+
+/**
+ * Check if a literal was found by the last scan.
+ *
+ * @memberof ee_litmatcher
+ * @public
+ *
+ * @param[in] matcher the matcher
+ * @param[in] id number of the literal
+ *
+ * @return 1 if it was found, 0 otherwise
+ */
+static inline int
+ee_literalFound(struct ee_litmatcher *matcher, unsigned id)
+{
+	return matcher->found[id] == matcher->gen;
+}
+
+#endif /* #ifndef LIBEE_LITMATCHER_H_INCLUDED */
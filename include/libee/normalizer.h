@@ -0,0 +1,223 @@
+/**
+ * @file normalizer.h
+ * @brief Normalize unstructured messages via a rulebase of samples.
+ * @class ee_normalizer normalizer.h
+ *
+ * A rule is a sample message in which the variable parts are replaced
+ * by field descriptions:
+ *
+ * @verbatim
+   user %user:word% logged in from %ip:ipv4% port %port:number%
+   @endverbatim
+ *
+ * A field description is "%name:type%" or "%name:type:extra%", where
+ * type is the name of a registered parser (see parser.h) and extra is
+ * the extra data some parsers need (e.g. "%host:char-to:,%"). If the
+ * name is "-", the text is matched but no field is created. "%%" is a
+ * literal percent sign.
+ *
+ * All rules are compiled into a single prefix tree (parse DAG). Literal
+ * text is stored path-compressed and common prefixes are shared, field
+ * descriptions are edges to the parser. A message is matched by walking
+ * the tree once, so the time needed depends on the length of the message,
+ * not on the number of rules. Where both match, literal text is preferred
+ * over fields and specific parsers over catch-all ones; if the rest of the
+ * message does not match, the next alternative is tried (backtracking).
+ * Values are only created for the rule that matched.
+ *
+ * Backtracking can still be costly, as field edges lead to many subtrees
+ * which all have to be tried. To avoid that, the literal text of all rules
+ * is put into a literal matcher (litmatcher.h), which finds all of it in a
+ * message in a single scan. Each field edge knows the literal text that
+ * all rules behind it still need, so the edge is skipped without calling
+ * the parser if some of it is missing from the message. The message is
+ * only scanned if there is such an edge on its way through the tree. The
+ * prefilter is rebuilt by the first ee_normalize() after rules were added.
+ * As the matcher keeps the result of the scan, a normalizer must not be
+ * used by multiple threads concurrently.
+ *
+ * If the context has a projection set or a filter, they are applied to
+ * the fields of the rule that matched.
+ *//*
+ *
+ * Libee - An Event Expression Library inspired by CEE
+ * Copyright 2012 by Rainer Gerhards and Adiscon GmbH.
+ *
+ * This file is part of libee.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * A copy of the LGPL v2.1 can be found in the file "COPYING" in this distribution.
+ */
+#ifndef LIBEE_NORMALIZER_H_INCLUDED
+#define	LIBEE_NORMALIZER_H_INCLUDED
+#include <libestr.h>
+#include "libee/litmatcher.h"
+
+/** maximum number of fields in a rule */
+#define EE_NORM_MAX_FIELDS 64
+
+struct ee_ptreeField;
+
+/**
+ * A node of the prefix tree.
+ */
+struct ee_ptreeNode {
+	unsigned char *prefix;	/**< literal text that must match first */
+	es_size_t lenPrefix;	/**< length of prefix */
+	unsigned nLits;		/**< number of literal children */
+	unsigned char *litChars; /**< first character of each literal child */
+	struct ee_ptreeNode **lits; /**< literal children (their first
+				 *   character is not part of their prefix) */
+	struct ee_ptreeField *fields; /**< field children, in the order
+				 *   they are tried */
+	int bTerminal;		/**< a rule ends at this node */
+	struct ee_tagbucket *tags; /**< tags of that rule, NULL if none */
+	unsigned nRuleLits;	/**< number of literal texts of that rule */
+	unsigned *ruleLits;	/**< the literal texts of that rule by position,
+				 *   as numbered by the literal matcher */
+	unsigned nReq;		/**< number of required literals */
+	unsigned *req;		/**< for nodes after a field: literals that all
+				 *   rules below contain after this point, except
+				 *   those checked at a node above */
+};
+
+/**
+ * A field edge of the prefix tree.
+ */
+struct ee_ptreeField {
+	es_str_t *name;		/**< field name, NULL if no field is created */
+	unsigned nameHash;	/**< hash of the field name */
+	struct ee_parser *parser; /**< parser for the field value */
+	es_str_t *ed;		/**< extra data for the parser, NULL if none */
+	struct ee_ptreeNode *child; /**< node after the field */
+	struct ee_ptreeField *next; /**< next field edge of the same node */
+};
+
+/**
+ * The normalizer object.
+ */
+struct ee_normalizer {
+	unsigned objID;		/**< a magic number to prevent some memory adressing errors */
+	ee_ctx ctx;		/**< associated library context */
+	struct ee_ptreeNode *root; /**< root of the prefix tree */
+	unsigned nRules;	/**< number of rules added */
+	struct ee_litmatcher *lits; /**< literal text of all rules */
+	int bPrefilterOK;	/**< required literals are up to date */
+};
+
+/**
+ * Constructor for the ee_normalizer object. The new normalizer has
+ * no rules.
+ *
+ * @memberof ee_normalizer
+ * @public
+ *
+ * @param[in] ctx library context
+ *
+ * @return new normalizer or NULL if an error occured
+ */
+struct ee_normalizer* ee_newNormalizer(ee_ctx ctx);
+
+/**
+ * Destructor for the ee_normalizer object.
+ *
+ * @memberof ee_normalizer
+ * @public
+ *
+ * @param[in] norm object to be destructed
+ */
+void ee_deleteNormalizer(struct ee_normalizer *norm);
+
+/**
+ * Add a rule. The parsers are looked up in the registry of the context,
+ * so custom parsers must be registered before rules that use them are
+ * added. If there already is a rule for the same sample, its tags are
+ * replaced. If the rule is invalid, the normalizer may contain some
+ * unused nodes, but it still works as before.
+ *
+ * @memberof ee_normalizer
+ * @public
+ *
+ * @param[in] norm the normalizer
+ * @param[in] sample sample message with field descriptions (see above)
+ * @param[in] tags comma-delimited list of tags to add to events that
+ *            match the rule, or NULL
+ *
+ * @return 0 on success, EE_INVLDFMT if the sample is invalid, EE_NOTFOUND
+ *         if it uses an unknown parser, something else otherwise
+ */
+int ee_addRule(struct ee_normalizer *norm, char *sample, char *tags);
+
+/**
+ * Load a rulebase. Each line of the file is a rule of the form
+ * "rule=tags:sample" (tags may be empty). Empty lines and lines
+ * starting with '#' are ignored. This is compatible with the rulebase
+ * format of liblognorm, as long as only the built-in parsers are used.
+ *
+ * @memberof ee_normalizer
+ * @public
+ *
+ * @param[in] norm the normalizer
+ * @param[in] fileName name of the rulebase file
+ *
+ * @return 0 on success, something else otherwise (all rules up to the
+ *         one in error were added)
+ */
+int ee_loadRulebase(struct ee_normalizer *norm, char *fileName);
+
+/**
+ * Normalize a message.
+ *
+ * @memberof ee_normalizer
+ * @public
+ *
+ * @param[in] norm the normalizer
+ * @param[in] str the message
+ * @param[out] event new event with the fields of the rule that matched
+ *             (NULL if there is none)
+ *
+ * @return 0 on success, EE_NOTFOUND if no rule matches, EE_FILTERED if
+ *         the event was rejected by the filter, something else if an
+ *         error occured
+ */
+int ee_normalize(struct ee_normalizer *norm, es_str_t *str, struct ee_event **event);
+
+/**
+ * Normalize lines into CEE structures.
+ *
+ * The interface is heavily callback-based, just like the other
+ * decoders (see apache.h). Lines that match no rule are passed on as
+ * event with the single field "originalmsg".
+ *
+ * @memberof ee_normalizer
+ * @public
+ *
+ * @param[in] ctx library context to use
+ * @param[in] cbGetLine get next line to be processed. Returns
+ *            0 if all went well, EE_EOF at end of file and something
+ *            else otherwise.
+ * @param[in] cbNewEvt callback for function that receives newly created
+ *            events. It must return 0 on success and something else otherwise.
+ * @param[out] errStr printable error message, provided only if an error
+ *             occurs. If so, the caller must delete the provided pointer.
+ * @param[in] norm the normalizer
+ * @returns 0 on success, something else otherwise
+ */
+int ee_normDec(ee_ctx ctx, int (*cbGetLine)(es_str_t **ln),
+	       int (*cbNewEvt)(struct ee_event *event),
+	       es_str_t **errMsg, struct ee_normalizer *norm);
+
+#endif /* #ifndef LIBEE_NORMALIZER_H_INCLUDED */
@@ -5,6 +5,14 @@
  * All parsers obey to this interface. In essence, it specifies the calling
  * conventions that must be met.
  *
+ * Parsers are registered by name inside the library context. The built-in
+ * parsers for the primitive types are registered when the context is
+ * initialized, applications may add their own (or replace built-in ones).
+ * Together with the parser, some capability information is registered:
+ * the set of bytes a match may start with and the minimum length of a
+ * match. Dispatchers use this to skip parsers that cannot match at the
+ * current offset without calling them.
+ *
  *//*
  *
  * Libee - An Event Expression Library inspired by CEE
@@ -30,4 +38,157 @@
  */
 #ifndef LIBEE_PARSER_H_INCLUDED
 #define	LIBEE_PARSER_H_INCLUDED
+
+/**
+ * Parser interface.
+ * @param[in] ctx current context
+ * @param[in] str input string
+ * @param[in/out] offs offset where parsing has to start inside str.
+ * 	Updated on exist. \b Note: if the parser consumed all characters,
+ * 	offs equals strlen(str) on exit. This is part of the interface and
+ * 	the predicate for the caller to detect end of parsing.
+ * @param[in] ed string with extra data
+ * @param[out] newVal new value object created if parsing was successful
+ * @return 0 on success, EE_WRONGPARSER if the parser does not match and
+ * 	something else if an error occured
+ */
+typedef int (*ee_parserFunc)(ee_ctx ctx, es_str_t *str, es_size_t *offs,
+			     es_str_t *ed, struct ee_value **newVal);
+
+#define EE_PROBE_STR	0	/**< only text available */
+#define EE_PROBE_NBR	1	/**< number available in v.nbr */
+#define EE_PROBE_IPV4	2	/**< address available in v.ipv4 */
+#define EE_PROBE_TS	3	/**< (partial) timestamp available in v.ts */
+#define EE_PROBE_NET	4	/**< network address available in v.net */
+#define EE_PROBE_DBL	5	/**< floating point number available in v.dbl */
+
+/**
+ * Result of a probe.
+ * Probes are the non-allocating counterpart of parsers: they only tell
+ * if (and how much of) the input matches and, where this is cheap, also
+ * provide the binary value. A probe result is meant to be kept on the
+ * stack. It can be turned into a "real" value via ee_newValueFromProbe().
+ */
+struct ee_probe {
+	int type;		/**< EE_PROBE_* */
+	es_size_t offsVal;	/**< start of the value's text, relative to the
+				 *   probed buffer (e.g. 1 for a quoted string) */
+	es_size_t lenVal;	/**< length of the value's text */
+	union {
+		long long nbr;
+		double dbl;
+		unsigned ipv4;	/**< address in host byte order */
+		struct ee_timestamp ts; /**< only the fields present in the
+					 *   input are set */
+		struct ee_netaddr net;
+	} v;			/**< binary value, as indicated by type */
+};
+
+/**
+ * Probe interface.
+ * @param[in] ctx current context
+ * @param[in] buf buffer to probe
+ * @param[in] len length of buffer
+ * @param[in] ed string with extra data
+ * @param[out] probe probe result, only valid if there was a match
+ * @return number of characters matched, 0 if there is no match
+ */
+typedef es_size_t (*ee_probeFunc)(ee_ctx ctx, unsigned char *buf, es_size_t len,
+				  es_str_t *ed, struct ee_probe *probe);
+
+#define EE_PARSER_FLAG_NEEDS_ED		1
+	/**< parser needs extra data (e.g. char-to needs the terminator) */
+#define EE_PARSER_FLAG_CATCHALL		2
+	/**< parser matches almost everything (like word), so it should be
+	 *   tried only after all more specific parsers */
+
+/**
+ * A registered parser.
+ */
+struct ee_parser {
+	unsigned objID;		/**< a magic number to prevent some memory adressing errors */
+	char *name;		/**< name the parser is registered under */
+	ee_parserFunc parse;	/**< the actual parser */
+	ee_probeFunc probe;	/**< non-allocating probe, NULL if there is none
+				 *   (may be set after registration) */
+	unsigned char firstBytes[32];	/**< bitmap of bytes a match may start with */
+	es_size_t minLen;	/**< minimum length of a match */
+	unsigned flags;		/**< EE_PARSER_FLAG_* */
+	struct ee_parser *next;	/**< next parser in registry */
+};
+
+/**
+ * Register a parser.
+ * If a parser with the same name is already registered, it is replaced.
+ *
+ * The set of first bytes is given as a string of characters, where
+ * ranges may be specified as "a-z". If the string starts with '^', the
+ * set is negated (so "^ " means "anything but a space"). If it is NULL,
+ * a match may start with any byte.
+ *
+ * @memberof ee_parser
+ * @public
+ *
+ * @param[in] ctx library context
+ * @param[in] name name of the parser (e.g. "ipv4")
+ * @param[in] parse the parser function
+ * @param[in] firstBytes set of bytes a match may start with (or NULL)
+ * @param[in] minLen minimum length of a match
+ * @param[in] flags EE_PARSER_FLAG_*
+ *
+ * @return the registered parser or NULL if an error occured
+ */
+struct ee_parser* ee_registerParser(ee_ctx ctx, char *name, ee_parserFunc parse,
+				    char *firstBytes, es_size_t minLen, unsigned flags);
+
+/**
+ * Find a registered parser by name.
+ *
+ * @memberof ee_parser
+ * @public
+ *
+ * @param[in] ctx library context
+ * @param[in] name name of the parser
+ *
+ * @return the parser or NULL if there is no parser with that name
+ */
+struct ee_parser* ee_findParser(ee_ctx ctx, char *name);
+
+/**
+ * Check if a byte may start a match of the parser.
+ *
+ * @memberof ee_parser
+ * @public
+ */
+static inline int
+ee_parserAcceptsByte(struct ee_parser *parser, unsigned char c)
+{
+	return parser->firstBytes[c >> 3] & (1 << (c & 7));
+}
+
+/**
+ * Check if the parser can possibly match at the given offset. If this
+ * returns 0, there is no need to call the parser.
+ *
+ * @memberof ee_parser
+ * @public
+ *
+ * @param[in] parser the parser
+ * @param[in] str string to be parsed
+ * @param[in] offs offset inside string
+ *
+ * @return 0 if the parser cannot match, something else otherwise
+ */
+static inline int
+ee_parserCanMatch(struct ee_parser *parser, es_str_t *str, es_size_t offs)
+{
+	return    offs < es_strlen(str)
+	       && es_strlen(str) - offs >= parser->minLen
+	       && ee_parserAcceptsByte(parser, es_getBufAddr(str)[offs]);
+}
+
+/* internal functions */
+int ee_registerBuiltinParsers(ee_ctx ctx);
+void ee_deleteParsers(ee_ctx ctx);
+
 #endif /* #ifndef LIBEE_PARSER_H_INCLUDED */
@@ -43,7 +43,7 @@
  */
 struct ee_primitiveType {
 	struct ee_obj o;	/*<< the base object */
-	int (*parse)(ee_ctx ctx, char *p, struct ee_field* newField);
+	ee_parserFunc parse;	/**< parser for this type */
 };
 
 /**
@@ -66,73 +66,137 @@ struct ee_primitiveType* ee_newPrimitiveType(void);
  */
 void ee_deletePrimitiveType(struct ee_primitiveType *primitiveType);
 
+/* Note: all parsers below obey to the interface described in parser.h
+ * (ee_parserFunc). Each parser has a probe (ee_probeFunc), which checks
+ * the same syntax but does not allocate anything.
+ */
+
 /**
- * Parser interface.
+ * Create a value from a probe result. Numbers and network addresses
+ * are stored in binary form, everything else as string.
+ *
  * @param[in] ctx current context
- * @param[in] str input string
- * @param[in/out] offs offset where parsing has to start inside str.
- * 	Updated on exist. \b Note: if the parser consumed all characters,
- * 	offs equals strlen(str) on exit. This is part of the interface and
- * 	the predicate for the caller to detect end of parsing.
- * @param[in] ed string with extra data
- * @param[out] newVal new value object created if parsing was successful
+ * @param[in] buf buffer that was probed
+ * @param[in] probe the probe result
+ * @param[out] value the new value
  * @return 0 on success, something else otherwise
  */
+int ee_newValueFromProbe(ee_ctx ctx, unsigned char *buf, struct ee_probe *probe,
+			 struct ee_value **value);
 
 
 /** 
  * Parser for RFC5424 date.
  */
 int ee_parseRFC5424Date(ee_ctx ctx, es_str_t *str, es_size_t *offs, es_str_t *ed, struct ee_value **newVal);
+es_size_t ee_probeRFC5424Date(ee_ctx ctx, unsigned char *buf, es_size_t len, es_str_t *ed, struct ee_probe *probe);
+
+/**
+ * Scan a RFC5424 date into a binary timestamp.
+ * This is the workhorse of ee_parseRFC5424Date(). The timestamp
+ * includes fractional seconds, the UTC offset and the epoch (stamp).
+ *
+ * @param[in] ctx current context
+ * @param[in] buf buffer to scan
+ * @param[in] len length of buffer
+ * @param[out] ts timestamp (only valid on success)
+ * @return number of characters used (not including a trailing space),
+ * 	0 if buf does not start with a RFC5424 date
+ */
+int ee_scanRFC5424Date(ee_ctx ctx, unsigned char *buf, es_size_t len, struct ee_timestamp *ts);
 
 /** 
  * Parser for RFC3164 date.
  */
 int ee_parseRFC3164Date(ee_ctx ctx, es_str_t *str, es_size_t *offs, es_str_t *ed, struct ee_value **newVal);
+es_size_t ee_probeRFC3164Date(ee_ctx ctx, unsigned char *buf, es_size_t len, es_str_t *ed, struct ee_probe *probe);
+
+/**
+ * Scan a RFC3164 date into a binary timestamp.
+ * This is the workhorse of ee_parseRFC3164Date(), for callers that need
+ * the actual time rather than its string representation. If the
+ * context has the RFC3164 cache enabled (ee_setRFC3164Cache()), a
+ * repeated timestamp is not parsed again.
+ *
+ * @param[in] ctx current context
+ * @param[in] buf buffer to scan
+ * @param[in] len length of buffer
+ * @param[out] ts timestamp (only valid on success)
+ * @return number of characters used, 0 if buf does not start with a
+ * 	RFC3164 date
+ */
+int ee_scanRFC3164Date(ee_ctx ctx, unsigned char *buf, es_size_t len, struct ee_timestamp *ts);
 
 /** 
- * Parser for numbers.
+ * Parser for numbers (signed integers, decimals and exponents). Creates
+ * a number value, or a string value if the number is out of range.
  */
 int ee_parseNumber(ee_ctx ctx, es_str_t *str, es_size_t *offs, es_str_t *ed, struct ee_value **newVal);
+es_size_t ee_probeNumber(ee_ctx ctx, unsigned char *buf, es_size_t len, es_str_t *ed, struct ee_probe *probe);
 
 
 /** 
  * Parser for Words (SP-terminated strings).
  */
 int ee_parseWord(ee_ctx ctx, es_str_t *str, es_size_t *offs, es_str_t *ed, struct ee_value **newVal);
+es_size_t ee_probeWord(ee_ctx ctx, unsigned char *buf, es_size_t len, es_str_t *ed, struct ee_probe *probe);
 
 
 /** 
  * Parse everything up to a specific character.
  */
 int ee_parseCharTo(ee_ctx ctx, es_str_t *str, es_size_t *offs, es_str_t *ed, struct ee_value **newVal);
+es_size_t ee_probeCharTo(ee_ctx ctx, unsigned char *buf, es_size_t len, es_str_t *ed, struct ee_probe *probe);
 
 
 /** 
  * Parse a quoted string.
  */
 int ee_parseQuotedString(ee_ctx ctx, es_str_t *str, es_size_t *offs, es_str_t *ed, struct ee_value **newVal);
+es_size_t ee_probeQuotedString(ee_ctx ctx, unsigned char *buf, es_size_t len, es_str_t *ed, struct ee_probe *probe);
 
 /** 
  * Parse an ISO date.
  */
 int ee_parseISODate(ee_ctx ctx, es_str_t *str, es_size_t *offs, es_str_t *ed, struct ee_value **newVal);
+es_size_t ee_probeISODate(ee_ctx ctx, unsigned char *buf, es_size_t len, es_str_t *ed, struct ee_probe *probe);
 
 
 /** 
  * Parse a timestamp in 12hr format.
  */
 int ee_parseTime12hr(ee_ctx ctx, es_str_t *str, es_size_t *offs, es_str_t *ed, struct ee_value **newVal);
+es_size_t ee_probeTime12hr(ee_ctx ctx, unsigned char *buf, es_size_t len, es_str_t *ed, struct ee_probe *probe);
 
 
 /** 
  * Parse a timestamp in 24hr format.
  */
 int ee_parseTime24hr(ee_ctx ctx, es_str_t *str, es_size_t *offs, es_str_t *ed, struct ee_value **newVal);
+es_size_t ee_probeTime24hr(ee_ctx ctx, unsigned char *buf, es_size_t len, es_str_t *ed, struct ee_probe *probe);
 
 /** 
  * Parser for IPv4 addresses.
  */
 int ee_parseIPv4(ee_ctx ctx, es_str_t *str, es_size_t *offs, es_str_t *ed, struct ee_value **newVal);
+es_size_t ee_probeIPv4(ee_ctx ctx, unsigned char *buf, es_size_t len, es_str_t *ed, struct ee_probe *probe);
+
+/** 
+ * Parser for IPv6 addresses (all forms of RFC4291). Creates a binary value.
+ */
+int ee_parseIPv6(ee_ctx ctx, es_str_t *str, es_size_t *offs, es_str_t *ed, struct ee_value **newVal);
+es_size_t ee_probeIPv6(ee_ctx ctx, unsigned char *buf, es_size_t len, es_str_t *ed, struct ee_probe *probe);
+
+/** 
+ * Parser for MAC addresses. Creates a binary value.
+ */
+int ee_parseMAC(ee_ctx ctx, es_str_t *str, es_size_t *offs, es_str_t *ed, struct ee_value **newVal);
+es_size_t ee_probeMAC(ee_ctx ctx, unsigned char *buf, es_size_t len, es_str_t *ed, struct ee_probe *probe);
+
+/** 
+ * Parser for CIDR networks (IPv4 or IPv6). Creates a binary value.
+ */
+int ee_parseCIDR(ee_ctx ctx, es_str_t *str, es_size_t *offs, es_str_t *ed, struct ee_value **newVal);
+es_size_t ee_probeCIDR(ee_ctx ctx, unsigned char *buf, es_size_t len, es_str_t *ed, struct ee_probe *probe);
 
 #endif /* #ifndef LIBEE_PRIMITIVETYPE_H_INCLUDED */
@@ -0,0 +1,117 @@
+/**
+ * @file recognizer.h
+ * @brief Recognize the type of a value by trying a set of parsers.
+ * @class ee_recognizer recognizer.h
+ *
+ * When the type of some value is unknown (e.g. for a field of an event
+ * with no dictionary), it must be recognized by trying parsers until
+ * one matches. Doing this naively means calling each parser in turn.
+ * The recognizer builds a dispatch table indexed by the first byte of
+ * the value, so that only parsers which can actually match are tried.
+ * Within each table slot, candidates are kept ordered by how often
+ * they matched, so the most likely parser is tried first. Catch-all
+ * parsers (like "word") are always tried last.
+ *
+ * A value is only recognized if the match ends at the end of the string
+ * or at a space. So "10.0.0.1x" is not recognized as an IPv4 address.
+ *//*
+ *
+ * Libee - An Event Expression Library inspired by CEE
+ * Copyright 2012 by Rainer Gerhards and Adiscon GmbH.
+ *
+ * This file is part of libee.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * A copy of the LGPL v2.1 can be found in the file "COPYING" in this distribution.
+ */
+#ifndef LIBEE_RECOGNIZER_H_INCLUDED
+#define	LIBEE_RECOGNIZER_H_INCLUDED
+
+/**
+ * A candidate parser of the recognizer.
+ */
+struct ee_recognizer_cand {
+	struct ee_parser *parser;	/**< the parser */
+	unsigned long long hits;	/**< number of successful matches */
+};
+
+/**
+ * The recognizer object.
+ */
+struct ee_recognizer {
+	unsigned objID;		/**< a magic number to prevent some memory adressing errors */
+	ee_ctx ctx;		/**< associated library context */
+	unsigned nCands;	/**< number of candidate parsers */
+	struct ee_recognizer_cand *cands; /**< the candidate parsers */
+	unsigned char *slots;	/**< candidate indexes for all 256 first bytes,
+				 *   nCands entries per byte */
+	unsigned char nSpecific[256];	/**< number of specific (not catch-all)
+				 *   candidates per byte; they come first */
+	unsigned char nTotal[256];	/**< number of candidates per byte */
+};
+
+/**
+ * Constructor for the ee_recognizer object.
+ * The parsers to use must be registered with the context. Parsers
+ * that need extra data are not supported (and ignored if all parsers
+ * are requested). Note that the recognizer takes a snapshot of the
+ * registry: parsers registered later are not used.
+ *
+ * @memberof ee_recognizer
+ * @public
+ *
+ * @param[in] ctx library context
+ * @param[in] names comma-delimited list of parser names to use (e.g.
+ *            "number,ipv4,word") or NULL to use all registered parsers.
+ *            A name given more than once is only used once.
+ *
+ * @return new recognizer or NULL if an error occured (including unknown
+ *         parser names)
+ */
+struct ee_recognizer* ee_newRecognizer(ee_ctx ctx, char *names);
+
+/**
+ * Destructor for the ee_recognizer object.
+ *
+ * @memberof ee_recognizer
+ * @public
+ *
+ * @param[in] recognizer object to be destructed
+ */
+void ee_deleteRecognizer(struct ee_recognizer *recognizer);
+
+/**
+ * Recognize a value.
+ *
+ * @memberof ee_recognizer
+ * @public
+ *
+ * @param[in] recognizer the recognizer
+ * @param[in] str input string
+ * @param[in/out] offs offset where the value starts inside str, updated
+ *                to point after the value on success
+ * @param[out] parser the parser that matched (may be NULL if not needed)
+ * @param[out] value the value created by the parser. If NULL, the value
+ *             is only classified and no value is created. For parsers
+ *             with a probe, nothing is allocated in this case.
+ *
+ * @return 0 on success, EE_WRONGPARSER if no parser matched, something
+ *         else if an error occured
+ */
+int ee_recognize(struct ee_recognizer *recognizer, es_str_t *str, es_size_t *offs,
+		 struct ee_parser **parser, struct ee_value **value);
+
+#endif /* #ifndef LIBEE_RECOGNIZER_H_INCLUDED */
@@ -0,0 +1,77 @@
+/**
+ * @file syslog.h
+ * The syslog structured data decoder.
+ *
+ * @class ee_syslog syslog.h
+ *
+ * This decodes RFC5424 STRUCTURED-DATA, as created by
+ * ee_fmtEventToRFC5424(), back into events. So events can travel through
+ * syslog and come back without loss (and without a JSON detour). The
+ * input looks like this:
+ *
+ * @verbatim
+   [cee@115 event.tags="tag1,tag2" host="srv1" msg="a \"quoted\" text"]
+   @endverbatim
+ *
+ * Parameters of the cee@115 element become fields, its "event.tags"
+ * parameter becomes the event's tags. Parameters of other SD-ELEMENTs
+ * are also decoded, but their names are prefixed by the SD-ID and a
+ * dot (e.g. "origin@6876.ip"), so that they cannot clash. A NIL
+ * structured data ("-") results in an empty event.
+ *
+ * Within PARAM-VALUE, the escapes \\\\, \\" and \\] of RFC5424 are
+ * supported, as well as the ones our encoder adds (\\, for a comma
+ * that is part of the value, \\0 and \\n). An unescaped comma separates
+ * multiple values of a field. Any other backslash is taken literally,
+ * as required by RFC5424.
+ *//*
+ *
+ * Libee - An Event Expression Library inspired by CEE
+ * Copyright 2012 by Rainer Gerhards and Adiscon GmbH.
+ *
+ * This file is part of libee.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * A copy of the LGPL v2.1 can be found in the file "COPYING" in this distribution.
+ */
+#ifndef LIBEE_SYSLOG_H_INCLUDED
+#define	LIBEE_SYSLOG_H_INCLUDED
+#include <libestr.h>
+
+/**
+ * Decode lines of RFC5424 structured data into CEE structures.
+ *
+ * The interface is heavily callback-based, just like the other
+ * decoders (see int.h).
+ *
+ * @memberof ee_syslog
+ * @public
+ *
+ * @param[in] ctx library context to use
+ * @param[in] cbGetLine get next line to be processed. Returns
+ *            0 if all went well, EE_EOF at end of file and something
+ *            else otherwise.
+ * @param[in] cbNewEvt callback for function that receives newly created
+ *            events. It must return 0 on success and something else otherwise.
+ * @param[out] errStr printable error message, provided only if an error
+ *             occurs. If so, the caller must delete the provided pointer.
+ * @returns 0 on success, something else otherwise
+ */
+int ee_syslogSDDec(ee_ctx ctx, int (*cbGetLine)(es_str_t **ln),
+		   int (*cbNewEvt)(struct ee_event *event),
+		   es_str_t **errMsg);
+
+#endif /* #ifndef LIBEE_SYSLOG_H_INCLUDED */
@@ -39,13 +39,20 @@ struct ee_tagbucket_listnode {
 
 /**
  * The tagbucket class, a container to store tags.
+ *
+ * Tag buckets are reference counted. This permits to share a single
+ * bucket between many events, e.g. all events from the same source.
+ * A bucket that is referenced more than once is considered immutable.
+ * Code that needs to modify a shared bucket must first obtain a private
+ * copy via ee_dupTagbucket() (copy-on-write). The event class already
+ * does this transparently inside ee_addTagToEvent().
  */
 struct ee_tagbucket {
 	unsigned objID;		/**< a magic number to prevent some memory adressing errors */
 	ee_ctx ctx;		/**< associated library context */
 	struct ee_tagbucket_listnode *root; /**< root of our tags list */
 	struct ee_tagbucket_listnode *tail; /**< list tail to speed up adding nodes */
-	unsigned refCount;
+	unsigned refCount;	/**< number of references held, freed when it drops to 0 */
 };
 
 /**
@@ -76,8 +83,42 @@ struct ee_tagbucket* ee_newTagbucket(ee_ctx ctx);
  */
 struct ee_tagbucket* ee_addRefTagbucket(struct ee_tagbucket *tagbucket);
 
+/**
+ * Create a private copy of a tagbucket.
+ * The new bucket contains copies of all tags of the original one and
+ * has a reference count of one, so it may be modified freely. This
+ * is the "copy" part of copy-on-write for shared buckets.
+ *
+ * @memberof ee_tagbucket
+ * @public
+ *
+ * @param[in] tagbucket the tagbucket to copy
+ *
+ * @return newly created object or NULL if an error occured
+ */
+struct ee_tagbucket* ee_dupTagbucket(struct ee_tagbucket *tagbucket);
+
+/**
+ * Check if a tagbucket is shared, that is referenced more than once.
+ * A shared bucket must not be modified.
+ *
+ * @memberof ee_tagbucket
+ * @public
+ *
+ * @param[in] tagbucket the tagbucket to check
+ *
+ * @return 0 if not shared, something else otherwise
+ */
+static inline int
+ee_TagbucketIsShared(struct ee_tagbucket *tagbucket)
+{
+	return tagbucket->refCount > 1;
+}
+
 /**
  * Destructor for the ee_tagbucket object.
+ * This drops one reference. The bucket (including all its tags)
+ * is only destructed when the last reference is dropped.
  *
  * @memberof ee_tagbucket
  * @public
@@ -88,12 +129,14 @@ void ee_deleteTagbucket(struct ee_tagbucket *tagbucket);
 
 /**
  * Add a tag (string) to the bucket.
+ * The bucket must not be shared (see ee_TagbucketIsShared()).
  *
  * @memberof ee_tagbucket
  * @public
  *
  * @param[in] tagbucket	the tagbucket to modify
- * @param[in] tagname	name of the tag to be added
+ * @param[in] tagname	name of the tag to be added. The bucket takes
+ * 			ownership of the string.
  *
  * @return 0 on success, something else otherwise
  */
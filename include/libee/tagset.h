@@ -35,9 +35,15 @@
  * @extends ee_obj
  *
  * TODO: is it correct that there is no short name in the CEE spec?
+ *
+ * A tagset holds the tags that all events of a type carry (see
+ * ee_assignTagsetToFieldset()). The tags are kept in a tag bucket,
+ * which is shared with these events, so they get their tags without
+ * any copying.
  */
 struct ee_tagset {
 	struct ee_obj o;	/*<< the base object */
+	struct ee_tagbucket *tags; /**< the tags, NULL if there are none */
 };
 
 /**
@@ -46,9 +52,11 @@ struct ee_tagset {
  * @memberof ee_tagset
  * @public
  *
- * @return new library context or NULL if an error occured
+ * @param[in] ctx library context
+ *
+ * @return new tagset or NULL if an error occured
  */
-struct ee_tagset* ee_newTagset(void);
+struct ee_tagset* ee_newTagset(ee_ctx ctx);
 
 /**
  * Destructor for the ee_tagset object.
@@ -60,5 +68,31 @@ struct ee_tagset* ee_newTagset(void);
  */
 void ee_deleteTagset(struct ee_tagset *tagset);
 
+/**
+ * Add a tag to the tagset. Events which already share the tags of the
+ * set are not affected.
+ *
+ * @memberof ee_tagset
+ * @public
+ *
+ * @param[in] tagset the tagset
+ * @param[in] tagname name of the tag (the caller keeps ownership)
+ *
+ * @return 0 on success, something else otherwise
+ */
+int ee_addTagToSet(struct ee_tagset *tagset, es_str_t *tagname);
+
+/**
+ * Check if the tagset contains a tag.
+ *
+ * @memberof ee_tagset
+ * @public
+ *
+ * @param[in] tagset the tagset
+ * @param[in] tagname name of the tag
+ *
+ * @return 1 if the tag is contained, 0 otherwise
+ */
+int ee_TagsetHasTag(struct ee_tagset *tagset, es_str_t *tagname);
 
 #endif /* #ifndef LIBEE_TAGSET_H_INCLUDED */
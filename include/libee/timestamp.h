@@ -30,14 +30,35 @@
 #define	LIBEE_TIMESTAMP_H_INCLUDED
 #include <time.h> /* needed for Solaris */
 
+#define EE_TS_NONE	0	/**< timestamp not set */
+#define EE_TS_RFC3164	1	/**< from RFC3164 (no year, no timezone) */
+#define EE_TS_RFC5424	2	/**< from RFC5424 (full information) */
+
 /**
  * An object to represent a CEE/XML timestamp.
  * 
+ * We keep the broken-down time as it was parsed (in the spirit
+ * of rsyslog's syslogTime), because many sources do not contain
+ * sufficient information to compute the absolute time (e.g. RFC3164
+ * stamps lack the year and timezone).
+ *
  * TODO: maybe replace with something from libxml, as it is
  * a xs:date type of stamp.
  */
 struct ee_timestamp {
-	time_t stamp;
+	time_t stamp;		/**< seconds since the epoch, 0 if unknown */
+	char timeType;		/**< EE_TS_* */
+	short year;		/**< 0 if not known */
+	char month;
+	char day;
+	char hour;		/**< 24 hour clock */
+	char minute;
+	char second;
+	char secfracPrecision;	/**< number of digits in secfrac */
+	int secfrac;		/**< fractional seconds */
+	char OffsetMode;	/**< UTC offset '+', '-', 'Z' or 0 if unknown */
+	char OffsetHour;	/**< UTC offset in hours */
+	char OffsetMinute;	/**< UTC offset in minutes */
 };
 
 
@@ -29,6 +29,36 @@
 #ifndef LIBEE_VALUE_H_INCLUDED
 #define	LIBEE_VALUE_H_INCLUDED
 
+#define EE_NET_IPV4	1	/**< IPv4 address, 4 bytes */
+#define EE_NET_IPV6	2	/**< IPv6 address, 16 bytes */
+#define EE_NET_MAC	3	/**< MAC address, 6 bytes */
+#define EE_NET_NOPREFIX	0xff	/**< address is not a CIDR network */
+
+/**
+ * A network (IPv4, IPv6 or MAC) address in binary form.
+ */
+struct ee_netaddr {
+	unsigned char type;	/**< EE_NET_* */
+	unsigned char prefixLen; /**< CIDR prefix length or EE_NET_NOPREFIX */
+	unsigned char addr[16];	/**< address in network byte order, only
+				 *   the first ee_netAddrLen() bytes are used */
+};
+
+/**
+ * Obtain the number of address bytes for a network address type.
+ *
+ * @param[in] type EE_NET_*
+ * @return number of bytes, 0 if the type is invalid
+ */
+static inline int
+ee_netAddrLen(unsigned type)
+{
+	return    type == EE_NET_IPV4 ? 4
+		: type == EE_NET_IPV6 ? 16
+		: type == EE_NET_MAC  ? 6
+		: 0;
+}
+
 /**
  * The value class.
  * This represents a value that is to be stored together with a CEE field.
@@ -45,13 +75,18 @@ struct ee_value {
 	enum {
 		ee_valtype_none = 0,
 		ee_valtype_str = 1,
-		ee_valtype_nbr = 2
+		ee_valtype_nbr = 2,
+		ee_valtype_net = 3,
+		ee_valtype_dbl = 4
 	} valtype;	/**< type of the value, selects union member */
 	union {
 		struct ee_timestamp ts;
 		long long number;
+		double dbl;
 		es_str_t *str;
+		struct ee_netaddr net;
 	} val;		/**< the actual value */
+	unsigned refCount;	/**< number of references (values may be shared by cloned events) */
 };
 
 
@@ -68,8 +103,30 @@ struct ee_value {
 struct ee_value* ee_newValue(ee_ctx ctx);
 
 
+/**
+ * Add an additional reference to the value. Values are immutable
+ * once created, so they can safely be shared between fields of
+ * different (cloned) events.
+ *
+ * @memberof ee_value
+ * @public
+ *
+ * @param[in] value the value to add ref for
+ *
+ * @return address of ref-added value (for convenience)
+ */
+static inline struct ee_value*
+ee_addRefValue(struct ee_value *value)
+{
+	value->refCount++;
+	return value;
+}
+
+
 /**
  * Destructor for the ee_value object.
+ * This drops one reference, the value is destructed when the last
+ * reference is gone.
  *
  * @memberof ee_value
  * @public
@@ -89,6 +146,64 @@ void ee_deleteValue(struct ee_value *value);
  */
 int ee_setStrValue(struct ee_value *value, es_str_t *val);
 
+/**
+ * Set the value to the provided number.
+ *
+ * @memberof ee_value
+ * @public
+ *
+ * @param[in] value value to set
+ * @param[in] val number to store
+ *
+ * @return 0 on success, something else otherwise
+ */
+int ee_setNbrValue(struct ee_value *value, long long val);
+
+/**
+ * Set the value to the provided floating point number.
+ *
+ * @memberof ee_value
+ * @public
+ *
+ * @param[in] value value to set
+ * @param[in] val number to store
+ *
+ * @return 0 on success, something else otherwise
+ */
+int ee_setDblValue(struct ee_value *value, double val);
+
+/**
+ * Set the value to the provided network address.
+ *
+ * @memberof ee_value
+ * @public
+ *
+ * @param[in] value value to set
+ * @param[in] net address to store (copied)
+ *
+ * @return 0 on success, something else otherwise
+ */
+int ee_setNetValue(struct ee_value *value, struct ee_netaddr *net);
+
+/**
+ * Add the plain textual representation of the value to the provided
+ * string. For string values, this is the string itself. Other types
+ * are formatted, floating point numbers with the shortest precision
+ * that reads back exactly and network addresses in their canonical
+ * form (e.g. IPv6 as of RFC5952). Note that the representation of non-string values
+ * never contains any characters that need escaping in our output
+ * formats.
+ *
+ * @memberof ee_value
+ * @public
+ *
+ * @param[in] value value to format
+ * @param[out] str string to which the value is to be added
+ *
+ * @returns 0 on success, something else otherwise
+ */
+int ee_addValueAsStr(struct ee_value *value, es_str_t **str);
+
 /**
  * Encode the current value in syslog format and add it to the provided string.
  * If just the plain value is required, an empty string must be passed
@@ -0,0 +1,204 @@
+/**
+ * @file view.h
+ * @brief Read-only event views over binary records.
+ * @class ee_eventview view.h
+ *
+ * An event view provides read access to an event stored in binary
+ * format (see binary.h) without creating any heap objects. All names
+ * and values are resolved by offset inside the record. This is meant
+ * for replaying large spool files (e.g. disk queues after an outage),
+ * where most events are just passed on or checked by some filter, and
+ * building full ee_event objects for each of them would be wasted effort.
+ * If a full event is needed, it can be created via ee_newEventFromView().
+ *
+ * Spool files are memory-mapped if the platform supports it. The views
+ * obtained from a spool are valid only as long as the spool is open.
+ *//*
+ *
+ * Libee - An Event Expression Library inspired by CEE
+ * Copyright 2012 by Rainer Gerhards and Adiscon GmbH.
+ *
+ * This file is part of libee.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * A copy of the LGPL v2.1 can be found in the file "COPYING" in this distribution.
+ */
+#ifndef LIBEE_VIEW_H_INCLUDED
+#define	LIBEE_VIEW_H_INCLUDED
+#include "libee/binary.h"
+
+/**
+ * A (read-only) spool file with binary records.
+ */
+struct ee_spool {
+	unsigned objID;		/**< a magic number to prevent some memory adressing errors */
+	ee_ctx ctx;		/**< associated library context */
+	unsigned char *buf;	/**< spool file contents */
+	size_t len;		/**< size of spool file */
+	size_t offs;		/**< offset of next record to read */
+	char bMapped;		/**< buf is mmap()ed (and not malloc()ed)? */
+};
+
+/**
+ * The event view.
+ * Views are small and meant to be kept on the stack. They do not own
+ * any resources and thus need no destructor.
+ */
+struct ee_eventview {
+	ee_ctx ctx;		/**< associated library context */
+	struct ee_binrec rec;	/**< the record we are viewing */
+	unsigned curName;	/**< ID of most recently resolved name ... */
+	unsigned char *curNamePos; /**< ... and its position in the dictionary */
+};
+
+/**
+ * A field as seen through a view.
+ */
+struct ee_viewfield {
+	unsigned char *name;	/**< field name (inside the record) */
+	es_size_t lenName;	/**< length of field name */
+	unsigned nVals;		/**< number of values */
+	unsigned char *vals;	/**< first value (inside the record) */
+	unsigned char *end;	/**< end of the record */
+};
+
+
+/**
+ * Open a spool file for reading.
+ *
+ * @memberof ee_eventview
+ * @public
+ *
+ * @param[in] ctx library context
+ * @param[in] path name of the spool file
+ *
+ * @return new spool object or NULL if an error occured
+ */
+struct ee_spool* ee_openSpool(ee_ctx ctx, char *path);
+
+/**
+ * Close a spool file.
+ * All views obtained from this spool become invalid.
+ *
+ * @memberof ee_eventview
+ * @public
+ *
+ * @param[in] spool spool to close
+ */
+void ee_closeSpool(struct ee_spool *spool);
+
+/**
+ * Obtain a view of the next event inside the spool.
+ *
+ * @memberof ee_eventview
+ * @public
+ *
+ * @param[in] spool spool to read
+ * @param[out] view view to be filled
+ *
+ * @return 0 on success, EE_EOF if there are no more (complete) records,
+ *         EE_INVLDFMT if the spool contains an invalid record
+ */
+int ee_spoolGetNextView(struct ee_spool *spool, struct ee_eventview *view);
+
+/**
+ * Obtain a view of a binary record inside some buffer (e.g. one that
+ * was received from another process).
+ *
+ * @memberof ee_eventview
+ * @public
+ *
+ * @param[in] ctx library context
+ * @param[in] buf buffer holding the record
+ * @param[in] lenBuf number of bytes in buffer
+ * @param[out] view view to be filled
+ *
+ * @return 0 on success, something else otherwise (see ee_binParseRecord())
+ */
+int ee_viewFromBuf(ee_ctx ctx, unsigned char *buf, size_t lenBuf, struct ee_eventview *view);
+
+/**
+ * Find a field inside the viewed event.
+ *
+ * @memberof ee_eventview
+ * @public
+ *
+ * @param[in] view the event view
+ * @param[in] ref compiled name of the field to find
+ * @param[out] field the field, if found
+ *
+ * @return 0 on success, EE_NOTFOUND if there is no such field,
+ *         EE_INVLDFMT if the record is truncated
+ */
+int ee_viewGetField(struct ee_eventview *view, ee_fieldref ref, struct ee_viewfield *field);
+
+/**
+ * Iterate over the fields of the viewed event.
+ *
+ * @memberof ee_eventview
+ * @public
+ *
+ * @param[in] view the event view
+ * @param[in/out] cookie must be NULL on the first call, is updated
+ *                by this function
+ * @param[out] field the field
+ *
+ * @return 0 on success, EE_EOF if there are no more fields,
+ *         EE_INVLDFMT if the record is truncated
+ */
+int ee_viewGetNextField(struct ee_eventview *view, void **cookie, struct ee_viewfield *field);
+
+/**
+ * Obtain a value of a view field.
+ *
+ * @memberof ee_eventview
+ * @public
+ *
+ * @param[in] field the field
+ * @param[in] n index of value to obtain (0 is the first value)
+ * @param[out] val the value
+ *
+ * @return 0 on success, EE_NOTFOUND if there is no such value,
+ *         EE_INVLDFMT if the record is truncated
+ */
+int ee_viewGetValue(struct ee_viewfield *field, unsigned n, struct ee_binvalue *val);
+
+/**
+ * Check if the viewed event has a specific tag.
+ *
+ * @memberof ee_eventview
+ * @public
+ *
+ * @param[in] view the event view
+ * @param[in] tagname tag to look for
+ *
+ * @return 0 if the tag is not present, something else otherwise
+ */
+int ee_viewHasTag(struct ee_eventview *view, es_str_t *tagname);
+
+/**
+ * Create a (full, modifiable) event from a view.
+ *
+ * @memberof ee_eventview
+ * @public
+ *
+ * @param[in] view the event view
+ *
+ * @return new event or NULL if an error occured
+ */
+struct ee_event* ee_newEventFromView(struct ee_eventview *view);
+
+#endif /* #ifndef LIBEE_VIEW_H_INCLUDED */
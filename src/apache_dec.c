@@ -30,6 +30,7 @@
 
 #include "libee/libee.h"
 #include "libee/apache.h"
+#include "libee/filter.h"
 #include "libee/internal.h"
 
 
@@ -76,6 +77,7 @@ ee_apacheAddName(ee_ctx ctx, struct ee_apache *apache, es_str_t *name)
 	CHKN(node = malloc(sizeof(ee_fieldListApache_t)));
 	node->next = NULL;
 	node->name = name;
+	node->nameHash = ee_hashName(es_getBufAddr(name), es_strlen(name));
 
 	/* enqueue */
 	if(apache->nroot == NULL) {
@@ -122,13 +124,14 @@ done:	return r;
 }
 
 static inline int
-addField(ee_ctx ctx, struct ee_event *event, es_str_t *name, struct ee_value *value)
+addField(ee_ctx ctx, struct ee_event *event, ee_fieldListApache_t *node, struct ee_value *value)
 {
 	int r;
 	struct ee_field *field;
 
 	CHKN(field = ee_newField(ctx));
-	CHKR(ee_nameField(field, name));
+	CHKN(field->name = es_strdup(node->name));
+	field->nameHash = node->nameHash;
 	CHKR(ee_addValueToField(field, value));
 	CHKR(ee_addFieldToEvent(event, field));
 	r = 0;
@@ -137,6 +140,7 @@ done:	return r;
 }
 
 
+/* if value is NULL, the field is just skipped */
 static inline int
 processField(ee_ctx ctx, es_str_t *str, es_size_t *offs, struct ee_value **value)
 {
@@ -146,17 +150,19 @@ processField(ee_ctx ctx, es_str_t *str, es_size_t *offs, struct ee_value **value
 	es_size_t i = *offs;
 	es_str_t *val;
 
-	CHKN(val = es_newStr(16));
 	c = es_getBufAddr(str);
-	CHKN(*value = ee_newValue(ctx));
+	if(value != NULL) {
+		CHKN(val = es_newStr(16));
+		CHKN(*value = ee_newValue(ctx));
+	}
 	/* skip leading whitespace */
 	while(i < es_strlen(str) && c[i] == ' ') {
 		++i;
 	}
-	if(i == es_strlen(str))
-		goto done;
 
-	if(c[i] == '"') {
+	if(i == es_strlen(str)) {
+		quoted = 0; /* empty field at end of line */
+	} else if(c[i] == '"') {
 		quoted = 1;
 		++i;
 	} else if(c[i] == '[') {
@@ -173,13 +179,20 @@ processField(ee_ctx ctx, es_str_t *str, es_size_t *offs, struct ee_value **value
 			++i;
 			break; /* end of field */
 		}
-		es_addChar(&val, c[i]);
+		if(value != NULL)
+			es_addChar(&val, c[i]);
 		++i;
 	}
+	if(value == NULL) {
+		*offs = i;
+		r = 0;
+		goto done;
+	}
 	/* just a dash means this field is empty! */
 	if(!es_strconstcmp(val, "-"))
 		es_emptyStr(val);
 
+	STATS_ADD(ctx, bytesCopied, es_strlen(val));
 	ee_setStrValue(*value, val);
 	*offs = i;
 	r = 0;
@@ -196,27 +209,61 @@ done:	return r;
  */
 static inline int
 processLn(ee_ctx ctx, struct ee_apache *apache, es_str_t *ln,
-	  int (*cbNewEvt)(struct ee_event *event))
+	  struct ee_event **event)
 {
 	int r;
 	es_size_t i;
 	struct ee_value *val;
 	ee_fieldListApache_t *node;
-	struct ee_value *value;
-	struct ee_event *event;
+	int bProjected;
+	unsigned long long fterms;
+	struct ee_filterState fstate = { 0 };
+	STATS_TIMER_DECL
 
-	CHKN(event = ee_newEvent(ctx));
+	STATS_TIMER_START;
+	CHKN(*event = ee_newEvent(ctx));
 	i = 0;
 	node = apache->nroot;
 	while(node != NULL && i < es_strlen(ln)) {
-		CHKR(processField(ctx, ln, &i, &val));
-		CHKR(addField(ctx, event, node->name, val));
+		bProjected = ee_isProjected(ctx, es_getBufAddr(node->name),
+					    es_strlen(node->name), node->nameHash);
+		fterms = (ctx->filter == NULL) ? 0
+			 : ee_filterTerms(ctx, es_getBufAddr(node->name), es_strlen(node->name),
+					  node->nameHash);
+		if(bProjected || fterms) {
+			CHKR(processField(ctx, ln, &i, &val));
+			if(fterms) {
+				ee_filterValue(ctx, &fstate, fterms, es_getBufAddr(val->val.str),
+					       es_strlen(val->val.str));
+				if((r = ee_filterFieldDone(&fstate, fterms)) != 0) {
+					ee_deleteValue(val);
+					goto done;
+				}
+			}
+			if(bProjected) {
+				CHKR(addField(ctx, *event, node, val));
+			} else {
+				ee_deleteValue(val);
+			}
+		} else {
+			CHKR(processField(ctx, ln, &i, NULL));
+		}
 		node = node->next;
 	}
-	CHKR(cbNewEvt(event));
+	if(ctx->filter != NULL)
+		CHKR(ee_filterEvent(ctx, &fstate, *event));
+	STATS_TIMER_STOP(ctx, decodeNs);
+	STATS_INC(ctx, eventsDecoded);
 	r = 0;
 
-done:	return r;
+done:
+	if(r != 0 && *event != NULL) {
+		ee_deleteEvent(*event);
+		*event = NULL;
+	}
+	if(r == EE_FILTERED)
+		STATS_INC(ctx, eventsFiltered);
+	return r;
 }
 
 
@@ -228,13 +275,21 @@ ee_apacheDec(ee_ctx ctx, int (*cbGetLine)(es_str_t **ln),
 	int r;
 	int lnNbr;
 	es_str_t *ln = NULL;
+	struct ee_event *event;
 	char errMsgBuf[1024];
 	size_t errlen;
 	
 	lnNbr = 1;
 	r = cbGetLine(&ln);
 	while(r == 0) {
-		if((r = processLn(ctx, apache, ln, cbNewEvt)) != 0) {
+		TRACE2(decode_start, "apache", lnNbr);
+		r = processLn(ctx, apache, ln, &event);
+		TRACE3(decode_done, "apache", lnNbr, r);
+		if(r == 0)
+			r = cbNewEvt(event);
+		else if(r == EE_FILTERED)
+			r = 0;
+		if(r != 0) {
 			errlen = snprintf(errMsgBuf, sizeof(errMsgBuf),
 					  "error processing line %d", lnNbr);
 			*errMsg = es_newStrFromCStr(errMsgBuf, errlen);
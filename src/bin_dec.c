@@ -0,0 +1,311 @@
+/**
+ * @file bin_dec.c
+ * Decoder for the binary event format (see binary.h for a description
+ * of the format).
+ *
+ * This file contains code from all related objects that is required in
+ * order to decode this format. The core idea of putting all of this into
+ * a single file is that this makes it very straightforward to write
+ * decoders for different encodings, as all is in one place.
+ *
+ *//* Libee - An Event Expression Library inspired by CEE
+ * Copyright 2012 by Rainer Gerhards and Adiscon GmbH.
+ *
+ * This file is part of libee.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * A copy of the LGPL v2.1 can be found in the file "COPYING" in this distribution.
+ */
+#include "config.h"
+#include <stdlib.h>
+#include <assert.h>
+
+#include "libee/libee.h"
+#include "libee/binary.h"
+#include "libee/internal.h"
+
+/* number of names we can resolve without allocating memory */
+#define NAMES_ON_STACK 32
+
+/* a name dictionary entry, resolved in place */
+struct binname {
+	unsigned char *name;
+	es_size_t len;
+};
+
+
+/* read a name ID and check that it is inside the dictionary */
+static inline int
+getNameID(unsigned char **pp, unsigned char *end, unsigned nNames, unsigned *id)
+{
+	int r;
+	unsigned long long v;
+
+	CHKR(ee_binGetVarint(pp, end, &v));
+	if(v >= nNames) {
+		r = EE_INVLDFMT;
+		goto done;
+	}
+	*id = (unsigned) v;
+
+done:
+	return r;
+}
+
+
+/* read a count; counts must fit into an unsigned and be plausible,
+ * that is each element needs at least one byte in the buffer.
+ */
+static inline int
+getCount(unsigned char **pp, unsigned char *end, unsigned *cnt)
+{
+	int r;
+	unsigned long long v;
+
+	CHKR(ee_binGetVarint(pp, end, &v));
+	if(v > (unsigned long long) (end - *pp)) {
+		r = EE_INVLDFMT;
+		goto done;
+	}
+	*cnt = (unsigned) v;
+
+done:
+	return r;
+}
+
+
+int
+ee_binRecordLen(unsigned char *buf, size_t lenBuf, size_t *len)
+{
+	int r = 0;
+
+	if(lenBuf < EE_BIN_HDRLEN) {
+		r = (lenBuf < 2 || (buf[0] == EE_BIN_MAGIC0 && buf[1] == EE_BIN_MAGIC1))
+		    ? EE_EOF : EE_INVLDFMT;
+		goto done;
+	}
+	if(   buf[0] != EE_BIN_MAGIC0 || buf[1] != EE_BIN_MAGIC1
+	   || buf[2] != EE_BIN_VERSION || buf[3] != 0) {
+		r = EE_INVLDFMT;
+		goto done;
+	}
+	*len = EE_BIN_HDRLEN + ( (size_t) buf[4]
+	                       | ((size_t) buf[5] << 8)
+	                       | ((size_t) buf[6] << 16)
+	                       | ((size_t) buf[7] << 24));
+
+done:
+	return r;
+}
+
+
+int
+ee_binParseRecord(unsigned char *buf, size_t lenBuf, struct ee_binrec *rec)
+{
+	int r;
+	unsigned char *p, *end;
+	unsigned char *str;
+	es_size_t len;
+	unsigned i, j, id, nVals;
+	struct ee_binvalue val;
+
+	CHKR(ee_binRecordLen(buf, lenBuf, &rec->len));
+	if(rec->len > lenBuf) {
+		r = EE_EOF;
+		goto done;
+	}
+	rec->buf = buf;
+	rec->end = end = buf + rec->len;
+	p = buf + EE_BIN_HDRLEN;
+
+	CHKR(getCount(&p, end, &rec->nNames));
+	rec->names = p;
+	for(i = 0 ; i < rec->nNames ; ++i)
+		CHKR(ee_binGetStr(&p, end, &str, &len));
+
+	CHKR(getCount(&p, end, &rec->nTags));
+	rec->tags = p;
+	for(i = 0 ; i < rec->nTags ; ++i)
+		CHKR(getNameID(&p, end, rec->nNames, &id));
+
+	CHKR(getCount(&p, end, &rec->nFields));
+	rec->fields = p;
+	for(i = 0 ; i < rec->nFields ; ++i) {
+		CHKR(getNameID(&p, end, rec->nNames, &id));
+		CHKR(getCount(&p, end, &nVals));
+		if(nVals > LIBEE_CEE_MAX_VALS_PER_FIELD) {
+			r = EE_TOOMANYVALUES;
+			goto done;
+		}
+		for(j = 0 ; j < nVals ; ++j)
+			CHKR(ee_binGetValue(&p, end, &val));
+	}
+
+	if(p != end)
+		r = EE_INVLDFMT;
+
+done:
+	return r;
+}
+
+
+int
+ee_binGetName(struct ee_binrec *rec, unsigned id, unsigned char **name, es_size_t *len)
+{
+	int r;
+	unsigned char *p = rec->names;
+	unsigned i;
+
+	if(id >= rec->nNames) {
+		r = EE_NOTFOUND;
+		goto done;
+	}
+	for(i = 0 ; i <= id ; ++i)
+		CHKR(ee_binGetStr(&p, rec->end, name, len));
+
+done:
+	return r;
+}
+
+
+/* create a value object from its binary representation */
+static int
+newValueFromBinary(ee_ctx ctx, unsigned char **pp, unsigned char *end, struct ee_value **value)
+{
+	int r;
+	struct ee_binvalue val;
+	es_str_t *valstr;
+
+	*value = NULL;
+	CHKR(ee_binGetValue(pp, end, &val));
+	CHKN(*value = ee_newValue(ctx));
+	if(val.type == EE_BIN_VAL_STR) {
+		CHKN(valstr = es_newStrFromBuf((char*) val.str, val.len));
+		STATS_ADD(ctx, bytesCopied, val.len);
+		ee_setStrValue(*value, valstr);
+	} else if(val.type == EE_BIN_VAL_NBR) {
+		ee_setNbrValue(*value, val.number);
+	} else if(val.type == EE_BIN_VAL_DBL) {
+		ee_setDblValue(*value, val.dbl);
+	} else {
+		ee_setNetValue(*value, &val.net);
+	}
+
+done:
+	if(r != 0 && *value != NULL) {
+		ee_deleteValue(*value);
+		*value = NULL;
+	}
+	return r;
+}
+
+
+struct ee_event*
+ee_newEventFromBinary(ee_ctx ctx, unsigned char *buf, size_t lenBuf, size_t *lenUsed)
+{
+	int r;
+	struct ee_binrec rec;
+	struct ee_event *event = NULL;
+	struct ee_field *field = NULL;
+	struct ee_value *value;
+	struct ee_tagbucket *tags = NULL;
+	es_str_t *tagname;
+	struct binname namesOnStack[NAMES_ON_STACK];
+	struct binname *names = namesOnStack;
+	unsigned char *p;
+	unsigned i, j, id, nVals;
+	unsigned hash;
+	unsigned long long v;
+	struct ee_binvalue binval;
+	STATS_TIMER_DECL
+
+	STATS_TIMER_START;
+	CHKR(ee_binParseRecord(buf, lenBuf, &rec));
+	if(rec.nNames > NAMES_ON_STACK)
+		CHKN(names = malloc(rec.nNames * sizeof(struct binname)));
+	p = rec.names;
+	for(i = 0 ; i < rec.nNames ; ++i)
+		CHKR(ee_binGetStr(&p, rec.end, &names[i].name, &names[i].len));
+
+	CHKN(event = ee_newEvent(ctx));
+
+	/* the record was validated above, so we do not need to re-check
+	 * IDs and counts below.
+	 */
+	if(rec.nTags > 0) {
+		CHKN(tags = ee_newTagbucket(ctx));
+		p = rec.tags;
+		for(i = 0 ; i < rec.nTags ; ++i) {
+			CHKR(ee_binGetVarint(&p, rec.end, &v));
+			id = (unsigned) v;
+			CHKN(tagname = es_newStrFromBuf((char*) names[id].name, names[id].len));
+			if((r = ee_addTagToBucket(tags, tagname)) != 0) {
+				es_deleteStr(tagname);
+				goto done;
+			}
+		}
+		CHKR(ee_assignTagbucketToEvent(event, tags));
+		tags = NULL;
+	}
+
+	p = rec.fields;
+	for(i = 0 ; i < rec.nFields ; ++i) {
+		CHKR(ee_binGetVarint(&p, rec.end, &v));
+		id = (unsigned) v;
+		CHKR(ee_binGetVarint(&p, rec.end, &v));
+		nVals = (unsigned) v;
+		hash = ee_hashName(names[id].name, names[id].len);
+		if(!ee_isProjected(ctx, names[id].name, names[id].len, hash)) {
+			for(j = 0 ; j < nVals ; ++j)
+				CHKR(ee_binGetValue(&p, rec.end, &binval));
+			continue;
+		}
+		CHKN(field = ee_newField(ctx));
+		CHKN(field->name = es_newStrFromBuf((char*) names[id].name, names[id].len));
+		field->nameHash = hash;
+		for(j = 0 ; j < nVals ; ++j) {
+			CHKR(newValueFromBinary(ctx, &p, rec.end, &value));
+			if((r = ee_addValueToField(field, value)) != 0) {
+				ee_deleteValue(value);
+				goto done;
+			}
+		}
+		CHKR(ee_addFieldToEvent(event, field));
+		field = NULL;
+	}
+
+	if(lenUsed != NULL)
+		*lenUsed = rec.len;
+
+done:
+	if(names != namesOnStack)
+		free(names);
+	if(r != 0) {
+		DBGPRINTF(ctx, EE_DBG_ERR, "binary: invalid record, error %d", r);
+		if(field != NULL)
+			ee_deleteField(field);
+		if(tags != NULL)
+			ee_deleteTagbucket(tags);
+		if(event != NULL)
+			ee_deleteEvent(event);
+		event = NULL;
+	} else {
+		STATS_INC(ctx, eventsDecoded);
+	}
+	STATS_TIMER_STOP(ctx, decodeNs);
+	return event;
+}
+/* vim :ts=4:sw=4 */
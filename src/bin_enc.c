@@ -0,0 +1,231 @@
+/**
+ * @file bin_enc.c
+ * Encoder for the binary event format (see binary.h for a description
+ * of the format).
+ *
+ * This file contains code from all related objects that is required in
+ * order to encode this format. The core idea of putting all of this into
+ * a single file is that this makes it very straightforward to write
+ * encoders for different encodings, as all is in one place.
+ *
+ *//* Libee - An Event Expression Library inspired by CEE
+ * Copyright 2012 by Rainer Gerhards and Adiscon GmbH.
+ *
+ * This file is part of libee.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * A copy of the LGPL v2.1 can be found in the file "COPYING" in this distribution.
+ */
+#include "config.h"
+#include <stdlib.h>
+#include <assert.h>
+
+#include "libee/libee.h"
+#include "libee/binary.h"
+#include "libee/internal.h"
+
+/* the name dictionary we build while encoding */
+struct namedict {
+	unsigned nNames;
+	struct namedict_ent {
+		es_str_t *name;
+		unsigned hash;
+	} *ent;
+};
+
+
+static inline int
+addVarint(es_str_t **str, unsigned long long v)
+{
+	char buf[10];
+	es_size_t i = 0;
+
+	while(v >= 0x80) {
+		buf[i++] = (char) ((v & 0x7f) | 0x80);
+		v >>= 7;
+	}
+	buf[i++] = (char) v;
+	return es_addBuf(str, buf, i);
+}
+
+
+/* Obtain the ID of a name, adding it to the dictionary if it is not yet
+ * present. The dictionary is usually small, and as we compare hashes
+ * first, a linear search is good enough.
+ */
+static unsigned
+getNameID(struct namedict *dict, es_str_t *name, unsigned hash)
+{
+	unsigned i;
+
+	for(i = 0 ; i < dict->nNames ; ++i) {
+		if(   dict->ent[i].hash == hash
+		   && !es_strcmp(dict->ent[i].name, name))
+			return i;
+	}
+	dict->ent[i].name = name;
+	dict->ent[i].hash = hash;
+	dict->nNames++;
+	return i;
+}
+
+
+int
+ee_addValue_Binary(struct ee_value *value, es_str_t **str)
+{
+	int r;
+	int i;
+	long long n;
+	unsigned long long u;
+
+	assert(value != NULL); assert(value->objID == ObjID_VALUE);
+	switch(value->valtype) {
+	case ee_valtype_str:
+		CHKR(es_addChar(str, EE_BIN_VAL_STR));
+		CHKR(addVarint(str, es_strlen(value->val.str)));
+		CHKR(es_addStr(str, value->val.str));
+		break;
+	case ee_valtype_nbr:
+		n = value->val.number;
+		CHKR(es_addChar(str, EE_BIN_VAL_NBR));
+		CHKR(addVarint(str, ((unsigned long long) n << 1) ^ (unsigned long long) (n >> 63)));
+		break;
+	case ee_valtype_dbl:
+		memcpy(&u, &value->val.dbl, sizeof(double));
+		CHKR(es_addChar(str, EE_BIN_VAL_DBL));
+		for(i = 0 ; i < 8 ; ++i, u >>= 8)
+			CHKR(es_addChar(str, u & 0xff));
+		break;
+	case ee_valtype_net:
+		CHKR(es_addChar(str, EE_BIN_VAL_NET));
+		CHKR(es_addChar(str, value->val.net.type));
+		CHKR(es_addChar(str, value->val.net.prefixLen));
+		CHKR(es_addBuf(str, (char*) value->val.net.addr,
+			       ee_netAddrLen(value->val.net.type)));
+		break;
+	default:
+		r = EE_EINVAL;
+		break;
+	}
+
+done:
+	return r;
+}
+
+
+int
+ee_fmtEventToBinary(struct ee_event *event, es_str_t **str)
+{
+	int r = -1;
+	struct namedict dict;
+	struct ee_tagbucket_listnode *tag;
+	struct ee_fieldbucket_listnode *node;
+	struct ee_field *field;
+	struct ee_valnode *valnode;
+	unsigned *ids = NULL;
+	unsigned nTags = 0, nFields = 0;
+	unsigned i;
+	unsigned hash;
+	unsigned char *hdr;
+	es_size_t lenPayload;
+	STATS_TIMER_DECL
+
+	assert(event != NULL);assert(event->objID == ObjID_EVENT);
+	*str = NULL;
+	TRACE2(encode_start, "binary", event);
+	STATS_TIMER_START;
+	dict.nNames = 0;
+	dict.ent = NULL;
+
+	if(event->tags != NULL)
+		for(tag = event->tags->root ; tag != NULL ; tag = tag->next)
+			++nTags;
+	if(event->fields != NULL)
+		nFields = event->fields->nFields;
+
+	/* first build the dictionary, we need to emit it before anything else */
+	if(nTags + nFields > 0) {
+		CHKN(dict.ent = malloc((nTags + nFields) * sizeof(struct namedict_ent)));
+		CHKN(ids = malloc((nTags + nFields) * sizeof(unsigned)));
+	}
+	i = 0;
+	if(event->tags != NULL) {
+		for(tag = event->tags->root ; tag != NULL ; tag = tag->next) {
+			hash = ee_hashName(es_getBufAddr(tag->name), es_strlen(tag->name));
+			ids[i++] = getNameID(&dict, tag->name, hash);
+		}
+	}
+	if(event->fields != NULL) {
+		for(node = event->fields->root ; node != NULL ; node = node->next) {
+			field = node->field;
+			if(field->name == NULL) {
+				r = EE_EINVAL;
+				goto done;
+			}
+			ids[i++] = getNameID(&dict, field->name, field->nameHash);
+		}
+	}
+
+	CHKN(*str = es_newStr(256));
+	CHKR(es_addBuf(str, "EB", 2));
+	CHKR(es_addChar(str, EE_BIN_VERSION));
+	CHKR(es_addBuf(str, "\0\0\0\0\0", 5)); /* flags, length (filled in below) */
+
+	CHKR(addVarint(str, dict.nNames));
+	for(i = 0 ; i < dict.nNames ; ++i) {
+		CHKR(addVarint(str, es_strlen(dict.ent[i].name)));
+		CHKR(es_addStr(str, dict.ent[i].name));
+	}
+
+	CHKR(addVarint(str, nTags));
+	for(i = 0 ; i < nTags ; ++i)
+		CHKR(addVarint(str, ids[i]));
+
+	CHKR(addVarint(str, nFields));
+	if(event->fields != NULL) {
+		for(node = event->fields->root ; node != NULL ; node = node->next) {
+			field = node->field;
+			CHKR(addVarint(str, ids[i++]));
+			CHKR(addVarint(str, field->nVals));
+			if(field->nVals == 0)
+				continue;
+			CHKR(ee_addValue_Binary(field->val, str));
+			for(valnode = field->valroot ; valnode != NULL ; valnode = valnode->next)
+				CHKR(ee_addValue_Binary(valnode->val, str));
+		}
+	}
+
+	lenPayload = es_strlen(*str) - EE_BIN_HDRLEN;
+	hdr = es_getBufAddr(*str);
+	hdr[4] = lenPayload & 0xff;
+	hdr[5] = (lenPayload >> 8) & 0xff;
+	hdr[6] = (lenPayload >> 16) & 0xff;
+	hdr[7] = (lenPayload >> 24) & 0xff;
+	r = 0;
+
+done:
+	free(dict.ent);
+	free(ids);
+	if(r != 0 && *str != NULL) {
+		es_deleteStr(*str);
+		*str = NULL;
+	}
+	STATS_TIMER_STOP(event->ctx, encodeNs);
+	STATS_ENCODED(event->ctx, *str);
+	TRACE3(encode_done, "binary", event, r);
+	return r;
+}
+/* vim :ts=4:sw=4 */
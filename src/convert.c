@@ -35,6 +35,10 @@
 #include "libee/libee.h"
 #include "libee/int.h"
 #include "libee/apache.h"
+#include "libee/syslog.h"
+#include "libee/kv.h"
+#include "libee/csv.h"
+#include "libee/normalizer.h"
 #include "libee/internal.h"
 
 /* private forward definition for decoders without headers */
@@ -46,7 +50,7 @@ int ee_jsonDec(ee_ctx ctx, int (*cbGetLine)(es_str_t **ln),
 static ee_ctx ctx;
 static FILE *fpIn;
 static int verbose = 0;
-enum codec { f_all, f_syslog, f_json, f_xml, f_int, f_apache, f_csv };
+enum codec { f_all, f_syslog, f_json, f_xml, f_int, f_apache, f_csv, f_kv, f_tsv, f_norm };
 static enum codec encoder = f_syslog;
 static enum codec decoder = f_int;
 static es_str_t *decFmt = NULL; /**< a format string for decoder use */
@@ -56,7 +60,7 @@ void
 dbgCallBack(void __attribute__((unused)) *cookie, char *msg,
 	    size_t __attribute__((unused)) lenMsg)
 {
-	printf("libee: %s\n", msg);
+	fprintf(stderr, "libee: %s\n", msg);
 }
 
 void errout(char *errmsg)
@@ -152,7 +156,8 @@ cbGetLine(es_str_t **ln)
 		r = EE_NOMEM;
 		goto done;
 	}
-	if(decoder != f_json)
+	if(   decoder != f_json && decoder != f_syslog && decoder != f_kv
+	   && decoder != f_csv && decoder != f_tsv && decoder != f_norm)
 		es_unescapeStr(*ln);
 	r = 0;
 done:
@@ -179,9 +184,8 @@ int main(int argc, char *argv[])
 	if((ctx = ee_initCtx()) == NULL) {
 		errout("Could not initialize libee context");
 	}
-	ee_setDebugCB(ctx, dbgCallBack, NULL);
 
-	while((opt = getopt(argc, argv, "c:i:ve:E:d:D:")) != -1) {
+	while((opt = getopt(argc, argv, "c:i:ve:E:d:D:p:f:")) != -1) {
 		switch (opt) {
 		case 'i':
 			if((fpIn = fopen(optarg, "r")) == NULL) {
@@ -191,6 +195,7 @@ int main(int argc, char *argv[])
 			break;
 		case 'v':
 			verbose = 1;
+			ee_setDebugCB(ctx, dbgCallBack, NULL);
 			break;
 		case 'e': /* encoder to use */
 			if(!strcmp(optarg, "json")) {
@@ -212,6 +217,16 @@ int main(int argc, char *argv[])
 				decoder = f_apache;
 			} else if(!strcmp(optarg, "json")) {
 				decoder = f_json;
+			} else if(!strcmp(optarg, "syslog")) {
+				decoder = f_syslog;
+			} else if(!strcmp(optarg, "kv")) {
+				decoder = f_kv;
+			} else if(!strcmp(optarg, "csv")) {
+				decoder = f_csv;
+			} else if(!strcmp(optarg, "tsv")) {
+				decoder = f_tsv;
+			} else if(!strcmp(optarg, "norm")) {
+				decoder = f_norm;
 			}
 			break;
 		case 'D': /* decoder-specific format string (will be validated by decoder) */ 
@@ -220,6 +235,14 @@ int main(int argc, char *argv[])
 		case 'E': /* encoder-specific format string (will be validated by encoder) */ 
 			encFmt = es_newStrFromCStr(optarg, strlen(optarg));
 			break;
+		case 'p': /* projection: fields to decode */
+			if(ee_setProjection(ctx, optarg) != 0)
+				errout("could not set projection");
+			break;
+		case 'f': /* filter: events to decode */
+			if(ee_setFilter(ctx, optarg) != 0)
+				errout("invalid filter expression");
+			break;
 		case 'c': /* compactness of encoding */
 			if(!strcmp(optarg, "ultra")) {
 				ee_setEncUltraCompact(ctx);
@@ -252,6 +275,51 @@ int main(int argc, char *argv[])
 			errout(errbuf);
 		}
 		break;
+	case f_syslog:
+		if((r = ee_syslogSDDec(ctx, cbGetLine, cbNewEvt, &errmsg)) != 0) {
+			cstr = es_str2cstr(errmsg, NULL);
+			snprintf(errbuf, sizeof(errbuf), "error %d in decoding stage: %s\n",
+				 r, cstr);
+			free(cstr);
+			errout(errbuf);
+		}
+		break;
+	case f_kv:
+		{
+		struct ee_kv *kv;
+		if((kv = ee_newKV(ctx)) == NULL) {
+			errout("error creating kv decoder");
+		}
+		if((r = ee_kvDec(ctx, cbGetLine, cbNewEvt, &errmsg, kv)) != 0) {
+			cstr = es_str2cstr(errmsg, NULL);
+			snprintf(errbuf, sizeof(errbuf), "error %d in decoding stage: %s\n",
+				 r, cstr);
+			free(cstr);
+			errout(errbuf);
+		}
+		ee_deleteKV(kv);
+		}
+		break;
+	case f_csv:
+	case f_tsv:
+		{
+		struct ee_csv *csv;
+		if(decFmt == NULL) {
+			errout("csv decoder needs a column list (-D)");
+		}
+		if((csv = ee_newCSV(ctx, decFmt, (decoder == f_csv) ? ',' : '\t', 0)) == NULL) {
+			errout("error applying decoder format string");
+		}
+		if((r = ee_csvDec(ctx, cbGetLine, cbNewEvt, &errmsg, csv)) != 0) {
+			cstr = es_str2cstr(errmsg, NULL);
+			snprintf(errbuf, sizeof(errbuf), "error %d in decoding stage: %s\n",
+				 r, cstr);
+			free(cstr);
+			errout(errbuf);
+		}
+		ee_deleteCSV(csv);
+		}
+		break;
 	case f_apache:
 		{
 		struct ee_apache *apache;
@@ -269,6 +337,30 @@ int main(int argc, char *argv[])
 		ee_deleteApache(apache);
 		}
 		break;
+	case f_norm:
+		{
+		struct ee_normalizer *norm;
+		if(decFmt == NULL) {
+			errout("normalizer needs a rulebase (-D)");
+		}
+		if((norm = ee_newNormalizer(ctx)) == NULL) {
+			errout("error creating normalizer");
+		}
+		cstr = es_str2cstr(decFmt, NULL);
+		if(ee_loadRulebase(norm, cstr) != 0) {
+			errout("error loading rulebase");
+		}
+		free(cstr);
+		if((r = ee_normDec(ctx, cbGetLine, cbNewEvt, &errmsg, norm)) != 0) {
+			cstr = es_str2cstr(errmsg, NULL);
+			snprintf(errbuf, sizeof(errbuf), "error %d in decoding stage: %s\n",
+				 r, cstr);
+			free(cstr);
+			errout(errbuf);
+		}
+		ee_deleteNormalizer(norm);
+		}
+		break;
 	default:
 		errout("program error, decoder not yet supported");
 	}
@@ -0,0 +1,565 @@
+/**
+ * @file csv_dec.c
+ * Decoder for CSV and TSV (the counterpart of csv_enc.c).
+ *//*
+ * Libee - An Event Expression Library inspired by CEE
+ * Copyright 2012 by Rainer Gerhards and Adiscon GmbH.
+ *
+ * This file is part of libee.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * A copy of the LGPL v2.1 can be found in the file "COPYING" in this distribution.
+ */
+#include "config.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+
+#include "libee/libee.h"
+#include "libee/csv.h"
+#include "libee/filter.h"
+#include "libee/internal.h"
+
+
+/* compile the column list; the syntax is the same as for the encoder */
+static int
+compileColSpec(struct ee_csv *csv, es_str_t *colSpec)
+{
+	int r = 0;
+	unsigned char *c = es_getBufAddr(colSpec);
+	es_size_t len = es_strlen(colSpec);
+	es_size_t i, start;
+	unsigned n;
+
+	for(n = 1, i = 0 ; i < len ; ++i)
+		if(c[i] == ',' || c[i] == ' ')
+			++n;
+	CHKN(csv->names = calloc(n, sizeof(es_str_t*)));
+	CHKN(csv->nameHashes = malloc(n * sizeof(unsigned)));
+
+	i = 0;
+	while(i < len) {
+		start = i;
+		while(i < len && c[i] != ',' && c[i] != ' ')
+			++i;
+		if(i == start) {
+			r = EE_INVLDFMT;
+			goto done;
+		}
+		CHKN(csv->names[csv->nCols] = es_newStrFromBuf((char*) c + start, i - start));
+		csv->nameHashes[csv->nCols++] = ee_hashName(c + start, i - start);
+		if(i < len)	/* are we on ','? */
+			++i;	/* "eat" it */
+	}
+	if(csv->nCols == 0)
+		r = EE_INVLDFMT;
+
+done:
+	return r;
+}
+
+
+/* Build the layout of the events from the columns, so that the fields
+ * go into preallocated slots. This is an optimization only: if it is not
+ * possible (e.g. a column name is used twice), the events are unbound.
+ */
+static void
+buildLayout(struct ee_csv *csv)
+{
+	int r = 0;
+	unsigned i;
+	char *name = NULL;
+	struct ee_fieldtype *fieldtype = NULL;
+
+	CHKN(csv->layout = ee_newFieldset(csv->ctx, "csv"));
+	for(i = 0 ; i < csv->nCols ; ++i) {
+		CHKN(name = es_str2cstr(csv->names[i], NULL));
+		CHKN(fieldtype = ee_newFieldtype(csv->ctx, name, NULL, 0, 1));
+		CHKR(ee_addFieldtypeToSet(csv->layout, fieldtype));
+		fieldtype = NULL;
+		free(name);
+		name = NULL;
+	}
+	r = ee_compileFieldset(csv->layout);
+
+done:
+	free(name);
+	if(fieldtype != NULL)
+		ee_deleteFieldtype(fieldtype);
+	if(r != 0 && csv->layout != NULL) {
+		ee_deleteFieldset(csv->layout);
+		csv->layout = NULL;
+	}
+}
+
+
+struct ee_csv*
+ee_newCSV(ee_ctx ctx, es_str_t *colSpec, char delim, unsigned flags)
+{
+	struct ee_csv *csv;
+
+	assert(ctx != NULL);assert(ctx->objID == ObjID_CTX);
+	if((csv = calloc(1, sizeof(struct ee_csv))) == NULL)
+		goto done;
+	csv->objID = ObjID_CSV;
+	csv->ctx = ctx;
+	csv->delim = (unsigned char) delim;
+	csv->flags = flags;
+	if(delim == '"' || compileColSpec(csv, colSpec) != 0) {
+		ee_deleteCSV(csv);
+		csv = NULL;
+		goto done;
+	}
+	buildLayout(csv);
+
+done:
+	return csv;
+}
+
+
+void
+ee_deleteCSV(struct ee_csv *csv)
+{
+	unsigned i;
+
+	assert(csv != NULL);assert(csv->objID == ObjID_CSV);
+	csv->objID = ObjID_DELETED;
+	for(i = 0 ; i < csv->nCols ; ++i)
+		es_deleteStr(csv->names[i]);
+	free(csv->names);
+	free(csv->nameHashes);
+	if(csv->layout != NULL)
+		ee_deleteFieldset(csv->layout);
+	free(csv);
+}
+
+
+/* find the next c, memchr() is usually vectorized
+ * @return offset of c, len if there is none
+ */
+static inline es_size_t
+scanOne(unsigned char *buf, es_size_t i, es_size_t len, unsigned char c)
+{
+	unsigned char *p;
+
+	if(i >= len)
+		return len;
+	p = memchr(buf + i, c, len - i);
+	return (p == NULL) ? len : (es_size_t) (p - buf);
+}
+
+
+/* find the next c1 or c2, eight bytes at a time
+ * @return offset of that byte, len if there is none
+ */
+static inline es_size_t
+scanTwo(unsigned char *buf, es_size_t i, es_size_t len, unsigned char c1, unsigned char c2)
+{
+	unsigned long long x;
+
+	while(len - i >= 8) {
+		memcpy(&x, buf + i, 8);
+		if(SWAR_HASBYTE(x, c1) | SWAR_HASBYTE(x, c2))
+			break;
+		i += 8;
+	}
+	while(i < len && buf[i] != c1 && buf[i] != c2)
+		++i;
+	return i;
+}
+
+
+static inline int
+hexVal(unsigned char c)
+{
+	if(c >= '0' && c <= '9')
+		return c - '0';
+	if(c >= 'a' && c <= 'f')
+		return c - 'a' + 10;
+	if(c >= 'A' && c <= 'F')
+		return c - 'A' + 10;
+	return -1;
+}
+
+
+/* Decode a backslash escape as created by ee_addValue_CSV(). *offs is
+ * at the backslash and is updated to point after the escape. Unknown
+ * escapes just stand for the escaped character.
+ */
+static int
+addEscape(es_str_t **valstr, unsigned char *buf, es_size_t len, es_size_t *offs)
+{
+	int r;
+	es_size_t i = *offs + 1;
+	unsigned char utf8[3];
+	unsigned u;
+	int j, n, v;
+
+	if(i == len) {
+		r = EE_EOF; /* escaped line break */
+		goto done;
+	}
+	n = 1;
+	switch(buf[i]) {
+	case 'b':
+		utf8[0] = '\b';
+		break;
+	case 'f':
+		utf8[0] = '\f';
+		break;
+	case 'n':
+		utf8[0] = '\n';
+		break;
+	case 'r':
+		utf8[0] = '\r';
+		break;
+	case 't':
+		utf8[0] = '\t';
+		break;
+	case 'u':
+		for(u = 0, j = 1 ; j < 5 && i + j < len && (v = hexVal(buf[i+j])) >= 0 ; ++j)
+			u = (u << 4) | v;
+		if(j < 5) {
+			utf8[0] = 'u';
+			break;
+		}
+		i += 4;
+		if(u < 0x80) {
+			utf8[0] = u;
+		} else if(u < 0x800) {
+			utf8[0] = 0xc0 | (u >> 6);
+			utf8[1] = 0x80 | (u & 0x3f);
+			n = 2;
+		} else {
+			utf8[0] = 0xe0 | (u >> 12);
+			utf8[1] = 0x80 | ((u >> 6) & 0x3f);
+			utf8[2] = 0x80 | (u & 0x3f);
+			n = 3;
+		}
+		break;
+	default:
+		utf8[0] = buf[i];
+		break;
+	}
+	CHKR(ee_addToValStr(valstr, utf8, n));
+	*offs = i + 1;
+
+done:
+	return r;
+}
+
+
+/* Obtain a quoted field, *offs is at the opening quote. Returns EE_EOF
+ * if the field does not end inside the buffer. If valstr is NULL, the
+ * field is just skipped.
+ */
+static int
+getQuotedField(struct ee_csv *csv, unsigned char *buf, es_size_t len, es_size_t *offs,
+	       es_str_t **valstr)
+{
+	int r;
+	es_size_t i = *offs + 1, j;
+	int bEsc = csv->flags & EE_CSV_BACKSLASH_ESC;
+
+	while(1) {
+		j = bEsc ? scanTwo(buf, i, len, '"', '\\') : scanOne(buf, i, len, '"');
+		if(j == len) {
+			r = EE_EOF;
+			goto done;
+		}
+		CHKR(ee_addToValStr(valstr, buf + i, j - i));
+		if(buf[j] == '\\') {
+			CHKR(addEscape(valstr, buf, len, &j));
+			i = j;
+		} else if(j + 1 < len && buf[j+1] == '"') {
+			CHKR(ee_addToValStr(valstr, buf + j, 1));
+			i = j + 2;
+		} else {
+			i = j + 1;
+			break;
+		}
+	}
+	/* nothing may follow the closing quote, but we are lenient */
+	*offs = scanOne(buf, i, len, csv->delim);
+
+done:
+	return r;
+}
+
+
+/* create a field for a column and add it to the bucket; the value
+ * string is handed over
+ */
+static int
+addField(struct ee_csv *csv, struct ee_fieldbucket *fields, unsigned col, es_str_t **valstr)
+{
+	int r;
+	struct ee_field *field;
+	struct ee_value *val;
+
+	CHKN(field = ee_newField(csv->ctx));
+	CHKN(field->name = es_strdup(csv->names[col]));
+	field->nameHash = csv->nameHashes[col];
+	CHKN(val = ee_newValue(csv->ctx));
+	STATS_ADD(csv->ctx, bytesCopied, es_strlen(*valstr));
+	ee_setStrValue(val, *valstr);
+	*valstr = NULL;
+	if((r = ee_addValueToField(field, val)) != 0) {
+		ee_deleteValue(val);
+		goto done;
+	}
+	if(fields->layout != NULL) {
+		CHKR(ee_addFieldToSlot(fields, col, field));
+	} else {
+		CHKR(ee_addFieldToBucket(fields, field));
+	}
+	field = NULL;
+
+done:
+	if(field != NULL)
+		ee_deleteField(field);
+	return r;
+}
+
+
+/* Check if a record is complete, that is it does not end inside a
+ * quoted field. Scanning starts at *offs, where the previous call for
+ * the record stopped, so a record of several lines is scanned only once.
+ * *bInQuote tells if *offs is inside a quoted field. Quotes and escapes
+ * are handled like in decodeRecord(), but no values are created.
+ */
+static int
+recordComplete(struct ee_csv *csv, unsigned char *buf, es_size_t len, es_size_t *offs,
+	       int *bInQuote)
+{
+	es_size_t i = *offs, j;
+	int bEsc = csv->flags & EE_CSV_BACKSLASH_ESC;
+
+	while(1) {
+		if(!*bInQuote) {
+			if(i < len && buf[i] == '"') {
+				*bInQuote = 1;
+				++i;
+				continue;
+			}
+			i = scanOne(buf, i, len, csv->delim);
+			if(i == len)
+				break;
+			++i; /* the delimiter */
+			continue;
+		}
+		j = bEsc ? scanTwo(buf, i, len, '"', '\\') : scanOne(buf, i, len, '"');
+		if(j == len) {
+			i = len;
+			break;
+		}
+		if(buf[j] == '\\') {
+			if(j + 1 == len) {
+				/* escaped line break, rescan once it is there */
+				i = j;
+				break;
+			}
+			i = j + 2;
+		} else if(j + 1 < len && buf[j+1] == '"') {
+			i = j + 2;
+		} else {
+			*bInQuote = 0;
+			i = scanOne(buf, j + 1, len, csv->delim);
+			if(i == len)
+				break;
+			++i;
+		}
+	}
+	*offs = i;
+	return !*bInQuote;
+}
+
+
+/* decode a record into a new event */
+static int
+decodeRecord(struct ee_csv *csv, unsigned char *buf, es_size_t len, struct ee_event **event)
+{
+	int r = 0;
+	es_size_t i = 0, end, lenVal;
+	unsigned col;
+	int bProjected;
+	int bRejected = 0;
+	unsigned long long fterms;
+	struct ee_filterState fstate = { 0 };
+	struct ee_fieldbucket *fields;
+	es_str_t *valstr = NULL;
+	STATS_TIMER_DECL
+
+	STATS_TIMER_START;
+	*event = NULL;
+	if(csv->layout != NULL) {
+		CHKN(fields = ee_newFieldbucketFromFieldset(csv->layout));
+	} else {
+		CHKN(fields = ee_newFieldbucket(csv->ctx));
+	}
+	for(col = 0 ; ; ++col) {
+		/* once the filter rejected the record, we only look for its end,
+		 * which may be on a later line
+		 */
+		bProjected = !bRejected && col < csv->nCols
+			     && ee_isProjected(csv->ctx, es_getBufAddr(csv->names[col]),
+					       es_strlen(csv->names[col]), csv->nameHashes[col]);
+		fterms = (!bRejected && col < csv->nCols && csv->ctx->filter != NULL)
+			 ? ee_filterTerms(csv->ctx, es_getBufAddr(csv->names[col]),
+					  es_strlen(csv->names[col]), csv->nameHashes[col])
+			 : 0;
+		if(i < len && buf[i] == '"') {
+			CHKR(getQuotedField(csv, buf, len, &i,
+					    (bProjected || fterms) ? &valstr : NULL));
+		} else {
+			end = scanOne(buf, i, len, csv->delim);
+			lenVal = end - i;
+			if(end == len && lenVal > 0 && buf[end-1] == '\r')
+				--lenVal; /* CRLF line end */
+			if((bProjected || fterms) && lenVal > 0)
+				CHKN(valstr = es_newStrFromBuf((char*) buf + i, lenVal));
+			i = end;
+		}
+		if(valstr != NULL && es_strlen(valstr) > 0 && fterms) {
+			ee_filterValue(csv->ctx, &fstate, fterms, es_getBufAddr(valstr),
+				       es_strlen(valstr));
+			bRejected = ee_filterFieldDone(&fstate, fterms) != 0;
+		}
+		if(valstr != NULL) {
+			if(es_strlen(valstr) > 0 && bProjected && !bRejected) {
+				CHKR(addField(csv, fields, col, &valstr));
+			} else {
+				es_deleteStr(valstr);
+				valstr = NULL;
+			}
+		}
+		if(i == len)
+			break;
+		++i; /* the delimiter */
+	}
+	if(bRejected) {
+		r = EE_FILTERED;
+		goto done;
+	}
+	CHKN(*event = ee_newEvent(csv->ctx));
+	(*event)->fields = fields;
+	fields = NULL;
+	if(csv->ctx->filter != NULL)
+		CHKR(ee_filterEvent(csv->ctx, &fstate, *event));
+
+done:
+	if(valstr != NULL)
+		es_deleteStr(valstr);
+	if(fields != NULL)
+		ee_deleteFieldbucket(fields);
+	if(r != 0 && *event != NULL) {
+		ee_deleteEvent(*event);
+		*event = NULL;
+	}
+	if(r == 0)
+		STATS_INC(csv->ctx, eventsDecoded);
+	else if(r == EE_FILTERED)
+		STATS_INC(csv->ctx, eventsFiltered);
+	STATS_TIMER_STOP(csv->ctx, decodeNs);
+	return r;
+}
+
+
+struct ee_event*
+ee_newEventFromCSV(struct ee_csv *csv, es_str_t *str)
+{
+	struct ee_event *event;
+
+	assert(csv != NULL);assert(csv->objID == ObjID_CSV);
+	decodeRecord(csv, es_getBufAddr(str), es_strlen(str), &event);
+	return event;
+}
+
+
+int
+ee_csvDec(ee_ctx ctx, int (*cbGetLine)(es_str_t **ln),
+	  int (*cbNewEvt)(struct ee_event *event),
+	  es_str_t **errMsg, struct ee_csv *csv)
+{
+	int r;
+	int lnNbr, recNbr;
+	es_str_t *ln = NULL;
+	es_str_t *rec = NULL;
+	es_size_t offs = 0;
+	int bInQuote = 0;
+	struct ee_event *event;
+	char errMsgBuf[1024];
+	size_t errlen;
+
+	assert(csv != NULL);assert(csv->objID == ObjID_CSV);
+	if(ctx != csv->ctx) {
+		r = EE_EINVAL;
+		*errMsg = es_newStrFromCStr("decoder belongs to another context", 34);
+		goto done;
+	}
+	lnNbr = recNbr = 1;
+	while((r = cbGetLine(&ln)) == 0) {
+		if(rec == NULL) {
+			rec = ln;
+			offs = 0;
+			bInQuote = 0;
+		} else {
+			/* the line continues a quoted field of the record */
+			r = es_addChar(&rec, '\n');
+			if(r == 0)
+				r = es_addStr(&rec, ln);
+			es_deleteStr(ln);
+			if(r != 0)
+				goto fail;
+		}
+		++lnNbr;
+		/* only decode once the record is complete */
+		if(!recordComplete(csv, es_getBufAddr(rec), es_strlen(rec), &offs, &bInQuote))
+			continue;
+		TRACE2(decode_start, "csv", recNbr);
+		r = decodeRecord(csv, es_getBufAddr(rec), es_strlen(rec), &event);
+		TRACE3(decode_done, "csv", recNbr, r);
+		es_deleteStr(rec);
+		rec = NULL;
+		if(r == 0)
+			r = cbNewEvt(event);
+		else if(r == EE_FILTERED)
+			r = 0;
+		if(r != 0)
+			goto fail;
+		recNbr = lnNbr;
+	}
+
+	if(r == EE_EOF) {
+		if(rec == NULL) {
+			r = 0;
+			goto done;
+		}
+		DBGPRINTF(ctx, EE_DBG_ERR, "csv: unterminated quoted field in record "
+			  "starting at line %d", recNbr);
+		r = EE_INVLDFMT; /* unterminated quoted field */
+	}
+fail:
+	errlen = snprintf(errMsgBuf, sizeof(errMsgBuf),
+			  "error processing record starting at line %d", recNbr);
+	*errMsg = es_newStrFromCStr(errMsgBuf, errlen);
+done:
+	if(rec != NULL)
+		es_deleteStr(rec);
+	return r;
+}
+/* vim :ts=4:sw=4 */
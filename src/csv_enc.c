@@ -127,6 +127,21 @@ done:	return fields;
 }
 
 
+static void
+freeNameList(struct ee_FieldCSV *fields)
+{
+	ee_fieldListCSV_t *node, *nodeDel;
+
+	for(node = fields->nroot ; node != NULL ; ) {
+		nodeDel = node;
+		es_deleteStr(node->name);
+		node = node->next;
+		free(nodeDel);
+	}
+	free(fields);
+}
+
+
 /* TODO: CSV encoding for Unicode characters is as of RFC4627 not fully
  * supported. The algorithm is that we must build the wide character from
  * UTF-8 (if char > 127) and build the full 4-octet Unicode character out
@@ -147,8 +162,11 @@ ee_addValue_CSV(struct ee_value *value, es_str_t **str)
 
 	assert(str != NULL); assert(*str != NULL);
 	assert(value != NULL); assert(value->objID == ObjID_VALUE);
-	// TODO: support other types!
-	assert(value->valtype == ee_valtype_str);
+	if(value->valtype != ee_valtype_str) {
+		/* no escaping needed, see ee_addValueAsStr() */
+		CHKR(ee_addValueAsStr(value, str));
+		goto done;
+	}
 	valstr = value->val.str;
 
 	buf = es_getBufAddr(valstr);
@@ -203,6 +221,7 @@ ee_addValue_CSV(struct ee_value *value, es_str_t **str)
 	}
 	r = 0;
 
+done:
 	return r;
 }
 
@@ -241,9 +260,12 @@ ee_fmtEventToCSV(struct ee_event *event, es_str_t **str, es_str_t *extraData)
 	struct ee_FieldCSV *fields = NULL;
 	struct ee_field* field;
 	ee_fieldListCSV_t *node;
+	STATS_TIMER_DECL
 
 	assert(event != NULL);assert(event->objID == ObjID_EVENT);
 	assert(extraData != NULL);
+	TRACE2(encode_start, "csv", event);
+	STATS_TIMER_START;
 	if((*str = es_newStr(256)) == NULL) goto done;
 	if((fields = genNameList(event->ctx, extraData)) == NULL) goto done;
 
@@ -261,6 +283,11 @@ ee_fmtEventToCSV(struct ee_event *event, es_str_t **str, es_str_t *extraData)
 	}
 	r = 0;
 done:
+	STATS_TIMER_STOP(event->ctx, encodeNs);
+	STATS_ENCODED(event->ctx, *str);
+	TRACE3(encode_done, "csv", event, r);
+	if(fields != NULL)
+		freeNameList(fields);
 	return r;
 }
 /* vim :ts=4:sw=4 */
@@ -23,6 +23,7 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <stdarg.h>
+#include <string.h>
 
 #include "libee/libee.h"
 #include "libee/internal.h"
@@ -30,11 +31,7 @@
 
 #define ERR_ABORT {r = 1; goto done; }
 
-#define CHECK_CTX \
-	if(ctx->objID != ObjID_CTX) { \
-		r = -1; \
-		goto done; \
-	}
+#define CHECK_CTX CHKOBJ(ctx, ObjID_CTX)
 
 char *
 ee_version(void)
@@ -50,10 +47,17 @@ ee_initCtx(void)
 	if((ctx = calloc(1, sizeof(struct ee_ctx_s))) == NULL)
 		goto done;
 
+	ee_initNumLocale();
 	ctx->objID = ObjID_CTX;
 	ctx->dbgCB = NULL;
+	ctx->dbgLevel = EE_DBG_TRACE;
 	ctx->tagBucketSize = EE_DFLT_TAG_BCKT_SIZE;
 	ctx->fieldBucketSize = EE_DFLT_FIELD_BCKT_SIZE;
+	if(ee_registerBuiltinParsers(ctx) != 0) {
+		ee_deleteParsers(ctx);
+		free(ctx);
+		ctx = NULL;
+	}
 done:
 	return ctx;
 }
@@ -66,6 +70,10 @@ ee_exitCtx(ee_ctx ctx)
 
 	CHECK_CTX;
 
+	ee_deleteFieldsets(ctx);
+	ee_deleteParsers(ctx);
+	ee_setProjection(ctx, NULL);
+	ee_setFilter(ctx, NULL);
 	ctx->objID = ObjID_None; /* prevent double free */
 	free(ctx);
 done:
@@ -83,6 +91,96 @@ unsigned int ee_getFlags(ee_ctx ctx)
 	return ctx->flags;
 }
 
+static void
+deleteProjection(struct ee_projection *proj)
+{
+	unsigned i;
+
+	for(i = 0 ; i < proj->nNames ; ++i)
+		es_deleteStr(proj->names[i]);
+	free(proj->names);
+	free(proj->hashes);
+	free(proj);
+}
+
+int
+ee_setProjection(ee_ctx ctx, char *names)
+{
+	int r = 0;
+	struct ee_projection *proj = NULL;
+	unsigned n;
+	char *name, *end;
+
+	if(names == NULL)
+		goto done;
+	CHKN(proj = calloc(1, sizeof(struct ee_projection)));
+	for(n = 1, name = names ; *name ; ++name)
+		if(*name == ',')
+			++n;
+	CHKN(proj->names = malloc(n * sizeof(es_str_t*)));
+	CHKN(proj->hashes = malloc(n * sizeof(unsigned)));
+	for(name = names ; ; name = end + 1) {
+		if((end = strchr(name, ',')) == NULL)
+			end = name + strlen(name);
+		if(end > name) { /* ignore empty names */
+			CHKN(proj->names[proj->nNames] = es_newStrFromCStr(name, end - name));
+			proj->hashes[proj->nNames] = ee_hashName((unsigned char*) name, end - name);
+			proj->filter |= 1ull << (proj->hashes[proj->nNames] % 64);
+			proj->nNames++;
+		}
+		if(*end == '\0')
+			break;
+	}
+
+done:
+	if(r == 0) {
+		if(ctx->projection != NULL)
+			deleteProjection(ctx->projection);
+		ctx->projection = proj;
+	} else if(proj != NULL) {
+		deleteProjection(proj);
+	}
+	return r;
+}
+
+int
+ee_getStats(ee_ctx ctx, struct ee_stats *stats)
+{
+#ifdef ENABLE_STATS
+	memcpy(stats, &ctx->stats, sizeof(struct ee_stats));
+	return 0;
+#else
+	(void) ctx;
+	memset(stats, 0, sizeof(struct ee_stats));
+	return EE_NOTFOUND;
+#endif
+}
+
+void
+ee_resetStats(ee_ctx ctx)
+{
+	memset(&ctx->stats, 0, sizeof(struct ee_stats));
+}
+
+char *
+ee_getStatsParserName(enum ee_statsParser parser)
+{
+	static char *names[EE_STATS_NPARSERS] = {
+		"date-rfc3164", "date-rfc5424", "date-iso", "time-24hr",
+		"time-12hr", "ipv4", "ipv6", "mac48", "cidr", "number",
+		"quoted-string", "char-to", "word" };
+
+	if((unsigned) parser >= EE_STATS_NPARSERS)
+		return NULL;
+	return names[parser];
+}
+
+void
+ee_setDebugLevel(ee_ctx ctx, int level)
+{
+	ctx->dbgLevel = level;
+}
+
 int
 ee_setDebugCB(ee_ctx ctx, void (*cb)(void*, char*, size_t), void *cookie)
 {
@@ -100,7 +198,8 @@ done:
  * Generate some debug message and call the caller provided callback.
  *
  * Will first check if a user callback is registered. If not, returns
- * immediately.
+ * immediately. Library code should use DBGPRINTF(), which also checks
+ * the debug level before the arguments are evaluated.
  */
 void
 ee_dbgprintf(ee_ctx ctx, char *fmt, ...)
@@ -37,34 +37,96 @@
 
 #define ERR_ABORT {r = 1; goto done; }
 
-#define CHECK_FIELD \
-	if(event->objID != ObjID_EVENT) { \
-		r = -1; \
-		goto done; \
-	}
+#define CHECK_FIELD CHKOBJ(event, ObjID_EVENT)
 
 
 struct ee_event*
-ee_newEvent(ee_ctx __attribute__((unused)) ctx)
+ee_newEvent(ee_ctx ctx)
 {
 	struct ee_event *event;
 	if((event = malloc(sizeof(struct ee_event))) == NULL)
 		goto done;
+	STATS_INC(ctx, eventsCreated);
 
 	event->objID = ObjID_EVENT;
 	event->ctx = ctx;
 	event->fields = NULL;
 	event->tags = NULL;
+	TRACE1(event_new, event);
 
 done:
 	return event;
 }
 
 
+struct ee_event*
+ee_newEventFromFieldset(struct ee_fieldset *fieldset)
+{
+	struct ee_event *event;
+
+	assert(fieldset != NULL);assert(fieldset->o.objID == ObjID_FIELDSET);
+	if((event = ee_newEvent(fieldset->o.ctx)) == NULL)
+		goto done;
+	if((event->fields = ee_newFieldbucketFromFieldset(fieldset)) == NULL) {
+		ee_deleteEvent(event);
+		event = NULL;
+		goto done;
+	}
+	/* all events of the type share the tags (copy-on-write) */
+	if(fieldset->tagset != NULL && fieldset->tagset->tags != NULL)
+		event->tags = ee_addRefTagbucket(fieldset->tagset->tags);
+
+done:
+	return event;
+}
+
+
+struct ee_event*
+ee_cloneEvent(struct ee_event *event)
+{
+	struct ee_event *clone;
+
+	assert(event != NULL);assert(event->objID == ObjID_EVENT);
+	if((clone = ee_newEvent(event->ctx)) == NULL)
+		goto done;
+	if(event->tags != NULL)
+		clone->tags = ee_addRefTagbucket(event->tags);
+	if(event->fields != NULL)
+		clone->fields = ee_addRefFieldbucket(event->fields);
+
+done:
+	return clone;
+}
+
+
+/* obtain a field bucket which we may modify. If there is none, one
+ * is created. If it is shared with a clone, we create a private copy.
+ */
+static inline int
+getPrivFieldbucket(struct ee_event *event)
+{
+	int r = 0;
+	struct ee_fieldbucket *fields;
+
+	if(event->fields == NULL) {
+		CHKN(event->fields = ee_newFieldbucket(event->ctx));
+	} else if(ee_FieldbucketIsShared(event->fields)) {
+		CHKN(fields = ee_dupFieldbucket(event->fields));
+		ee_deleteFieldbucket(event->fields);
+		event->fields = fields;
+	}
+
+done:
+	return r;
+}
+
+
 void
 ee_deleteEvent(struct ee_event *event)
 {
 	assert(event != NULL);assert(event->objID == ObjID_EVENT);
+	STATS_INC(event->ctx, eventsDeleted);
+	TRACE1(event_delete, event);
 	if(event->tags != NULL)
 		ee_deleteTagbucket(event->tags);
 	if(event->fields != NULL)
@@ -98,12 +160,25 @@ ee_addTagToEvent(struct ee_event *event, es_str_t *tag)
 {
 	int r = -1;
 
+	struct ee_tagbucket *tags;
+	es_str_t *name;
+
 	assert(event != NULL);assert(event->objID == ObjID_EVENT);
-	if(event->tags == NULL)
+	if(event->tags == NULL) {
 		if((event->tags = ee_newTagbucket(event->ctx)) == NULL)
 			goto done;
+	} else if(ee_TagbucketIsShared(event->tags)) {
+		/* copy-on-write: never modify a bucket others still see */
+		if((tags = ee_dupTagbucket(event->tags)) == NULL)
+			goto done;
+		ee_deleteTagbucket(event->tags);
+		event->tags = tags;
+	}
 
-	r = ee_addTagToBucket(event->tags, es_strdup(tag));
+	if((name = es_strdup(tag)) == NULL)
+		goto done;
+	if((r = ee_addTagToBucket(event->tags, name)) != 0)
+		es_deleteStr(name);
 	
 done:
 	return r;
@@ -116,9 +191,7 @@ ee_addFieldToEvent(struct ee_event *event, struct ee_field *field)
 	int r;
 
 	assert(event != NULL);assert(event->objID == ObjID_EVENT);
-	if(event->fields == NULL) {
-		CHKN(event->fields = ee_newFieldbucket(event->ctx));
-	}
+	CHKR(getPrivFieldbucket(event));
 
 	r = ee_addFieldToBucket(event->fields, field);
 	
@@ -135,9 +208,9 @@ ee_addStrFieldToEvent(struct ee_event *event, char *fieldname, es_str_t *value)
 	struct ee_value *val = NULL;
 
 	assert(event != NULL);assert(event->objID == ObjID_EVENT);
-	if(event->fields == NULL)
-		if((event->fields = ee_newFieldbucket(event->ctx)) == NULL)
-			goto done;
+	if((r = getPrivFieldbucket(event)) != 0)
+		goto done;
+	r = -1;
 //printf("addStrField: %s/%s\n", fieldname, es_str2cstr(value, NULL));
 
 	if((val = ee_newValue(event->ctx)) == NULL) goto done;
@@ -172,10 +245,178 @@ ee_EventHasTag(struct ee_event *event, es_str_t *tagname)
 struct ee_field*
 ee_getEventField(struct ee_event *event, es_str_t *name)
 {
+	if(event->fields == NULL)
+		return NULL;
 	return(ee_getBucketField(event->fields, name));
 }
 
 
+struct ee_field*
+ee_getEventFieldByRef(struct ee_event *event, ee_fieldref ref)
+{
+	assert(ref->objID == ObjID_FIELDREF);
+	if(event->fields == NULL || ref->kind != ee_fieldref_field)
+		return NULL;
+	return(ee_getBucketFieldHashed(event->fields, ref->name, ref->hash));
+}
+
+
+struct ee_field*
+ee_getEventFieldForUpdate(struct ee_event *event, es_str_t *name)
+{
+	struct ee_field *field = NULL;
+
+	if(event->fields == NULL)
+		goto done;
+	if(getPrivFieldbucket(event) != 0)
+		goto done;
+	field = ee_getBucketFieldForUpdate(event->fields, name);
+
+done:
+	return field;
+}
+
+
+struct ee_field*
+ee_getEventFieldBySlot(struct ee_event *event, unsigned slot)
+{
+	assert(event != NULL);assert(event->objID == ObjID_EVENT);
+	if(   event->fields == NULL || event->fields->layout == NULL
+	   || slot >= event->fields->layout->nSlots)
+		return NULL;
+	return ee_getBucketFieldBySlot(event->fields, slot);
+}
+
+
+int
+ee_addValueToEventSlot(struct ee_event *event, unsigned slot, struct ee_value *value)
+{
+	int r;
+	struct ee_fieldset *layout;
+	struct ee_fieldtype *fieldtype;
+	struct ee_field *field = NULL;
+	struct ee_field **slotField;
+
+	assert(event != NULL);assert(event->objID == ObjID_EVENT);
+	if(   event->fields == NULL || (layout = event->fields->layout) == NULL
+	   || slot >= layout->nSlots) {
+		r = EE_EINVAL;
+		goto done;
+	}
+	CHKR(getPrivFieldbucket(event));
+	fieldtype = layout->types[slot];
+	slotField = &event->fields->slots[slot].field;
+
+	if(*slotField == NULL) {
+		CHKN(field = ee_newField(event->ctx));
+		CHKR(ee_nameField(field, fieldtype->name));
+		CHKR(ee_addFieldToSlot(event->fields, slot, field));
+		field = NULL;
+	} else if(ee_FieldIsShared(*slotField)) {
+		/* the field is shared with a clone, so we need our own */
+		CHKN(field = ee_dupField(*slotField));
+		ee_deleteField(*slotField); /* drops our reference only */
+		*slotField = field;
+		field = NULL;
+	}
+
+	if(fieldtype->maxVals > 0 && (*slotField)->nVals >= fieldtype->maxVals) {
+		r = EE_TOOMANYVALUES;
+		goto done;
+	}
+	r = ee_addValueToField(*slotField, value);
+
+done:
+	if(field != NULL)
+		ee_deleteField(field);
+	return r;
+}
+
+
+int
+ee_addStrToEventSlot(struct ee_event *event, unsigned slot, unsigned char *buf,
+		     es_size_t len)
+{
+	int r;
+	struct ee_value *value = NULL;
+
+	assert(event != NULL);assert(event->objID == ObjID_EVENT);
+	if(   event->fields == NULL || event->fields->layout == NULL
+	   || slot >= event->fields->layout->nSlots) {
+		r = EE_EINVAL;
+		goto done;
+	}
+	CHKR(ee_newValueFromFieldtype(event->fields->layout->types[slot], buf, len, &value));
+	if((r = ee_addValueToEventSlot(event, slot, value)) != 0)
+		ee_deleteValue(value);
+
+done:
+	return r;
+}
+
+
+int
+ee_validateEvent(struct ee_event *event)
+{
+	int r = 0;
+	unsigned slot;
+	unsigned nVals;
+	struct ee_fieldset *layout;
+	struct ee_field *field;
+
+	assert(event != NULL);assert(event->objID == ObjID_EVENT);
+	if(event->fields == NULL || (layout = event->fields->layout) == NULL) {
+		r = EE_EINVAL;
+		goto done;
+	}
+	for(slot = 0 ; slot < layout->nSlots ; ++slot) {
+		field = ee_getBucketFieldBySlot(event->fields, slot);
+		nVals = (field == NULL) ? 0 : field->nVals;
+		if(nVals < layout->types[slot]->minVals) {
+			r = EE_NOTFOUND;
+			goto done;
+		}
+		if(layout->types[slot]->maxVals > 0 && nVals > layout->types[slot]->maxVals) {
+			r = EE_TOOMANYVALUES;
+			goto done;
+		}
+	}
+
+done:
+	return r;
+}
+
+
+/* obtain the string representation of the event's tags */
+static int
+getTagsAsString(struct ee_event *event, es_str_t **strVal)
+{
+	int r;
+	struct ee_tagbucket_listnode *tag;
+	int needComma = 0;
+
+	if(event->tags == NULL) {
+		r = EE_NOTFOUND;
+		goto done;
+	}
+	if(*strVal == NULL) {
+		CHKN(*strVal = es_newStr(16));
+	}
+	for(tag = event->tags->root ; tag != NULL ; tag = tag->next) {
+		if(needComma) {
+			CHKR(es_addChar(strVal, ','));
+		} else {
+			needComma = 1;
+		}
+		CHKR(es_addStr(strVal, tag->name));
+	}
+	r = 0;
+
+done:
+	return r;
+}
+
+
 /* TODO: this function should use the default encoder. However, none of
  * that plumbing currently exists. So the current implementation is just
  * a quick skeleton, which needs to be extended severely (but it still
@@ -186,8 +427,6 @@ ee_getEventFieldAsString(struct ee_event *event, es_str_t *name, es_str_t **strV
 {
 	int r = EE_ERR;
 	struct ee_field *f;
-	struct ee_tagbucket_listnode *tag;
-	int needComma = 0;
 
 	/* checking event.tags is a hack and will be removed with the
 	 * next version when I change the internal representation of
@@ -195,23 +434,32 @@ ee_getEventFieldAsString(struct ee_event *event, es_str_t *name, es_str_t **strV
 	 * TODO -- rgerhards, 2011-04-12
 	 */
 	if(!es_strbufcmp(name, (unsigned char*) "event.tags", 10)) {
-		if(event->tags == NULL) {
+		r = getTagsAsString(event, strVal);
+	} else {
+		f = ee_getEventField(event, name);
+		if(f == NULL) {
 			r = EE_NOTFOUND;
 			goto done;
 		}
-		if(*strVal == NULL) {
-			CHKN(*strVal = es_newStr(16));
-		}
-		for(tag = event->tags->root ; tag != NULL ; tag = tag->next) {
-			if(needComma) {
-				CHKR(es_addChar(strVal, ','));
-			} else {
-				needComma = 1;
-			}
-			CHKR(es_addStr(strVal, tag->name));
-		}
+		CHKR(ee_getFieldAsString(f, strVal));
+	}
+
+done:
+	return r;
+}
+
+
+int
+ee_getEventFieldAsStringByRef(struct ee_event *event, ee_fieldref ref, es_str_t **strVal)
+{
+	int r = EE_ERR;
+	struct ee_field *f;
+
+	assert(ref->objID == ObjID_FIELDREF);
+	if(ref->kind == ee_fieldref_tags) {
+		r = getTagsAsString(event, strVal);
 	} else {
-		f = ee_getBucketField(event->fields, name);
+		f = ee_getEventFieldByRef(event, ref);
 		if(f == NULL) {
 			r = EE_NOTFOUND;
 			goto done;
@@ -223,7 +471,6 @@ done:
 	return r;
 }
 
-
 void
 ee_EventGetTagbucket(struct ee_event *event, struct ee_tagbucket **tagbucket)
 {
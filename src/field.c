@@ -33,34 +33,71 @@
 
 #define ERR_ABORT {r = 1; goto done; }
 
-#define CHECK_FIELD \
-	if(field->objID != ObjID_FIELD) { \
-		r = -1; \
-		goto done; \
-	}
+#define CHECK_FIELD CHKOBJ(field, ObjID_FIELD)
 
 struct ee_field*
 ee_newField(ee_ctx ctx)
 {
 	struct ee_field *field;
 	if((field = malloc(sizeof(struct ee_field))) == NULL) goto done;
+	STATS_INC(ctx, fieldsAlloced);
 	field->objID = ObjID_FIELD;
 	field->ctx = ctx;
 	field->name = NULL;
+	field->nameHash = 0;
 	field->nVals = 0;
 	field->valroot = field->valtail = NULL;
+	field->refCount = 1;
 done:
 	return field;
 }
 
 
+struct ee_field*
+ee_dupField(struct ee_field *field)
+{
+	struct ee_field *newf;
+	struct ee_valnode *node;
+
+	assert(field != NULL);assert(field->objID == ObjID_FIELD);
+	if((newf = ee_newField(field->ctx)) == NULL) goto done;
+	if(field->name != NULL) {
+		if((newf->name = es_strdup(field->name)) == NULL)
+			goto fail;
+		newf->nameHash = field->nameHash;
+	}
+	if(field->nVals > 0) {
+		if(ee_addValueToField(newf, ee_addRefValue(field->val)) != 0) {
+			ee_deleteValue(field->val);
+			goto fail;
+		}
+	}
+	for(node = field->valroot ; node != NULL ; node = node->next) {
+		if(ee_addValueToField(newf, ee_addRefValue(node->val)) != 0) {
+			ee_deleteValue(node->val);
+			goto fail;
+		}
+	}
+
+done:
+	return newf;
+fail:
+	ee_deleteField(newf);
+	return NULL;
+}
+
+
 void
 ee_deleteField(struct ee_field *field)
 {
 	struct ee_valnode *node, *nodeDel;
 
 	assert(field->objID == ObjID_FIELD);
-	es_deleteStr(field->name);
+	assert(field->refCount > 0);
+	if(--field->refCount > 0)
+		return; /* still shared */
+	if(field->name != NULL)
+		es_deleteStr(field->name);
 	if(field->nVals > 0) {
 		ee_deleteValue(field->val);
 	}
@@ -88,6 +125,7 @@ ee_newFieldFromNV(ee_ctx __attribute__((unused)) ctx, char *name, struct ee_valu
 		field = NULL;
 		goto done;
 	}
+	field->nameHash = ee_hashName(es_getBufAddr(field->name), es_strlen(field->name));
 
 	field->val = val;
 	field->nVals = 1;
@@ -107,11 +145,13 @@ ee_nameField(struct ee_field *field, es_str_t *name)
 {
 	int r;
 	assert(field->objID == ObjID_FIELD);
+	assert(!ee_FieldIsShared(field));
 	if(field->name != NULL) {
 		r = EE_FIELDHASNAME;
 		goto done;
 	}
 	CHKN(field->name = es_strdup(name));
+	field->nameHash = ee_hashName(es_getBufAddr(name), es_strlen(name));
 	r = 0;
 done:
 	return r;
@@ -126,6 +166,10 @@ ee_addValueToField(struct ee_field *field, struct ee_value *val)
 	assert(field != NULL);assert(field->objID== ObjID_FIELD);
 	assert(val != NULL);assert(val->objID == ObjID_VALUE);
 
+	if(ee_FieldIsShared(field)) {
+		r = EE_EINVAL;
+		goto done;
+	}
 	if(field->nVals == 0) {
 		field->nVals = 1;
 		field->val = val;
@@ -162,7 +206,13 @@ ee_replaceValueInField(struct ee_field *field, struct ee_value *val, unsigned in
 	assert(field != NULL);assert(field->objID== ObjID_FIELD);
 	assert(val != NULL);assert(val->objID == ObjID_VALUE);
 
-	if (n >= field->nVals) {
+	/* Note: ee_deleteValue() only drops our reference. If the old value
+	 * is shared with a cloned event, it stays intact over there.
+	 */
+	if(ee_FieldIsShared(field)) {
+		r = EE_EINVAL;
+		goto done;
+	} else if (n >= field->nVals) {
 		r = 1;
 		goto done;
 	} else if (n == 0) {
@@ -189,6 +239,10 @@ ee_addStrValueToField(struct ee_field *field, es_str_t *str)
 	struct ee_value *value;
 	assert(field != NULL);assert(field->objID== ObjID_FIELD);
 
+	if(ee_FieldIsShared(field)) {
+		r = EE_EINVAL;
+		goto done;
+	}
 	CHKN(value = ee_newValue(field->ctx));
 	CHKR(ee_setStrValue(value, str));
 	r = ee_addValueToField(field, value);
@@ -223,7 +277,7 @@ ee_getFieldValueAsStr(struct ee_field *field, unsigned short n)
 		goto done;
 	}
 	if(n == 0) {
-		str = es_strdup(field->val->val.str);
+		curNode = NULL;
 	} else {
 		for (curNode = field->valroot; i < n; i++){
 			if (curNode == NULL) {
@@ -232,17 +286,19 @@ ee_getFieldValueAsStr(struct ee_field *field, unsigned short n)
 			}
 			curNode = curNode->next;
 		}
-		str = es_strdup(curNode->val->val.str);
+	}
+	if((str = es_newStr(16)) == NULL)
+		goto done;
+	if(ee_addValueAsStr(curNode == NULL ? field->val : curNode->val, &str) != 0) {
+		es_deleteStr(str);
+		str = NULL;
 	}
 done:
 	return str;
 }
 
 
-/* TODO: this function currently assumes that the field has a string
- * representation, which for now is always true. Needs to be changed if
- * we change the representation!
- * TODO: implement (default) encoder interface
+/* TODO: implement (default) encoder interface
  */
 int
 ee_getFieldAsString(struct ee_field *field, es_str_t **str)
@@ -259,11 +315,11 @@ ee_getFieldAsString(struct ee_field *field, es_str_t **str)
 		goto done;
 	}
 	/* first value needs to be treated seperately */
-	CHKR(es_addStr(str, field->val->val.str));
+	CHKR(ee_addValueAsStr(field->val, str));
 
 	/* on to the rest */
 	for(node = field->valroot ; node != NULL ; node = node->next) {
-		CHKR(es_addStr(str, node->val->val.str));
+		CHKR(ee_addValueAsStr(node->val, str));
 	}
 
 done:	return r;
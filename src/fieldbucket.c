@@ -26,6 +26,7 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <stdarg.h>
+#include <stdint.h>
 #include <assert.h>
 
 #include "libee/libee.h"
@@ -33,11 +34,7 @@
 
 #define ERR_ABORT {r = 1; goto done; }
 
-#define CHECK_FIELD \
-	if(fieldbucket->objID != ObjID_FIELDBUCKET) { \
-		r = -1; \
-		goto done; \
-	}
+#define CHECK_FIELD CHKOBJ(fieldbucket, ObjID_FIELDBUCKET)
 
 
 struct ee_fieldbucket*
@@ -50,38 +47,214 @@ ee_newFieldbucket(ee_ctx ctx)
 	fieldbucket->objID = ObjID_FIELDBUCKET;
 	fieldbucket->ctx = ctx;
 	fieldbucket->root = fieldbucket->tail = NULL;
+	fieldbucket->refCount = 1;
+	fieldbucket->nFields = 0;
+	fieldbucket->htab = NULL;
+	fieldbucket->htabSize = 0;
+	fieldbucket->layout = NULL;
+	fieldbucket->slots = NULL;
+
+done:	return fieldbucket;
+}
+
+
+struct ee_fieldbucket*
+ee_newFieldbucketFromFieldset(struct ee_fieldset *fieldset)
+{
+	struct ee_fieldbucket *fieldbucket = NULL;
+	size_t size;
+
+	assert(fieldset != NULL);assert(fieldset->o.objID == ObjID_FIELDSET);
+	if(ee_compileFieldset(fieldset) != 0)
+		goto done;
+	/* one allocation for the bucket and all slots */
+	size = sizeof(struct ee_fieldbucket)
+	       + fieldset->nSlots * sizeof(struct ee_fieldbucket_listnode);
+	if((fieldbucket = malloc(size)) == NULL)
+		goto done;
+
+	fieldbucket->objID = ObjID_FIELDBUCKET;
+	fieldbucket->ctx = fieldset->o.ctx;
+	fieldbucket->root = fieldbucket->tail = NULL;
+	fieldbucket->refCount = 1;
+	fieldbucket->nFields = 0;
+	fieldbucket->htab = NULL;
+	fieldbucket->htabSize = 0;
+	fieldbucket->layout = ee_addRefFieldset(fieldset);
+	fieldbucket->slots = (struct ee_fieldbucket_listnode*) (fieldbucket + 1);
+	memset(fieldbucket->slots, 0, fieldset->nSlots * sizeof(struct ee_fieldbucket_listnode));
 
 done:	return fieldbucket;
 }
 
 
+/* check if a list node is one of the slots (and thus not malloc'ed) */
+static inline int
+isSlotNode(struct ee_fieldbucket *bucket, struct ee_fieldbucket_listnode *node)
+{
+	return    bucket->layout != NULL
+	       && (uintptr_t) node - (uintptr_t) bucket->slots
+		  < bucket->layout->nSlots * sizeof(struct ee_fieldbucket_listnode);
+}
+
+
+struct ee_fieldbucket*
+ee_dupFieldbucket(struct ee_fieldbucket *fieldbucket)
+{
+	struct ee_fieldbucket *newb;
+	struct ee_fieldbucket_listnode *node;
+
+	assert(fieldbucket->objID == ObjID_FIELDBUCKET);
+	if(fieldbucket->layout != NULL)
+		newb = ee_newFieldbucketFromFieldset(fieldbucket->layout);
+	else
+		newb = ee_newFieldbucket(fieldbucket->ctx);
+	if(newb == NULL)
+		goto done;
+
+	for(node = fieldbucket->root ; node != NULL ; node = node->next) {
+		if(ee_addFieldToBucket(newb, ee_addRefField(node->field)) != 0) {
+			ee_deleteField(node->field);
+			ee_deleteFieldbucket(newb);
+			newb = NULL;
+			goto done;
+		}
+	}
+
+done:	return newb;
+}
+
+
 void
 ee_deleteFieldbucket(struct ee_fieldbucket *fieldbucket)
 {
 	struct ee_fieldbucket_listnode *node, *nodeDel;
 
 	assert(fieldbucket->objID == ObjID_FIELDBUCKET);
+	assert(fieldbucket->refCount > 0);
+	if(--fieldbucket->refCount > 0)
+		return; /* still shared */
 	fieldbucket->objID = ObjID_DELETED;
 	for(node = fieldbucket->root ; node != NULL ; ) {
 		nodeDel = node;
 		node = node->next;
 		ee_deleteField(nodeDel->field);
-		free(nodeDel);
+		if(!isSlotNode(fieldbucket, nodeDel))
+			free(nodeDel);
 	}
+	free(fieldbucket->htab);
+	if(fieldbucket->layout != NULL)
+		ee_deleteFieldset(fieldbucket->layout);
 	free(fieldbucket);
 }
 
 
-/* TODO: when in validating mode, check duplicate field entries */
-int
-ee_addFieldToBucket(struct ee_fieldbucket *fieldb, struct ee_field *field)
+/* insert a field into the hash index. The index must have room for it.
+ * If a field with the same name already exists, the index is left
+ * unchanged, because lookups must find the first field of that name.
+ */
+static inline void
+hashInsert(struct ee_fieldbucket *bucket, struct ee_field *field)
+{
+	unsigned i;
+	unsigned mask = bucket->htabSize - 1;
+	struct ee_fieldbucket_hashent *ent;
+
+	for(i = field->nameHash & mask ; ; i = (i + 1) & mask) {
+		ent = bucket->htab + i;
+		if(ent->field == NULL) {
+			ent->hash = field->nameHash;
+			ent->field = field;
+			break;
+		}
+		if(ent->hash == field->nameHash && !es_strcmp(ent->field->name, field->name))
+			break; /* duplicate name, keep first one */
+	}
+}
+
+
+/* (re)build the hash index. It is sized so that the load factor is
+ * at most 50%. Fields without a name cannot be indexed. If we have
+ * such, we do not build an index at all (this is an exotic case). If
+ * there is not enough memory, the old index is kept.
+ * @returns 0 if the index could be built, EE_ERR if there is a field
+ *          without name, something else otherwise
+ */
+static int
+buildHashIndex(struct ee_fieldbucket *bucket, unsigned minFields)
 {
 	int r;
+	unsigned size;
+	struct ee_fieldbucket_hashent *htab;
 	struct ee_fieldbucket_listnode *node;
-	assert(fieldb != NULL);assert(fieldb->objID == ObjID_FIELDBUCKET);
-	assert(field != NULL);assert(field->objID == ObjID_FIELD);
 
-	CHKN(node = malloc(sizeof(struct ee_fieldbucket_listnode)));
+	for(node = bucket->root ; node != NULL ; node = node->next) {
+		if(node->field->name == NULL) {
+			r = EE_ERR;
+			goto done;
+		}
+	}
+	for(size = 16 ; size < 2 * minFields ; size *= 2)
+		/*JUST SKIP*/;
+	CHKN(htab = calloc(size, sizeof(struct ee_fieldbucket_hashent)));
+	free(bucket->htab);
+	bucket->htab = htab;
+	bucket->htabSize = size;
+	for(node = bucket->root ; node != NULL ; node = node->next)
+		hashInsert(bucket, node->field);
+	r = 0;
+
+done:	return r;
+}
+
+
+static inline void
+dropHashIndex(struct ee_fieldbucket *bucket)
+{
+	free(bucket->htab);
+	bucket->htab = NULL;
+	bucket->htabSize = 0;
+}
+
+
+/* let the index entry of a field point to its replacement */
+static inline void
+hashReplace(struct ee_fieldbucket *bucket, struct ee_field *old, struct ee_field *field)
+{
+	unsigned i;
+	unsigned mask = bucket->htabSize - 1;
+
+	for(i = old->nameHash & mask ; bucket->htab[i].field != NULL ; i = (i + 1) & mask) {
+		if(bucket->htab[i].field == old) {
+			bucket->htab[i].field = field;
+			break;
+		}
+	}
+}
+
+
+/* append a field to the list; node is its slot or NULL. Buckets without
+ * layout get a hash index once they hold EE_FIELDBUCKET_HASH_MIN fields.
+ * Lookups never change the bucket, so the index is built and grown here,
+ * before the field is added, so that we fail without changing anything.
+ */
+static int
+addField(struct ee_fieldbucket *fieldb, struct ee_fieldbucket_listnode *node,
+	 struct ee_field *field)
+{
+	int r;
+
+	if(fieldb->htab != NULL && field->name != NULL
+	   && 2 * (fieldb->nFields + 1) > fieldb->htabSize) {
+		CHKR(buildHashIndex(fieldb, fieldb->nFields + 1));
+	} else if(   fieldb->htab == NULL && fieldb->layout == NULL && field->name != NULL
+		  && fieldb->nFields + 1 == EE_FIELDBUCKET_HASH_MIN) {
+		r = buildHashIndex(fieldb, fieldb->nFields + 1);
+		if(r != 0 && r != EE_ERR) /* EE_ERR: there is a field without name */
+			goto done;
+	}
+	if(node == NULL)
+		CHKN(node = malloc(sizeof(struct ee_fieldbucket_listnode)));
 	node->field = field;
 	node->next = NULL;
 	if(fieldb->root == NULL) {
@@ -90,28 +263,132 @@ ee_addFieldToBucket(struct ee_fieldbucket *fieldb, struct ee_field *field)
 		fieldb->tail->next = node;
 		fieldb->tail = node;
 	}
+	fieldb->nFields++;
+	if(fieldb->htab != NULL) {
+		if(field->name == NULL)
+			dropHashIndex(fieldb);
+		else
+			hashInsert(fieldb, field);
+	}
 	r = 0;
 
 done:	return r;
 }
 
 
-/* Note: this function currently is quite performance-hungry. We should
- * replace all this searching by hashtable access some time in the future,
- * but for now the focus is on getting things done in a simple fashion, and
- * so the simple list search approach is good enough. But if you try to
- * optimize, do not optimize the list search but rather introduce the hash
- * table as second indexing structure! -- rgerhards, 2010-12-01
+/* TODO: when in validating mode, check duplicate field entries */
+int
+ee_addFieldToBucket(struct ee_fieldbucket *fieldb, struct ee_field *field)
+{
+	int slot;
+	struct ee_fieldbucket_listnode *node = NULL;
+
+	assert(fieldb != NULL);assert(fieldb->objID == ObjID_FIELDBUCKET);
+	assert(field != NULL);assert(field->objID == ObjID_FIELD);
+	assert(!ee_FieldbucketIsShared(fieldb));
+
+	if(fieldb->layout != NULL && field->name != NULL) {
+		slot = ee_findFieldsetSlot(fieldb->layout, es_getBufAddr(field->name),
+					   es_strlen(field->name), field->nameHash);
+		if(slot >= 0 && fieldb->slots[slot].field == NULL)
+			node = fieldb->slots + slot;
+	}
+	return addField(fieldb, node, field);
+}
+
+
+int
+ee_addFieldToSlot(struct ee_fieldbucket *fieldb, unsigned slot, struct ee_field *field)
+{
+	assert(fieldb != NULL);assert(fieldb->objID == ObjID_FIELDBUCKET);
+	assert(field != NULL);assert(field->objID == ObjID_FIELD);
+	assert(!ee_FieldbucketIsShared(fieldb));
+	assert(fieldb->layout != NULL);assert(slot < fieldb->layout->nSlots);
+
+	return addField(fieldb, (fieldb->slots[slot].field == NULL) ? fieldb->slots + slot : NULL,
+			field);
+}
+
+
+/* Note: for small buckets, we do a simple list search, which is the
+ * fastest thing to do. Comparing the hashes first saves us from most
+ * string compares. For larger buckets, there is a hash index as second
+ * indexing structure, as was always the plan.
  */
+struct ee_field*
+ee_getBucketFieldHashed(struct ee_fieldbucket *bucket, es_str_t *name, unsigned hash)
+{
+	struct ee_fieldbucket_listnode *node;
+	struct ee_fieldbucket_hashent *ent;
+	struct ee_field *field = NULL;
+	unsigned i, mask;
+	int slot;
+
+	/* fields of the layout are always in their slot */
+	if(bucket->layout != NULL) {
+		slot = ee_findFieldsetSlot(bucket->layout, es_getBufAddr(name), es_strlen(name), hash);
+		if(slot >= 0) {
+			field = bucket->slots[slot].field;
+			goto done;
+		}
+	}
+
+	if(bucket->htab != NULL) {
+		mask = bucket->htabSize - 1;
+		for(i = hash & mask ; bucket->htab[i].field != NULL ; i = (i + 1) & mask) {
+			ent = bucket->htab + i;
+			if(ent->hash == hash && !es_strcmp(name, ent->field->name)) {
+				field = ent->field;
+				break;
+			}
+		}
+	} else {
+		for(node = bucket->root ; node != NULL ; node = node->next) {
+			if(   node->field->nameHash == hash
+			   && node->field->name != NULL
+			   && !es_strcmp(name, node->field->name)) {
+				field = node->field;
+				break;
+			}
+		}
+	}
+
+done:
+	return field;
+}
+
+
 struct ee_field*
 ee_getBucketField(struct ee_fieldbucket *bucket, es_str_t *name)
+{
+	return ee_getBucketFieldHashed(bucket, name,
+			ee_hashName(es_getBufAddr(name), es_strlen(name)));
+}
+
+struct ee_field*
+ee_getBucketFieldForUpdate(struct ee_fieldbucket *bucket, es_str_t *name)
 {
 	struct ee_fieldbucket_listnode *node;
+	struct ee_field *field = NULL;
 
+	assert(!ee_FieldbucketIsShared(bucket));
 	for(node = bucket->root ; node != NULL ; node = node->next) {
-		if(!es_strcmp(name, node->field->name))
+		if(node->field->name != NULL && !es_strcmp(name, node->field->name))
 			break;
 	}
+	if(node == NULL)
+		goto done;
+
+	if(ee_FieldIsShared(node->field)) {
+		if((field = ee_dupField(node->field)) == NULL)
+			goto done;
+		if(bucket->htab != NULL) /* index points to the old field */
+			hashReplace(bucket, node->field, field);
+		ee_deleteField(node->field); /* drops our reference only */
+		node->field = field;
+	}
+	field = node->field;
 
-	return((node == NULL) ? NULL : node->field);
+done:
+	return field;
 }
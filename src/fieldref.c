@@ -0,0 +1,70 @@
+/**
+ * @file fieldref.c
+ * Implements fieldref object methods.
+ *//* Libee - An Event Expression Library inspired by CEE
+ * Copyright 2012 by Rainer Gerhards and Adiscon GmbH.
+ *
+ * This file is part of libee.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * A copy of the LGPL v2.1 can be found in the file "COPYING" in this distribution.
+ */
+#include "config.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+
+#include "libee/libee.h"
+#include "libee/internal.h"
+
+
+ee_fieldref
+ee_compileFieldPath(ee_ctx ctx, char *name)
+{
+	ee_fieldref ref;
+	size_t len;
+
+	assert(name != NULL);
+	if((ref = malloc(sizeof(struct ee_fieldref_s))) == NULL)
+		goto done;
+
+	len = strlen(name);
+	ref->objID = ObjID_FIELDREF;
+	ref->ctx = ctx;
+	/* checking event.tags is a hack, see ee_getEventFieldAsString() */
+	ref->kind = (len == 10 && !strcmp(name, "event.tags")) ? ee_fieldref_tags
+							     : ee_fieldref_field;
+	if((ref->name = es_newStrFromCStr(name, len)) == NULL) {
+		free(ref);
+		ref = NULL;
+		goto done;
+	}
+	ref->hash = ee_hashName(es_getBufAddr(ref->name), es_strlen(ref->name));
+
+done:
+	return ref;
+}
+
+
+void
+ee_deleteFieldref(ee_fieldref ref)
+{
+	assert(ref != NULL);assert(ref->objID == ObjID_FIELDREF);
+	ref->objID = ObjID_DELETED;
+	es_deleteStr(ref->name);
+	free(ref);
+}
@@ -0,0 +1,230 @@
+/**
+ * @file fieldset.c
+ * Implements the fieldset object (event types and their layouts).
+ *//*
+ * Libee - An Event Expression Library inspired by CEE
+ * Copyright 2012 by Rainer Gerhards and Adiscon GmbH.
+ *
+ * This file is part of libee.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * A copy of the LGPL v2.1 can be found in the file "COPYING" in this distribution.
+ */
+#include "config.h"
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include "libee/libee.h"
+#include "libee/internal.h"
+
+
+struct ee_fieldset*
+ee_newFieldset(ee_ctx ctx, char *name)
+{
+	struct ee_fieldset *fieldset;
+
+	assert(ctx != NULL);assert(ctx->objID == ObjID_CTX);
+	assert(name != NULL);
+	if((fieldset = calloc(1, sizeof(struct ee_fieldset))) == NULL)
+		goto done;
+	ee_initObj(ctx, &fieldset->o);
+	fieldset->o.objID = ObjID_FIELDSET;
+	fieldset->refCount = 1;
+	if((fieldset->o.name = strdup(name)) == NULL) {
+		free(fieldset);
+		fieldset = NULL;
+	}
+
+done:
+	return fieldset;
+}
+
+
+void
+ee_deleteFieldset(struct ee_fieldset *fieldset)
+{
+	unsigned i;
+
+	assert(fieldset != NULL);assert(fieldset->o.objID == ObjID_FIELDSET);
+	assert(fieldset->refCount > 0);
+	if(--fieldset->refCount > 0)
+		return; /* still in use */
+	fieldset->o.objID = ObjID_DELETED;
+	for(i = 0 ; i < fieldset->nSlots ; ++i)
+		ee_deleteFieldtype(fieldset->types[i]);
+	free(fieldset->types);
+	free(fieldset->htab);
+	if(fieldset->tagset != NULL)
+		ee_deleteTagset(fieldset->tagset);
+	free(fieldset->o.name);
+	ee_deinitObj(&fieldset->o);
+	free(fieldset);
+}
+
+
+int
+ee_addFieldtypeToSet(struct ee_fieldset *fieldset, struct ee_fieldtype *fieldtype)
+{
+	int r = 0;
+	unsigned i, size;
+	struct ee_fieldtype **types;
+
+	assert(fieldset != NULL);assert(fieldset->o.objID == ObjID_FIELDSET);
+	assert(fieldtype != NULL);assert(fieldtype->o.objID == ObjID_FIELDTYPE);
+	if(fieldset->htab != NULL) {
+		r = EE_EINVAL;
+		goto done;
+	}
+	for(i = 0 ; i < fieldset->nSlots ; ++i) {
+		if(!es_strcmp(fieldset->types[i]->name, fieldtype->name)) {
+			r = EE_EINVAL;
+			goto done;
+		}
+	}
+	if(fieldset->nSlots == fieldset->sizeSlots) {
+		size = (fieldset->sizeSlots == 0) ? 8 : 2 * fieldset->sizeSlots;
+		CHKN(types = realloc(fieldset->types, size * sizeof(struct ee_fieldtype*)));
+		fieldset->types = types;
+		fieldset->sizeSlots = size;
+	}
+	fieldset->types[fieldset->nSlots++] = fieldtype;
+
+done:
+	return r;
+}
+
+
+void
+ee_assignTagsetToFieldset(struct ee_fieldset *fieldset, struct ee_tagset *tagset)
+{
+	assert(fieldset != NULL);assert(fieldset->o.objID == ObjID_FIELDSET);
+	if(fieldset->tagset != NULL)
+		ee_deleteTagset(fieldset->tagset);
+	fieldset->tagset = tagset;
+}
+
+
+/* The name index is sized so that the load factor is at most 50%, like
+ * the one of the field bucket. It is built once for all events.
+ */
+int
+ee_compileFieldset(struct ee_fieldset *fieldset)
+{
+	int r = 0;
+	unsigned i, j, size, mask;
+	struct ee_fieldtype *type;
+
+	assert(fieldset != NULL);assert(fieldset->o.objID == ObjID_FIELDSET);
+	if(fieldset->htab != NULL)
+		goto done;
+	for(size = 16 ; size < 2 * fieldset->nSlots ; size *= 2)
+		/*JUST SKIP*/;
+	CHKN(fieldset->htab = calloc(size, sizeof(struct ee_fieldset_hashent)));
+	fieldset->htabSize = size;
+	mask = size - 1;
+	for(i = 0 ; i < fieldset->nSlots ; ++i) {
+		type = fieldset->types[i];
+		for(j = type->nameHash & mask ; fieldset->htab[j].type != NULL ; j = (j + 1) & mask)
+			/*JUST SKIP*/;
+		fieldset->htab[j].hash = type->nameHash;
+		fieldset->htab[j].slot = i;
+		fieldset->htab[j].type = type;
+	}
+	DBGPRINTF(fieldset->o.ctx, EE_DBG_TRACE, "fieldset '%s': %u slots",
+		  fieldset->o.name, fieldset->nSlots);
+
+done:
+	return r;
+}
+
+
+int
+ee_findFieldsetSlot(struct ee_fieldset *fieldset, unsigned char *name, es_size_t len,
+		    unsigned hash)
+{
+	unsigned i;
+	unsigned mask = fieldset->htabSize - 1;
+	struct ee_fieldset_hashent *ent;
+
+	assert(fieldset->htab != NULL);
+	for(i = hash & mask ; fieldset->htab[i].type != NULL ; i = (i + 1) & mask) {
+		ent = fieldset->htab + i;
+		if(   ent->hash == hash && es_strlen(ent->type->name) == len
+		   && !memcmp(es_getBufAddr(ent->type->name), name, len))
+			return ent->slot;
+	}
+	return -1;
+}
+
+
+int
+ee_getFieldsetSlot(struct ee_fieldset *fieldset, char *name)
+{
+	size_t len = strlen(name);
+
+	assert(fieldset != NULL);assert(fieldset->o.objID == ObjID_FIELDSET);
+	return ee_findFieldsetSlot(fieldset, (unsigned char*) name, len,
+				   ee_hashName((unsigned char*) name, len));
+}
+
+
+struct ee_fieldset*
+ee_findFieldset(ee_ctx ctx, char *name)
+{
+	struct ee_fieldset *fieldset;
+
+	for(fieldset = ctx->fieldsets ; fieldset != NULL ; fieldset = fieldset->next)
+		if(!strcmp(fieldset->o.name, name))
+			break;
+	return fieldset;
+}
+
+
+int
+ee_registerFieldset(ee_ctx ctx, struct ee_fieldset *fieldset)
+{
+	int r;
+
+	assert(ctx != NULL);assert(ctx->objID == ObjID_CTX);
+	assert(fieldset != NULL);assert(fieldset->o.objID == ObjID_FIELDSET);
+	if(ee_findFieldset(ctx, fieldset->o.name) != NULL) {
+		r = EE_EINVAL;
+		goto done;
+	}
+	CHKR(ee_compileFieldset(fieldset));
+	fieldset->next = ctx->fieldsets;
+	ctx->fieldsets = fieldset;
+	DBGPRINTF(ctx, EE_DBG_TRACE, "registered fieldset '%s'", fieldset->o.name);
+
+done:
+	return r;
+}
+
+
+void
+ee_deleteFieldsets(ee_ctx ctx)
+{
+	struct ee_fieldset *fieldset, *del;
+
+	for(fieldset = ctx->fieldsets ; fieldset != NULL ; ) {
+		del = fieldset;
+		fieldset = fieldset->next;
+		ee_deleteFieldset(del);
+	}
+	ctx->fieldsets = NULL;
+}
+/* vim :ts=4:sw=4 */
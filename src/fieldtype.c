@@ -0,0 +1,130 @@
+/**
+ * @file fieldtype.c
+ * Implements the fieldtype object.
+ *//*
+ * Libee - An Event Expression Library inspired by CEE
+ * Copyright 2012 by Rainer Gerhards and Adiscon GmbH.
+ *
+ * This file is part of libee.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * A copy of the LGPL v2.1 can be found in the file "COPYING" in this distribution.
+ */
+#include "config.h"
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include "libee/libee.h"
+#include "libee/internal.h"
+
+
+struct ee_fieldtype*
+ee_newFieldtype(ee_ctx ctx, char *name, char *type, unsigned minVals, unsigned maxVals)
+{
+	int r = 0;
+	struct ee_fieldtype *fieldtype;
+
+	assert(ctx != NULL);assert(ctx->objID == ObjID_CTX);
+	assert(name != NULL);
+	CHKN(fieldtype = calloc(1, sizeof(struct ee_fieldtype)));
+	ee_initObj(ctx, &fieldtype->o);
+	fieldtype->o.objID = ObjID_FIELDTYPE;
+	if(maxVals > 255 || (maxVals > 0 && minVals > maxVals)) {
+		r = EE_EINVAL;
+		goto done;
+	}
+	fieldtype->minVals = minVals;
+	fieldtype->maxVals = maxVals;
+	CHKN(fieldtype->name = es_newStrFromCStr(name, strlen(name)));
+	fieldtype->nameHash = ee_hashName(es_getBufAddr(fieldtype->name),
+					  es_strlen(fieldtype->name));
+	if(type != NULL) {
+		if(   (fieldtype->parser = ee_findParser(ctx, type)) == NULL
+		   || (fieldtype->parser->flags & EE_PARSER_FLAG_NEEDS_ED)) {
+			DBGPRINTF(ctx, EE_DBG_ERR, "fieldtype '%s': unusable type '%s'", name, type);
+			r = EE_NOTFOUND;
+			goto done;
+		}
+	}
+
+done:
+	if(r != 0 && fieldtype != NULL) {
+		ee_deleteFieldtype(fieldtype);
+		fieldtype = NULL;
+	}
+	return fieldtype;
+}
+
+
+void
+ee_deleteFieldtype(struct ee_fieldtype *fieldtype)
+{
+	assert(fieldtype != NULL);assert(fieldtype->o.objID == ObjID_FIELDTYPE);
+	fieldtype->o.objID = ObjID_DELETED;
+	if(fieldtype->name != NULL)
+		es_deleteStr(fieldtype->name);
+	ee_deinitObj(&fieldtype->o);
+	free(fieldtype);
+}
+
+
+int
+ee_newValueFromFieldtype(struct ee_fieldtype *fieldtype, unsigned char *buf,
+			 es_size_t len, struct ee_value **value)
+{
+	int r;
+	ee_ctx ctx = fieldtype->o.ctx;
+	struct ee_parser *parser = fieldtype->parser;
+	struct ee_probe probe;
+	es_str_t *str = NULL;
+	es_size_t offs;
+
+	assert(fieldtype->o.objID == ObjID_FIELDTYPE);
+	*value = NULL;
+	if(parser == NULL) {
+		CHKN(str = es_newStrFromBuf((char*) buf, len));
+		CHKN(*value = ee_newValue(ctx));
+		STATS_ADD(ctx, bytesCopied, len);
+		CHKR(ee_setStrValue(*value, str));
+		str = NULL;
+	} else if(parser->probe != NULL) {
+		if(len < parser->minLen || parser->probe(ctx, buf, len, NULL, &probe) != len) {
+			r = EE_WRONGPARSER;
+			goto done;
+		}
+		CHKR(ee_newValueFromProbe(ctx, buf, &probe, value));
+	} else {
+		CHKN(str = es_newStrFromBuf((char*) buf, len));
+		offs = 0;
+		CHKR(parser->parse(ctx, str, &offs, NULL, value));
+		if(offs != len) {
+			r = EE_WRONGPARSER;
+			goto done;
+		}
+	}
+	r = 0;
+
+done:
+	if(str != NULL)
+		es_deleteStr(str);
+	if(r != 0 && *value != NULL) {
+		ee_deleteValue(*value);
+		*value = NULL;
+	}
+	return r;
+}
+/* vim :ts=4:sw=4 */
@@ -0,0 +1,449 @@
+/**
+ * @file filter.c
+ * Implements event filters (compilation and evaluation).
+ *//*
+ * Libee - An Event Expression Library inspired by CEE
+ * Copyright 2012 by Rainer Gerhards and Adiscon GmbH.
+ *
+ * This file is part of libee.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * A copy of the LGPL v2.1 can be found in the file "COPYING" in this distribution.
+ */
+#include "config.h"
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include "libee/libee.h"
+#include "libee/filter.h"
+#include "libee/internal.h"
+
+#define ISSPACE(c) ((c) == ' ' || (c) == '\t')
+/* characters that end a field name */
+#define ISNAMEEND(c) (ISSPACE(c) || (c) == '=' || (c) == '!' || (c) == '^' \
+		      || (c) == '<' || (c) == '>' || (c) == '\0')
+
+
+/* Obtain a value, *pp is at its start. Set members end at one of the
+ * characters in setEnd (and whitespace), others at whitespace only.
+ */
+static int
+getVal(char **pp, char *setEnd, es_str_t **val)
+{
+	int r;
+	char *p = *pp;
+	char *start;
+
+	CHKN(*val = es_newStr(16));
+	if(*p == '"') {
+		for(++p ; *p != '"' ; ++p) {
+			if(*p == '\\' && p[1] != '\0')
+				++p;
+			if(*p == '\0') {
+				r = EE_INVLDFMT;
+				goto done;
+			}
+			CHKR(es_addChar(val, *p));
+		}
+		++p;
+	} else {
+		for(start = p ; *p != '\0' && !ISSPACE(*p) ; ++p)
+			if(setEnd != NULL && strchr(setEnd, *p) != NULL)
+				break;
+		CHKR(es_addBuf(val, start, p - start));
+	}
+	*pp = p;
+	r = 0;
+
+done:
+	if(r != 0 && *val != NULL) {
+		es_deleteStr(*val);
+		*val = NULL;
+	}
+	return r;
+}
+
+
+/* Count the values of a set, p is behind its '{'. Values are skipped
+ * the way getVal() reads them, so that quoted ones may contain ',' and
+ * '}'. Returns 0 if the set is empty or not terminated by '}'.
+ */
+static int
+countSetVals(char *p)
+{
+	int n = 0;
+
+	if(*p == '}')
+		return 0;
+	while(1) {
+		++n;
+		if(*p == '"') {
+			for(++p ; *p != '"' ; ++p) {
+				if(*p == '\\' && p[1] != '\0')
+					++p;
+				if(*p == '\0')
+					return 0;
+			}
+			++p;
+		}
+		for( ; *p != ',' && *p != '}' ; ++p)
+			if(*p == '\0')
+				return 0;
+		if(*p == '}')
+			return n;
+		++p;
+	}
+}
+
+
+/* convert a string to a number; returns 0 if it is not a number */
+static int
+getNumber(unsigned char *buf, es_size_t len, double *number)
+{
+	char numBuf[64];
+	char *end;
+
+	if(len == 0 || len >= sizeof(numBuf))
+		return 0;
+	memcpy(numBuf, buf, len);
+	numBuf[len] = '\0';
+	*number = ee_strtod(numBuf, &end);
+	return *end == '\0';
+}
+
+
+/* compile a single term, *pp is at its start */
+static int
+compileTerm(struct ee_filterTerm *term, char **pp)
+{
+	int r;
+	char *p = *pp;
+	char *start;
+	es_str_t *val;
+	int n;
+
+	if(*p == '#' || (p[0] == '!' && p[1] == '#')) {
+		term->op = (*p == '#') ? ee_fop_TAG : ee_fop_NOTAG;
+		p += (*p == '#') ? 1 : 2;
+		CHKR(getVal(&p, NULL, &term->name));
+		if(es_strlen(term->name) == 0) {
+			r = EE_INVLDFMT;
+			goto done;
+		}
+		goto finalize;
+	}
+
+	for(start = p ; !ISNAMEEND(*p) ; ++p)
+		/*JUST SKIP*/;
+	if(p == start) {
+		r = EE_INVLDFMT;
+		goto done;
+	}
+	CHKN(term->name = es_newStrFromCStr(start, p - start));
+	term->nameHash = ee_hashName((unsigned char*) start, p - start);
+
+	if(p[0] == '=' && p[1] == '{') {
+		term->op = ee_fop_IN;
+		p += 2;
+	} else if(p[0] == '=') {
+		term->op = ee_fop_EQ;
+		p += 1;
+	} else if(p[0] == '!' && p[1] == '=') {
+		term->op = ee_fop_NE;
+		p += 2;
+	} else if(p[0] == '^' && p[1] == '=') {
+		term->op = ee_fop_PREFIX;
+		p += 2;
+	} else if(p[0] == '<' || p[0] == '>') {
+		if(p[1] == '=')
+			term->op = (p[0] == '<') ? ee_fop_LE : ee_fop_GE;
+		else
+			term->op = (p[0] == '<') ? ee_fop_LT : ee_fop_GT;
+		p += (p[1] == '=') ? 2 : 1;
+	} else {
+		r = EE_INVLDFMT;
+		goto done;
+	}
+
+	if(term->op == ee_fop_IN) {
+		if((n = countSetVals(p)) == 0) {
+			r = EE_INVLDFMT;
+			goto done;
+		}
+		CHKN(term->vals = malloc(n * sizeof(es_str_t*)));
+		while(1) {
+			CHKR(getVal(&p, ",}", &val));
+			term->vals[term->nVals++] = val;
+			if(*p == '}')
+				break;
+			if(*p != ',') {
+				r = EE_INVLDFMT;
+				goto done;
+			}
+			++p;
+		}
+		++p;
+	} else {
+		CHKN(term->vals = malloc(sizeof(es_str_t*)));
+		CHKR(getVal(&p, NULL, &term->vals[0]));
+		term->nVals = 1;
+		if(   term->op >= ee_fop_LT && term->op <= ee_fop_GE
+		   && !getNumber(es_getBufAddr(term->vals[0]), es_strlen(term->vals[0]),
+		                 &term->number)) {
+			r = EE_INVLDFMT;
+			goto done;
+		}
+	}
+
+finalize:
+	if(*p != '\0' && !ISSPACE(*p)) {
+		r = EE_INVLDFMT;
+		goto done;
+	}
+	*pp = p;
+	r = 0;
+
+done:
+	return r;
+}
+
+
+struct ee_filter*
+ee_newFilter(char *expr)
+{
+	int r = 0;
+	struct ee_filter *filter;
+	struct ee_filterTerm *term;
+	char *p;
+	unsigned nTerms = 0;
+
+	CHKN(filter = calloc(1, sizeof(struct ee_filter)));
+	filter->objID = ObjID_FILTER;
+	/* upper bound: each term is preceded by whitespace or at start */
+	for(p = expr ; *p ; ++p)
+		if(!ISSPACE(*p) && (p == expr || ISSPACE(p[-1])))
+			++nTerms;
+	if(nTerms > EE_FILTER_MAX_TERMS) {
+		r = EE_INVLDFMT;
+		goto done;
+	}
+	if(nTerms > 0)
+		CHKN(filter->terms = calloc(nTerms, sizeof(struct ee_filterTerm)));
+
+	for(p = expr ; ; ) {
+		while(ISSPACE(*p))
+			++p;
+		if(*p == '\0')
+			break;
+		/* quoted values may contain whitespace, so our estimate may be high,
+		 * but never too low */
+		term = filter->terms + filter->nTerms++;
+		CHKR(compileTerm(term, &p));
+		if(term->op != ee_fop_TAG && term->op != ee_fop_NOTAG) {
+			filter->fieldTerms |= 1ull << (filter->nTerms - 1);
+			filter->hashFilter |= 1ull << (term->nameHash % 64);
+		}
+	}
+
+done:
+	if(r != 0 && filter != NULL) {
+		ee_deleteFilter(filter);
+		filter = NULL;
+	}
+	return filter;
+}
+
+
+void
+ee_deleteFilter(struct ee_filter *filter)
+{
+	unsigned i, j;
+
+	assert(filter != NULL);assert(filter->objID == ObjID_FILTER);
+	filter->objID = ObjID_DELETED;
+	for(i = 0 ; i < filter->nTerms ; ++i) {
+		if(filter->terms[i].name != NULL)
+			es_deleteStr(filter->terms[i].name);
+		for(j = 0 ; j < filter->terms[i].nVals ; ++j)
+			es_deleteStr(filter->terms[i].vals[j]);
+		free(filter->terms[i].vals);
+	}
+	free(filter->terms);
+	free(filter);
+}
+
+
+int
+ee_setFilter(ee_ctx ctx, char *expr)
+{
+	int r = 0;
+	struct ee_filter *filter = NULL;
+
+	if(expr != NULL && (filter = ee_newFilter(expr)) == NULL) {
+		r = EE_INVLDFMT;
+		goto done;
+	}
+	if(ctx->filter != NULL)
+		ee_deleteFilter(ctx->filter);
+	ctx->filter = filter;
+
+done:
+	return r;
+}
+
+
+unsigned long long
+ee_filterTerms(ee_ctx ctx, unsigned char *name, es_size_t len, unsigned hash)
+{
+	struct ee_filter *filter = ctx->filter;
+	unsigned long long terms = 0;
+	unsigned i;
+
+	if(!(filter->hashFilter & (1ull << (hash % 64))))
+		goto done;
+	for(i = 0 ; i < filter->nTerms ; ++i)
+		if(   (filter->fieldTerms & (1ull << i))
+		   && filter->terms[i].nameHash == hash
+		   && es_strlen(filter->terms[i].name) == len
+		   && !memcmp(es_getBufAddr(filter->terms[i].name), name, len))
+			terms |= 1ull << i;
+
+done:
+	return terms;
+}
+
+
+/* check if a term is true for a value */
+static int
+evalTerm(struct ee_filterTerm *term, unsigned char *buf, es_size_t len)
+{
+	unsigned i;
+	double number;
+
+	switch(term->op) {
+	case ee_fop_EQ:
+		return    es_strlen(term->vals[0]) == len
+		       && !memcmp(es_getBufAddr(term->vals[0]), buf, len);
+	case ee_fop_NE:
+		return    es_strlen(term->vals[0]) != len
+		       || memcmp(es_getBufAddr(term->vals[0]), buf, len);
+	case ee_fop_PREFIX:
+		return    es_strlen(term->vals[0]) <= len
+		       && !memcmp(es_getBufAddr(term->vals[0]), buf, es_strlen(term->vals[0]));
+	case ee_fop_IN:
+		for(i = 0 ; i < term->nVals ; ++i)
+			if(   es_strlen(term->vals[i]) == len
+			   && !memcmp(es_getBufAddr(term->vals[i]), buf, len))
+				return 1;
+		return 0;
+	case ee_fop_LT:
+		return getNumber(buf, len, &number) && number < term->number;
+	case ee_fop_LE:
+		return getNumber(buf, len, &number) && number <= term->number;
+	case ee_fop_GT:
+		return getNumber(buf, len, &number) && number > term->number;
+	case ee_fop_GE:
+		return getNumber(buf, len, &number) && number >= term->number;
+	default:
+		return 0;
+	}
+}
+
+
+void
+ee_filterValue(ee_ctx ctx, struct ee_filterState *state, unsigned long long terms,
+	       unsigned char *buf, es_size_t len)
+{
+	unsigned i;
+
+	/* each set bit is a term */
+	for(i = 0 ; terms != 0 ; ++i, terms >>= 1)
+		if((terms & 1) && evalTerm(ctx->filter->terms + i, buf, len))
+			state->matched |= 1ull << i;
+}
+
+
+/* evaluate a value object, non-string values are compared in their
+ * string representation
+ */
+static int
+filterValueObj(ee_ctx ctx, struct ee_filterState *state, unsigned long long terms,
+	       struct ee_value *val)
+{
+	int r = 0;
+	es_str_t *str;
+
+	if(val->valtype == ee_valtype_str) {
+		ee_filterValue(ctx, state, terms, es_getBufAddr(val->val.str),
+			       es_strlen(val->val.str));
+	} else {
+		CHKN(str = es_newStr(16));
+		if(ee_addValueAsStr(val, &str) == 0)
+			ee_filterValue(ctx, state, terms, es_getBufAddr(str), es_strlen(str));
+		es_deleteStr(str);
+	}
+
+done:
+	return r;
+}
+
+
+int
+ee_filterField(ee_ctx ctx, struct ee_filterState *state, unsigned long long terms,
+	       struct ee_field *field)
+{
+	int r;
+	struct ee_valnode *node;
+
+	if(field->val != NULL)
+		CHKR(filterValueObj(ctx, state, terms, field->val));
+	for(node = field->valroot ; node != NULL ; node = node->next)
+		CHKR(filterValueObj(ctx, state, terms, node->val));
+	r = ee_filterFieldDone(state, terms);
+
+done:
+	return r;
+}
+
+
+int
+ee_filterEvent(ee_ctx ctx, struct ee_filterState *state, struct ee_event *event)
+{
+	int r = 0;
+	struct ee_filter *filter = ctx->filter;
+	struct ee_filterTerm *term;
+	unsigned i;
+
+	/* terms for fields that did not occur are false */
+	if(filter->fieldTerms & ~state->seen) {
+		r = EE_FILTERED;
+		goto done;
+	}
+	for(i = 0 ; i < filter->nTerms ; ++i) {
+		term = filter->terms + i;
+		if(term->op != ee_fop_TAG && term->op != ee_fop_NOTAG)
+			continue;
+		if(!ee_EventHasTag(event, term->name) != (term->op == ee_fop_NOTAG)) {
+			r = EE_FILTERED;
+			goto done;
+		}
+	}
+
+done:
+	return r;
+}
+/* vim :ts=4:sw=4 */
@@ -26,21 +26,33 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <stdarg.h>
+#include <string.h>
 #include <assert.h>
 
 #include "libee/libee.h"
 #include "libee/int.h"
+#include "libee/filter.h"
 #include "libee/internal.h"
 
+/* filter data while decoding an event */
+struct intFilter {
+	struct ee_filterState state;
+	unsigned long long terms;	/* terms of the current field */
+	int bRejected;			/* skip the rest of the event */
+};
+
 
 /**
- * Decode a line into type and value. Value is NOT unescaped.
+ * Decode a line into type and value. Value is NOT unescaped. A value
+ * string is only created for value lines, and only if bSkipVal is not
+ * set (otherwise *value is NULL).
  * @memberof ee_int
  * @private
  * @returns 0 on success, something else otherwise.
  */
 static inline int
-decodeLn(es_str_t *ln, char *typ, es_str_t **value)
+decodeLn(ee_ctx __attribute__((unused)) ctx, es_str_t *ln, char *typ, int bSkipVal,
+	 es_str_t **value)
 {
 	int r ;
 
@@ -59,10 +71,16 @@ decodeLn(es_str_t *ln, char *typ, es_str_t **value)
 		r = EE_INVLDFMT;
 		goto done;
 	}
+	*value = NULL;
+	if(*typ != 'v' || bSkipVal) {
+		r = 0;
+		goto done;
+	}
 	if((*value = es_newStrFromSubStr(ln, 2, es_strlen(ln) - 2)) == NULL) {
 		r = EE_NOMEM;
 		goto done;
 	}
+	STATS_ADD(ctx, bytesCopied, es_strlen(ln) - 2);
 	r = 0;
 done:
 	return r;
@@ -91,40 +109,126 @@ done:
 
 
 /**
- * Process a decoded line.
+ * Finish processing the current event (if there is one). If it passes
+ * the filter, it is returned in *complete, otherwise it is discarded
+ * and *complete is NULL.
  * @memberof ee_int
  * @private
  * @returns 0 on success, something else otherwise.
  */
 static inline int
-processLn(ee_ctx ctx, char typ, es_str_t *value, struct ee_event **event,
-		  struct ee_field **field,
-          int (*cbNewEvt)(struct ee_event *event))
+finishEvent(ee_ctx ctx, struct ee_event **event, struct ee_field **field,
+	    struct intFilter *filter, struct ee_event **complete)
+{
+	int r;
+
+	*complete = NULL;
+	if(*event == NULL) {
+		r = 0;
+		goto done;
+	}
+	CHKR(finishField(*event, field));
+	if(   filter != NULL
+	   && (   ee_filterFieldDone(&filter->state, filter->terms) != 0
+	       || ee_filterEvent(ctx, &filter->state, *event) != 0)) {
+		ee_deleteEvent(*event);
+		STATS_INC(ctx, eventsFiltered);
+	} else {
+		*complete = *event;
+	}
+	*event = NULL;
+	r = 0;
+
+done:
+	return r;
+}
+
+
+/**
+ * Discard the current event, because the filter rejected it. All lines
+ * up to the next event are ignored.
+ * @memberof ee_int
+ * @private
+ */
+static inline void
+rejectEvent(ee_ctx __attribute__((unused)) ctx, struct ee_event **event,
+	    struct ee_field **field, int *bSkip, struct intFilter *filter)
+{
+	if(*field != NULL) {
+		ee_deleteField(*field);
+		*field = NULL;
+	}
+	ee_deleteEvent(*event);
+	*event = NULL;
+	*bSkip = 1;
+	filter->bRejected = 1;
+	STATS_INC(ctx, eventsFiltered);
+}
+
+
+/**
+ * Process a decoded line. If the line starts a new event, the previous
+ * one is complete and returned in *complete (otherwise, that is NULL).
+ * If a field is not in the projection set, *bSkip is set and its values
+ * are ignored. filter is NULL if there is no filter. Values of fields
+ * the filter checks are evaluated directly in the line buffer.
+ * @memberof ee_int
+ * @private
+ * @returns 0 on success, something else otherwise.
+ */
+static inline int
+processLn(ee_ctx ctx, char typ, es_str_t *ln, es_str_t *value, struct ee_event **event,
+		  struct ee_field **field, int *bSkip, struct intFilter *filter,
+		  struct ee_event **complete)
 {
 	int r;
 	struct ee_value *val;
+	unsigned char *name;
+	es_size_t lenName;
+	unsigned hash;
 
+	*complete = NULL;
 	switch(typ) {
 	case '#':
 		/* comment - ignore */
 		break;
 	case 'e':
-		if(*event != NULL) {
-			CHKR(finishField(*event, field));
-			CHKR(cbNewEvt(*event));
-		}
+		CHKR(finishEvent(ctx, event, field, filter, complete));
 		CHKN(*event = ee_newEvent(ctx));
+		*bSkip = 0;
+		if(filter != NULL)
+			memset(filter, 0, sizeof(struct intFilter));
 		break;
 	case 'f':
+		if(filter != NULL && filter->bRejected)
+			break;
 		if(*event == NULL) {
 			r = EE_INVLDFMT;
 			goto done;
 		}
+		/* all values of the previous field are known now */
+		if(filter != NULL && ee_filterFieldDone(&filter->state, filter->terms) != 0) {
+			rejectEvent(ctx, event, field, bSkip, filter);
+			break;
+		}
 		CHKR(finishField(*event, field));
-		CHKN(*field = ee_newField(ctx));
-		CHKR(ee_nameField(*field, value));
+		name = es_getBufAddr(ln) + 2;
+		lenName = es_strlen(ln) - 2;
+		hash = ee_hashName(name, lenName);
+		if(!(*bSkip = !ee_isProjected(ctx, name, lenName, hash))) {
+			CHKN(*field = ee_newField(ctx));
+			CHKN((*field)->name = es_newStrFromBuf((char*) name, lenName));
+			(*field)->nameHash = hash;
+		}
+		if(filter != NULL)
+			filter->terms = ee_filterTerms(ctx, name, lenName, hash);
 		break;
 	case 'v':
+		if(filter != NULL && !filter->bRejected && filter->terms != 0)
+			ee_filterValue(ctx, &filter->state, filter->terms,
+				       es_getBufAddr(ln) + 2, es_strlen(ln) - 2);
+		if(*bSkip)
+			break;
 		if(*field == NULL) {
 			r = EE_INVLDFMT;
 			goto done;
@@ -152,20 +256,40 @@ ee_intDec(ee_ctx ctx, int (*cbGetLine)(es_str_t **ln),
 	char typ;
 	es_str_t *value;
 	struct ee_event *event = NULL;
+	struct ee_event *complete;
 	struct ee_field *field = NULL;
+	int bSkip = 0;
+	struct intFilter filterData;
+	struct intFilter *filter = NULL;
 	char errMsgBuf[1024];
 	size_t errlen;
+	STATS_TIMER_DECL
 	
+	if(ctx->filter != NULL) {
+		memset(&filterData, 0, sizeof(filterData));
+		filter = &filterData;
+	}
 	lnNbr = 1;
 	r = cbGetLine(&ln);
 	while(r == 0) {
-		if((r = decodeLn(ln, &typ, &value)) != 0) {
+		TRACE2(decode_start, "int", lnNbr);
+		STATS_TIMER_START;
+		if((r = decodeLn(ctx, ln, &typ, bSkip, &value)) != 0) {
+			STATS_TIMER_STOP(ctx, decodeNs);
+			TRACE3(decode_done, "int", lnNbr, r);
 			errlen = snprintf(errMsgBuf, sizeof(errMsgBuf),
 					  "invalid format in line %d", lnNbr);
 			*errMsg = es_newStrFromCStr(errMsgBuf, errlen);
 			goto done;
 		}
-		if((r = processLn(ctx, typ, value, &event, &field, cbNewEvt)) != 0) {
+		r = processLn(ctx, typ, ln, value, &event, &field, &bSkip, filter, &complete);
+		STATS_TIMER_STOP(ctx, decodeNs);
+		TRACE3(decode_done, "int", lnNbr, r);
+		if(r == 0 && complete != NULL) {
+			STATS_INC(ctx, eventsDecoded);
+			r = cbNewEvt(complete);
+		}
+		if(r != 0) {
 			errlen = snprintf(errMsgBuf, sizeof(errMsgBuf),
 					  "error processing line %d", lnNbr);
 			*errMsg = es_newStrFromCStr(errMsgBuf, errlen);
@@ -178,15 +302,14 @@ ee_intDec(ee_ctx ctx, int (*cbGetLine)(es_str_t **ln),
 	/* when we are done with the file, we need to check if there are
 	 * any objects to submit (usually there are!)
 	 */
-	if(event != NULL) {
-		if(field != NULL) {
-			CHKR(finishField(event, &field));
-		}
-		CHKR(cbNewEvt(event));
+	if(r != EE_EOF)
+		goto done;
+	CHKR(finishEvent(ctx, &event, &field, filter, &complete));
+	if(complete != NULL) {
+		STATS_INC(ctx, eventsDecoded);
+		CHKR(cbNewEvt(complete));
 	}
-
-	if(r == EE_EOF)
-		r = 0;
+	r = 0;
 done:
 	return r;
 }
@@ -38,18 +38,14 @@
  * @returns 0 on success, something else otherwise.
  */
 static inline int
-processLn(ee_ctx ctx, es_str_t *ln,
-	  int (*cbNewEvt)(struct ee_event *event))
+processLn(ee_ctx ctx, es_str_t *ln, struct ee_event **event)
 {
 	int r;
-	struct ee_event *event;
 	char *str;
 
-	str = es_str2cstr(ln, NULL);
-	CHKN(event = ee_newEventFromJSON(ctx, str));
+	CHKN(str = es_str2cstr(ln, NULL));
+	r = ee_decodeJSON(ctx, str, event);
 	free(str);
-	CHKR(cbNewEvt(event));
-	r = 0;
 
 done:	return r;
 }
@@ -63,13 +59,21 @@ ee_jsonDec(ee_ctx ctx, int (*cbGetLine)(es_str_t **ln),
 	int r;
 	int lnNbr;
 	es_str_t *ln = NULL;
+	struct ee_event *event;
 	char errMsgBuf[1024];
 	size_t errlen;
 	
 	lnNbr = 1;
 	r = cbGetLine(&ln);
 	while(r == 0) {
-		if((r = processLn(ctx, ln, cbNewEvt)) != 0) {
+		TRACE2(decode_start, "json", lnNbr);
+		r = processLn(ctx, ln, &event);
+		TRACE3(decode_done, "json", lnNbr, r);
+		if(r == 0)
+			r = cbNewEvt(event);
+		else if(r == EE_FILTERED)
+			r = 0;
+		if(r != 0) {
 			errlen = snprintf(errMsgBuf, sizeof(errMsgBuf),
 					  "error processing line %d", lnNbr);
 			*errMsg = es_newStrFromCStr(errMsgBuf, errlen);
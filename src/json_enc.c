@@ -34,6 +34,7 @@
 #include <stdio.h>
 #include <stdarg.h>
 #include <assert.h>
+#include <math.h>
 
 #include "libee/libee.h"
 #include "libee/internal.h"
@@ -62,8 +63,19 @@ ee_addValue_JSON(struct ee_value *value, es_str_t **str)
 
 	assert(str != NULL); assert(*str != NULL);
 	assert(value != NULL); assert(value->objID == ObjID_VALUE);
-	// TODO: support other types!
-	assert(value->valtype == ee_valtype_str);
+	if(   value->valtype == ee_valtype_nbr
+	   || (value->valtype == ee_valtype_dbl && isfinite(value->val.dbl))) {
+		/* JSON numbers are not quoted */
+		CHKR(ee_addValueAsStr(value, str));
+		goto done;
+	}
+	if(value->valtype != ee_valtype_str) {
+		/* no escaping needed, see ee_addValueAsStr() */
+		CHKR(es_addChar(str, '\"'));
+		CHKR(ee_addValueAsStr(value, str));
+		CHKR(es_addChar(str, '\"'));
+		goto done;
+	}
 	valstr = value->val.str;
 	es_addChar(str, '\"');
 
@@ -120,6 +132,7 @@ ee_addValue_JSON(struct ee_value *value, es_str_t **str)
 	es_addChar(str, '\"');
 	r = 0;
 
+done:
 	return r;
 }
 
@@ -136,7 +149,8 @@ ee_addField_JSON(struct ee_field *field, es_str_t **str)
 if(field->nVals == 0) {
 	r = 1;
 	goto done;
-} else if(field->nVals == 1 && es_strlen(field->val->val.str) == 0) {
+} else if(field->nVals == 1 && field->val->valtype == ee_valtype_str
+	  && es_strlen(field->val->val.str) == 0) {
 	r = 1;
 	goto done;
 }
@@ -201,8 +215,11 @@ ee_fmtEventToJSON(struct ee_event *event, es_str_t **str)
 	int r = -1;
 	struct ee_fieldbucket_listnode *node;
 	int bNeedComma = 0;
+	STATS_TIMER_DECL
 
 	assert(event != NULL);assert(event->objID == ObjID_EVENT);
+	TRACE2(encode_start, "json", event);
+	STATS_TIMER_START;
 	if((*str = es_newStr(256)) == NULL) goto done;
 
 	es_addChar(str, '{');
@@ -230,6 +247,9 @@ ee_fmtEventToJSON(struct ee_event *event, es_str_t **str)
 	es_addChar(str, '}');
 
 done:
+	STATS_TIMER_STOP(event->ctx, encodeNs);
+	STATS_ENCODED(event->ctx, *str);
+	TRACE3(encode_done, "json", event, r);
 	return r;
 }
 /* vim :ts=4:sw=4 */
@@ -22,25 +22,46 @@
  *
  * A copy of the LGPL v2.1 can be found in the file "COPYING" in this distribution.
  */
+#include "config.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include "libestr.h"
 #include "libee/libee.h"
 #include "libee/fieldbucket.h"
+#include "libee/filter.h"
+#include "libee/internal.h"
 #include "cjson/cjson.h"
 
+/* Create a field for a JSON item. If there is a filter, fstate is its
+ * state, otherwise NULL.
+ * @return 1 if the children of item shall be processed, 0 if not,
+ *         EE_FILTERED if the filter rejected the event
+ */
 int
-callback(struct ee_fieldbucket *fields, char *name,int type,cJSON *item)
+callback(struct ee_fieldbucket *fields, struct ee_filterState *fstate, char *name,
+	 int type, cJSON *item)
 {
 	struct ee_field *f;
 	struct ee_value *val;
 	char *valstr = NULL;
 	es_str_t *estr;
+	size_t lenName;
+	unsigned hash;
+	int bProjected;
+	unsigned long long fterms;
+	int r = 1;
 
 //printf("callback: type %d, name %s\n", type, name);
 	if(type == cJSON_Object || type == cJSON_Array)
 		return 1; // TODO: support!
+	lenName = strlen(name);
+	hash = ee_hashName((unsigned char*) name, lenName);
+	bProjected = ee_isProjected(fields->ctx, (unsigned char*) name, lenName, hash);
+	fterms = (fstate == NULL) ? 0
+		 : ee_filterTerms(fields->ctx, (unsigned char*) name, lenName, hash);
+	if(!bProjected && !fterms)
+		return 1;
 
 	if(type == cJSON_String) {
 		valstr = item->valuestring;
@@ -54,28 +75,43 @@ callback(struct ee_fieldbucket *fields, char *name,int type,cJSON *item)
 		valstr = "true";
 	}
 //printf("callback: string value %s\n", valstr);
-	
-	estr = es_newStrFromCStr(valstr, strlen(valstr));
-	val = ee_newValue(fields->ctx);
-	ee_setStrValue(val, estr);
-	f = ee_newFieldFromNV(fields->ctx, name, val);
-	ee_addFieldToBucket(fields, f);
 
+	if(fterms) {
+		ee_filterValue(fields->ctx, fstate, fterms, (unsigned char*) valstr,
+			       strlen(valstr));
+		if(ee_filterFieldDone(fstate, fterms) != 0) {
+			r = EE_FILTERED;
+			goto done;
+		}
+	}
+	if(bProjected) {
+		estr = es_newStrFromCStr(valstr, strlen(valstr));
+		STATS_ADD(fields->ctx, bytesCopied, es_strlen(estr));
+		val = ee_newValue(fields->ctx);
+		ee_setStrValue(val, estr);
+		f = ee_newFieldFromNV(fields->ctx, name, val);
+		ee_addFieldToBucket(fields, f);
+	}
+
+done:
 	if(type == cJSON_Number)
 		free(valstr);
-	return 1;
+	return r;
 }
 
 
-void parse_and_callback(struct ee_fieldbucket *fields, cJSON *item, char *prefix)
+/* @return 0 on success, EE_FILTERED if the filter rejected the event */
+int parse_and_callback(struct ee_fieldbucket *fields, struct ee_filterState *fstate,
+		       cJSON *item, char *prefix)
 {
 	char *name;
 	char *newprefix;
 	int lenprefix;
 	int bNeedFree;
 	int dorecurse;
+	int r = 0;
 //printf("parse_and_callback, item %p, item->string %p, prefix(%d): '%s'\n", item, item->string, strlen(prefix), prefix);
-	while (item)
+	while (item && r == 0)
 	{
 		lenprefix = strlen(prefix);
 		if(lenprefix == 0) {
@@ -87,28 +123,59 @@ void parse_and_callback(struct ee_fieldbucket *fields, cJSON *item, char *prefix
 			sprintf(newprefix,"%s.%s",prefix,name);
 			bNeedFree = 1;
 		}
-		dorecurse = callback(fields, newprefix, item->type, item);
-		if (item->child && dorecurse)
-			parse_and_callback(fields, item->child,newprefix);
+		dorecurse = callback(fields, fstate, newprefix, item->type, item);
+		if(dorecurse == EE_FILTERED)
+			r = EE_FILTERED;
+		else if (item->child && dorecurse)
+			r = parse_and_callback(fields, fstate, item->child,newprefix);
 		item=item->next;
 		if(bNeedFree)
 			free(newprefix);
 	}
+	return r;
 }
 
-struct ee_event*
-ee_newEventFromJSON(ee_ctx ctx, char *str)
+int
+ee_decodeJSON(ee_ctx ctx, char *str, struct ee_event **event)
 {
+	int r;
 	struct cJSON *json;
-	struct ee_event *e = NULL;
+	struct ee_filterState fstate = { 0 };
+	STATS_TIMER_DECL
 
-	json = cJSON_Parse(str);
-	if(json == NULL)
+	STATS_TIMER_START;
+	*event = NULL;
+	if((json = cJSON_Parse(str)) == NULL) {
+		r = EE_INVLDFMT;
 		goto done;
-	e = ee_newEvent(ctx);
-	e->fields = ee_newFieldbucket(ctx);
-	parse_and_callback(e->fields, json, "");
-	cJSON_Delete(json);
+	}
+	CHKN(*event = ee_newEvent(ctx));
+	CHKN((*event)->fields = ee_newFieldbucket(ctx));
+	CHKR(parse_and_callback((*event)->fields, (ctx->filter == NULL) ? NULL : &fstate,
+				json, ""));
+	if(ctx->filter != NULL)
+		CHKR(ee_filterEvent(ctx, &fstate, *event));
+
 done:
+	if(json != NULL)
+		cJSON_Delete(json);
+	if(r != 0 && *event != NULL) {
+		ee_deleteEvent(*event);
+		*event = NULL;
+	}
+	if(r == 0)
+		STATS_INC(ctx, eventsDecoded);
+	else if(r == EE_FILTERED)
+		STATS_INC(ctx, eventsFiltered);
+	STATS_TIMER_STOP(ctx, decodeNs);
+	return r;
+}
+
+struct ee_event*
+ee_newEventFromJSON(ee_ctx ctx, char *str)
+{
+	struct ee_event *e;
+
+	ee_decodeJSON(ctx, str, &e);
 	return e;
 }
@@ -0,0 +1,402 @@
+/**
+ * @file kv_dec.c
+ * Decoder for key=value (logfmt) lines.
+ *//*
+ * Libee - An Event Expression Library inspired by CEE
+ * Copyright 2012 by Rainer Gerhards and Adiscon GmbH.
+ *
+ * This file is part of libee.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * A copy of the LGPL v2.1 can be found in the file "COPYING" in this distribution.
+ */
+#include "config.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "libee/libee.h"
+#include "libee/kv.h"
+#include "libee/filter.h"
+#include "libee/internal.h"
+
+#define INSET(map, c) ((map)[(c) >> 3] & (1 << ((c) & 7)))
+
+/* larger sets are scanned via the table only, as comparing against
+ * each character would not be faster any longer.
+ */
+#define SIMD_MAX_DELIMS 8
+
+
+/* add characters to a delimiter set, duplicates are ignored */
+static int
+addDelims(struct ee_kv_delims *delims, unsigned char *chars, size_t len)
+{
+	int r = 0;
+	size_t i;
+
+	for(i = 0 ; i < len ; ++i) {
+		if(INSET(delims->map, chars[i]))
+			continue;
+		if(delims->nChars == EE_KV_MAX_DELIMS) {
+			r = EE_EINVAL;
+			goto done;
+		}
+		delims->map[chars[i] >> 3] |= 1 << (chars[i] & 7);
+		delims->chars[delims->nChars++] = chars[i];
+	}
+
+done:
+	return r;
+}
+
+
+/* set a delimiter set from a C-string (or keep it if NULL) */
+static int
+setDelims(struct ee_kv_delims *delims, struct ee_kv_delims *current, char *chars)
+{
+	int r;
+
+	if(chars == NULL) {
+		*delims = *current;
+		r = 0;
+		goto done;
+	}
+	memset(delims, 0, sizeof(struct ee_kv_delims));
+	CHKR(addDelims(delims, (unsigned char*) chars, strlen(chars)));
+	if(delims->nChars == 0 || INSET(delims->map, '\\'))
+		r = EE_EINVAL;
+
+done:
+	return r;
+}
+
+
+/* Find the first byte of buf (starting at i) that is in the delimiter
+ * set. This is the hot spot of the decoder.
+ * @return offset of that byte, len if there is none
+ */
+static inline es_size_t
+scanDelims(struct ee_kv_delims *delims, unsigned char *buf, es_size_t i, es_size_t len)
+{
+#ifdef __SSE2__
+	__m128i vec[SIMD_MAX_DELIMS];
+	__m128i x, m;
+	unsigned k, mask;
+
+	if(delims->nChars <= SIMD_MAX_DELIMS && len - i >= 16) {
+		for(k = 0 ; k < delims->nChars ; ++k)
+			vec[k] = _mm_set1_epi8((char) delims->chars[k]);
+		do {
+			x = _mm_loadu_si128((__m128i*) (buf + i));
+			m = _mm_cmpeq_epi8(x, vec[0]);
+			for(k = 1 ; k < delims->nChars ; ++k)
+				m = _mm_or_si128(m, _mm_cmpeq_epi8(x, vec[k]));
+			if((mask = _mm_movemask_epi8(m)) != 0)
+				return i + __builtin_ctz(mask);
+			i += 16;
+		} while(len - i >= 16);
+	}
+#endif
+	while(i < len && !INSET(delims->map, buf[i]))
+		++i;
+	return i;
+}
+
+
+struct ee_kv*
+ee_newKV(ee_ctx ctx)
+{
+	struct ee_kv *kv;
+
+	assert(ctx != NULL);assert(ctx->objID == ObjID_CTX);
+	if((kv = calloc(1, sizeof(struct ee_kv))) == NULL)
+		goto done;
+	kv->objID = ObjID_KV;
+	kv->ctx = ctx;
+	if(ee_setKVSeparators(kv, " \t", "=", "\"") != 0) {
+		ee_deleteKV(kv);
+		kv = NULL;
+	}
+
+done:
+	return kv;
+}
+
+
+void
+ee_deleteKV(struct ee_kv *kv)
+{
+	assert(kv != NULL);assert(kv->objID == ObjID_KV);
+	kv->objID = ObjID_DELETED;
+	free(kv);
+}
+
+
+int
+ee_setKVSeparators(struct ee_kv *kv, char *pairSeps, char *kvSeps, char *quotes)
+{
+	int r;
+	int i;
+	struct ee_kv_delims pair, kvs, quote, keyEnd, quoteEnd;
+
+	assert(kv != NULL);assert(kv->objID == ObjID_KV);
+	CHKR(setDelims(&pair, &kv->pairSeps, pairSeps));
+	CHKR(setDelims(&kvs, &kv->kvSeps, kvSeps));
+	CHKR(setDelims(&quote, &kv->quotes, quotes));
+	for(i = 0 ; i < 32 ; ++i) {
+		if((pair.map[i] & kvs.map[i]) | (pair.map[i] & quote.map[i]) | (kvs.map[i] & quote.map[i])) {
+			r = EE_EINVAL;
+			goto done;
+		}
+	}
+	keyEnd = pair;
+	CHKR(addDelims(&keyEnd, kvs.chars, kvs.nChars));
+	quoteEnd = quote;
+	CHKR(addDelims(&quoteEnd, (unsigned char*) "\\", 1));
+
+	kv->pairSeps = pair;
+	kv->kvSeps = kvs;
+	kv->quotes = quote;
+	kv->keyEnd = keyEnd;
+	kv->quoteEnd = quoteEnd;
+
+done:
+	return r;
+}
+
+
+/* obtain a quoted value, *offs is at the opening quote; if valstr is
+ * NULL, the value is just skipped
+ */
+static int
+getQuotedVal(struct ee_kv *kv, unsigned char *buf, es_size_t len, es_size_t *offs,
+	     es_str_t **valstr)
+{
+	int r;
+	es_size_t i = *offs, j;
+	unsigned char q, c;
+
+	q = buf[i++];
+	while(1) {
+		j = scanDelims(&kv->quoteEnd, buf, i, len);
+		if(j == len) {
+			DBGPRINTF(kv->ctx, EE_DBG_ERR, "kv: unterminated quoted value at "
+				  "offset %u", (unsigned) *offs);
+			r = EE_INVLDFMT; /* unterminated value */
+			goto done;
+		}
+		if(buf[j] == q) {
+			CHKR(ee_addToValStr(valstr, buf + i, j - i));
+			i = j + 1;
+			break;
+		} else if(buf[j] == '\\') {
+			if(j + 1 == len) {
+				r = EE_INVLDFMT;
+				goto done;
+			}
+			CHKR(ee_addToValStr(valstr, buf + i, j - i));
+			c = buf[j+1];
+			if(c == 'n')
+				c = '\n';
+			else if(c == 't')
+				c = '\t';
+			CHKR(ee_addToValStr(valstr, &c, 1));
+			i = j + 2;
+		} else { /* a different quote character, which is just data */
+			CHKR(ee_addToValStr(valstr, buf + i, j + 1 - i));
+			i = j + 1;
+		}
+	}
+	/* anything between the closing quote and the next pair is ignored */
+	*offs = scanDelims(&kv->pairSeps, buf, i, len);
+
+done:
+	return r;
+}
+
+
+/* create a field and add it to the bucket; the value string is handed over */
+static int
+addField(ee_ctx ctx, struct ee_fieldbucket *fields, unsigned char *name, es_size_t lenName,
+	 unsigned hash, es_str_t **valstr)
+{
+	int r;
+	struct ee_field *field;
+	struct ee_value *val;
+
+	CHKN(field = ee_newField(ctx));
+	CHKN(field->name = es_newStrFromBuf((char*) name, lenName));
+	field->nameHash = hash;
+	CHKN(val = ee_newValue(ctx));
+	STATS_ADD(ctx, bytesCopied, es_strlen(*valstr));
+	ee_setStrValue(val, *valstr);
+	*valstr = NULL;
+	if((r = ee_addValueToField(field, val)) != 0) {
+		ee_deleteValue(val);
+		goto done;
+	}
+	CHKR(ee_addFieldToBucket(fields, field));
+	field = NULL;
+
+done:
+	if(field != NULL)
+		ee_deleteField(field);
+	return r;
+}
+
+
+/* decode a line into a new event */
+static int
+decodeLn(struct ee_kv *kv, unsigned char *buf, es_size_t len, struct ee_event **event)
+{
+	int r = 0;
+	es_size_t i = 0, keyStart, lenKey, valEnd;
+	struct ee_fieldbucket *fields;
+	es_str_t *valstr = NULL;
+	unsigned hash;
+	int bProjected;
+	unsigned long long fterms;
+	struct ee_filterState fstate = { 0 };
+	STATS_TIMER_DECL
+
+	STATS_TIMER_START;
+	*event = NULL;
+	CHKN(fields = ee_newFieldbucket(kv->ctx));
+	while(1) {
+		while(i < len && INSET(kv->pairSeps.map, buf[i]))
+			++i;
+		if(i == len)
+			break;
+		keyStart = i;
+		i = scanDelims(&kv->keyEnd, buf, i, len);
+		lenKey = i - keyStart;
+		hash = ee_hashName(buf + keyStart, lenKey);
+		/* a value without key cannot be used */
+		bProjected = lenKey > 0 && ee_isProjected(kv->ctx, buf + keyStart, lenKey, hash);
+		fterms = (lenKey > 0 && kv->ctx->filter != NULL)
+			 ? ee_filterTerms(kv->ctx, buf + keyStart, lenKey, hash) : 0;
+		if(i < len && INSET(kv->kvSeps.map, buf[i])) {
+			++i;
+			if(i < len && INSET(kv->quotes.map, buf[i])) {
+				CHKR(getQuotedVal(kv, buf, len, &i,
+						  (bProjected || fterms) ? &valstr : NULL));
+			} else {
+				valEnd = scanDelims(&kv->pairSeps, buf, i, len);
+				if(bProjected || fterms)
+					CHKN(valstr = es_newStrFromBuf((char*) buf + i, valEnd - i));
+				i = valEnd;
+			}
+		}
+		if(!bProjected && !fterms)
+			continue;
+		if(valstr == NULL) /* bare key */
+			CHKN(valstr = es_newStr(1));
+		if(fterms) {
+			/* the rest of the line is not even looked at if this fails */
+			ee_filterValue(kv->ctx, &fstate, fterms, es_getBufAddr(valstr),
+				       es_strlen(valstr));
+			CHKR(ee_filterFieldDone(&fstate, fterms));
+		}
+		if(!bProjected) {
+			es_deleteStr(valstr);
+			valstr = NULL;
+			continue;
+		}
+		CHKR(addField(kv->ctx, fields, buf + keyStart, lenKey, hash, &valstr));
+	}
+	CHKN(*event = ee_newEvent(kv->ctx));
+	(*event)->fields = fields;
+	fields = NULL;
+	if(kv->ctx->filter != NULL)
+		CHKR(ee_filterEvent(kv->ctx, &fstate, *event));
+
+done:
+	if(valstr != NULL)
+		es_deleteStr(valstr);
+	if(fields != NULL)
+		ee_deleteFieldbucket(fields);
+	if(r != 0 && *event != NULL) {
+		ee_deleteEvent(*event);
+		*event = NULL;
+	}
+	if(r == 0)
+		STATS_INC(kv->ctx, eventsDecoded);
+	else if(r == EE_FILTERED)
+		STATS_INC(kv->ctx, eventsFiltered);
+	STATS_TIMER_STOP(kv->ctx, decodeNs);
+	return r;
+}
+
+
+struct ee_event*
+ee_newEventFromKV(struct ee_kv *kv, es_str_t *str)
+{
+	struct ee_event *event;
+
+	assert(kv != NULL);assert(kv->objID == ObjID_KV);
+	decodeLn(kv, es_getBufAddr(str), es_strlen(str), &event);
+	return event;
+}
+
+
+int
+ee_kvDec(ee_ctx ctx, int (*cbGetLine)(es_str_t **ln),
+	 int (*cbNewEvt)(struct ee_event *event),
+	 es_str_t **errMsg, struct ee_kv *kv)
+{
+	int r;
+	int lnNbr;
+	es_str_t *ln = NULL;
+	struct ee_event *event;
+	char errMsgBuf[1024];
+	size_t errlen;
+
+	assert(kv != NULL);assert(kv->objID == ObjID_KV);
+	if(ctx != kv->ctx) {
+		r = EE_EINVAL;
+		*errMsg = es_newStrFromCStr("decoder belongs to another context", 34);
+		goto done;
+	}
+	lnNbr = 1;
+	while((r = cbGetLine(&ln)) == 0) {
+		TRACE2(decode_start, "kv", lnNbr);
+		r = decodeLn(kv, es_getBufAddr(ln), es_strlen(ln), &event);
+		TRACE3(decode_done, "kv", lnNbr, r);
+		es_deleteStr(ln);
+		if(r == 0)
+			r = cbNewEvt(event);
+		else if(r == EE_FILTERED)
+			r = 0;
+		if(r != 0) {
+			errlen = snprintf(errMsgBuf, sizeof(errMsgBuf),
+					  "error processing line %d", lnNbr);
+			*errMsg = es_newStrFromCStr(errMsgBuf, errlen);
+			goto done;
+		}
+		lnNbr++;
+	}
+
+	if(r == EE_EOF)
+		r = 0;
+done:
+	return r;
+}
+/* vim :ts=4:sw=4 */
@@ -0,0 +1,306 @@
+/**
+ * @file litmatcher.c
+ * Implements the literal matcher (Aho-Corasick automaton).
+ *//*
+ * Libee - An Event Expression Library inspired by CEE
+ * Copyright 2012 by Rainer Gerhards and Adiscon GmbH.
+ *
+ * This file is part of libee.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * A copy of the LGPL v2.1 can be found in the file "COPYING" in this distribution.
+ */
+#include "config.h"
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include "libee/libee.h"
+#include "libee/litmatcher.h"
+#include "libee/internal.h"
+
+/* states with at least this many transitions get a transition table */
+#define MIN_TABLE_EDGES 8
+
+
+/* find the transition of a state while literals are added */
+static inline unsigned
+findEdge(struct ee_litmatcher *matcher, unsigned state, unsigned char c)
+{
+	unsigned e;
+
+	for(e = matcher->states[state].edges ; e != 0 ; e = matcher->edges[e].next)
+		if(matcher->edges[e].c == c)
+			return matcher->edges[e].target;
+	return 0;
+}
+
+
+/* transition of a compiled matcher; 0 if there is none (the root
+ * cannot be the target of a transition)
+ */
+static inline unsigned
+nextState(struct ee_litmatcher *matcher, unsigned state, unsigned char c)
+{
+	if(matcher->states[state].table != NULL)
+		return matcher->states[state].table[c];
+	return findEdge(matcher, state, c);
+}
+
+
+static int
+newState(struct ee_litmatcher *matcher, unsigned *state)
+{
+	int r = 0;
+	struct ee_litmatcherState *states;
+	unsigned size;
+
+	if(matcher->nStates == matcher->sizeStates) {
+		size = matcher->sizeStates * 2;
+		CHKN(states = realloc(matcher->states, size * sizeof(struct ee_litmatcherState)));
+		matcher->states = states;
+		matcher->sizeStates = size;
+	}
+	*state = matcher->nStates++;
+	memset(matcher->states + *state, 0, sizeof(struct ee_litmatcherState));
+	matcher->states[*state].lit = -1;
+
+done:
+	return r;
+}
+
+
+static int
+addEdge(struct ee_litmatcher *matcher, unsigned state, unsigned char c, unsigned target)
+{
+	int r = 0;
+	struct ee_litmatcherEdge *edges;
+	unsigned size;
+	unsigned e;
+
+	if(matcher->nEdges == matcher->sizeEdges) {
+		size = matcher->sizeEdges * 2;
+		CHKN(edges = realloc(matcher->edges, size * sizeof(struct ee_litmatcherEdge)));
+		matcher->edges = edges;
+		matcher->sizeEdges = size;
+	}
+	e = matcher->nEdges++;
+	matcher->edges[e].c = c;
+	matcher->edges[e].target = target;
+	matcher->edges[e].next = matcher->states[state].edges;
+	matcher->states[state].edges = e;
+	matcher->states[state].nEdges++;
+
+done:
+	return r;
+}
+
+
+struct ee_litmatcher*
+ee_newLitmatcher(ee_ctx ctx)
+{
+	int r = 0;
+	struct ee_litmatcher *matcher;
+	unsigned root;
+
+	assert(ctx != NULL);assert(ctx->objID == ObjID_CTX);
+	CHKN(matcher = calloc(1, sizeof(struct ee_litmatcher)));
+	matcher->objID = ObjID_LITMATCHER;
+	matcher->ctx = ctx;
+	CHKN(matcher->states = malloc(16 * sizeof(struct ee_litmatcherState)));
+	matcher->sizeStates = 16;
+	CHKN(matcher->edges = malloc(16 * sizeof(struct ee_litmatcherEdge)));
+	matcher->sizeEdges = 16;
+	matcher->nEdges = 1; /* 0 means "no transition" */
+	CHKR(newState(matcher, &root));
+
+done:
+	if(r != 0 && matcher != NULL) {
+		ee_deleteLitmatcher(matcher);
+		matcher = NULL;
+	}
+	return matcher;
+}
+
+
+static void
+freeTables(struct ee_litmatcher *matcher)
+{
+	unsigned i;
+
+	for(i = 0 ; i < matcher->nStates ; ++i) {
+		free(matcher->states[i].table);
+		matcher->states[i].table = NULL;
+	}
+}
+
+
+void
+ee_deleteLitmatcher(struct ee_litmatcher *matcher)
+{
+	assert(matcher != NULL);assert(matcher->objID == ObjID_LITMATCHER);
+	matcher->objID = ObjID_DELETED;
+	if(matcher->states != NULL)
+		freeTables(matcher);
+	free(matcher->states);
+	free(matcher->edges);
+	free(matcher->found);
+	free(matcher);
+}
+
+
+int
+ee_addLiteralToMatcher(struct ee_litmatcher *matcher, unsigned char *buf,
+		       es_size_t len, unsigned *id)
+{
+	int r = 0;
+	unsigned state = 0;
+	unsigned next;
+	es_size_t i;
+
+	assert(matcher != NULL);assert(matcher->objID == ObjID_LITMATCHER);
+	assert(len > 0);
+	for(i = 0 ; i < len ; ++i) {
+		if((next = findEdge(matcher, state, buf[i])) == 0) {
+			CHKR(newState(matcher, &next));
+			if((r = addEdge(matcher, state, buf[i], next)) != 0) {
+				matcher->nStates--;
+				goto done;
+			}
+			matcher->bCompiled = 0;
+		}
+		state = next;
+	}
+	if(matcher->states[state].lit < 0) {
+		matcher->states[state].lit = matcher->nLits++;
+		matcher->bCompiled = 0;
+	}
+	*id = matcher->states[state].lit;
+
+done:
+	return r;
+}
+
+
+static int
+buildTable(struct ee_litmatcher *matcher, unsigned state)
+{
+	int r = 0;
+	unsigned e;
+	unsigned *table;
+
+	CHKN(table = calloc(256, sizeof(unsigned)));
+	for(e = matcher->states[state].edges ; e != 0 ; e = matcher->edges[e].next)
+		table[matcher->edges[e].c] = matcher->edges[e].target;
+	matcher->states[state].table = table;
+
+done:
+	return r;
+}
+
+
+/* Compute the failure links breadth-first, so that the link of a state
+ * always points to a state that is already done. The output link of a
+ * state is the nearest state on its failure chain that ends a literal.
+ */
+int
+ee_compileLitmatcher(struct ee_litmatcher *matcher)
+{
+	int r = 0;
+	unsigned *queue = NULL;
+	unsigned head, tail;
+	unsigned s, t, f, e;
+	unsigned char c;
+	struct ee_litmatcherState *states;
+
+	assert(matcher != NULL);assert(matcher->objID == ObjID_LITMATCHER);
+	if(matcher->bCompiled)
+		goto done;
+	states = matcher->states;
+
+	freeTables(matcher);
+	for(s = 0 ; s < matcher->nStates ; ++s)
+		if(s == 0 || states[s].nEdges >= MIN_TABLE_EDGES)
+			CHKR(buildTable(matcher, s));
+
+	free(matcher->found);
+	/* at least one entry, so that an empty matcher has a valid array */
+	CHKN(matcher->found = calloc(matcher->nLits + 1, sizeof(unsigned)));
+	matcher->gen = 0;
+
+	CHKN(queue = malloc(matcher->nStates * sizeof(unsigned)));
+	head = tail = 0;
+	for(e = states[0].edges ; e != 0 ; e = matcher->edges[e].next) {
+		t = matcher->edges[e].target;
+		states[t].fail = states[t].out = 0;
+		queue[tail++] = t;
+	}
+	while(head < tail) {
+		s = queue[head++];
+		for(e = states[s].edges ; e != 0 ; e = matcher->edges[e].next) {
+			c = matcher->edges[e].c;
+			t = matcher->edges[e].target;
+			for(f = states[s].fail ; f != 0 && nextState(matcher, f, c) == 0 ; f = states[f].fail)
+				/*JUST SKIP*/;
+			f = nextState(matcher, f, c);
+			states[t].fail = f;
+			states[t].out = (states[f].lit >= 0) ? f : states[f].out;
+			queue[tail++] = t;
+		}
+	}
+	matcher->bCompiled = 1;
+	DBGPRINTF(matcher->ctx, EE_DBG_TRACE, "litmatcher: %u literals, %u states",
+		  matcher->nLits, matcher->nStates);
+
+done:
+	free(queue);
+	return r;
+}
+
+
+void
+ee_scanLiterals(struct ee_litmatcher *matcher, unsigned char *buf, es_size_t len)
+{
+	struct ee_litmatcherState *states = matcher->states;
+	unsigned *found = matcher->found;
+	unsigned gen;
+	unsigned s, t, o;
+	es_size_t i;
+
+	assert(matcher != NULL);assert(matcher->objID == ObjID_LITMATCHER);
+	assert(matcher->bCompiled);
+	if(++matcher->gen == 0) {
+		memset(found, 0, (matcher->nLits + 1) * sizeof(unsigned));
+		matcher->gen = 1;
+	}
+	gen = matcher->gen;
+
+	for(s = 0, i = 0 ; i < len ; ++i) {
+		while((t = nextState(matcher, s, buf[i])) == 0 && s != 0)
+			s = states[s].fail;
+		s = t;
+		/* If a literal was already found, so were all literals on its
+		 * output chain, because the chain was walked back then. So we
+		 * can stop there, which bounds the work per literal.
+		 */
+		for(o = (states[s].lit >= 0) ? s : states[s].out ; o != 0 ; o = states[o].out) {
+			if(found[states[o].lit] == gen)
+				break;
+			found[states[o].lit] = gen;
+		}
+	}
+}
+/* vim :ts=4:sw=4 */
@@ -0,0 +1,1023 @@
+/**
+ * @file normalizer.c
+ * Implements the normalizer (prefix tree of message samples).
+ *//*
+ * Libee - An Event Expression Library inspired by CEE
+ * Copyright 2012 by Rainer Gerhards and Adiscon GmbH.
+ *
+ * This file is part of libee.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * A copy of the LGPL v2.1 can be found in the file "COPYING" in this distribution.
+ */
+#include "config.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+
+#include "libee/libee.h"
+#include "libee/normalizer.h"
+#include "libee/filter.h"
+#include "libee/internal.h"
+
+/* longest parser name we support in field descriptions */
+#define MAX_TYPE_NAME 64
+
+/* Shorter literal text is not used for prefiltering. It is found in
+ * almost every message, so checking it would not pay.
+ */
+#define MIN_PREFILTER_LEN 3
+
+/* marks literal text of a rule that is not used for prefiltering */
+#define NO_LIT ((unsigned) -1)
+
+
+/* a field that matched while walking the tree */
+struct match {
+	struct ee_ptreeField *field;
+	es_size_t offs;		/* start of the text */
+	es_size_t len;		/* length of the text */
+	struct ee_probe probe;	/* probe result, if the parser has a probe */
+	struct ee_value *value;	/* otherwise the value created by the parser */
+};
+
+/* state of a match */
+struct matchState {
+	ee_ctx ctx;
+	es_str_t *str;
+	unsigned char *buf;
+	es_size_t len;
+	struct ee_litmatcher *lits;	/* literals of the rulebase */
+	int bScanned;			/* message was scanned for them */
+	struct ee_ptreeNode *terminal;	/* node of the rule that matched */
+	unsigned nMatches;
+	struct match matches[EE_NORM_MAX_FIELDS];
+};
+
+
+static inline int
+isEmptyNode(struct ee_ptreeNode *node)
+{
+	return    node->lenPrefix == 0 && node->nLits == 0 && node->fields == NULL
+	       && !node->bTerminal;
+}
+
+
+static void
+deleteNode(struct ee_ptreeNode *node)
+{
+	unsigned i;
+	struct ee_ptreeField *field, *del;
+
+	for(i = 0 ; i < node->nLits ; ++i)
+		deleteNode(node->lits[i]);
+	for(field = node->fields ; field != NULL ; ) {
+		del = field;
+		field = field->next;
+		deleteNode(del->child);
+		if(del->name != NULL)
+			es_deleteStr(del->name);
+		if(del->ed != NULL)
+			es_deleteStr(del->ed);
+		free(del);
+	}
+	if(node->tags != NULL)
+		ee_deleteTagbucket(node->tags);
+	free(node->ruleLits);
+	free(node->req);
+	free(node->prefix);
+	free(node->litChars);
+	free(node->lits);
+	free(node);
+}
+
+
+static inline struct ee_ptreeNode*
+findLit(struct ee_ptreeNode *node, unsigned char c)
+{
+	unsigned char *p;
+
+	if(node->nLits == 0 || (p = memchr(node->litChars, c, node->nLits)) == NULL)
+		return NULL;
+	return node->lits[p - node->litChars];
+}
+
+
+static int
+addLit(struct ee_ptreeNode *node, unsigned char c, struct ee_ptreeNode *child)
+{
+	int r = 0;
+	unsigned char *litChars;
+	struct ee_ptreeNode **lits;
+
+	CHKN(litChars = realloc(node->litChars, node->nLits + 1));
+	node->litChars = litChars;
+	CHKN(lits = realloc(node->lits, (node->nLits + 1) * sizeof(struct ee_ptreeNode*)));
+	node->lits = lits;
+	node->litChars[node->nLits] = c;
+	node->lits[node->nLits] = child;
+	node->nLits++;
+
+done:
+	return r;
+}
+
+
+/* Split a node after the first n characters of its prefix. The node
+ * keeps these, everything else moves to a new literal child.
+ */
+static int
+splitNode(struct ee_ptreeNode *node, es_size_t n)
+{
+	int r = 0;
+	struct ee_ptreeNode *tail;
+	es_size_t lenTail = node->lenPrefix - n - 1;
+	unsigned char *litChars = NULL;
+	struct ee_ptreeNode **lits = NULL;
+
+	/* allocate everything first, so that the tree stays intact on error */
+	if(   (tail = calloc(1, sizeof(struct ee_ptreeNode))) == NULL
+	   || (litChars = malloc(1)) == NULL
+	   || (lits = malloc(sizeof(struct ee_ptreeNode*))) == NULL
+	   || (lenTail > 0 && (tail->prefix = malloc(lenTail)) == NULL)) {
+		free(tail);
+		free(litChars);
+		free(lits);
+		r = EE_NOMEM;
+		goto done;
+	}
+	if(lenTail > 0)
+		memcpy(tail->prefix, node->prefix + n + 1, lenTail);
+	tail->lenPrefix = lenTail;
+	tail->nLits = node->nLits;
+	tail->litChars = node->litChars;
+	tail->lits = node->lits;
+	tail->fields = node->fields;
+	tail->bTerminal = node->bTerminal;
+	tail->tags = node->tags;
+	tail->nRuleLits = node->nRuleLits;
+	tail->ruleLits = node->ruleLits;
+
+	litChars[0] = node->prefix[n];
+	lits[0] = tail;
+	node->lenPrefix = n;
+	node->nLits = 1;
+	node->litChars = litChars;
+	node->lits = lits;
+	node->fields = NULL;
+	node->bTerminal = 0;
+	node->tags = NULL;
+	node->nRuleLits = 0;
+	node->ruleLits = NULL;
+
+done:
+	return r;
+}
+
+
+/* add literal text below a node; *end is the node where it ends */
+static int
+addLiteral(struct ee_ptreeNode *node, unsigned char *buf, es_size_t len,
+	   struct ee_ptreeNode **end)
+{
+	int r = 0;
+	es_size_t i;
+	struct ee_ptreeNode *child;
+
+	while(1) {
+		/* a new node just takes the text */
+		if(len > 0 && isEmptyNode(node)) {
+			CHKN(node->prefix = malloc(len));
+			memcpy(node->prefix, buf, len);
+			node->lenPrefix = len;
+			break;
+		}
+		for(i = 0 ; i < node->lenPrefix && i < len && node->prefix[i] == buf[i] ; ++i)
+			/*JUST SKIP*/;
+		if(i < node->lenPrefix)
+			CHKR(splitNode(node, i));
+		buf += i;
+		len -= i;
+		if(len == 0)
+			break;
+		if((child = findLit(node, buf[0])) == NULL) {
+			CHKN(child = calloc(1, sizeof(struct ee_ptreeNode)));
+			if((r = addLit(node, buf[0], child)) != 0) {
+				free(child);
+				goto done;
+			}
+		}
+		node = child;
+		++buf;
+		--len;
+	}
+	*end = node;
+
+done:
+	return r;
+}
+
+
+static inline int
+sameStr(es_str_t *s1, es_str_t *s2)
+{
+	if(s1 == NULL || s2 == NULL)
+		return s1 == s2;
+	return !es_strcmp(s1, s2);
+}
+
+
+/* Add a field edge below a node (or find an identical one); *end is
+ * the node after it. Catch-all parsers are tried after all others.
+ */
+static int
+addField(struct ee_ptreeNode *node, es_str_t *name, struct ee_parser *parser,
+	 es_str_t *ed, struct ee_ptreeNode **end)
+{
+	int r = 0;
+	struct ee_ptreeField *field, **link;
+
+	for(field = node->fields ; field != NULL ; field = field->next) {
+		if(field->parser == parser && sameStr(field->name, name) && sameStr(field->ed, ed)) {
+			*end = field->child;
+			goto done;
+		}
+	}
+
+	CHKN(field = calloc(1, sizeof(struct ee_ptreeField)));
+	if(   (field->child = calloc(1, sizeof(struct ee_ptreeNode))) == NULL
+	   || (name != NULL && (field->name = es_strdup(name)) == NULL)
+	   || (ed != NULL && (field->ed = es_strdup(ed)) == NULL)) {
+		if(field->child != NULL)
+			deleteNode(field->child);
+		if(field->name != NULL)
+			es_deleteStr(field->name);
+		free(field);
+		r = EE_NOMEM;
+		goto done;
+	}
+	if(name != NULL)
+		field->nameHash = ee_hashName(es_getBufAddr(name), es_strlen(name));
+	field->parser = parser;
+	for(link = &node->fields ; *link != NULL ; link = &(*link)->next)
+		if(   !(parser->flags & EE_PARSER_FLAG_CATCHALL)
+		   && ((*link)->parser->flags & EE_PARSER_FLAG_CATCHALL))
+			break;
+	field->next = *link;
+	*link = field;
+	*end = field->child;
+
+done:
+	return r;
+}
+
+
+/* Parse a field description, *pp is at the opening percent sign and
+ * is updated to point after the closing one.
+ */
+static int
+parseFieldDesc(struct ee_normalizer *norm, char **pp, es_str_t **name,
+	       struct ee_parser **parser, es_str_t **ed)
+{
+	int r;
+	char *p = *pp + 1;
+	char *start;
+	char typeName[MAX_TYPE_NAME];
+
+	*name = *ed = NULL;
+	for(start = p ; *p != '\0' && *p != ':' && *p != '%' ; ++p)
+		/*JUST SKIP*/;
+	if(*p != ':' || p == start) {
+		r = EE_INVLDFMT;
+		goto done;
+	}
+	if(p - start != 1 || *start != '-')
+		CHKN(*name = es_newStrFromCStr(start, p - start));
+
+	for(start = ++p ; *p != '\0' && *p != ':' && *p != '%' ; ++p)
+		/*JUST SKIP*/;
+	if(*p == '\0' || p == start || p - start >= MAX_TYPE_NAME) {
+		r = EE_INVLDFMT;
+		goto done;
+	}
+	memcpy(typeName, start, p - start);
+	typeName[p - start] = '\0';
+	if(*p == ':') {
+		for(start = ++p ; *p != '\0' && *p != '%' ; ++p)
+			/*JUST SKIP*/;
+		if(*p == '\0') {
+			r = EE_INVLDFMT;
+			goto done;
+		}
+		CHKN(*ed = es_newStrFromCStr(start, p - start));
+	}
+	++p;
+
+	if((*parser = ee_findParser(norm->ctx, typeName)) == NULL) {
+		DBGPRINTF(norm->ctx, EE_DBG_ERR, "normalizer: unknown parser '%s'", typeName);
+		r = EE_NOTFOUND;
+		goto done;
+	}
+	if((*parser)->flags & EE_PARSER_FLAG_NEEDS_ED) {
+		/* char-to needs exactly one terminator */
+		if(   *ed == NULL || es_strlen(*ed) == 0
+		   || (!strcmp(typeName, "char-to") && es_strlen(*ed) != 1)) {
+			r = EE_INVLDFMT;
+			goto done;
+		}
+	}
+	*pp = p;
+	r = 0;
+
+done:
+	if(r != 0) {
+		if(*name != NULL)
+			es_deleteStr(*name);
+		if(*ed != NULL)
+			es_deleteStr(*ed);
+		*name = *ed = NULL;
+	}
+	return r;
+}
+
+
+static int
+newTagbucketFromList(ee_ctx ctx, char *list, struct ee_tagbucket **tags)
+{
+	int r = 0;
+	char *p, *start;
+	es_str_t *tag;
+
+	*tags = NULL;
+	for(p = list ; *p != '\0' ; ) {
+		for(start = p ; *p != '\0' && *p != ',' ; ++p)
+			/*JUST SKIP*/;
+		if(p > start) {
+			if(*tags == NULL)
+				CHKN(*tags = ee_newTagbucket(ctx));
+			CHKN(tag = es_newStrFromCStr(start, p - start));
+			if((r = ee_addTagToBucket(*tags, tag)) != 0) {
+				es_deleteStr(tag);
+				goto done;
+			}
+		}
+		if(*p == ',')
+			++p;
+	}
+
+done:
+	if(r != 0 && *tags != NULL) {
+		ee_deleteTagbucket(*tags);
+		*tags = NULL;
+	}
+	return r;
+}
+
+
+struct ee_normalizer*
+ee_newNormalizer(ee_ctx ctx)
+{
+	struct ee_normalizer *norm;
+
+	assert(ctx != NULL);assert(ctx->objID == ObjID_CTX);
+	if((norm = calloc(1, sizeof(struct ee_normalizer))) == NULL)
+		goto done;
+	norm->objID = ObjID_NORMALIZER;
+	norm->ctx = ctx;
+	if(   (norm->root = calloc(1, sizeof(struct ee_ptreeNode))) == NULL
+	   || (norm->lits = ee_newLitmatcher(ctx)) == NULL) {
+		if(norm->root != NULL)
+			deleteNode(norm->root);
+		free(norm);
+		norm = NULL;
+	}
+
+done:
+	return norm;
+}
+
+
+void
+ee_deleteNormalizer(struct ee_normalizer *norm)
+{
+	assert(norm != NULL);assert(norm->objID == ObjID_NORMALIZER);
+	norm->objID = ObjID_DELETED;
+	deleteNode(norm->root);
+	ee_deleteLitmatcher(norm->lits);
+	free(norm);
+}
+
+
+/* Add literal text of a rule to the literal matcher, unless it is too
+ * short. The literals of a rule are kept by position (text before the
+ * first field, between the first and second field, ...).
+ */
+static int
+addRuleLit(struct ee_normalizer *norm, es_str_t *lit, unsigned *ruleLits,
+	   unsigned *nRuleLits)
+{
+	int r = 0;
+	unsigned id = NO_LIT;
+
+	if(es_strlen(lit) >= MIN_PREFILTER_LEN)
+		CHKR(ee_addLiteralToMatcher(norm->lits, es_getBufAddr(lit), es_strlen(lit), &id));
+	ruleLits[(*nRuleLits)++] = id;
+
+done:
+	return r;
+}
+
+
+int
+ee_addRule(struct ee_normalizer *norm, char *sample, char *tags)
+{
+	int r;
+	char *p = sample;
+	struct ee_ptreeNode *node = norm->root;
+	struct ee_parser *parser;
+	es_str_t *lit = NULL, *name = NULL, *ed = NULL;
+	struct ee_tagbucket *tagbucket = NULL;
+	unsigned nFields = 0;
+	unsigned ruleLits[EE_NORM_MAX_FIELDS + 1];
+	unsigned nRuleLits = 0;
+	unsigned *ruleLitsCopy = NULL;
+
+	assert(norm != NULL);assert(norm->objID == ObjID_NORMALIZER);
+	/* the tree changes even if the rule turns out to be invalid */
+	norm->bPrefilterOK = 0;
+	if(tags != NULL)
+		CHKR(newTagbucketFromList(norm->ctx, tags, &tagbucket));
+	CHKN(lit = es_newStr(64));
+	while(*p != '\0') {
+		if(*p != '%') {
+			CHKR(es_addChar(&lit, *p++));
+			continue;
+		}
+		if(p[1] == '%') {
+			CHKR(es_addChar(&lit, '%'));
+			p += 2;
+			continue;
+		}
+		if(++nFields > EE_NORM_MAX_FIELDS) {
+			r = EE_INVLDFMT;
+			goto done;
+		}
+		CHKR(parseFieldDesc(norm, &p, &name, &parser, &ed));
+		CHKR(addRuleLit(norm, lit, ruleLits, &nRuleLits));
+		CHKR(addLiteral(node, es_getBufAddr(lit), es_strlen(lit), &node));
+		es_emptyStr(lit);
+		CHKR(addField(node, name, parser, ed, &node));
+		if(name != NULL) {
+			es_deleteStr(name);
+			name = NULL;
+		}
+		if(ed != NULL) {
+			es_deleteStr(ed);
+			ed = NULL;
+		}
+	}
+	CHKR(addRuleLit(norm, lit, ruleLits, &nRuleLits));
+	CHKR(addLiteral(node, es_getBufAddr(lit), es_strlen(lit), &node));
+	CHKN(ruleLitsCopy = malloc(nRuleLits * sizeof(unsigned)));
+	memcpy(ruleLitsCopy, ruleLits, nRuleLits * sizeof(unsigned));
+
+	if(node->bTerminal) {
+		DBGPRINTF(norm->ctx, EE_DBG_INFO, "normalizer: duplicate rule '%s'", sample);
+		if(node->tags != NULL)
+			ee_deleteTagbucket(node->tags);
+	} else {
+		node->bTerminal = 1;
+		norm->nRules++;
+	}
+	node->tags = tagbucket;
+	tagbucket = NULL;
+	free(node->ruleLits);
+	node->ruleLits = ruleLitsCopy;
+	node->nRuleLits = nRuleLits;
+	ruleLitsCopy = NULL;
+
+done:
+	if(r != 0)
+		DBGPRINTF(norm->ctx, EE_DBG_ERR, "normalizer: invalid rule '%s', error %d",
+			  sample, r);
+	if(lit != NULL)
+		es_deleteStr(lit);
+	if(name != NULL)
+		es_deleteStr(name);
+	if(ed != NULL)
+		es_deleteStr(ed);
+	if(tagbucket != NULL)
+		ee_deleteTagbucket(tagbucket);
+	free(ruleLitsCopy);
+	return r;
+}
+
+
+int
+ee_loadRulebase(struct ee_normalizer *norm, char *fileName)
+{
+	int r = 0;
+	FILE *fp;
+	char *ln = NULL;
+	char *sample;
+	size_t lenBuf = 0;
+	ssize_t len;
+	int lnNbr = 0;
+
+	assert(norm != NULL);assert(norm->objID == ObjID_NORMALIZER);
+	if((fp = fopen(fileName, "r")) == NULL) {
+		r = EE_NOTFOUND;
+		goto done;
+	}
+	while((len = getline(&ln, &lenBuf, fp)) != -1) {
+		++lnNbr;
+		while(len > 0 && (ln[len-1] == '\n' || ln[len-1] == '\r'))
+			ln[--len] = '\0';
+		if(len == 0 || ln[0] == '#')
+			continue;
+		if(strncmp(ln, "rule=", 5) || (sample = strchr(ln + 5, ':')) == NULL) {
+			DBGPRINTF(norm->ctx, EE_DBG_ERR, "normalizer: %s, line %d: invalid "
+				  "rule", fileName, lnNbr);
+			r = EE_INVLDFMT;
+			goto done;
+		}
+		*sample++ = '\0';
+		CHKR(ee_addRule(norm, sample, ln + 5));
+	}
+
+done:
+	free(ln);
+	if(fp != NULL)
+		fclose(fp);
+	return r;
+}
+
+
+/* add a literal to a sorted set, unless it is already part of it */
+static inline void
+addToSet(unsigned *set, unsigned *n, unsigned id)
+{
+	unsigned i, j;
+
+	for(i = 0 ; i < *n && set[i] < id ; ++i)
+		/*JUST SKIP*/;
+	if(i < *n && set[i] == id)
+		return;
+	for(j = *n ; j > i ; --j)
+		set[j] = set[j-1];
+	set[i] = id;
+	(*n)++;
+}
+
+
+/* Merge the literals below a child into the set of its parent. The
+ * parent needs those literals all rules below it contain, so this is
+ * an intersection, except for the first child, whose set is copied.
+ * extra is an additional literal of the child (or NO_LIT).
+ */
+static int
+mergeSet(unsigned **set, unsigned *n, int bFirst, unsigned *childSet,
+	 unsigned nChild, unsigned extra)
+{
+	int r = 0;
+	unsigned i, j, k;
+
+	if(bFirst) {
+		CHKN(*set = malloc((nChild + 1) * sizeof(unsigned)));
+		if(nChild > 0)
+			memcpy(*set, childSet, nChild * sizeof(unsigned));
+		*n = nChild;
+		if(extra != NO_LIT)
+			addToSet(*set, n, extra);
+		goto done;
+	}
+	for(i = j = k = 0 ; i < *n ; ++i) {
+		while(j < nChild && childSet[j] < (*set)[i])
+			++j;
+		if((j < nChild && childSet[j] == (*set)[i]) || (*set)[i] == extra)
+			(*set)[k++] = (*set)[i];
+	}
+	*n = k;
+
+done:
+	return r;
+}
+
+
+/* Compute the literals that all rules below a node contain after depth
+ * fields, that is the ones which are not yet matched when the node is
+ * reached. *terminal is some node below where a rule ends (NULL if there
+ * is none). The set of each node after a field is stored in node->req,
+ * these are the nodes that are checked.
+ */
+static int
+collectReq(struct ee_ptreeNode *node, unsigned depth, unsigned **set, unsigned *n,
+	   struct ee_ptreeNode **terminal)
+{
+	int r = 0;
+	unsigned i;
+	unsigned *childSet = NULL;
+	unsigned nChild;
+	struct ee_ptreeNode *childTerminal;
+	struct ee_ptreeField *field;
+
+	*set = NULL;
+	*n = 0;
+	*terminal = NULL;
+	if(node->bTerminal) {
+		CHKN(*set = malloc(node->nRuleLits * sizeof(unsigned)));
+		for(i = depth ; i < node->nRuleLits ; ++i)
+			if(node->ruleLits[i] != NO_LIT)
+				addToSet(*set, n, node->ruleLits[i]);
+		*terminal = node;
+	}
+	for(i = 0 ; i < node->nLits ; ++i) {
+		CHKR(collectReq(node->lits[i], depth, &childSet, &nChild, &childTerminal));
+		if(childTerminal != NULL) {
+			CHKR(mergeSet(set, n, *terminal == NULL, childSet, nChild, NO_LIT));
+			*terminal = childTerminal;
+		}
+		free(childSet);
+		childSet = NULL;
+	}
+	for(field = node->fields ; field != NULL ; field = field->next) {
+		CHKR(collectReq(field->child, depth + 1, &childSet, &nChild, &childTerminal));
+		free(field->child->req);
+		field->child->req = childSet;
+		field->child->nReq = nChild;
+		childSet = NULL;
+		/* the text before the field is not yet matched at this node */
+		if(childTerminal != NULL) {
+			CHKR(mergeSet(set, n, *terminal == NULL, field->child->req,
+				      field->child->nReq, childTerminal->ruleLits[depth]));
+			*terminal = childTerminal;
+		}
+	}
+
+done:
+	free(childSet);
+	if(r != 0) {
+		free(*set);
+		*set = NULL;
+	}
+	return r;
+}
+
+
+static void diffReqBelow(struct ee_ptreeNode *node, unsigned *checked, unsigned nChecked);
+
+/* Remove the literals that were already checked at a node above from a
+ * node after a field. Nodes below are done first, as they need the full
+ * set of the node.
+ */
+static void
+diffReq(struct ee_ptreeNode *node, unsigned *checked, unsigned nChecked)
+{
+	unsigned i, j, k;
+
+	diffReqBelow(node, node->req, node->nReq);
+	for(i = j = k = 0 ; i < node->nReq ; ++i) {
+		while(j < nChecked && checked[j] < node->req[i])
+			++j;
+		if(j == nChecked || checked[j] != node->req[i])
+			node->req[k++] = node->req[i];
+	}
+	node->nReq = k;
+	if(k == 0) {
+		free(node->req);
+		node->req = NULL;
+	}
+}
+
+
+static void
+diffReqBelow(struct ee_ptreeNode *node, unsigned *checked, unsigned nChecked)
+{
+	unsigned i;
+	struct ee_ptreeField *field;
+
+	for(i = 0 ; i < node->nLits ; ++i)
+		diffReqBelow(node->lits[i], checked, nChecked);
+	for(field = node->fields ; field != NULL ; field = field->next)
+		diffReq(field->child, checked, nChecked);
+}
+
+
+static int
+buildPrefilter(struct ee_normalizer *norm)
+{
+	int r;
+	unsigned *set;
+	unsigned n;
+	struct ee_ptreeNode *terminal;
+
+	CHKR(ee_compileLitmatcher(norm->lits));
+	CHKR(collectReq(norm->root, 0, &set, &n, &terminal));
+	free(set);
+	diffReqBelow(norm->root, NULL, 0);
+	norm->bPrefilterOK = 1;
+
+done:
+	return r;
+}
+
+
+/* check if the message contains all literals required by a node; the
+ * message is only scanned when this is needed for the first time
+ */
+static inline int
+hasRequired(struct matchState *st, struct ee_ptreeNode *node)
+{
+	unsigned i;
+
+	if(!st->bScanned) {
+		ee_scanLiterals(st->lits, st->buf, st->len);
+		st->bScanned = 1;
+	}
+	for(i = 0 ; i < node->nReq ; ++i)
+		if(!ee_literalFound(st->lits, node->req[i]))
+			return 0;
+	return 1;
+}
+
+
+/* try a field at offs; returns the match length or 0 */
+static inline es_size_t
+tryField(struct matchState *st, struct ee_ptreeField *field, es_size_t offs,
+	 struct match *m)
+{
+	es_size_t offsParser;
+
+	m->value = NULL;
+	if(field->parser->probe != NULL) {
+		m->len = field->parser->probe(st->ctx, st->buf + offs, st->len - offs,
+					      field->ed, &m->probe);
+		return m->len;
+	}
+	offsParser = offs;
+	if(field->parser->parse(st->ctx, st->str, &offsParser, field->ed, &m->value) != 0) {
+		m->value = NULL;
+		return 0;
+	}
+	if(offsParser == offs) {
+		ee_deleteValue(m->value);
+		m->value = NULL;
+		return 0;
+	}
+	m->len = offsParser - offs;
+	return m->len;
+}
+
+
+/* Walk the tree. Returns 1 if a rule matched (st->terminal is its node),
+ * 0 otherwise. depth is the number of fields matched so far.
+ */
+static int
+matchNode(struct matchState *st, struct ee_ptreeNode *node, es_size_t offs, unsigned depth)
+{
+	struct ee_ptreeNode *child;
+	struct ee_ptreeField *field;
+	struct match *m;
+	es_size_t n;
+
+	if(   node->lenPrefix > 0
+	   && (   node->lenPrefix > st->len - offs
+	       || memcmp(node->prefix, st->buf + offs, node->lenPrefix)))
+		return 0;
+	offs += node->lenPrefix;
+	if(offs == st->len) {
+		if(!node->bTerminal)
+			return 0;
+		st->terminal = node;
+		st->nMatches = depth;
+		return 1;
+	}
+
+	/* literal text is more specific than any field, so it comes first */
+	if((child = findLit(node, st->buf[offs])) != NULL && matchNode(st, child, offs + 1, depth))
+		return 1;
+	m = st->matches + depth;
+	for(field = node->fields ; field != NULL ; field = field->next) {
+		if(   st->len - offs < field->parser->minLen
+		   || !ee_parserAcceptsByte(field->parser, st->buf[offs]))
+			continue;
+		if(field->child->nReq > 0 && !hasRequired(st, field->child))
+			continue;
+		if((n = tryField(st, field, offs, m)) == 0)
+			continue;
+		m->field = field;
+		m->offs = offs;
+		if(matchNode(st, field->child, offs + n, depth + 1))
+			return 1;
+		if(m->value != NULL) {
+			ee_deleteValue(m->value);
+			m->value = NULL;
+		}
+	}
+	return 0;
+}
+
+
+/* check the fields of the rule that matched against the filter, before
+ * any value is created
+ */
+static int
+filterMatches(struct matchState *st, struct ee_filterState *fstate)
+{
+	int r = 0;
+	unsigned i;
+	struct match *m;
+	struct ee_ptreeField *field;
+	unsigned long long fterms;
+
+	for(i = 0 ; i < st->nMatches ; ++i) {
+		m = st->matches + i;
+		field = m->field;
+		if(field->name == NULL)
+			continue;
+		fterms = ee_filterTerms(st->ctx, es_getBufAddr(field->name),
+					es_strlen(field->name), field->nameHash);
+		if(fterms == 0)
+			continue;
+		if(m->value == NULL)
+			ee_filterValue(st->ctx, fstate, fterms,
+				       st->buf + m->offs + m->probe.offsVal, m->probe.lenVal);
+		else
+			ee_filterValue(st->ctx, fstate, fterms, st->buf + m->offs, m->len);
+		CHKR(ee_filterFieldDone(fstate, fterms));
+	}
+
+done:
+	return r;
+}
+
+
+/* create the event for the rule that matched */
+static int
+buildEvent(struct matchState *st, struct ee_event *event)
+{
+	int r = 0;
+	unsigned i;
+	struct match *m;
+	struct ee_field *field = NULL;
+
+	for(i = 0 ; i < st->nMatches ; ++i) {
+		m = st->matches + i;
+		if(   m->field->name == NULL
+		   || !ee_isProjected(st->ctx, es_getBufAddr(m->field->name),
+				      es_strlen(m->field->name), m->field->nameHash))
+			continue;
+		if(m->value == NULL)
+			CHKR(ee_newValueFromProbe(st->ctx, st->buf + m->offs, &m->probe, &m->value));
+		CHKN(field = ee_newField(st->ctx));
+		CHKN(field->name = es_strdup(m->field->name));
+		field->nameHash = m->field->nameHash;
+		CHKR(ee_addValueToField(field, m->value));
+		m->value = NULL;
+		CHKR(ee_addFieldToEvent(event, field));
+		field = NULL;
+	}
+	if(st->terminal->tags != NULL)
+		CHKR(ee_assignTagbucketToEvent(event, ee_addRefTagbucket(st->terminal->tags)));
+
+done:
+	if(field != NULL)
+		ee_deleteField(field);
+	return r;
+}
+
+
+int
+ee_normalize(struct ee_normalizer *norm, es_str_t *str, struct ee_event **event)
+{
+	int r;
+	unsigned i;
+	struct matchState st;
+	struct ee_filterState fstate = { 0 };
+	STATS_TIMER_DECL
+
+	assert(norm != NULL);assert(norm->objID == ObjID_NORMALIZER);
+	STATS_TIMER_START;
+	*event = NULL;
+	st.ctx = norm->ctx;
+	st.str = str;
+	st.buf = es_getBufAddr(str);
+	st.len = es_strlen(str);
+	st.nMatches = 0;
+	st.lits = norm->lits;
+	st.bScanned = 0;
+	if(!norm->bPrefilterOK)
+		CHKR(buildPrefilter(norm));
+	if(!matchNode(&st, norm->root, 0, 0)) {
+		r = EE_NOTFOUND;
+		goto done;
+	}
+	if(norm->ctx->filter != NULL)
+		CHKR(filterMatches(&st, &fstate));
+	CHKN(*event = ee_newEvent(norm->ctx));
+	CHKR(buildEvent(&st, *event));
+	if(norm->ctx->filter != NULL)
+		CHKR(ee_filterEvent(norm->ctx, &fstate, *event));
+
+done:
+	for(i = 0 ; i < st.nMatches ; ++i)
+		if(st.matches[i].value != NULL)
+			ee_deleteValue(st.matches[i].value);
+	if(r != 0 && *event != NULL) {
+		ee_deleteEvent(*event);
+		*event = NULL;
+	}
+	if(r == 0)
+		STATS_INC(norm->ctx, eventsDecoded);
+	else if(r == EE_FILTERED)
+		STATS_INC(norm->ctx, eventsFiltered);
+	STATS_TIMER_STOP(norm->ctx, decodeNs);
+	return r;
+}
+
+
+/* create the event for a line that matches no rule */
+static int
+unmatchedEvent(ee_ctx ctx, es_str_t *ln, struct ee_event **event)
+{
+	int r = 0;
+	es_str_t *msg;
+	struct ee_filterState fstate = { 0 };
+	unsigned long long fterms;
+	unsigned hash = ee_hashName((unsigned char*) "originalmsg", 11);
+
+	CHKN(*event = ee_newEvent(ctx));
+	if(ctx->filter != NULL) {
+		fterms = ee_filterTerms(ctx, (unsigned char*) "originalmsg", 11, hash);
+		ee_filterValue(ctx, &fstate, fterms, es_getBufAddr(ln), es_strlen(ln));
+		CHKR(ee_filterFieldDone(&fstate, fterms));
+		CHKR(ee_filterEvent(ctx, &fstate, *event));
+	}
+	if(ee_isProjected(ctx, (unsigned char*) "originalmsg", 11, hash)) {
+		CHKN(msg = es_strdup(ln));
+		CHKR(ee_addStrFieldToEvent(*event, "originalmsg", msg));
+	}
+
+done:
+	if(r != 0 && *event != NULL) {
+		ee_deleteEvent(*event);
+		*event = NULL;
+	}
+	return r;
+}
+
+
+int
+ee_normDec(ee_ctx ctx, int (*cbGetLine)(es_str_t **ln),
+	   int (*cbNewEvt)(struct ee_event *event),
+	   es_str_t **errMsg, struct ee_normalizer *norm)
+{
+	int r;
+	int lnNbr;
+	es_str_t *ln = NULL;
+	struct ee_event *event;
+	char errMsgBuf[1024];
+	size_t errlen;
+
+	assert(norm != NULL);assert(norm->objID == ObjID_NORMALIZER);
+	lnNbr = 1;
+	while((r = cbGetLine(&ln)) == 0) {
+		TRACE2(decode_start, "norm", lnNbr);
+		r = ee_normalize(norm, ln, &event);
+		if(r == EE_NOTFOUND)
+			r = unmatchedEvent(ctx, ln, &event);
+		TRACE3(decode_done, "norm", lnNbr, r);
+		es_deleteStr(ln);
+		if(r == 0)
+			r = cbNewEvt(event);
+		else if(r == EE_FILTERED)
+			r = 0;
+		if(r != 0) {
+			errlen = snprintf(errMsgBuf, sizeof(errMsgBuf),
+					  "error processing line %d", lnNbr);
+			*errMsg = es_newStrFromCStr(errMsgBuf, errlen);
+			goto done;
+		}
+		lnNbr++;
+	}
+
+	if(r == EE_EOF)
+		r = 0;
+done:
+	return r;
+}
+/* vim :ts=4:sw=4 */
@@ -0,0 +1,193 @@
+/**
+ * @file parser.c
+ * Implements the parser registry.
+ *//*
+ * Libee - An Event Expression Library inspired by CEE
+ * Copyright 2012 by Rainer Gerhards and Adiscon GmbH.
+ *
+ * This file is part of libee.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * A copy of the LGPL v2.1 can be found in the file "COPYING" in this distribution.
+ */
+#include "config.h"
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include "libee/libee.h"
+#include "libee/internal.h"
+
+/* The built-in parsers. Names are the same as used by liblognorm
+ * rulebases, so that these can be used unchanged.
+ */
+static struct {
+	char *name;
+	ee_parserFunc parse;
+	ee_probeFunc probe;
+	char *firstBytes;
+	es_size_t minLen;
+	unsigned flags;
+} builtinParsers[] = {
+	{ "date-rfc3164", ee_parseRFC3164Date, ee_probeRFC3164Date,
+	  "JFMASONDjfmasond", 11, 0 },
+	{ "date-rfc5424", ee_parseRFC5424Date, ee_probeRFC5424Date,
+	  "0-9", 12, 0 },
+	{ "date-iso", ee_parseISODate, ee_probeISODate,
+	  "0-9", 10, 0 },
+	{ "time-24hr", ee_parseTime24hr, ee_probeTime24hr,
+	  "0-2", 8, 0 },
+	{ "time-12hr", ee_parseTime12hr, ee_probeTime12hr,
+	  "0-1", 8, 0 },
+	{ "ipv4", ee_parseIPv4, ee_probeIPv4,
+	  "0-9", 7, 0 },
+	{ "ipv6", ee_parseIPv6, ee_probeIPv6,
+	  "0-9a-fA-F:", 2, 0 },
+	{ "mac48", ee_parseMAC, ee_probeMAC,
+	  "0-9a-fA-F", 14, 0 },
+	{ "cidr", ee_parseCIDR, ee_probeCIDR,
+	  "0-9a-fA-F:", 4, 0 },
+	{ "number", ee_parseNumber, ee_probeNumber,
+	  "0-9+-", 1, 0 },
+	{ "quoted-string", ee_parseQuotedString, ee_probeQuotedString,
+	  "\"", 2, 0 },
+	{ "char-to", ee_parseCharTo, ee_probeCharTo,
+	  NULL, 2, EE_PARSER_FLAG_NEEDS_ED },
+	{ "word", ee_parseWord, ee_probeWord,
+	  "^ ", 1, EE_PARSER_FLAG_CATCHALL },
+	{ NULL, NULL, NULL, NULL, 0, 0 }
+};
+
+
+/* build the first byte bitmap from its string specification */
+static void
+setFirstBytes(unsigned char *map, char *spec)
+{
+	unsigned char *p = (unsigned char*) spec;
+	unsigned c, last;
+	int bNegate = 0;
+	int i;
+
+	if(spec == NULL) {
+		memset(map, 0xff, 32);
+		return;
+	}
+	memset(map, 0, 32);
+	if(*p == '^') {
+		bNegate = 1;
+		++p;
+	}
+	while(*p) {
+		c = last = *p++;
+		if(*p == '-' && p[1] != '\0') {
+			last = p[1];
+			p += 2;
+		}
+		for( ; c <= last ; ++c)
+			map[c >> 3] |= 1 << (c & 7);
+	}
+	if(bNegate)
+		for(i = 0 ; i < 32 ; ++i)
+			map[i] = ~map[i];
+}
+
+
+struct ee_parser*
+ee_findParser(ee_ctx ctx, char *name)
+{
+	struct ee_parser *parser;
+
+	for(parser = ctx->parsers ; parser != NULL ; parser = parser->next)
+		if(!strcmp(parser->name, name))
+			break;
+	return parser;
+}
+
+
+struct ee_parser*
+ee_registerParser(ee_ctx ctx, char *name, ee_parserFunc parse,
+		  char *firstBytes, es_size_t minLen, unsigned flags)
+{
+	struct ee_parser *parser, *last;
+
+	assert(ctx != NULL);assert(ctx->objID == ObjID_CTX);
+	assert(name != NULL);assert(parse != NULL);
+	if((parser = ee_findParser(ctx, name)) == NULL) {
+		if((parser = calloc(1, sizeof(struct ee_parser))) == NULL)
+			goto done;
+		if((parser->name = strdup(name)) == NULL) {
+			free(parser);
+			parser = NULL;
+			goto done;
+		}
+		parser->objID = ObjID_PARSER;
+		/* keep registration order, dispatchers may depend on it */
+		if(ctx->parsers == NULL) {
+			ctx->parsers = parser;
+		} else {
+			for(last = ctx->parsers ; last->next != NULL ; last = last->next)
+				/*JUST SKIP*/;
+			last->next = parser;
+		}
+	}
+	parser->parse = parse;
+	parser->probe = NULL;
+	parser->minLen = minLen;
+	parser->flags = flags;
+	setFirstBytes(parser->firstBytes, firstBytes);
+	DBGPRINTF(ctx, EE_DBG_TRACE, "registered parser '%s'", name);
+
+done:
+	return parser;
+}
+
+
+int
+ee_registerBuiltinParsers(ee_ctx ctx)
+{
+	int r = 0;
+	int i;
+	struct ee_parser *parser;
+
+	for(i = 0 ; builtinParsers[i].name != NULL ; ++i) {
+		CHKN(parser = ee_registerParser(ctx, builtinParsers[i].name,
+					        builtinParsers[i].parse,
+					        builtinParsers[i].firstBytes,
+					        builtinParsers[i].minLen,
+					        builtinParsers[i].flags));
+		parser->probe = builtinParsers[i].probe;
+	}
+
+done:
+	return r;
+}
+
+
+void
+ee_deleteParsers(ee_ctx ctx)
+{
+	struct ee_parser *parser, *del;
+
+	for(parser = ctx->parsers ; parser != NULL ; ) {
+		del = parser;
+		parser = parser->next;
+		del->objID = ObjID_DELETED;
+		free(del->name);
+		free(del);
+	}
+	ctx->parsers = NULL;
+}
+/* vim :ts=4:sw=4 */
@@ -29,17 +29,17 @@
 #include <stdarg.h>
 #include <assert.h>
 #include <ctype.h>
+#include <string.h>
+#include <limits.h>
+#include <errno.h>
+#include <math.h>
 
 #include "libee/libee.h"
 #include "libee/internal.h"
 
 #define ERR_ABORT {r = 1; goto done; }
 
-#define CHECK_CTX \
-	if(ctx->objID != ObjID_CTX) { \
-		r = -1; \
-		goto done; \
-	}
+#define CHECK_CTX CHKOBJ(ctx, ObjID_CTX)
 
 ee_ctx
 ee_initPrimitiveType(void)
@@ -68,6 +68,9 @@ done:
 }
 
 /* some helpers */
+/* Values that do not fit into 9 digits are returned as 1000000000, which
+ * is out of range for all callers (and does not overflow).
+ */
 static inline int
 hParseInt(unsigned char **buf, es_size_t *lenBuf)
 {
@@ -76,7 +79,7 @@ hParseInt(unsigned char **buf, es_size_t *lenBuf)
 	int i = 0;
 	
 	while(len > 0 && isdigit(*p)) {
-		i = i * 10 + *p - '0';
+		i = (i < 100000000) ? i * 10 + *p - '0' : 1000000000;
 		++p;
 		--len;
 	}
@@ -116,39 +119,278 @@ int ee_parse##ParserName(ee_ctx __attribute__((unused)) ctx, es_str_t *str, es_s
 	return r; \
 }
 
+/* Most parsers are fully described by their probe: they just turn the
+ * probe result into a value.
+ */
+#define PARSER_FROM_PROBE(ParserName) \
+int ee_parse##ParserName(ee_ctx ctx, es_str_t *str, es_size_t *offs, \
+                      es_str_t *ed, struct ee_value **value) \
+{ \
+	return parseByProbe(ctx, str, offs, ed, value, ee_probe##ParserName, \
+			    ee_stp_##ParserName); \
+}
 
+#define SET_PROBE(probe, t, offs, len) { \
+	(probe)->type = (t); \
+	(probe)->offsVal = (offs); \
+	(probe)->lenVal = (len); \
+	}
 
 
-/**
- * Parse a TIMESTAMP as specified in RFC5424 (subset of RFC3339).
+int
+ee_newValueFromProbe(ee_ctx ctx, unsigned char *buf, struct ee_probe *probe,
+		     struct ee_value **value)
+{
+	int r = 0;
+	es_str_t *valstr;
+
+	if(probe->type == EE_PROBE_NET) {
+		CHKN(*value = ee_newValue(ctx));
+		ee_setNetValue(*value, &probe->v.net);
+		goto done;
+	}
+	if(probe->type == EE_PROBE_NBR) {
+		CHKN(*value = ee_newValue(ctx));
+		ee_setNbrValue(*value, probe->v.nbr);
+		goto done;
+	}
+	if(probe->type == EE_PROBE_DBL) {
+		CHKN(*value = ee_newValue(ctx));
+		ee_setDblValue(*value, probe->v.dbl);
+		goto done;
+	}
+	CHKN(valstr = es_newStrFromBuf((char*) buf + probe->offsVal, probe->lenVal));
+	STATS_ADD(ctx, bytesCopied, probe->lenVal);
+	if((*value = ee_newValue(ctx)) == NULL) {
+		es_deleteStr(valstr);
+		r = EE_NOMEM;
+		goto done;
+	}
+	ee_setStrValue(*value, valstr);
+
+done:
+	return r;
+}
+
+
+static int
+parseByProbe(ee_ctx ctx, es_str_t *str, es_size_t *offs, es_str_t *ed,
+	     struct ee_value **value, ee_probeFunc probe,
+	     enum ee_statsParser __attribute__((unused)) statsIdx)
+{
+	int r = EE_WRONGPARSER;
+	struct ee_probe pr;
+	es_size_t usedLen;
+
+	assert(str != NULL);
+	assert(offs != NULL);
+	if(*offs >= es_strlen(str))
+		goto done;
+	usedLen = probe(ctx, es_getBufAddr(str) + *offs, es_strlen(str) - *offs, ed, &pr);
+	if(usedLen == 0)
+		goto done;
+
+	/* success, persist */
+	CHKR(ee_newValueFromProbe(ctx, es_getBufAddr(str) + *offs, &pr, value));
+	*offs += usedLen;
+
+done:
+	STATS_PARSER(ctx, statsIdx, r);
+	return r;
+}
+
+
+
+
+#define ISDIGIT(c) ((unsigned) ((c) - '0') < 10)
+#define DIGIT(c) ((c) - '0')
+
+/* SWAR helpers. We gather up to eight ASCII digits into one 64 bit word
+ * (first digit in the lowest byte) and then check and convert them all
+ * at once instead of digit by digit.
  */
-BEGINParser(RFC5424Date)
-	unsigned char *pszTS;
-	/* variables to temporarily hold time information while we parse */
-	int year;
-	int month;
-	int day;
-	int hour; /* 24 hour clock */
-	int minute;
-	int second;
-	int secfrac;	/* fractional seconds (must be 32 bit!) */
-	int secfracPrecision;
-	char OffsetMode;	/* UTC offset + or - */
-	char OffsetHour;	/* UTC offset in hours */
-	int OffsetMinute;	/* UTC offset in minutes */
-	es_size_t len;
-	es_size_t orglen;
-	/* end variables to temporarily hold time information while we parse */
+#define SWAR_GATHER8(b0, b1, b2, b3, b4, b5, b6, b7) \
+	(  (unsigned long long) (b0)        | ((unsigned long long) (b1) << 8) \
+	 | ((unsigned long long) (b2) << 16) | ((unsigned long long) (b3) << 24) \
+	 | ((unsigned long long) (b4) << 32) | ((unsigned long long) (b5) << 40) \
+	 | ((unsigned long long) (b6) << 48) | ((unsigned long long) (b7) << 56))
+
+/* check that all eight bytes are ASCII digits */
+static inline int
+swarAllDigits(unsigned long long x)
+{
+	return    (x & 0xF0F0F0F0F0F0F0F0ULL) == 0x3030303030303030ULL
+	       && ((x + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) == 0x3030303030303030ULL;
+}
+
+/* Convert eight digits to four two-digit numbers, which are returned in
+ * bytes 0, 2, 4 and 6 of the result (in order of appearance).
+ */
+static inline unsigned long long
+swarPairs(unsigned long long x)
+{
+	x &= 0x0F0F0F0F0F0F0F0FULL;
+	return ((x * 10) + (x >> 8)) & 0x00FF00FF00FF00FFULL;
+}
+
+
+/* Compute days since the epoch from a proleptic Gregorian date. Algorithm
+ * by Howard Hinnant (days_from_civil), which works without any tables.
+ */
+static inline long
+daysFromCivil(int year, int month, int day)
+{
+	int era;
+	unsigned yoe, doy, doe;
+
+	year -= month <= 2;
+	era = (year >= 0 ? year : year - 399) / 400;
+	yoe = (unsigned) (year - era * 400);
+	doy = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+	doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+	return era * 146097L + (long) doe - 719468L;
+}
+
+
+/* Compute the epoch of a RFC5424 timestamp. The calendar part only
+ * changes once per hour, so we memorize the result for the last
+ * "YYYY-MM-DDThh" prefix seen. Consecutive log lines hit that cache
+ * almost always.
+ */
+static inline void
+computeStamp(ee_ctx ctx, unsigned char *prefix, struct ee_timestamp *ts)
+{
+	time_t hourStamp;
+	int offset;
+
+	if(prefix != NULL && ctx->rfc5424Cache.bValid
+	   && !memcmp(prefix, ctx->rfc5424Cache.prefix, 13)) {
+		hourStamp = ctx->rfc5424Cache.hourStamp;
+	} else {
+		hourStamp = (time_t) daysFromCivil(ts->year, ts->month, ts->day) * 86400
+			    + ts->hour * 3600;
+		if(prefix != NULL) {
+			memcpy(ctx->rfc5424Cache.prefix, prefix, 13);
+			ctx->rfc5424Cache.hourStamp = hourStamp;
+			ctx->rfc5424Cache.bValid = 1;
+		}
+	}
+	offset = ts->OffsetHour * 3600 + ts->OffsetMinute * 60;
+	ts->stamp = hourStamp + ts->minute * 60 + ts->second
+		    - (ts->OffsetMode == '-' ? -offset : offset);
+}
+
+
+/* parse fractional seconds, we keep up to 9 digits (nanoseconds) */
+static inline void
+parseSecfrac(unsigned char **pp, es_size_t *plen, struct ee_timestamp *ts)
+{
+	unsigned char *p = *pp;
+	es_size_t len = *plen;
+	int secfrac = 0;
+	int prec = 0;
+
+	while(len > 0 && ISDIGIT(*p)) {
+		if(prec < 9) {
+			secfrac = secfrac * 10 + DIGIT(*p);
+			++prec;
+		}
+		++p;
+		--len;
+	}
+	ts->secfrac = secfrac;
+	ts->secfracPrecision = prec;
+	*pp = p;
+	*plen = len;
+}
 
-	assert(*offs < es_strlen(str));
 
-	pszTS = es_getBufAddr(str) + *offs;
-	len = orglen = es_strlen(str) - *offs;
+/* Fast path for the canonical "YYYY-MM-DDThh:mm:ss[.frac](Z|+hh:mm)"
+ * layout, where all fields (but the fraction) are at fixed offsets.
+ * Returns the number of characters used or 0 if the layout did not match.
+ */
+static inline int
+parseRFC5424Fast(ee_ctx ctx, unsigned char *p, es_size_t len, struct ee_timestamp *ts)
+{
+	unsigned char *start = p;
+	unsigned long long x;
+
+	if(   len < 20 || p[4] != '-' || p[7] != '-' || p[10] != 'T'
+	   || p[13] != ':' || p[16] != ':')
+		return 0;
+
+	x = SWAR_GATHER8(p[0], p[1], p[2], p[3], p[5], p[6], p[8], p[9]);
+	if(!swarAllDigits(x))
+		return 0;
+	x = swarPairs(x);
+	ts->year = (x & 0xff) * 100 + ((x >> 16) & 0xff);
+	ts->month = (x >> 32) & 0xff;
+	ts->day = (x >> 48) & 0xff;
+
+	x = SWAR_GATHER8(p[11], p[12], p[14], p[15], p[17], p[18], '0', '0');
+	if(!swarAllDigits(x))
+		return 0;
+	x = swarPairs(x);
+	ts->hour = x & 0xff;
+	ts->minute = (x >> 16) & 0xff;
+	ts->second = (x >> 32) & 0xff;
+
+	if(   ts->month < 1 || ts->month > 12 || ts->day < 1 || ts->day > 31
+	   || ts->hour > 23 || ts->minute > 59 || ts->second > 60)
+		return 0;
+
+	p += 19;
+	len -= 19;
+	if(*p == '.') {
+		++p;
+		--len;
+		parseSecfrac(&p, &len, ts);
+		if(ts->secfracPrecision == 0)
+			return 0;
+	} else {
+		ts->secfrac = 0;
+		ts->secfracPrecision = 0;
+	}
+
+	if(len >= 1 && *p == 'Z') {
+		ts->OffsetMode = 'Z';
+		ts->OffsetHour = 0;
+		ts->OffsetMinute = 0;
+		++p;
+		--len;
+	} else if(   len >= 6 && (*p == '+' || *p == '-') && p[3] == ':'
+		  && ISDIGIT(p[1]) && ISDIGIT(p[2]) && ISDIGIT(p[4]) && ISDIGIT(p[5])) {
+		ts->OffsetMode = *p;
+		ts->OffsetHour = DIGIT(p[1]) * 10 + DIGIT(p[2]);
+		ts->OffsetMinute = DIGIT(p[4]) * 10 + DIGIT(p[5]);
+		if(ts->OffsetHour > 23 || ts->OffsetMinute > 59)
+			return 0;
+		p += 6;
+		len -= 6;
+	} else {
+		return 0;
+	}
+	if(len > 0 && *p != ' ')
+		return 0;
+
+	computeStamp(ctx, start, ts);
+	return p - start;
+}
+
+
+/* Slow path. We take the liberty to accept slightly malformed timestamps
+ * e.g. in the format of 2003-9-1T1:0:0.
+ * Returns the number of characters used or 0 if the format did not match.
+ */
+static int
+parseRFC5424Slow(ee_ctx ctx, unsigned char *pszTS, es_size_t len, struct ee_timestamp *ts)
+{
+	es_size_t orglen = len;
+	int year, month, day, hour, minute, second;
+	int OffsetHour, OffsetMinute;
 
 	year = hParseInt(&pszTS, &len);
 
-	/* We take the liberty to accept slightly malformed timestamps e.g. in 
-	 * the format of 2003-9-1T1:0:0.  */
 	if(len == 0 || *pszTS++ != '-') goto fail;
 	--len;
 	month = hParseInt(&pszTS, &len);
@@ -180,12 +422,13 @@ BEGINParser(RFC5424Date)
 	/* Now let's see if we have secfrac */
 	if(len > 0 && *pszTS == '.') {
 		--len;
-		unsigned char *pszStart = ++pszTS;
-		secfrac = hParseInt(&pszTS, &len);
-		secfracPrecision = (int) (pszTS - pszStart);
+		++pszTS;
+		parseSecfrac(&pszTS, &len, ts);
+		if(ts->secfracPrecision == 0)
+			goto fail;
 	} else {
-		secfracPrecision = 0;
-		secfrac = 0;
+		ts->secfracPrecision = 0;
+		ts->secfrac = 0;
 	}
 
 	/* check the timezone */
@@ -194,11 +437,11 @@ BEGINParser(RFC5424Date)
 	if(*pszTS == 'Z') {
 		--len;
 		pszTS++; /* eat Z */
-		OffsetMode = 'Z';
+		ts->OffsetMode = 'Z';
 		OffsetHour = 0;
 		OffsetMinute = 0;
 	} else if((*pszTS == '+') || (*pszTS == '-')) {
-		OffsetMode = *pszTS;
+		ts->OffsetMode = *pszTS;
 		--len;
 		pszTS++;
 
@@ -208,6 +451,7 @@ BEGINParser(RFC5424Date)
 
 		if(len == 0 || *pszTS++ != ':')
 			goto fail;
+		--len;
 		OffsetMinute = hParseInt(&pszTS, &len);
 		if(OffsetMinute < 0 || OffsetMinute > 59)
 			goto fail;
@@ -216,202 +460,166 @@ BEGINParser(RFC5424Date)
 		goto fail;
 	}
 
-	if(len > 0) {
-		if(*pszTS != ' ') /* if it is not a space, it can not be a "good" time */
-			goto fail;
-		++pszTS; /* just skip past it */
-		--len;
-	}
+	/* if it is not a space, it can not be a "good" time */
+	if(len > 0 && *pszTS != ' ')
+		goto fail;
 
-	/* we had success, so update parse pointer and caller-provided timestamp */
-	es_size_t usedLen =  orglen - len;
-	es_str_t *valstr = es_newStrFromSubStr(str, *offs, usedLen);
-	*value = ee_newValue(ctx);
-	ee_setStrValue(*value, valstr);
-	*offs += usedLen;
-	r = 0; /* parsing was successful */
-#	if 0 /* currently, we need to persist only the string format */
-	/* we had success, so update parse pointer and caller-provided timestamp */
-	*ppszTS = pszTS;
-	pTime->timeType = 2;
-	pTime->year = year;
-	pTime->month = month;
-	pTime->day = day;
-	pTime->hour = hour;
-	pTime->minute = minute;
-	pTime->second = second;
-	pTime->secfrac = secfrac;
-	pTime->secfracPrecision = secfracPrecision;
-	pTime->OffsetMode = OffsetMode;
-	pTime->OffsetHour = OffsetHour;
-	pTime->OffsetMinute = OffsetMinute;
-#	endif
+	ts->year = year;
+	ts->month = month;
+	ts->day = day;
+	ts->hour = hour;
+	ts->minute = minute;
+	ts->second = second;
+	ts->OffsetHour = OffsetHour;
+	ts->OffsetMinute = OffsetMinute;
+	/* the prefix is not canonical, so we must not cache it */
+	computeStamp(ctx, NULL, ts);
+	return orglen - len;
 
 fail:
-ENDParser
+	return 0;
+}
+
+
+int
+ee_scanRFC5424Date(ee_ctx ctx, unsigned char *buf, es_size_t len, struct ee_timestamp *ts)
+{
+	int used;
+
+	if((used = parseRFC5424Fast(ctx, buf, len, ts)) == 0)
+		used = parseRFC5424Slow(ctx, buf, len, ts);
+	if(used != 0)
+		ts->timeType = EE_TS_RFC5424;
+	return used;
+}
+
+
+es_size_t
+ee_probeRFC5424Date(ee_ctx ctx, unsigned char *buf, es_size_t len,
+		    es_str_t __attribute__((unused)) *ed, struct ee_probe *probe)
+{
+	es_size_t used;
+
+	if((used = ee_scanRFC5424Date(ctx, buf, len, &probe->v.ts)) != 0)
+		SET_PROBE(probe, EE_PROBE_TS, 0, used);
+	return used;
+}
 
 
 /**
- * Parse a RFC3164 Date.
+ * Parse a TIMESTAMP as specified in RFC5424 (subset of RFC3339).
+ * Note that, other than the probe, the parser also consumes the
+ * space after the timestamp.
  */
-BEGINParser(RFC3164Date)
-	unsigned char *p;
-	es_size_t len, orglen;
-	/* variables to temporarily hold time information while we parse */
-	int month;
-	int day;
-	//int year = 0; /* 0 means no year provided */
-	int hour; /* 24 hour clock */
-	int minute;
-	int second;
+BEGINParser(RFC5424Date)
+	struct ee_probe probe;
+	es_size_t usedLen;
 
 	assert(*offs < es_strlen(str));
 
-	p = es_getBufAddr(str) + *offs;
-	orglen = len = es_strlen(str) - *offs;
-	/* If we look at the month (Jan, Feb, Mar, Apr, May, Jun, Jul, Aug, Sep, Oct, Nov, Dec),
-	 * we may see the following character sequences occur:
-	 *
-	 * J(an/u(n/l)), Feb, Ma(r/y), A(pr/ug), Sep, Oct, Nov, Dec
-	 *
-	 * We will use this for parsing, as it probably is the
-	 * fastest way to parse it.
-	 */
-	if(len < 3)
+	usedLen = ee_probeRFC5424Date(ctx, es_getBufAddr(str) + *offs,
+				      es_strlen(str) - *offs, ed, &probe);
+	if(usedLen == 0)
 		goto fail;
+	/* the space after the timestamp belongs to it */
+	if(*offs + usedLen < es_strlen(str))
+		probe.lenVal = ++usedLen;
 
-	switch(*p++)
-	{
-	case 'j':
-	case 'J':
-		if(*p == 'a' || *p == 'A') {
-			++p;
-			if(*p == 'n' || *p == 'N') {
-				++p;
-				month = 1;
-			} else
-				goto fail;
-		} else if(*p == 'u' || *p == 'U') {
-			++p;
-			if(*p == 'n' || *p == 'N') {
-				++p;
-				month = 6;
-			} else if(*p == 'l' || *p == 'L') {
-				++p;
-				month = 7;
-			} else
-				goto fail;
-		} else
-			goto fail;
-		break;
-	case 'f':
-	case 'F':
-		if(*p == 'e' || *p == 'E') {
-			++p;
-			if(*p == 'b' || *p == 'B') {
-				++p;
-				month = 2;
-			} else
-				goto fail;
-		} else
-			goto fail;
-		break;
-	case 'm':
-	case 'M':
-		if(*p == 'a' || *p == 'A') {
-			++p;
-			if(*p == 'r' || *p == 'R') {
-				++p;
-				month = 3;
-			} else if(*p == 'y' || *p == 'Y') {
-				++p;
-				month = 5;
-			} else
-				goto fail;
-		} else
-			goto fail;
-		break;
-	case 'a':
-	case 'A':
-		if(*p == 'p' || *p == 'P') {
-			++p;
-			if(*p == 'r' || *p == 'R') {
-				++p;
-				month = 4;
-			} else
-				goto fail;
-		} else if(*p == 'u' || *p == 'U') {
-			++p;
-			if(*p == 'g' || *p == 'G') {
-				++p;
-				month = 8;
-			} else
-				goto fail;
-		} else
-			goto fail;
-		break;
-	case 's':
-	case 'S':
-		if(*p == 'e' || *p == 'E') {
-			++p;
-			if(*p == 'p' || *p == 'P') {
-				++p;
-				month = 9;
-			} else
-				goto fail;
-		} else
-			goto fail;
-		break;
-	case 'o':
-	case 'O':
-		if(*p == 'c' || *p == 'C') {
-			++p;
-			if(*p == 't' || *p == 'T') {
-				++p;
-				month = 10;
-			} else
-				goto fail;
-		} else
-			goto fail;
-		break;
-	case 'n':
-	case 'N':
-		if(*p == 'o' || *p == 'O') {
-			++p;
-			if(*p == 'v' || *p == 'V') {
-				++p;
-				month = 11;
-			} else
-				goto fail;
-		} else
-			goto fail;
-		break;
-	case 'd':
-	case 'D':
-		if(*p == 'e' || *p == 'E') {
-			++p;
-			if(*p == 'c' || *p == 'C') {
-				++p;
-				month = 12;
-			} else
-				goto fail;
-		} else
-			goto fail;
-		break;
-	default:
-		goto fail;
-	}
+	/* we had success, so update parse pointer and caller-provided timestamp */
+	CHKR(ee_newValueFromProbe(ctx, es_getBufAddr(str) + *offs, &probe, value));
+	*offs += usedLen;
+	r = 0; /* parsing was successful */
+done:
+fail:
+	STATS_PARSER(ctx, ee_stp_RFC5424Date, (int) r);
+ENDParser
 
-	len -= 3;
 
-	/* done month */
+/* Month names are looked up via a perfect hash. For the lower-cased
+ * three letter month names, (2*c0 + 9*c1 + c2) % 32 is collision-free
+ * (found by brute force search), so a single table probe plus a
+ * verification is sufficient. Note that or'ing 0x20 lower-cases
+ * letters and does not map any non-letter to a letter.
+ */
+#define MONTH_HASH(c0, c1, c2) ((2 * (c0) + 9 * (c1) + (c2)) & 31)
+static const struct {
+	char name[3];
+	char month;
+} monthTab[32] = {
+	[11] = {"jan", 1}, [27] = {"feb", 2}, [21] = {"mar", 3},
+	[ 4] = {"apr", 4}, [28] = {"may", 5}, [31] = {"jun", 6},
+	[29] = {"jul", 7}, [ 6] = {"aug", 8}, [ 3] = {"sep", 9},
+	[13] = {"oct", 10}, [25] = {"nov", 11}, [24] = {"dec", 12}
+};
+
+/* returns month (1..12) or 0 if p does not point to a month name.
+ * p must point to at least three characters.
+ */
+static inline int
+getMonth(unsigned char *p)
+{
+	unsigned char c0 = p[0] | 0x20, c1 = p[1] | 0x20, c2 = p[2] | 0x20;
+	int i = MONTH_HASH(c0, c1, c2);
+
+	if(   monthTab[i].name[0] == c0 && monthTab[i].name[1] == c1
+	   && monthTab[i].name[2] == c2)
+		return monthTab[i].month;
+	return 0;
+}
+
+/* Fast path for the by far most common format "Mmm dd hh:mm:ss" (with
+ * the day space-padded if it is a single digit). All fields are at
+ * fixed offsets, so we can extract them without any scanning.
+ * Returns 15 on success, 0 if the format did not match.
+ */
+static inline int
+parseRFC3164Fast(unsigned char *p, es_size_t len, struct ee_timestamp *ts)
+{
+	int day, hour, minute, second;
+
+	if(   p[3] != ' ' || p[6] != ' ' || p[9] != ':' || p[12] != ':'
+	   || !(ISDIGIT(p[4]) || p[4] == ' ') || !ISDIGIT(p[5])
+	   || !ISDIGIT(p[7]) || !ISDIGIT(p[8]) || !ISDIGIT(p[10])
+	   || !ISDIGIT(p[11]) || !ISDIGIT(p[13]) || !ISDIGIT(p[14])
+	   || (len > 15 && ISDIGIT(p[15])))
+		return 0;
+	if((ts->month = getMonth(p)) == 0)
+		return 0;
+	day = (p[4] == ' ' ? 0 : DIGIT(p[4]) * 10) + DIGIT(p[5]);
+	hour = DIGIT(p[7]) * 10 + DIGIT(p[8]);
+	minute = DIGIT(p[10]) * 10 + DIGIT(p[11]);
+	second = DIGIT(p[13]) * 10 + DIGIT(p[14]);
+	if(day < 1 || day > 31 || hour > 23 || minute > 59 || second > 60)
+		return 0;
+	ts->day = day;
+	ts->hour = hour;
+	ts->minute = minute;
+	ts->second = second;
+	ts->year = 0;
+	return 15;
+}
+
+/* Slow path, for all the variants found in practice. Returns the number
+ * of characters used, or 0 if the format did not match.
+ */
+static int
+parseRFC3164Slow(unsigned char *p, es_size_t len, struct ee_timestamp *ts)
+{
+	es_size_t orglen = len;
+	int day, hour, minute, second;
+	int year = 0; /* 0 means no year provided */
+
+	if(len < 3 || (ts->month = getMonth(p)) == 0)
+		goto fail;
+	p += 3;
+	len -= 3;
 
 	if(len == 0 || *p++ != ' ')
 		goto fail;
 	--len;
 
 	/* we accept a slightly malformed timestamp with one-digit days. */
-	if(*p == ' ') {
+	if(len > 0 && *p == ' ') {
 		--len;
 		++p;
 	}
@@ -429,9 +637,8 @@ BEGINParser(RFC3164Date)
 	if(hour > 1970 && hour < 2100) {
 		/* if so, we assume this actually is a year. This is a format found
 		 * e.g. in Cisco devices.
-		 *
+		 */
 		year = hour;
-		*/
 
 		/* re-query the hour, this time it must be valid */
 		if(len == 0 || *p++ != ' ')
@@ -457,108 +664,243 @@ BEGINParser(RFC3164Date)
 	if(second < 0 || second > 60)
 		goto fail;
 
+	ts->year = year;
+	ts->day = day;
+	ts->hour = hour;
+	ts->minute = minute;
+	ts->second = second;
+	return orglen - len;
+
+fail:
+	return 0;
+}
+
+
+int
+ee_scanRFC3164Date(ee_ctx ctx, unsigned char *p, es_size_t len, struct ee_timestamp *ts)
+{
+	int used;
+
+	if(len >= 15) {
+		if(   (ctx->flags & EE_CTX_FLAG_RFC3164_CACHE)
+		   && ctx->rfc3164Cache.bValid
+		   && !memcmp(p, ctx->rfc3164Cache.prefix, 15)
+		   && !(len > 15 && ISDIGIT(p[15]))) {
+			*ts = ctx->rfc3164Cache.ts;
+			used = 15;
+			goto trailer;
+		}
+		used = parseRFC3164Fast(p, len, ts);
+	} else {
+		used = 0;
+	}
+	if(used == 0 && (used = parseRFC3164Slow(p, len, ts)) == 0)
+		goto done;
+
+	ts->timeType = EE_TS_RFC3164;
+	ts->stamp = 0;
+	ts->secfrac = 0;
+	ts->secfracPrecision = 0;
+	ts->OffsetMode = 0;
+	ts->OffsetHour = 0;
+	ts->OffsetMinute = 0;
+	if(used == 15 && (ctx->flags & EE_CTX_FLAG_RFC3164_CACHE)) {
+		memcpy(ctx->rfc3164Cache.prefix, p, 15);
+		ctx->rfc3164Cache.ts = *ts;
+		ctx->rfc3164Cache.bValid = 1;
+	}
+
+trailer:
 	/* we provide support for an extra ":" after the date. While this is an
 	 * invalid format, it occurs frequently enough (e.g. with Cisco devices)
 	 * to permit it as a valid case. -- rgerhards, 2008-09-12
 	 */
-	if(len > 0 && *p == ':') {
-		++p; /* just skip past it */
-		--len;
-	}
+	if((es_size_t) used < len && p[used] == ':')
+		++used;
+done:
+	return used;
+}
 
-	/* we had success, so update parse pointer and caller-provided timestamp */
-	es_size_t usedLen =  orglen - len;
-	es_str_t *valstr = es_newStrFromSubStr(str, *offs, usedLen);
-	*value = ee_newValue(ctx);
-	ee_setStrValue(*value, valstr);
-	*offs += usedLen;
-	r = 0; /* parsing was successful */
-#if 0 /* TODO: see how we represent the actual timestamp */
-	pTime->month = month;
-	if(year > 0)
-		pTime->year = year; /* persist year if detected */
-	pTime->day = day;
-	pTime->hour = hour;
-	pTime->minute = minute;
-	pTime->second = second;
-#endif
-fail:
-ENDParser
 
+es_size_t
+ee_probeRFC3164Date(ee_ctx ctx, unsigned char *buf, es_size_t len,
+		    es_str_t __attribute__((unused)) *ed, struct ee_probe *probe)
+{
+	es_size_t used;
+
+	if((used = ee_scanRFC3164Date(ctx, buf, len, &probe->v.ts)) != 0)
+		SET_PROBE(probe, EE_PROBE_TS, 0, used);
+	return used;
+}
 
 /**
- * Parse a Number.
- * Note that a number is an abstracted concept. We always represent it
- * as 64 bits (but may later change our mind if performance dictates so).
+ * Parse a RFC3164 Date.
  */
-BEGINParser(Number)
-	unsigned char *p;
-	es_size_t len, orglen;
-	long long n;
-
+PARSER_FROM_PROBE(RFC3164Date)
 
-//printf("parseNumber got '%s'\n", es_str2cstr(str, NULL)+ *offs);
-	p = es_getBufAddr(str) + *offs;
-	orglen = len = es_strlen(str) - *offs;
 
-	n = hParseInt(&p, &len);
-	if(p == es_getBufAddr(str))
-		goto fail;
+/* Convert eight digits (see SWAR_GATHER8) to their value. */
+static inline unsigned
+swarEight(unsigned long long x)
+{
+	x = swarPairs(x);
+	x = ((x * 100) + (x >> 16)) & 0x0000FFFF0000FFFFULL;
+	return (unsigned) (((x * 10000) + (x >> 32)) & 0xFFFFFFFFULL);
+}
 
-	if((*value = ee_newValue(ctx)) == NULL) {
-		r = EE_NOMEM;
-		goto fail;
+/* powers of ten that are exactly representable as double */
+static const double exactPow10[] = {
+	1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+	1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+/* Convert a decimal or exponent number to double. If the mantissa has
+ * at most 15 digits and the exponent is small, both are exactly
+ * representable and a single multiplication or division gives the
+ * correctly rounded result (Clinger's fast path). Everything else
+ * goes to ee_strtod().
+ * @return 0 on success, something else if the number is out of range
+ */
+static int
+toDouble(unsigned char *buf, es_size_t len, unsigned long long mant,
+	 int nDigits, int exp10, int bNeg, double *val)
+{
+	char tmp[64];
+	double d;
+
+	if(nDigits <= 15 && exp10 >= -22 && exp10 <= 22) {
+		d = (double) mant;
+		d = (exp10 < 0) ? d / exactPow10[-exp10] : d * exactPow10[exp10];
+		*val = bNeg ? -d : d;
+		return 0;
 	}
+	if(len >= sizeof(tmp))
+		return 1;
+	memcpy(tmp, buf, len);
+	tmp[len] = '\0';
+	errno = 0;
+	d = ee_strtod(tmp, NULL);
+	if(errno == ERANGE || !isfinite(d))
+		return 1;
+	*val = d;
+	return 0;
+}
 
-	/* success, persist */
-	es_size_t usedLen =  orglen - len;
-	es_str_t *valstr = es_newStrFromSubStr(str, *offs, usedLen);
-	ee_setStrValue(*value, valstr);
-	*offs += usedLen;
-	r = 0;
-fail:
-ENDParser
+/**
+ * Probe for a Number.
+ * Note that a number is an abstracted concept. Integers are represented
+ * as 64 bits, numbers with decimals or an exponent as double. Numbers
+ * that do not fit (or would lose precision) are provided as text only.
+ * Integer digits are converted eight at a time.
+ */
+es_size_t
+ee_probeNumber(ee_ctx __attribute__((unused)) ctx, unsigned char *buf, es_size_t len,
+	       es_str_t __attribute__((unused)) *ed, struct ee_probe *probe)
+{
+	es_size_t i = 0, iStart, j;
+	unsigned long long n = 0, x, limit;
+	int bNeg = 0, bOverflow = 0, bFloat = 0;
+	int nDigits, nFrac = 0, exp10 = 0, bNegExp = 0;
+	double d;
+
+	if(len > 0 && (buf[0] == '-' || buf[0] == '+')) {
+		bNeg = (buf[0] == '-');
+		++i;
+	}
+	iStart = i;
+	/* n * 10^8 + 99999999 can not overflow as long as n <= 92233720367 */
+	while(len - i >= 8 && n <= 92233720367ULL) {
+		x = SWAR_GATHER8(buf[i], buf[i+1], buf[i+2], buf[i+3],
+				 buf[i+4], buf[i+5], buf[i+6], buf[i+7]);
+		if(!swarAllDigits(x))
+			break;
+		n = n * 100000000 + swarEight(x);
+		i += 8;
+	}
+	limit = bNeg ? (unsigned long long) LLONG_MAX + 1 : (unsigned long long) LLONG_MAX;
+	for( ; i < len && ISDIGIT(buf[i]) ; ++i) {
+		if(n > (limit - DIGIT(buf[i])) / 10)
+			bOverflow = 1;
+		else
+			n = n * 10 + DIGIT(buf[i]);
+	}
+	if(i == iStart)
+		return 0;
+	nDigits = i - iStart;
+
+	/* decimals */
+	if(i + 1 < len && buf[i] == '.' && ISDIGIT(buf[i+1])) {
+		bFloat = 1;
+		for(++i ; i < len && ISDIGIT(buf[i]) ; ++i, ++nFrac)
+			if(nDigits + nFrac < 19)
+				n = n * 10 + DIGIT(buf[i]);
+		nDigits += nFrac;
+	}
+	/* exponent */
+	if(i + 1 < len && (buf[i] == 'e' || buf[i] == 'E')) {
+		j = i + 1;
+		if(buf[j] == '-' || buf[j] == '+') {
+			bNegExp = (buf[j] == '-');
+			++j;
+		}
+		if(j < len && ISDIGIT(buf[j])) {
+			bFloat = 1;
+			for(i = j ; i < len && ISDIGIT(buf[i]) ; ++i)
+				if(exp10 < 10000)
+					exp10 = exp10 * 10 + DIGIT(buf[i]);
+			if(bNegExp)
+				exp10 = -exp10;
+		}
+	}
 
+	if(bFloat) {
+		if(toDouble(buf, i, n, bOverflow ? 99 : nDigits, exp10 - nFrac, bNeg, &d) == 0) {
+			SET_PROBE(probe, EE_PROBE_DBL, 0, i);
+			probe->v.dbl = d;
+		} else {
+			SET_PROBE(probe, EE_PROBE_STR, 0, i);
+		}
+	} else if(bOverflow) {
+		SET_PROBE(probe, EE_PROBE_STR, 0, i);
+	} else {
+		SET_PROBE(probe, EE_PROBE_NBR, 0, i);
+		probe->v.nbr = bNeg ? (long long) (0 - n) : (long long) n;
+	}
+	return i;
+}
 
 /**
- * Parse a word.
- * A word is a SP-delimited entity. The parser always works, except if
- * the offset is position on a space upon entry.
+ * Parse a Number.
  */
-BEGINParser(Word)
-	unsigned char *c;
-	es_size_t i;
-	es_size_t len;	/**< length of substring we finally extract */
-	es_str_t *valstr;
+PARSER_FROM_PROBE(Number)
 
-	assert(str != NULL);
-	assert(offs != NULL);
-	c = es_getBufAddr(str);
-	i = *offs;
+
+/**
+ * Probe for a word (SP-terminated string).
+ */
+es_size_t
+ee_probeWord(ee_ctx __attribute__((unused)) ctx, unsigned char *buf, es_size_t len,
+	     es_str_t __attribute__((unused)) *ed, struct ee_probe *probe)
+{
+	es_size_t i = 0;
 
 	/* search end of word */
-	while(i < es_strlen(str) && c[i] != ' ') 
+	while(i < len && buf[i] != ' ') 
 		i++;
 
-	if(i == *offs) {
-		r = EE_WRONGPARSER;
-		goto done;
-	}
-
-	/* success, persist */
-	len =  i - *offs;
-	CHKN(*value = ee_newValue(ctx));
-	CHKN(valstr = es_newStrFromSubStr(str, *offs, len));
-	ee_setStrValue(*value, valstr);
-	*offs = i;
-	r = 0;
+	if(i > 0)
+		SET_PROBE(probe, EE_PROBE_STR, 0, i);
+	return i;
+}
 
-done:	return r;
-ENDParser
+/**
+ * Parse a word.
+ */
+PARSER_FROM_PROBE(Word)
 
 
 /**
- * Parse everything up to a specific character.
+ * Probe for everything up to a specific character.
  * The character must be the only char inside extra data passed to the parser.
  * It is a program error if strlen(ed) != 1. It is considered a format error if
  * a) the to-be-parsed buffer is already positioned on the terminator character
@@ -566,292 +908,496 @@ ENDParser
  * In those cases, the parsers declares itself as not being successful, in all
  * other cases a string is extracted.
  */
-BEGINParser(CharTo)
-	unsigned char *c;
+es_size_t
+ee_probeCharTo(ee_ctx __attribute__((unused)) ctx, unsigned char *buf, es_size_t len,
+	       es_str_t *ed, struct ee_probe *probe)
+{
 	unsigned char cTerm;
-	es_size_t i;
-	es_str_t *valstr;
+	es_size_t i = 0;
 
-	assert(str != NULL);
-	assert(offs != NULL);
 	assert(es_strlen(ed) == 1);
 	cTerm = *(es_getBufAddr(ed));
-	c = es_getBufAddr(str);
-	i = *offs;
 
 	/* search end of word */
-	while(i < es_strlen(str) && c[i] != cTerm) 
+	while(i < len && buf[i] != cTerm) 
 		i++;
 
-	if(i == *offs || i == es_strlen(str) || c[i] != cTerm) {
-		r = EE_WRONGPARSER;
-		goto done;
-	}
-
-	/* success, persist */
-	CHKN(*value = ee_newValue(ctx));
-	CHKN(valstr = es_newStrFromSubStr(str, *offs, i - *offs));
-	ee_setStrValue(*value, valstr);
-	*offs = i;
-	r = 0;
+	if(i == 0 || i == len)
+		return 0;
+	SET_PROBE(probe, EE_PROBE_STR, 0, i);
+	return i;
+}
 
-done:	return r;
-ENDParser
+/**
+ * Parse everything up to a specific character.
+ */
+PARSER_FROM_PROBE(CharTo)
 
 
 /**
- * Parse a quoted string. In this initial implementation, escaping of the quote
+ * Probe for a quoted string. In this initial implementation, escaping of the quote
  * char is not supported. A quoted string is one start starts with a double quote,
  * has some text (not containing double quotes) and ends with the first double
  * quote character seen. The extracted string does NOT include the quote characters.
  * rgerhards, 2011-01-14
  */
-BEGINParser(QuotedString)
-	unsigned char *c;
+es_size_t
+ee_probeQuotedString(ee_ctx __attribute__((unused)) ctx, unsigned char *buf, es_size_t len,
+		     es_str_t __attribute__((unused)) *ed, struct ee_probe *probe)
+{
 	es_size_t i;
-	es_str_t *valstr;
 
-	assert(str != NULL);
-	assert(offs != NULL);
-	c = es_getBufAddr(str);
-	i = *offs;
-
-	if(c[i] != '"')
-		goto done;
-	++i;
+	if(len == 0 || buf[0] != '"')
+		return 0;
 
 	/* search end of string */
-	while(i < es_strlen(str) && c[i] != '"') 
-		i++;
+	for(i = 1 ; i < len && buf[i] != '"' ; ++i)
+		/*JUST SKIP*/;
 
-	if(i == es_strlen(str) || c[i] != '"') {
-		r = EE_WRONGPARSER;
-		goto done;
-	}
-
-	/* success, persist */
-	CHKN(*value = ee_newValue(ctx));
-	CHKN(valstr = es_newStrFromSubStr(str, *offs + 1, i - *offs - 1));
-	ee_setStrValue(*value, valstr);
-	*offs = i + 1; /* "eat" terminal double quote */
-
-	r = 0;
+	if(i == len)
+		return 0;
+	SET_PROBE(probe, EE_PROBE_STR, 1, i - 1);
+	return i + 1; /* "eat" terminal double quote */
+}
 
-done:	return r;
-ENDParser
+/**
+ * Parse a quoted string.
+ */
+PARSER_FROM_PROBE(QuotedString)
 
 
 /**
- * Parse an ISO date, that is YYYY-MM-DD (exactly this format).
+ * Probe for an ISO date, that is YYYY-MM-DD (exactly this format).
  * Note: we do manual loop unrolling -- this is fast AND efficient.
  * rgerhards, 2011-01-14
  */
-BEGINParser(ISODate)
-	unsigned char *c;
-	es_size_t i;
-	es_str_t *valstr;
-
-	assert(str != NULL);
-	assert(offs != NULL);
-	c = es_getBufAddr(str);
-	i = *offs;
-
-	if(*offs+10 > es_strlen(str))
-		goto done;	/* if it is not 10 chars, it can't be an ISO date */
+es_size_t
+ee_probeISODate(ee_ctx __attribute__((unused)) ctx, unsigned char *c, es_size_t len,
+		es_str_t __attribute__((unused)) *ed, struct ee_probe *probe)
+{
+	if(len < 10)
+		goto fail;	/* if it is not 10 chars, it can't be an ISO date */
 
 	/* year */
-	if(!isdigit(c[i])) goto done;
-	if(!isdigit(c[i+1])) goto done;
-	if(!isdigit(c[i+2])) goto done;
-	if(!isdigit(c[i+3])) goto done;
-	if(c[i+4] != '-') goto done;
+	if(!isdigit(c[0])) goto fail;
+	if(!isdigit(c[1])) goto fail;
+	if(!isdigit(c[2])) goto fail;
+	if(!isdigit(c[3])) goto fail;
+	if(c[4] != '-') goto fail;
 	/* month */
-	if(c[i+5] == '0') {
-		if(c[i+6] < '1' || c[i+6] > '9') goto done;
-	} else if(c[i+5] == '1') {
-		if(c[i+6] < '0' || c[i+6] > '2') goto done;
+	if(c[5] == '0') {
+		if(c[6] < '1' || c[6] > '9') goto fail;
+	} else if(c[5] == '1') {
+		if(c[6] < '0' || c[6] > '2') goto fail;
 	} else {
-		goto done;
+		goto fail;
 	}
-	if(c[i+7] != '-') goto done;
+	if(c[7] != '-') goto fail;
 	/* day */
-	if(c[i+8] == '0') {
-		if(c[i+9] < '1' || c[i+9] > '9') goto done;
-	} else if(c[i+8] == '1' || c[i+8] == '2') {
-		if(!isdigit(c[i+9])) goto done;
-	} else if(c[i+8] == '3') {
-		if(c[i+9] != '0' && c[i+9] != '1') goto done;
+	if(c[8] == '0') {
+		if(c[9] < '1' || c[9] > '9') goto fail;
+	} else if(c[8] == '1' || c[8] == '2') {
+		if(!isdigit(c[9])) goto fail;
+	} else if(c[8] == '3') {
+		if(c[9] != '0' && c[9] != '1') goto fail;
 	} else {
-		goto done;
+		goto fail;
 	}
 
-	/* success, persist */
-	CHKN(*value = ee_newValue(ctx));
-	CHKN(valstr = es_newStrFromSubStr(str, *offs, 10));
-	ee_setStrValue(*value, valstr);
-	*offs += 10;
-	r = 0;
+	/* success, the digits are already checked, so converting them is cheap */
+	SET_PROBE(probe, EE_PROBE_TS, 0, 10);
+	memset(&probe->v.ts, 0, sizeof(probe->v.ts));
+	probe->v.ts.year = DIGIT(c[0]) * 1000 + DIGIT(c[1]) * 100
+			 + DIGIT(c[2]) * 10 + DIGIT(c[3]);
+	probe->v.ts.month = DIGIT(c[5]) * 10 + DIGIT(c[6]);
+	probe->v.ts.day = DIGIT(c[8]) * 10 + DIGIT(c[9]);
+	return 10;
 
-done:	return r;
-ENDParser
+fail:
+	return 0;
+}
 
 /**
- * Parse a timestamp in 24hr format (exactly HH:MM:SS).
- * Note: we do manual loop unrolling -- this is fast AND efficient.
- * rgerhards, 2011-01-14
+ * Parse an ISO date.
  */
-BEGINParser(Time24hr)
-	unsigned char *c;
-	es_size_t i;
-	es_str_t *valstr;
+PARSER_FROM_PROBE(ISODate)
 
-	assert(str != NULL);
-	assert(offs != NULL);
-	c = es_getBufAddr(str);
-	i = *offs;
 
-	if(*offs+8 > es_strlen(str))
-		goto done;	/* if it is not 8 chars, it can't be us */
+/* helper to the time probes: checks ":MM:SS" at c and stores the
+ * time into the probe. The hour must already have been checked.
+ * @return 8 (length of time) if OK, 0 otherwise
+ */
+static inline es_size_t
+chkMinSec(unsigned char *c, struct ee_probe *probe)
+{
+	if(c[2] != ':') goto fail;
+	if(c[3] < '0' || c[3] > '5') goto fail;
+	if(!isdigit(c[4])) goto fail;
+	if(c[5] != ':') goto fail;
+	if(c[6] < '0' || c[6] > '5') goto fail;
+	if(!isdigit(c[7])) goto fail;
+
+	SET_PROBE(probe, EE_PROBE_TS, 0, 8);
+	memset(&probe->v.ts, 0, sizeof(probe->v.ts));
+	probe->v.ts.hour = DIGIT(c[0]) * 10 + DIGIT(c[1]);
+	probe->v.ts.minute = DIGIT(c[3]) * 10 + DIGIT(c[4]);
+	probe->v.ts.second = DIGIT(c[6]) * 10 + DIGIT(c[7]);
+	return 8;
+
+fail:
+	return 0;
+}
+
+/**
+ * Probe for a timestamp in 24hr format (exactly HH:MM:SS).
+ * Note: we do manual loop unrolling -- this is fast AND efficient.
+ * rgerhards, 2011-01-14
+ */
+es_size_t
+ee_probeTime24hr(ee_ctx __attribute__((unused)) ctx, unsigned char *c, es_size_t len,
+		 es_str_t __attribute__((unused)) *ed, struct ee_probe *probe)
+{
+	if(len < 8)
+		return 0;	/* if it is not 8 chars, it can't be us */
 
 	/* hour */
-	if(c[i] == '0' || c[i] == '1') {
-		if(!isdigit(c[i+1])) goto done;
-	} else if(c[i] == '2') {
-		if(c[i+1] < '0' || c[i+1] > '3') goto done;
+	if(c[0] == '0' || c[0] == '1') {
+		if(!isdigit(c[1])) return 0;
+	} else if(c[0] == '2') {
+		if(c[1] < '0' || c[1] > '3') return 0;
 	} else {
-		goto done;
+		return 0;
 	}
-	/* TODO: the code below is a duplicate of 24hr parser - create common function */
-	if(c[i+2] != ':') goto done;
-	if(c[i+3] < '0' || c[i+3] > '5') goto done;
-	if(!isdigit(c[i+4])) goto done;
-	if(c[i+5] != ':') goto done;
-	if(c[i+6] < '0' || c[i+6] > '5') goto done;
-	if(!isdigit(c[i+7])) goto done;
-
-	/* success, persist */
-	CHKN(*value = ee_newValue(ctx));
-	CHKN(valstr = es_newStrFromSubStr(str, *offs, 8));
-	ee_setStrValue(*value, valstr);
-	*offs += 8;
-	r = 0;
+	return chkMinSec(c, probe);
+}
 
-done:	return r;
-ENDParser
+/**
+ * Parse a timestamp in 24hr format.
+ */
+PARSER_FROM_PROBE(Time24hr)
 
 /**
- * Parse a timestamp in 12hr format (exactly HH:MM:SS).
+ * Probe for a timestamp in 12hr format (exactly HH:MM:SS).
  * Note: we do manual loop unrolling -- this is fast AND efficient.
- * TODO: the code below is a duplicate of 24hr parser - create common function?
  * rgerhards, 2011-01-14
  */
-BEGINParser(Time12hr)
-	unsigned char *c;
-	es_size_t i;
-	es_str_t *valstr;
-
-	assert(str != NULL);
-	assert(offs != NULL);
-	c = es_getBufAddr(str);
-	i = *offs;
-
-	if(*offs+8 > es_strlen(str))
-		goto done;	/* if it is not 8 chars, it can't be us */
+es_size_t
+ee_probeTime12hr(ee_ctx __attribute__((unused)) ctx, unsigned char *c, es_size_t len,
+		 es_str_t __attribute__((unused)) *ed, struct ee_probe *probe)
+{
+	if(len < 8)
+		return 0;	/* if it is not 8 chars, it can't be us */
 
 	/* hour */
-	if(c[i] == '0') {
-		if(!isdigit(c[i+1])) goto done;
-	} else if(c[i] == '1') {
-		if(c[i+1] < '0' || c[i+1] > '2') goto done;
+	if(c[0] == '0') {
+		if(!isdigit(c[1])) return 0;
+	} else if(c[0] == '1') {
+		if(c[1] < '0' || c[1] > '2') return 0;
 	} else {
-		goto done;
+		return 0;
 	}
-	if(c[i+2] != ':') goto done;
-	if(c[i+3] < '0' || c[i+3] > '5') goto done;
-	if(!isdigit(c[i+4])) goto done;
-	if(c[i+5] != ':') goto done;
-	if(c[i+6] < '0' || c[i+6] > '5') goto done;
-	if(!isdigit(c[i+7])) goto done;
-
-	/* success, persist */
-	CHKN(*value = ee_newValue(ctx));
-	CHKN(valstr = es_newStrFromSubStr(str, *offs, 8));
-	ee_setStrValue(*value, valstr);
-	*offs += 8;
-	r = 0;
+	return chkMinSec(c, probe);
+}
 
-done:	return r;
-ENDParser
+/**
+ * Parse a timestamp in 12hr format.
+ */
+PARSER_FROM_PROBE(Time12hr)
 
 
 
 
-/* helper to IPv4 address parser, checks the next set of numbers.
+/* helper to IPv4 address probe, checks the next set of numbers.
  * Syntax 1 to 3 digits, value together not larger than 255.
- * @param[in] str parse buffer
+ * @param[in] c parse buffer
+ * @param[in] len length of parse buffer
  * @param[in/out] offs offset into buffer, updated if successful
+ * @param[in/out] addr address, the byte is shifted in if successful
  * @return 0 if OK, 1 otherwise
  */
-static int
-chkIPv4AddrByte(es_str_t *str, es_size_t *offs)
+static inline int
+chkIPv4AddrByte(unsigned char *c, es_size_t len, es_size_t *offs, unsigned *addr)
 {
 	int val = 0;
 	int r = 1;	/* default: fail -- simplifies things */
-	unsigned char *c = es_getBufAddr(str);
 	es_size_t i = *offs;
 
-	if(i == es_strlen(str) || !isdigit(c[i])) goto done;
+	if(i == len || !isdigit(c[i])) goto done;
 	val = c[i++] - '0';
-	if(i < es_strlen(str) && isdigit(c[i])) {
+	if(i < len && isdigit(c[i])) {
 		val = val * 10 + c[i++] - '0';
-		if(i < es_strlen(str) && isdigit(c[i]))
+		if(i < len && isdigit(c[i]))
 			val = val * 10 + c[i++] - '0';
 	}
 	if(val > 255)	/* cannot be a valid IP address byte! */
 		goto done;
 
 	*offs = i;
+	*addr = (*addr << 8) | val;
 	r = 0;
 
 done:	return r;
 }
+
 /**
- * Parser for IPv4 addresses.
+ * Probe for IPv4 addresses.
  */
-BEGINParser(IPv4)
-	unsigned char *c;
-	es_size_t i;
-	es_str_t *valstr;
+es_size_t
+ee_probeIPv4(ee_ctx __attribute__((unused)) ctx, unsigned char *c, es_size_t len,
+	     es_str_t __attribute__((unused)) *ed, struct ee_probe *probe)
+{
+	es_size_t i = 0;
+	unsigned addr = 0;
 
-	assert(str != NULL);
-	assert(offs != NULL);
-	i = *offs;
-	if(es_strlen(str) - i + 1 < 7) {
-		/* IPv4 addr requires at least 7 characters */
-		r = EE_WRONGPARSER;
-		goto done;
-	}
-	c = es_getBufAddr(str);
+	if(len < 7)	/* IPv4 addr requires at least 7 characters */
+		goto fail;
 
-	r = EE_WRONGPARSER; /* let's assume things go wrong, leads to simpler code */
 	/* byte 1*/
-	if(chkIPv4AddrByte(str, &i) != 0) goto done;
-	if(i == es_strlen(str) || c[i++] != '.') goto done;
+	if(chkIPv4AddrByte(c, len, &i, &addr) != 0) goto fail;
+	if(i == len || c[i++] != '.') goto fail;
 	/* byte 2*/
-	if(chkIPv4AddrByte(str, &i) != 0) goto done;
-	if(i == es_strlen(str) || c[i++] != '.') goto done;
+	if(chkIPv4AddrByte(c, len, &i, &addr) != 0) goto fail;
+	if(i == len || c[i++] != '.') goto fail;
 	/* byte 3*/
-	if(chkIPv4AddrByte(str, &i) != 0) goto done;
-	if(i == es_strlen(str) || c[i++] != '.') goto done;
+	if(chkIPv4AddrByte(c, len, &i, &addr) != 0) goto fail;
+	if(i == len || c[i++] != '.') goto fail;
 	/* byte 4 - we do NOT need any char behind it! */
-	if(chkIPv4AddrByte(str, &i) != 0) goto done;
+	if(chkIPv4AddrByte(c, len, &i, &addr) != 0) goto fail;
 
 	/* if we reach this point, we found a valid IP address */
-	CHKN(*value = ee_newValue(ctx));
-	CHKN(valstr = es_newStrFromSubStr(str, *offs, i - *offs));
-	ee_setStrValue(*value, valstr);
-	*offs = i;
-	r = 0;
+	SET_PROBE(probe, EE_PROBE_IPV4, 0, i);
+	probe->v.ipv4 = addr;
+	return i;
 
-done:	return r;
-ENDParser
+fail:
+	return 0;
+}
+
+/**
+ * Parser for IPv4 addresses.
+ */
+PARSER_FROM_PROBE(IPv4)
+
+
+/* Hex digit classification: a single table lookup both checks if a
+ * character is a hex digit and provides its value. This is what the
+ * IPv6 and MAC address probes spend most of their time on.
+ */
+#define X 0xff
+static const unsigned char hexVal[256] = {
+	X, X, X, X, X, X, X, X, X, X, X, X, X, X, X, X,
+	X, X, X, X, X, X, X, X, X, X, X, X, X, X, X, X,
+	X, X, X, X, X, X, X, X, X, X, X, X, X, X, X, X,
+	0, 1, 2, 3, 4, 5, 6, 7, 8, 9, X, X, X, X, X, X,
+	X, 10, 11, 12, 13, 14, 15, X, X, X, X, X, X, X, X, X,
+	X, X, X, X, X, X, X, X, X, X, X, X, X, X, X, X,
+	X, 10, 11, 12, 13, 14, 15, X, X, X, X, X, X, X, X, X,
+	X, X, X, X, X, X, X, X, X, X, X, X, X, X, X, X,
+	X, X, X, X, X, X, X, X, X, X, X, X, X, X, X, X,
+	X, X, X, X, X, X, X, X, X, X, X, X, X, X, X, X,
+	X, X, X, X, X, X, X, X, X, X, X, X, X, X, X, X,
+	X, X, X, X, X, X, X, X, X, X, X, X, X, X, X, X,
+	X, X, X, X, X, X, X, X, X, X, X, X, X, X, X, X,
+	X, X, X, X, X, X, X, X, X, X, X, X, X, X, X, X,
+	X, X, X, X, X, X, X, X, X, X, X, X, X, X, X, X,
+	X, X, X, X, X, X, X, X, X, X, X, X, X, X, X, X,
+};
+#undef X
+#define ISHEX(c) (hexVal[(c)] != 0xff)
+
+
+/* Scan an IPv6 address in any of the text forms of RFC4291 (full,
+ * compressed via "::" and with embedded IPv4 address).
+ * @return number of characters used, 0 if there is no IPv6 address
+ */
+static es_size_t
+scanIPv6(unsigned char *c, es_size_t len, unsigned char *addr)
+{
+	unsigned grp[8];
+	int nGrp = 0;
+	int dblColon = -1;	/* group index where "::" is, -1 if none */
+	es_size_t i = 0, start;
+	struct ee_probe v4;
+	unsigned v;
+	int j, k;
+
+	if(len >= 2 && c[0] == ':' && c[1] == ':') {
+		dblColon = 0;
+		i = 2;
+	}
+	while(nGrp < 8) {
+		start = i;
+		for(v = 0 ; i < len && i - start < 4 && ISHEX(c[i]) ; ++i)
+			v = (v << 4) | hexVal[c[i]];
+		if(i == start)
+			break; /* "::" at end of address */
+		if(i < len && c[i] == '.') {
+			/* embedded IPv4 address, must be the last part */
+			if(nGrp > 6 || ee_probeIPv4(NULL, c + start, len - start, NULL, &v4) == 0)
+				return 0;
+			i = start + v4.lenVal;
+			grp[nGrp++] = v4.v.ipv4 >> 16;
+			grp[nGrp++] = v4.v.ipv4 & 0xffff;
+			break;
+		}
+		if(i < len && ISHEX(c[i]))
+			return 0; /* more than four hex digits */
+		grp[nGrp++] = v;
+		if(i + 1 < len && c[i] == ':' && c[i+1] == ':') {
+			if(dblColon != -1)
+				return 0;
+			dblColon = nGrp;
+			i += 2;
+		} else if(i + 1 < len && c[i] == ':' && ISHEX(c[i+1])) {
+			++i;
+		} else {
+			break;
+		}
+	}
+	if(dblColon == -1 ? nGrp != 8 : nGrp > 7)
+		return 0;
+
+	/* expand "::" */
+	memset(addr, 0, 16);
+	k = (dblColon == -1) ? nGrp : dblColon;
+	for(j = 0 ; j < k ; ++j) {
+		addr[2*j] = grp[j] >> 8;
+		addr[2*j+1] = grp[j] & 0xff;
+	}
+	for(j = 8 - (nGrp - k) ; k < nGrp ; ++j, ++k) {
+		addr[2*j] = grp[k] >> 8;
+		addr[2*j+1] = grp[k] & 0xff;
+	}
+	return i;
+}
+
+
+/* Scan a CIDR prefix length ("/nn") of at most max.
+ * @return number of characters used, 0 if there is no valid prefix
+ */
+static inline es_size_t
+scanPrefixLen(unsigned char *c, es_size_t len, unsigned max, unsigned char *prefixLen)
+{
+	es_size_t i;
+	unsigned v = 0;
+
+	if(len < 2 || c[0] != '/')
+		return 0;
+	for(i = 1 ; i < len && i < 5 && ISDIGIT(c[i]) ; ++i)
+		v = v * 10 + DIGIT(c[i]);
+	if(i == 1 || v > max || (i < len && ISDIGIT(c[i])))
+		return 0;
+	*prefixLen = v;
+	return i;
+}
+
+
+/**
+ * Probe for IPv6 addresses.
+ */
+es_size_t
+ee_probeIPv6(ee_ctx __attribute__((unused)) ctx, unsigned char *c, es_size_t len,
+	     es_str_t __attribute__((unused)) *ed, struct ee_probe *probe)
+{
+	es_size_t i;
+
+	if((i = scanIPv6(c, len, probe->v.net.addr)) == 0)
+		return 0;
+	SET_PROBE(probe, EE_PROBE_NET, 0, i);
+	probe->v.net.type = EE_NET_IPV6;
+	probe->v.net.prefixLen = EE_NET_NOPREFIX;
+	return i;
+}
+
+/**
+ * Parser for IPv6 addresses.
+ */
+PARSER_FROM_PROBE(IPv6)
+
+
+/**
+ * Probe for MAC addresses. We support the common notations with colons
+ * or dashes (00:11:22:33:44:55) as well as the one used by Cisco
+ * (0011.2233.4455).
+ */
+es_size_t
+ee_probeMAC(ee_ctx __attribute__((unused)) ctx, unsigned char *c, es_size_t len,
+	    es_str_t __attribute__((unused)) *ed, struct ee_probe *probe)
+{
+	unsigned char *addr = probe->v.net.addr;
+	unsigned char sep;
+	es_size_t i, used;
+	int j;
+
+	if(len < 14)
+		return 0;
+	if(len >= 17 && (c[2] == ':' || c[2] == '-')) {
+		sep = c[2];
+		for(i = 0, j = 0 ; j < 6 ; ++j, i += 3) {
+			if(!ISHEX(c[i]) || !ISHEX(c[i+1]) || (j < 5 && c[i+2] != sep))
+				return 0;
+			addr[j] = (hexVal[c[i]] << 4) | hexVal[c[i+1]];
+		}
+		used = 17;
+	} else if(c[4] == '.' && c[9] == '.') {
+		for(i = 0, j = 0 ; j < 6 ; j += 2, i += 5) {
+			if(   !ISHEX(c[i]) || !ISHEX(c[i+1])
+			   || !ISHEX(c[i+2]) || !ISHEX(c[i+3]))
+				return 0;
+			addr[j] = (hexVal[c[i]] << 4) | hexVal[c[i+1]];
+			addr[j+1] = (hexVal[c[i+2]] << 4) | hexVal[c[i+3]];
+		}
+		used = 14;
+	} else {
+		return 0;
+	}
+	if(used < len && ISHEX(c[used]))
+		return 0;
+	SET_PROBE(probe, EE_PROBE_NET, 0, used);
+	probe->v.net.type = EE_NET_MAC;
+	probe->v.net.prefixLen = EE_NET_NOPREFIX;
+	return used;
+}
+
+/**
+ * Parser for MAC addresses.
+ */
+PARSER_FROM_PROBE(MAC)
+
+
+/**
+ * Probe for CIDR networks (IPv4 or IPv6 address with prefix length,
+ * e.g. 10.0.0.0/8 or 2001:db8::/32).
+ */
+es_size_t
+ee_probeCIDR(ee_ctx __attribute__((unused)) ctx, unsigned char *c, es_size_t len,
+	     es_str_t __attribute__((unused)) *ed, struct ee_probe *probe)
+{
+	struct ee_netaddr *net = &probe->v.net;
+	es_size_t i, lenPrefix;
+	struct ee_probe v4;
+
+	if((i = ee_probeIPv4(NULL, c, len, NULL, &v4)) != 0) {
+		net->type = EE_NET_IPV4;
+		net->addr[0] = v4.v.ipv4 >> 24;
+		net->addr[1] = (v4.v.ipv4 >> 16) & 0xff;
+		net->addr[2] = (v4.v.ipv4 >> 8) & 0xff;
+		net->addr[3] = v4.v.ipv4 & 0xff;
+	} else if((i = scanIPv6(c, len, net->addr)) != 0) {
+		net->type = EE_NET_IPV6;
+	} else {
+		return 0;
+	}
+	lenPrefix = scanPrefixLen(c + i, len - i, net->type == EE_NET_IPV4 ? 32 : 128,
+				  &net->prefixLen);
+	if(lenPrefix == 0)
+		return 0;
+	i += lenPrefix;
+	SET_PROBE(probe, EE_PROBE_NET, 0, i);
+	return i;
+}
+
+/**
+ * Parser for CIDR networks.
+ */
+PARSER_FROM_PROBE(CIDR)
@@ -0,0 +1,281 @@
+/**
+ * @file recognizer.c
+ * Implements the recognizer (first-byte dispatch over registered parsers).
+ *//*
+ * Libee - An Event Expression Library inspired by CEE
+ * Copyright 2012 by Rainer Gerhards and Adiscon GmbH.
+ *
+ * This file is part of libee.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * A copy of the LGPL v2.1 can be found in the file "COPYING" in this distribution.
+ */
+#include "config.h"
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include "libee/libee.h"
+#include "libee/recognizer.h"
+#include "libee/internal.h"
+
+/* the slot indexes are unsigned chars */
+#define MAX_CANDS 255
+
+
+/* add a parser to the candidate list. The list is sized by the number
+ * of registered parsers, so each one may only be added once.
+ */
+static int
+addCand(struct ee_recognizer *recognizer, struct ee_parser *parser)
+{
+	int r = 0;
+	unsigned i;
+
+	if(parser->flags & EE_PARSER_FLAG_NEEDS_ED) {
+		r = EE_EINVAL;
+		goto done;
+	}
+	for(i = 0 ; i < recognizer->nCands ; ++i)
+		if(recognizer->cands[i].parser == parser)
+			goto done;
+	if(recognizer->nCands == MAX_CANDS) {
+		r = EE_ERR;
+		goto done;
+	}
+	recognizer->cands[recognizer->nCands].parser = parser;
+	recognizer->cands[recognizer->nCands].hits = 0;
+	recognizer->nCands++;
+
+done:
+	return r;
+}
+
+
+/* collect the candidates from a comma-delimited list of names */
+static int
+addCandsByName(struct ee_recognizer *recognizer, char *names)
+{
+	int r = 0;
+	char *list = NULL;
+	char *name, *next;
+	struct ee_parser *parser;
+
+	CHKN(list = strdup(names));
+	for(name = list ; name != NULL ; name = next) {
+		if((next = strchr(name, ',')) != NULL)
+			*next++ = '\0';
+		if((parser = ee_findParser(recognizer->ctx, name)) == NULL) {
+			DBGPRINTF(recognizer->ctx, EE_DBG_ERR, "recognizer: unknown parser '%s'", name);
+			r = EE_NOTFOUND;
+			goto done;
+		}
+		CHKR(addCand(recognizer, parser));
+	}
+
+done:
+	free(list);
+	return r;
+}
+
+
+/* Build the dispatch table. For each byte, specific parsers come first,
+ * catch-all parsers last (in registration order).
+ */
+static void
+buildTable(struct ee_recognizer *recognizer)
+{
+	unsigned c, i;
+	unsigned char *slot;
+	struct ee_parser *parser;
+	int bCatchAll;
+
+	for(c = 0 ; c < 256 ; ++c) {
+		slot = recognizer->slots + c * recognizer->nCands;
+		recognizer->nTotal[c] = 0;
+		for(bCatchAll = 0 ; bCatchAll < 2 ; ++bCatchAll) {
+			for(i = 0 ; i < recognizer->nCands ; ++i) {
+				parser = recognizer->cands[i].parser;
+				if(   !(parser->flags & EE_PARSER_FLAG_CATCHALL) == !bCatchAll
+				   && ee_parserAcceptsByte(parser, c))
+					slot[recognizer->nTotal[c]++] = i;
+			}
+			if(!bCatchAll)
+				recognizer->nSpecific[c] = recognizer->nTotal[c];
+		}
+	}
+}
+
+
+struct ee_recognizer*
+ee_newRecognizer(ee_ctx ctx, char *names)
+{
+	int r = 0;
+	struct ee_recognizer *recognizer;
+	struct ee_parser *parser;
+	unsigned nParsers = 0;
+
+	assert(ctx != NULL);assert(ctx->objID == ObjID_CTX);
+	CHKN(recognizer = calloc(1, sizeof(struct ee_recognizer)));
+	recognizer->objID = ObjID_RECOGNIZER;
+	recognizer->ctx = ctx;
+
+	for(parser = ctx->parsers ; parser != NULL ; parser = parser->next)
+		++nParsers;
+	if(nParsers == 0) {
+		r = EE_NOTFOUND;
+		goto done;
+	}
+	CHKN(recognizer->cands = malloc(nParsers * sizeof(struct ee_recognizer_cand)));
+
+	if(names == NULL) {
+		for(parser = ctx->parsers ; parser != NULL ; parser = parser->next)
+			if(!(parser->flags & EE_PARSER_FLAG_NEEDS_ED))
+				CHKR(addCand(recognizer, parser));
+	} else {
+		CHKR(addCandsByName(recognizer, names));
+	}
+
+	if(recognizer->nCands > 0) {
+		CHKN(recognizer->slots = malloc(256 * recognizer->nCands));
+		buildTable(recognizer);
+	}
+
+done:
+	if(r != 0 && recognizer != NULL) {
+		ee_deleteRecognizer(recognizer);
+		recognizer = NULL;
+	}
+	return recognizer;
+}
+
+
+void
+ee_deleteRecognizer(struct ee_recognizer *recognizer)
+{
+	assert(recognizer != NULL);assert(recognizer->objID == ObjID_RECOGNIZER);
+	recognizer->objID = ObjID_DELETED;
+	free(recognizer->cands);
+	free(recognizer->slots);
+	free(recognizer);
+}
+
+
+/* Record a hit of the candidate at position i of the slot. If it now has
+ * more hits than its predecessor, the two are swapped. Over time, this
+ * orders the slot by hit rate, at a very low cost per recognition.
+ * Catch-all candidates always stay behind the specific ones.
+ */
+static inline void
+recordHit(struct ee_recognizer *recognizer, unsigned char *slot, unsigned c, unsigned i)
+{
+	unsigned char tmp;
+
+	recognizer->cands[slot[i]].hits++;
+	if(   i > 0 && i < recognizer->nSpecific[c]
+	   && recognizer->cands[slot[i]].hits > recognizer->cands[slot[i-1]].hits) {
+		tmp = slot[i-1];
+		slot[i-1] = slot[i];
+		slot[i] = tmp;
+	}
+}
+
+
+/* try a candidate; returns the match length or 0 if it does not match
+ * (or -1 if an error occured). The match must cover the full value.
+ */
+static int
+tryCand(struct ee_recognizer *recognizer, struct ee_parser *cand, es_str_t *str,
+	es_size_t offs, struct ee_value **value)
+{
+	int r;
+	struct ee_probe probe;
+	struct ee_value *val;
+	es_size_t offsParser;
+	es_size_t len = es_strlen(str) - offs;
+	unsigned char *buf = es_getBufAddr(str) + offs;
+
+	if(len < cand->minLen)
+		return 0;
+	if(cand->probe != NULL) {
+		if((r = cand->probe(recognizer->ctx, buf, len, NULL, &probe)) == 0)
+			return 0;
+		if((es_size_t) r < len && buf[r] != ' ')
+			return 0;
+		/* we only materialize the winner */
+		if(value != NULL && ee_newValueFromProbe(recognizer->ctx, buf, &probe, value) != 0)
+			return -1;
+		return r;
+	}
+
+	/* no probe, so we need to call the (allocating) parser */
+	offsParser = offs;
+	r = cand->parse(recognizer->ctx, str, &offsParser, NULL, &val);
+	if(r == EE_WRONGPARSER)
+		return 0;
+	if(r != 0)
+		return -1;
+	if(offsParser < es_strlen(str) && es_getBufAddr(str)[offsParser] != ' ') {
+		ee_deleteValue(val);
+		return 0;
+	}
+	if(value == NULL)
+		ee_deleteValue(val);
+	else
+		*value = val;
+	return offsParser - offs;
+}
+
+
+int
+ee_recognize(struct ee_recognizer *recognizer, es_str_t *str, es_size_t *offs,
+	     struct ee_parser **parser, struct ee_value **value)
+{
+	int r = EE_WRONGPARSER;
+	unsigned c;
+	unsigned i;
+	int len;
+	unsigned char *slot;
+	struct ee_parser *cand;
+
+	assert(recognizer != NULL);assert(recognizer->objID == ObjID_RECOGNIZER);
+	if(*offs >= es_strlen(str))
+		goto done;
+
+	c = es_getBufAddr(str)[*offs];
+	slot = recognizer->slots + c * recognizer->nCands;
+	for(i = 0 ; i < recognizer->nTotal[c] ; ++i) {
+		cand = recognizer->cands[slot[i]].parser;
+		if((len = tryCand(recognizer, cand, str, *offs, value)) == 0)
+			continue;
+		if(len < 0) {
+			r = EE_ERR;
+			goto done;
+		}
+		DBGPRINTF(recognizer->ctx, EE_DBG_TRACE, "recognizer: '%.*s' is %s", len,
+			  (char*) es_getBufAddr(str) + *offs, cand->name);
+		*offs += len;
+		if(parser != NULL)
+			*parser = cand;
+		recordHit(recognizer, slot, c, i);
+		r = 0;
+		break;
+	}
+
+done:
+	return r;
+}
+/* vim :ts=4:sw=4 */
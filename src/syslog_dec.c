@@ -0,0 +1,371 @@
+/**
+ * @file syslog_dec.c
+ * Decoder for RFC5424 structured data (the counterpart of syslog_enc.c).
+ *//*
+ * Libee - An Event Expression Library inspired by CEE
+ * Copyright 2012 by Rainer Gerhards and Adiscon GmbH.
+ *
+ * This file is part of libee.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * A copy of the LGPL v2.1 can be found in the file "COPYING" in this distribution.
+ */
+#include "config.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+
+#include "libee/libee.h"
+#include "libee/syslog.h"
+#include "libee/filter.h"
+#include "libee/internal.h"
+
+#define CEE_SDID "cee@115"
+#define TAGS_PARAM "event.tags"
+
+
+/* Find the next byte inside a PARAM-VALUE that needs attention, that
+ * is a backslash, a quote or a comma. Most values contain none of them
+ * or just the closing quote, so we skip eight plain bytes at a time.
+ * @return offset of that byte, len if there is none
+ */
+static inline es_size_t
+scanPlain(unsigned char *buf, es_size_t i, es_size_t len)
+{
+	unsigned long long x;
+
+	while(len - i >= 8) {
+		memcpy(&x, buf + i, 8);
+		if(SWAR_HASBYTE(x, '\\') | SWAR_HASBYTE(x, '"') | SWAR_HASBYTE(x, ','))
+			break;
+		i += 8;
+	}
+	while(i < len && buf[i] != '\\' && buf[i] != '"' && buf[i] != ',')
+		++i;
+	return i;
+}
+
+
+/* add the value string to the field (an empty one if it does not exist) */
+static int
+finishValue(ee_ctx ctx, struct ee_field *field, es_str_t **valstr)
+{
+	int r;
+	struct ee_value *val;
+
+	if(*valstr == NULL)
+		CHKN(*valstr = es_newStr(1));
+	CHKN(val = ee_newValue(ctx));
+	STATS_ADD(ctx, bytesCopied, es_strlen(*valstr));
+	ee_setStrValue(val, *valstr);
+	*valstr = NULL;
+	if((r = ee_addValueToField(field, val)) != 0)
+		ee_deleteValue(val);
+
+done:
+	return r;
+}
+
+
+/* Parse a PARAM-VALUE (after the opening quote) into the values of
+ * field. All escapes are resolved in this single pass. If field is NULL,
+ * the value is just skipped.
+ */
+static int
+parseParamValue(ee_ctx ctx, unsigned char *buf, es_size_t len, es_size_t *offs,
+		struct ee_field *field)
+{
+	int r;
+	es_size_t i = *offs, j;
+	es_str_t *valstr = NULL;
+	es_str_t **pval = (field == NULL) ? NULL : &valstr;
+	char c;
+
+	while(1) {
+		j = scanPlain(buf, i, len);
+		if(j == len) {
+			r = EE_INVLDFMT; /* unterminated value */
+			goto done;
+		}
+		CHKR(ee_addToValStr(pval, buf + i, j - i));
+		if(buf[j] == '"') {
+			i = j + 1;
+			break;
+		} else if(buf[j] == ',') {
+			if(field != NULL)
+				CHKR(finishValue(ctx, field, &valstr));
+			i = j + 1;
+		} else { /* backslash */
+			if(j + 1 == len) {
+				r = EE_INVLDFMT;
+				goto done;
+			}
+			switch(buf[j+1]) {
+			case '\\':
+			case '"':
+			case ']':
+			case ',':
+				c = buf[j+1];
+				CHKR(ee_addToValStr(pval, (unsigned char*) &c, 1));
+				break;
+			case '0':
+				c = '\0';
+				CHKR(ee_addToValStr(pval, (unsigned char*) &c, 1));
+				break;
+			case 'n':
+				c = '\n';
+				CHKR(ee_addToValStr(pval, (unsigned char*) &c, 1));
+				break;
+			default: /* not an escape, RFC5424 says to keep it */
+				CHKR(ee_addToValStr(pval, buf + j, 2));
+				break;
+			}
+			i = j + 2;
+		}
+	}
+	if(field != NULL)
+		CHKR(finishValue(ctx, field, &valstr));
+	*offs = i;
+
+done:
+	if(valstr != NULL)
+		es_deleteStr(valstr);
+	return r;
+}
+
+
+/* add the values of the tags parameter as tags to the event */
+static int
+addTags(struct ee_event *event, struct ee_field *field)
+{
+	int r = 0;
+	struct ee_valnode *node;
+
+	if(field->nVals == 0)
+		goto done;
+	CHKR(ee_addTagToEvent(event, field->val->val.str));
+	for(node = field->valroot ; node != NULL ; node = node->next)
+		CHKR(ee_addTagToEvent(event, node->val->val.str));
+
+done:
+	return r;
+}
+
+
+/* Parse a SD-ELEMENT (starting at the opening bracket) and add its
+ * parameters to the event. If there is a filter, fstate is its state,
+ * otherwise NULL.
+ */
+static int
+parseElement(ee_ctx ctx, unsigned char *buf, es_size_t len, es_size_t *offs,
+	     struct ee_event *event, struct ee_filterState *fstate)
+{
+	int r;
+	es_size_t i = *offs + 1;
+	es_size_t idStart, idLen, nameStart;
+	int bCee, bTags, bProjected;
+	struct ee_field *field = NULL;
+	es_str_t *name = NULL;
+	unsigned char *nameBuf;
+	es_size_t nameLen;
+	unsigned hash;
+	unsigned long long fterms;
+
+	/* SD-ID */
+	idStart = i;
+	while(i < len && buf[i] != ' ' && buf[i] != ']' && buf[i] != '=' && buf[i] != '"')
+		++i;
+	idLen = i - idStart;
+	if(idLen == 0) {
+		r = EE_INVLDFMT;
+		goto done;
+	}
+	bCee = (idLen == sizeof(CEE_SDID) - 1 && !memcmp(buf + idStart, CEE_SDID, idLen));
+
+	/* SD-PARAMs */
+	while(1) {
+		if(i == len) {
+			r = EE_INVLDFMT;
+			goto done;
+		}
+		if(buf[i] == ']') {
+			++i;
+			break;
+		}
+		if(buf[i] != ' ') {
+			r = EE_INVLDFMT;
+			goto done;
+		}
+		++i;
+		nameStart = i;
+		while(i < len && buf[i] != '=' && buf[i] != ' ' && buf[i] != ']' && buf[i] != '"')
+			++i;
+		if(i == nameStart || len - i < 2 || buf[i] != '=' || buf[i+1] != '"') {
+			r = EE_INVLDFMT;
+			goto done;
+		}
+
+		if(bCee) {
+			nameBuf = buf + nameStart;
+			nameLen = i - nameStart;
+			bTags = (   nameLen == sizeof(TAGS_PARAM) - 1
+				 && !memcmp(nameBuf, TAGS_PARAM, nameLen));
+		} else {
+			bTags = 0;
+			CHKN(name = es_newStrFromBuf((char*) buf + idStart, idLen + 1));
+			es_getBufAddr(name)[idLen] = '.';
+			CHKR(es_addBuf(&name, (char*) buf + nameStart, i - nameStart));
+			nameBuf = es_getBufAddr(name);
+			nameLen = es_strlen(name);
+		}
+		hash = ee_hashName(nameBuf, nameLen);
+		/* tags are checked when the event is complete */
+		bProjected = bTags || ee_isProjected(ctx, nameBuf, nameLen, hash);
+		fterms = (fstate != NULL && !bTags) ? ee_filterTerms(ctx, nameBuf, nameLen, hash) : 0;
+		i += 2;
+		if(!bProjected && !fterms) {
+			if(name != NULL) {
+				es_deleteStr(name);
+				name = NULL;
+			}
+			CHKR(parseParamValue(ctx, buf, len, &i, NULL));
+			continue;
+		}
+		if(name == NULL)
+			CHKN(name = es_newStrFromBuf((char*) nameBuf, nameLen));
+		CHKN(field = ee_newField(ctx));
+		field->name = name;
+		field->nameHash = hash;
+		name = NULL;
+		CHKR(parseParamValue(ctx, buf, len, &i, field));
+
+		if(fterms)
+			CHKR(ee_filterField(ctx, fstate, fterms, field));
+		if(bTags)
+			CHKR(addTags(event, field));
+		if(bProjected && !bTags) {
+			CHKR(ee_addFieldToEvent(event, field));
+		} else {
+			ee_deleteField(field);
+		}
+		field = NULL;
+	}
+	*offs = i;
+	r = 0;
+
+done:
+	if(name != NULL)
+		es_deleteStr(name);
+	if(field != NULL)
+		ee_deleteField(field);
+	return r;
+}
+
+
+/* Decode STRUCTURED-DATA into a new event. Anything after the last
+ * SD-ELEMENT (usually the MSG part) is ignored.
+ */
+static int
+decodeSD(ee_ctx ctx, unsigned char *buf, es_size_t len, struct ee_event **event)
+{
+	int r;
+	es_size_t i = 0;
+	struct ee_filterState fstate = { 0 };
+	STATS_TIMER_DECL
+
+	STATS_TIMER_START;
+	*event = NULL;
+	while(i < len && buf[i] == ' ')
+		++i;
+	if(i == len || (buf[i] != '[' && buf[i] != '-')) {
+		r = EE_INVLDFMT;
+		goto done;
+	}
+	CHKN(*event = ee_newEvent(ctx));
+	/* nothing to do for the NIL value ("-") */
+	while(i < len && buf[i] == '[')
+		CHKR(parseElement(ctx, buf, len, &i, *event,
+				  (ctx->filter == NULL) ? NULL : &fstate));
+	r = 0;
+	if(ctx->filter != NULL)
+		CHKR(ee_filterEvent(ctx, &fstate, *event));
+
+done:
+	if(r != 0) {
+		if(r != EE_FILTERED)
+			DBGPRINTF(ctx, EE_DBG_ERR, "syslog: invalid structured data, error %d", r);
+		if(*event != NULL) {
+			ee_deleteEvent(*event);
+			*event = NULL;
+		}
+	}
+	if(r == 0)
+		STATS_INC(ctx, eventsDecoded);
+	else if(r == EE_FILTERED)
+		STATS_INC(ctx, eventsFiltered);
+	STATS_TIMER_STOP(ctx, decodeNs);
+	return r;
+}
+
+
+struct ee_event*
+ee_newEventFromRFC5424(ee_ctx ctx, es_str_t *str)
+{
+	struct ee_event *event;
+
+	decodeSD(ctx, es_getBufAddr(str), es_strlen(str), &event);
+	return event;
+}
+
+
+int
+ee_syslogSDDec(ee_ctx ctx, int (*cbGetLine)(es_str_t **ln),
+	       int (*cbNewEvt)(struct ee_event *event),
+	       es_str_t **errMsg)
+{
+	int r;
+	int lnNbr;
+	es_str_t *ln = NULL;
+	struct ee_event *event;
+	char errMsgBuf[1024];
+	size_t errlen;
+
+	lnNbr = 1;
+	while((r = cbGetLine(&ln)) == 0) {
+		TRACE2(decode_start, "syslog", lnNbr);
+		r = decodeSD(ctx, es_getBufAddr(ln), es_strlen(ln), &event);
+		TRACE3(decode_done, "syslog", lnNbr, r);
+		es_deleteStr(ln);
+		if(r == 0)
+			r = cbNewEvt(event);
+		else if(r == EE_FILTERED)
+			r = 0;
+		if(r != 0) {
+			errlen = snprintf(errMsgBuf, sizeof(errMsgBuf),
+					  "error processing line %d", lnNbr);
+			*errMsg = es_newStrFromCStr(errMsgBuf, errlen);
+			goto done;
+		}
+		lnNbr++;
+	}
+
+	if(r == EE_EOF)
+		r = 0;
+done:
+	return r;
+}
+/* vim :ts=4:sw=4 */
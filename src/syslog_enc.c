@@ -46,8 +46,11 @@ ee_addValue_Syslog(struct ee_value *value, es_str_t **str)
 
 	assert(str != NULL); assert(*str != NULL);
 	assert(value != NULL); assert(value->objID == ObjID_VALUE);
-	// TODO: support other types!
-	assert(value->valtype == ee_valtype_str);
+	if(value->valtype != ee_valtype_str) {
+		/* no escaping needed, see ee_addValueAsStr() */
+		CHKR(ee_addValueAsStr(value, str));
+		goto done;
+	}
 	valstr = value->val.str;
 
 	c = es_getBufAddr(valstr);
@@ -94,6 +97,7 @@ ee_addValue_Syslog(struct ee_value *value, es_str_t **str)
 	}
 	r = 0;
 
+done:
 	return r;
 }
 
@@ -151,8 +155,11 @@ ee_fmtEventToRFC5424(struct ee_event *event, es_str_t **str)
 {
 	int r = -1;
 	struct ee_fieldbucket_listnode *node;
+	STATS_TIMER_DECL
 
 	assert(event != NULL);assert(event->objID == ObjID_EVENT);
+	TRACE2(encode_start, "syslog", event);
+	STATS_TIMER_START;
 	if((*str = es_newStr(256)) == NULL) goto done;
 
 	es_addBuf(str, "[cee@115", 8);
@@ -169,6 +176,9 @@ ee_fmtEventToRFC5424(struct ee_event *event, es_str_t **str)
 	es_addChar(str, ']');
 
 done:
+	STATS_TIMER_STOP(event->ctx, encodeNs);
+	STATS_ENCODED(event->ctx, *str);
+	TRACE3(encode_done, "syslog", event, r);
 	return r;
 }
 /* vim :ts=4:sw=4 */
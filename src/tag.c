@@ -34,11 +34,7 @@
 
 #define ERR_ABORT {r = 1; goto done; }
 
-#define CHECK_TAG \
-	if(tag->o.objID != ObjID_TAG) { \
-		r = -1; \
-		goto done; \
-	}
+#define CHECK_TAG CHKOBJ(&tag->o, ObjID_TAG)
 
 
 struct ee_tag*
@@ -33,11 +33,7 @@
 
 #define ERR_ABORT {r = 1; goto done; }
 
-#define CHECK_TAGBUCKET \
-	if(tagbucket->objID != ObjID_TAGBUCKET) { \
-		r = -1; \
-		goto done; \
-	}
+#define CHECK_TAGBUCKET CHKOBJ(tagbucket, ObjID_TAGBUCKET)
 
 
 struct ee_tagbucket*
@@ -58,6 +54,9 @@ done:	return tagbucket;
 
 /* Add an additional reference to the tag bucket.
  * TODO: atomic instructions for ref counting! -- rgerhards, 2011-04-06
+ * Note that for the time being this is not a real problem, as a
+ * context (and thus all objects created from it) must not be used
+ * concurrently.
  */
 struct ee_tagbucket*
 ee_addRefTagbucket(struct ee_tagbucket *tagbucket)
@@ -68,19 +67,53 @@ ee_addRefTagbucket(struct ee_tagbucket *tagbucket)
 }
 
 
+struct ee_tagbucket*
+ee_dupTagbucket(struct ee_tagbucket *tagbucket)
+{
+	struct ee_tagbucket *newb;
+	struct ee_tagbucket_listnode *tag;
+	es_str_t *name;
+
+	assert(tagbucket->objID == ObjID_TAGBUCKET);
+	if((newb = ee_newTagbucket(tagbucket->ctx)) == NULL)
+		goto done;
+
+	for(tag = tagbucket->root ; tag != NULL ; tag = tag->next) {
+		if(   (name = es_strdup(tag->name)) == NULL
+		   || ee_addTagToBucket(newb, name) != 0) {
+			if(name != NULL)
+				es_deleteStr(name);
+			ee_deleteTagbucket(newb);
+			newb = NULL;
+			goto done;
+		}
+	}
+
+done:	return newb;
+}
+
+
 void
 ee_deleteTagbucket(struct ee_tagbucket *tagbucket)
 {
-	int currRefCount;
+	struct ee_tagbucket_listnode *node, *nodeDel;
 
 	// TODO: use atomic instructions for reference counting!
 	assert(tagbucket->objID == ObjID_TAGBUCKET);
-	currRefCount = tagbucket->refCount--;
-	if(currRefCount == 0) {
-		tagbucket->objID = ObjID_DELETED;
-		// TODO: free list (memleak)
-		free(tagbucket);
+	assert(tagbucket->refCount > 0);
+	if(--tagbucket->refCount > 0)
+		goto done; /* still in use by someone else */
+
+	tagbucket->objID = ObjID_DELETED;
+	for(node = tagbucket->root ; node != NULL ; ) {
+		nodeDel = node;
+		node = node->next;
+		es_deleteStr(nodeDel->name);
+		free(nodeDel);
 	}
+	free(tagbucket);
+
+done:	return;
 }
 
 
@@ -91,6 +124,8 @@ ee_addTagToBucket(struct ee_tagbucket *tagbucket, es_str_t *tagname)
 	int r;
 	struct ee_tagbucket_listnode *node;
 	assert(tagbucket != NULL);assert(tagbucket->objID == ObjID_TAGBUCKET);
+	/* a shared bucket is immutable - users must go through COW */
+	assert(tagbucket->refCount == 1);
 
 	CHKN(node = malloc(sizeof(struct ee_tagbucket_listnode)));
 	node->name = tagname;
@@ -0,0 +1,94 @@
+/**
+ * @file tagset.c
+ * Implements the tagset object.
+ *//*
+ * Libee - An Event Expression Library inspired by CEE
+ * Copyright 2012 by Rainer Gerhards and Adiscon GmbH.
+ *
+ * This file is part of libee.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * A copy of the LGPL v2.1 can be found in the file "COPYING" in this distribution.
+ */
+#include "config.h"
+#include <stdlib.h>
+#include <assert.h>
+
+#include "libee/libee.h"
+#include "libee/internal.h"
+
+
+struct ee_tagset*
+ee_newTagset(ee_ctx ctx)
+{
+	struct ee_tagset *tagset;
+
+	assert(ctx != NULL);assert(ctx->objID == ObjID_CTX);
+	if((tagset = malloc(sizeof(struct ee_tagset))) == NULL)
+		goto done;
+	ee_initObj(ctx, &tagset->o);
+	tagset->o.objID = ObjID_TAGSET;
+	tagset->tags = NULL;
+
+done:
+	return tagset;
+}
+
+
+void
+ee_deleteTagset(struct ee_tagset *tagset)
+{
+	assert(tagset != NULL);assert(tagset->o.objID == ObjID_TAGSET);
+	tagset->o.objID = ObjID_DELETED;
+	if(tagset->tags != NULL)
+		ee_deleteTagbucket(tagset->tags);
+	ee_deinitObj(&tagset->o);
+	free(tagset);
+}
+
+
+int
+ee_addTagToSet(struct ee_tagset *tagset, es_str_t *tagname)
+{
+	int r;
+	struct ee_tagbucket *tags;
+	es_str_t *name;
+
+	assert(tagset != NULL);assert(tagset->o.objID == ObjID_TAGSET);
+	if(tagset->tags == NULL) {
+		CHKN(tagset->tags = ee_newTagbucket(tagset->o.ctx));
+	} else if(ee_TagbucketIsShared(tagset->tags)) {
+		/* events keep the tags they got */
+		CHKN(tags = ee_dupTagbucket(tagset->tags));
+		ee_deleteTagbucket(tagset->tags);
+		tagset->tags = tags;
+	}
+	CHKN(name = es_strdup(tagname));
+	if((r = ee_addTagToBucket(tagset->tags, name)) != 0)
+		es_deleteStr(name);
+
+done:
+	return r;
+}
+
+
+int
+ee_TagsetHasTag(struct ee_tagset *tagset, es_str_t *tagname)
+{
+	assert(tagset != NULL);assert(tagset->o.objID == ObjID_TAGSET);
+	return tagset->tags != NULL && ee_TagbucketHasTag(tagset->tags, tagname);
+}
+/* vim :ts=4:sw=4 */
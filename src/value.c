@@ -27,6 +27,11 @@
 #include <stdio.h>
 #include <stdarg.h>
 #include <assert.h>
+#include <string.h>
+#include <locale.h>
+#ifdef HAVE_XLOCALE_H
+#include <xlocale.h>
+#endif
 
 #include "libee/libee.h"
 #include "libee/internal.h"
@@ -39,9 +44,11 @@ ee_newValue(ee_ctx ctx)
 	struct ee_value *value;
 	if((value = malloc(sizeof(struct ee_value))) == NULL)
 		goto done;
+	STATS_INC(ctx, valuesAlloced);
 	value->objID = ObjID_VALUE;
 	value->valtype = ee_valtype_none;
 	value->val.str = NULL;
+	value->refCount = 1;
 
 done:
 	return value;
@@ -52,7 +59,10 @@ void
 ee_deleteValue(struct ee_value *value)
 {
 	assert(value != NULL); assert(value->objID == ObjID_VALUE);
-	if(value->val.str != NULL)
+	assert(value->refCount > 0);
+	if(--value->refCount > 0)
+		return; /* still shared */
+	if(value->valtype == ee_valtype_str && value->val.str != NULL)
 		es_deleteStr(value->val.str);
 	free(value);
 }
@@ -68,3 +78,238 @@ ee_setStrValue(struct ee_value *value, es_str_t *val)
 	value->val.str = val;
 	return 0;
 }
+
+
+int
+ee_setNbrValue(struct ee_value *value, long long val)
+{
+	assert(value != NULL);
+	assert(value->objID == ObjID_VALUE);
+	assert(value->valtype == ee_valtype_none);
+	value->valtype = ee_valtype_nbr;
+	value->val.number = val;
+	return 0;
+}
+
+
+int
+ee_setDblValue(struct ee_value *value, double val)
+{
+	assert(value != NULL);
+	assert(value->objID == ObjID_VALUE);
+	assert(value->valtype == ee_valtype_none);
+	value->valtype = ee_valtype_dbl;
+	value->val.dbl = val;
+	return 0;
+}
+
+
+int
+ee_setNetValue(struct ee_value *value, struct ee_netaddr *net)
+{
+	assert(value != NULL);
+	assert(value->objID == ObjID_VALUE);
+	assert(value->valtype == ee_valtype_none);
+	value->valtype = ee_valtype_net;
+	value->val.net = *net;
+	return 0;
+}
+
+
+/* Format an IPv6 address as of RFC5952: lower case, leading zeros
+ * suppressed, the longest run (first one on a tie) of at least two
+ * zero groups replaced by "::", and IPv4-mapped addresses with the
+ * IPv4 part in dotted notation.
+ * @return length of formatted address
+ */
+static int
+fmtIPv6(unsigned char *addr, char *buf)
+{
+	unsigned grp[8];
+	int i, len = 0;
+	int best = -1, bestLen = 1;
+	int cur = -1;
+
+	for(i = 0 ; i < 8 ; ++i) {
+		grp[i] = (addr[2*i] << 8) | addr[2*i+1];
+		if(grp[i] == 0) {
+			if(cur == -1)
+				cur = i;
+			if(i - cur + 1 > bestLen) {
+				best = cur;
+				bestLen = i - cur + 1;
+			}
+		} else {
+			cur = -1;
+		}
+	}
+
+	if(best == 0 && bestLen == 5 && grp[5] == 0xffff)
+		return sprintf(buf, "::ffff:%u.%u.%u.%u", addr[12], addr[13], addr[14], addr[15]);
+
+	for(i = 0 ; i < 8 ; ++i) {
+		if(i == best) {
+			buf[len++] = ':';
+			if(i == 0)
+				buf[len++] = ':';
+			i += bestLen - 1;
+			continue;
+		}
+		len += sprintf(buf + len, "%x", grp[i]);
+		if(i < 7)
+			buf[len++] = ':';
+	}
+	buf[len] = '\0';
+	return len;
+}
+
+
+/* format a network address */
+static int
+addNetAddr(struct ee_netaddr *net, es_str_t **str)
+{
+	char buf[64];
+	unsigned char *a = net->addr;
+	int len;
+
+	switch(net->type) {
+	case EE_NET_IPV4:
+		len = sprintf(buf, "%u.%u.%u.%u", a[0], a[1], a[2], a[3]);
+		break;
+	case EE_NET_IPV6:
+		len = fmtIPv6(a, buf);
+		break;
+	case EE_NET_MAC:
+		len = sprintf(buf, "%02x:%02x:%02x:%02x:%02x:%02x",
+			      a[0], a[1], a[2], a[3], a[4], a[5]);
+		break;
+	default:
+		return EE_EINVAL;
+	}
+	if(net->prefixLen != EE_NET_NOPREFIX)
+		len += sprintf(buf + len, "/%u", net->prefixLen);
+	return es_addBuf(str, buf, len);
+}
+
+
+/* Format an integer. We convert two digits at a time, which is
+ * considerably faster than sprintf().
+ * @return length of formatted number (at most 20)
+ */
+static int
+fmtNbr(long long n, char *buf)
+{
+	static const char digitPairs[201] =
+		"0001020304050607080910111213141516171819202122232425262728293031323334353637383940414243444546474849"
+		"5051525354555657585960616263646566676869707172737475767778798081828384858687888990919293949596979899";
+	char tmp[20];
+	int i = 20;
+	int len = 0;
+	unsigned d;
+	unsigned long long u;
+
+	u = (n < 0) ? 0 - (unsigned long long) n : (unsigned long long) n;
+	while(u >= 100) {
+		d = (u % 100) * 2;
+		u /= 100;
+		tmp[--i] = digitPairs[d+1];
+		tmp[--i] = digitPairs[d];
+	}
+	if(u >= 10) {
+		d = u * 2;
+		tmp[--i] = digitPairs[d+1];
+		tmp[--i] = digitPairs[d];
+	} else {
+		tmp[--i] = '0' + u;
+	}
+	if(n < 0)
+		buf[len++] = '-';
+	memcpy(buf + len, tmp + i, 20 - i);
+	return len + 20 - i;
+}
+
+
+#ifdef HAVE_USELOCALE
+/* The C library formats and parses numbers as LC_NUMERIC says, which
+ * the application may have set to a locale with a decimal comma. We
+ * always need '.', so we switch the thread to this one for the calls.
+ */
+static locale_t numLocale = (locale_t) 0;
+#endif
+
+
+void
+ee_initNumLocale(void)
+{
+#ifdef HAVE_USELOCALE
+	if(numLocale == (locale_t) 0)
+		numLocale = newlocale(LC_NUMERIC_MASK, "C", (locale_t) 0);
+#endif
+}
+
+
+double
+ee_strtod(char *str, char **end)
+{
+	double d;
+#ifdef HAVE_USELOCALE
+	locale_t prev = uselocale(numLocale);
+#endif
+
+	d = strtod(str, end);
+#ifdef HAVE_USELOCALE
+	uselocale(prev);
+#endif
+	return d;
+}
+
+
+/* Format a floating point number. We use the shortest of the usual
+ * precisions that reads back to the same value, so that 0.1 is not
+ * printed as 0.10000000000000001.
+ * @return length of formatted number
+ */
+static int
+fmtDbl(double n, char *buf)
+{
+	int len;
+#ifdef HAVE_USELOCALE
+	locale_t prev = uselocale(numLocale);
+#endif
+
+	len = sprintf(buf, "%.15g", n);
+	if(strtod(buf, NULL) != n)
+		len = sprintf(buf, "%.17g", n);
+#ifdef HAVE_USELOCALE
+	uselocale(prev);
+#endif
+	return len;
+}
+
+
+int
+ee_addValueAsStr(struct ee_value *value, es_str_t **str)
+{
+	int r;
+	char numbuf[32];
+
+	assert(value != NULL); assert(value->objID == ObjID_VALUE);
+	switch(value->valtype) {
+	case ee_valtype_str:
+		r = es_addStr(str, value->val.str);
+		break;
+	case ee_valtype_nbr:
+		r = es_addBuf(str, numbuf, fmtNbr(value->val.number, numbuf));
+		break;
+	case ee_valtype_dbl:
+		r = es_addBuf(str, numbuf, fmtDbl(value->val.dbl, numbuf));
+		break;
+	case ee_valtype_net:
+		r = addNetAddr(&value->val.net, str);
+		break;
+	default:
+		r = EE_EINVAL;
+		break;
+	}
+	return r;
+}
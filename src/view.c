@@ -0,0 +1,343 @@
+/**
+ * @file view.c
+ * Implements read-only event views over binary records, as well as
+ * access to (memory-mapped) spool files.
+ *//*
+ * Libee - An Event Expression Library inspired by CEE
+ * Copyright 2012 by Rainer Gerhards and Adiscon GmbH.
+ *
+ * This file is part of libee.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * A copy of the LGPL v2.1 can be found in the file "COPYING" in this distribution.
+ */
+#include "config.h"
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#ifdef HAVE_SYS_MMAN_H
+#include <sys/mman.h>
+#endif
+
+#include "libee/libee.h"
+#include "libee/view.h"
+#include "libee/internal.h"
+
+#if defined(HAVE_MMAP) && defined(HAVE_SYS_MMAN_H)
+#define USE_MMAP 1
+#endif
+
+
+/* read the complete file into memory, used if we cannot mmap() */
+static int
+readSpool(int fd, struct ee_spool *spool)
+{
+	int r = 0;
+	ssize_t n;
+	size_t offs = 0;
+
+	CHKN(spool->buf = malloc(spool->len));
+	while(offs < spool->len) {
+		n = read(fd, spool->buf + offs, spool->len - offs);
+		if(n <= 0) {
+			r = EE_ERR;
+			goto done;
+		}
+		offs += n;
+	}
+
+done:
+	return r;
+}
+
+
+struct ee_spool*
+ee_openSpool(ee_ctx ctx, char *path)
+{
+	int r = 0;
+	int fd = -1;
+	struct stat st;
+	struct ee_spool *spool;
+
+	CHKN(spool = calloc(1, sizeof(struct ee_spool)));
+	spool->objID = ObjID_SPOOL;
+	spool->ctx = ctx;
+
+	if((fd = open(path, O_RDONLY)) == -1 || fstat(fd, &st) == -1) {
+		r = EE_ERR;
+		goto done;
+	}
+	spool->len = st.st_size;
+	if(spool->len == 0)
+		goto done; /* nothing to map, an empty spool is OK */
+
+#ifdef USE_MMAP
+	spool->buf = mmap(NULL, spool->len, PROT_READ, MAP_PRIVATE, fd, 0);
+	if(spool->buf != MAP_FAILED) {
+		spool->bMapped = 1;
+#	ifdef HAVE_MADVISE
+		madvise(spool->buf, spool->len, MADV_SEQUENTIAL);
+#	endif
+		goto done;
+	}
+	spool->buf = NULL;
+#endif
+	r = readSpool(fd, spool);
+
+done:
+	if(fd != -1)
+		close(fd);
+	if(r != 0 && spool != NULL) {
+		ee_closeSpool(spool);
+		spool = NULL;
+	}
+	return spool;
+}
+
+
+void
+ee_closeSpool(struct ee_spool *spool)
+{
+	assert(spool != NULL);assert(spool->objID == ObjID_SPOOL);
+#ifdef USE_MMAP
+	if(spool->bMapped)
+		munmap(spool->buf, spool->len);
+	else
+#endif
+		free(spool->buf);
+	spool->objID = ObjID_DELETED;
+	free(spool);
+}
+
+
+int
+ee_viewFromBuf(ee_ctx ctx, unsigned char *buf, size_t lenBuf, struct ee_eventview *view)
+{
+	int r;
+
+	CHKR(ee_binParseRecord(buf, lenBuf, &view->rec));
+	view->ctx = ctx;
+	view->curName = 0;
+	view->curNamePos = view->rec.names;
+
+done:
+	return r;
+}
+
+
+int
+ee_spoolGetNextView(struct ee_spool *spool, struct ee_eventview *view)
+{
+	int r;
+
+	assert(spool != NULL);assert(spool->objID == ObjID_SPOOL);
+	if(spool->offs == spool->len) {
+		r = EE_EOF;
+		goto done;
+	}
+	CHKR(ee_viewFromBuf(spool->ctx, spool->buf + spool->offs,
+			    spool->len - spool->offs, view));
+	spool->offs += view->rec.len;
+
+done:
+	return r;
+}
+
+
+/* Resolve a name ID. Fields are usually accessed in sequence and the
+ * encoder assigns IDs in order of first use, so we keep a cursor into
+ * the dictionary and walk forward from it if possible.
+ */
+static int
+getName(struct ee_eventview *view, unsigned id, unsigned char **name, es_size_t *len)
+{
+	int r;
+	unsigned char *p;
+	unsigned cur;
+
+	if(id < view->curName) {
+		p = view->rec.names;
+		cur = 0;
+	} else {
+		p = view->curNamePos;
+		cur = view->curName;
+	}
+	for( ; cur < id ; ++cur)
+		CHKR(ee_binGetStr(&p, view->rec.end, name, len));
+	view->curName = id;
+	view->curNamePos = p;
+	r = ee_binGetStr(&p, view->rec.end, name, len);
+
+done:
+	return r;
+}
+
+
+/* find the ID of a name, returns EE_NOTFOUND if the name is not in the
+ * dictionary
+ */
+static int
+findName(struct ee_eventview *view, unsigned char *name, es_size_t len, unsigned *id)
+{
+	int r;
+	unsigned char *p = view->rec.names;
+	unsigned char *str;
+	es_size_t lenStr;
+	unsigned i;
+
+	for(i = 0 ; i < view->rec.nNames ; ++i) {
+		CHKR(ee_binGetStr(&p, view->rec.end, &str, &lenStr));
+		if(lenStr == len && !memcmp(str, name, len)) {
+			*id = i;
+			goto done;
+		}
+	}
+	r = EE_NOTFOUND;
+
+done:
+	return r;
+}
+
+
+/* skip a number of values */
+static inline int
+skipValues(unsigned char **pp, unsigned char *end, unsigned nVals)
+{
+	int r = 0;
+	struct ee_binvalue val;
+
+	while(nVals-- > 0)
+		CHKR(ee_binGetValue(pp, end, &val));
+
+done:
+	return r;
+}
+
+
+int
+ee_viewGetNextField(struct ee_eventview *view, void **cookie, struct ee_viewfield *field)
+{
+	int r = 0;
+	unsigned char *p;
+	unsigned long long v;
+	unsigned id;
+
+	p = (*cookie == NULL) ? view->rec.fields : (unsigned char*) *cookie;
+	if(p == view->rec.end) {
+		r = EE_EOF;
+		goto done;
+	}
+	CHKR(ee_binGetVarint(&p, view->rec.end, &v));
+	id = (unsigned) v;
+	CHKR(ee_binGetVarint(&p, view->rec.end, &v));
+	field->nVals = (unsigned) v;
+	field->vals = p;
+	field->end = view->rec.end;
+	CHKR(skipValues(&p, view->rec.end, field->nVals));
+	CHKR(getName(view, id, &field->name, &field->lenName));
+	*cookie = p;
+
+done:
+	return r;
+}
+
+
+int
+ee_viewGetField(struct ee_eventview *view, ee_fieldref ref, struct ee_viewfield *field)
+{
+	int r = EE_NOTFOUND;
+	unsigned id;
+	unsigned i;
+	unsigned char *p;
+	unsigned long long v;
+
+	assert(ref != NULL);assert(ref->objID == ObjID_FIELDREF);
+	if(ref->kind != ee_fieldref_field)
+		goto done;
+	CHKR(findName(view, es_getBufAddr(ref->name), es_strlen(ref->name), &id));
+
+	p = view->rec.fields;
+	for(i = 0 ; i < view->rec.nFields ; ++i) {
+		CHKR(ee_binGetVarint(&p, view->rec.end, &v));
+		if(v == id) {
+			field->name = es_getBufAddr(ref->name);
+			field->lenName = es_strlen(ref->name);
+			CHKR(ee_binGetVarint(&p, view->rec.end, &v));
+			field->nVals = (unsigned) v;
+			field->vals = p;
+			field->end = view->rec.end;
+			goto done;
+		}
+		CHKR(ee_binGetVarint(&p, view->rec.end, &v));
+		CHKR(skipValues(&p, view->rec.end, (unsigned) v));
+	}
+	r = EE_NOTFOUND;
+
+done:
+	return r;
+}
+
+
+int
+ee_viewGetValue(struct ee_viewfield *field, unsigned n, struct ee_binvalue *val)
+{
+	int r = 0;
+	unsigned char *p = field->vals;
+	unsigned i;
+
+	if(n >= field->nVals) {
+		r = EE_NOTFOUND;
+		goto done;
+	}
+	for(i = 0 ; i <= n ; ++i)
+		CHKR(ee_binGetValue(&p, field->end, val));
+
+done:
+	return r;
+}
+
+
+int
+ee_viewHasTag(struct ee_eventview *view, es_str_t *tagname)
+{
+	unsigned id;
+	unsigned i;
+	unsigned char *p;
+	unsigned long long v;
+
+	if(findName(view, es_getBufAddr(tagname), es_strlen(tagname), &id) != 0)
+		return 0;
+	p = view->rec.tags;
+	for(i = 0 ; i < view->rec.nTags ; ++i) {
+		if(ee_binGetVarint(&p, view->rec.end, &v) != 0)
+			return 0;
+		if(v == id)
+			return 1;
+	}
+	return 0;
+}
+
+
+struct ee_event*
+ee_newEventFromView(struct ee_eventview *view)
+{
+	return ee_newEventFromBinary(view->ctx, view->rec.buf, view->rec.len, NULL);
+}
+/* vim :ts=4:sw=4 */
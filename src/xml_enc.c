@@ -61,8 +61,13 @@ ee_addValue_XML(struct ee_value *value, es_str_t **str)
 
 	assert(str != NULL); assert(*str != NULL);
 	assert(value != NULL); assert(value->objID == ObjID_VALUE);
-	// TODO: support other types!
-	assert(value->valtype == ee_valtype_str);
+	if(value->valtype != ee_valtype_str) {
+		/* no escaping needed, see ee_addValueAsStr() */
+		CHKR(es_addBuf(str, "<value>", 7));
+		CHKR(ee_addValueAsStr(value, str));
+		CHKR(es_addBuf(str, "</value>", 8));
+		goto done;
+	}
 	valstr = value->val.str;
 	es_addBuf(str, "<value>", 7);
 
@@ -118,6 +123,7 @@ ee_addValue_XML(struct ee_value *value, es_str_t **str)
 	es_addBuf(str, "</value>", 8);
 	r = 0;
 
+done:
 	return r;
 }
 
@@ -174,8 +180,11 @@ ee_fmtEventToXML(struct ee_event *event, es_str_t **str)
 {
 	int r = -1;
 	struct ee_fieldbucket_listnode *node;
+	STATS_TIMER_DECL
 
 	assert(event != NULL);assert(event->objID == ObjID_EVENT);
+	TRACE2(encode_start, "xml", event);
+	STATS_TIMER_START;
 	if((*str = es_newStr(256)) == NULL) goto done;
 
 	es_addBuf(str, "<event>", 7);
@@ -191,6 +200,9 @@ ee_fmtEventToXML(struct ee_event *event, es_str_t **str)
 	es_addBuf(str, "</event>", 8);
 
 done:
+	STATS_TIMER_STOP(event->ctx, encodeNs);
+	STATS_ENCODED(event->ctx, *str);
+	TRACE3(encode_done, "xml", event, r);
 	return r;
 }
 /* vim :ts=4:sw=4 */
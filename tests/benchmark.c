@@ -0,0 +1,806 @@
+/**
+ * @file benchmark.c
+ * @brief Micro benchmarks for the primitive parsers, decoders, the
+ * normalizer and the encoders.
+ *
+ * Run via "make bench". Each benchmark works on a synthetic corpus,
+ * which is generated with a fixed seed, so results are reproducible.
+ * Reported are the time and the number of heap allocations per event
+ * (per value for the parsers), the throughput in input bytes (output
+ * bytes for encoders) and the peak RSS. Each group of benchmarks (parsers,
+ * decoders, normalizer, encoders) runs in a child process of its own, so
+ * the peak RSS is that of the group so far, not of all groups before it.
+ * The time is the best of three runs.
+ *
+ * Decoders obtain their lines via a callback that copies them from
+ * the corpus, just like reading them from a file; this copy is
+ * included in the numbers.
+ *
+ * Usage: benchmark [nbrEvents [name]]
+ * If a name is given, only benchmarks containing it are run.
+ *//*
+ *//*
+ * Libee - An Event Expression Library inspired by CEE
+ * Copyright 2012 by Rainer Gerhards and Adiscon GmbH.
+ *
+ * This file is part of libee.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * A copy of the LGPL v2.1 can be found in the file "COPYING" in this distribution.
+ */
+#include "config.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <libestr.h>
+#include "libee/libee.h"
+#include "libee/int.h"
+#include "libee/apache.h"
+#include "libee/syslog.h"
+#include "libee/kv.h"
+#include "libee/csv.h"
+#include "libee/normalizer.h"
+
+/* private forward definition for decoders without headers */
+int ee_jsonDec(ee_ctx ctx, int (*cbGetLine)(es_str_t **ln),
+	       int (*cbNewEvt)(struct ee_event *event),
+	       es_str_t **errMsg);
+
+#define NBR_RUNS 3
+#define SEED 42
+
+static ee_ctx ctx;
+static unsigned nEvts = 100000;
+static char *filter = NULL;
+static unsigned seed;
+
+/* the current benchmark run */
+static unsigned long long nsStart, allocsStart;
+static unsigned long long nsBest, allocsRun;
+
+/* corpus and counters for the decoder callbacks */
+static es_str_t **lines;
+static unsigned nLines, currLine, nDecoded;
+
+
+#ifdef __GLIBC__
+/* Count heap allocations by interposing the allocator. Allocations done
+ * by libee and libestr go through these, too, as they are shared libs.
+ */
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t n, size_t size);
+extern void *__libc_realloc(void *p, size_t size);
+extern void __libc_free(void *p);
+static unsigned long long nAllocs = 0;
+
+void *malloc(size_t size)
+{
+	++nAllocs;
+	return __libc_malloc(size);
+}
+
+void *calloc(size_t n, size_t size)
+{
+	++nAllocs;
+	return __libc_calloc(n, size);
+}
+
+void *realloc(void *p, size_t size)
+{
+	++nAllocs;
+	return __libc_realloc(p, size);
+}
+
+void free(void *p)
+{
+	__libc_free(p);
+}
+#else
+static unsigned long long nAllocs = 0; /* not supported, always 0 */
+#endif
+
+
+void errout(char *errmsg)
+{
+	fprintf(stderr, "%s\n", errmsg);
+	exit(1);
+}
+
+
+/* a simple LCG, so that the corpus is the same on all platforms */
+static inline unsigned
+rnd(unsigned mod)
+{
+	seed = seed * 1103515245 + 12345;
+	return ((seed >> 16) & 0x7fff) % mod;
+}
+
+
+static inline unsigned long long
+nsNow(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (unsigned long long) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+
+static inline void
+startRun(void)
+{
+	allocsStart = nAllocs;
+	nsStart = nsNow();
+}
+
+
+static inline void
+endRun(void)
+{
+	unsigned long long ns = nsNow() - nsStart;
+
+	allocsRun = nAllocs - allocsStart;
+	if(nsBest == 0 || ns < nsBest)
+		nsBest = ns;
+}
+
+
+static int
+selected(char *name)
+{
+	nsBest = 0;
+	seed = SEED;
+	return filter == NULL || strstr(name, filter) != NULL;
+}
+
+
+static void
+report(char *name, unsigned long long n, unsigned long long bytes)
+{
+	struct rusage ru;
+
+	getrusage(RUSAGE_SELF, &ru);
+	if(n == 0)
+		n = 1;
+	printf("%-20s %10.1f ns/evt %9.1f MB/s %8.2f allocs/evt %9ld KB group peak RSS\n",
+	       name, (double) nsBest / n,
+	       (nsBest == 0) ? 0.0 : bytes * 1000.0 / nsBest,
+	       (double) allocsRun / n, ru.ru_maxrss);
+}
+
+
+/* ---------- the corpora ---------- */
+
+static char *hosts[] = { "srv1", "web-frontend-02", "db7", "mail.example.com" };
+static char *msgs[] = {
+	"user logged in",
+	"connection from \"10.0.0.1\" refused, retrying",
+	"disk /dev/sda1 is 95% full",
+	"GET /index.html HTTP/1.1 took 12ms"
+};
+static char *tags[] = { "security", "network", "disk", "app" };
+
+static struct ee_event*
+genEvent(void)
+{
+	struct ee_event *event;
+	es_str_t *tag;
+	char buf[64];
+	int len;
+
+	if((event = ee_newEvent(ctx)) == NULL)
+		errout("could not create event");
+	len = snprintf(buf, sizeof(buf), "%s", hosts[rnd(4)]);
+	ee_addStrFieldToEvent(event, "host", es_newStrFromCStr(buf, len));
+	len = snprintf(buf, sizeof(buf), "10.%u.%u.%u", rnd(256), rnd(256), rnd(256));
+	ee_addStrFieldToEvent(event, "ip", es_newStrFromCStr(buf, len));
+	len = snprintf(buf, sizeof(buf), "%u", rnd(32768));
+	ee_addStrFieldToEvent(event, "pid", es_newStrFromCStr(buf, len));
+	len = snprintf(buf, sizeof(buf), "%s", msgs[rnd(4)]);
+	ee_addStrFieldToEvent(event, "msg", es_newStrFromCStr(buf, len));
+	len = snprintf(buf, sizeof(buf), "%s", tags[rnd(4)]);
+	tag = es_newStrFromCStr(buf, len);
+	ee_addTagToEvent(event, tag);
+	es_deleteStr(tag);
+	return event;
+}
+
+
+static struct ee_event **
+genEvents(void)
+{
+	struct ee_event **events;
+	unsigned i;
+
+	if((events = malloc(nEvts * sizeof(struct ee_event*))) == NULL)
+		errout("out of memory");
+	for(i = 0 ; i < nEvts ; ++i)
+		events[i] = genEvent();
+	return events;
+}
+
+
+static void
+deleteEvents(struct ee_event **events)
+{
+	unsigned i;
+
+	for(i = 0 ; i < nEvts ; ++i)
+		ee_deleteEvent(events[i]);
+	free(events);
+}
+
+
+static void
+addLine(char *buf, size_t len)
+{
+	if((lines[nLines++] = es_newStrFromCStr(buf, len)) == NULL)
+		errout("out of memory");
+}
+
+
+static void
+allocLines(unsigned n)
+{
+	if((lines = malloc(n * sizeof(es_str_t*))) == NULL)
+		errout("out of memory");
+	nLines = 0;
+}
+
+
+static void
+deleteLines(void)
+{
+	unsigned i;
+
+	for(i = 0 ; i < nLines ; ++i)
+		es_deleteStr(lines[i]);
+	free(lines);
+}
+
+
+/* lines encoded from events with one of the encoders */
+static void
+genEncodedLines(int (*fmt)(struct ee_event *event, es_str_t **str))
+{
+	struct ee_event *event;
+	es_str_t *str;
+	unsigned i;
+
+	allocLines(nEvts);
+	for(i = 0 ; i < nEvts ; ++i) {
+		event = genEvent();
+		fmt(event, &str);
+		lines[nLines++] = str;
+		ee_deleteEvent(event);
+	}
+}
+
+
+static es_str_t *csvCols;
+
+static int
+fmtCSV(struct ee_event *event, es_str_t **str)
+{
+	return ee_fmtEventToCSV(event, str, csvCols);
+}
+
+
+/* ---------- primitive parsers ---------- */
+
+static int
+genRFC3164Date(char *buf, size_t size)
+{
+	static char *months[] = { "Jan", "Feb", "Mar", "Apr", "May", "Jun",
+				  "Jul", "Aug", "Sep", "Oct", "Nov", "Dec" };
+	return snprintf(buf, size, "%s %2u %02u:%02u:%02u", months[rnd(12)],
+			rnd(28) + 1, rnd(24), rnd(60), rnd(60));
+}
+
+static int
+genRFC5424Date(char *buf, size_t size)
+{
+	return snprintf(buf, size, "2012-%02u-%02uT%02u:%02u:%02u.%06u+02:00",
+			rnd(12) + 1, rnd(28) + 1, rnd(24), rnd(60), rnd(60), rnd(32768));
+}
+
+static int
+genISODate(char *buf, size_t size)
+{
+	return snprintf(buf, size, "2012-%02u-%02u", rnd(12) + 1, rnd(28) + 1);
+}
+
+static int
+genTime24hr(char *buf, size_t size)
+{
+	return snprintf(buf, size, "%02u:%02u:%02u", rnd(24), rnd(60), rnd(60));
+}
+
+static int
+genTime12hr(char *buf, size_t size)
+{
+	return snprintf(buf, size, "%02u:%02u:%02u", rnd(12) + 1, rnd(60), rnd(60));
+}
+
+static int
+genIPv4(char *buf, size_t size)
+{
+	return snprintf(buf, size, "%u.%u.%u.%u", rnd(256), rnd(256), rnd(256), rnd(256));
+}
+
+static int
+genIPv6(char *buf, size_t size)
+{
+	return snprintf(buf, size, "2001:db8:%x::%x:%x", rnd(32768), rnd(32768), rnd(32768));
+}
+
+static int
+genMAC(char *buf, size_t size)
+{
+	return snprintf(buf, size, "00:1a:2b:%02x:%02x:%02x", rnd(256), rnd(256), rnd(256));
+}
+
+static int
+genCIDR(char *buf, size_t size)
+{
+	return snprintf(buf, size, "10.%u.%u.0/%u", rnd(256), rnd(256), rnd(17) + 8);
+}
+
+static int
+genNumber(char *buf, size_t size)
+{
+	return snprintf(buf, size, "%u", rnd(32768) * rnd(32768));
+}
+
+static int
+genQuotedString(char *buf, size_t size)
+{
+	return snprintf(buf, size, "\"%s\"", hosts[rnd(4)]);
+}
+
+static int
+genCharTo(char *buf, size_t size)
+{
+	return snprintf(buf, size, "%s:%u", hosts[rnd(4)], rnd(32768));
+}
+
+static int
+genWord(char *buf, size_t size)
+{
+	return snprintf(buf, size, "%s %u", hosts[rnd(4)], rnd(32768));
+}
+
+static struct {
+	char *name;
+	ee_parserFunc parse;
+	int (*gen)(char *buf, size_t size);
+	char *ed;
+} parsers[] = {
+	{ "date-rfc3164", ee_parseRFC3164Date, genRFC3164Date, NULL },
+	{ "date-rfc5424", ee_parseRFC5424Date, genRFC5424Date, NULL },
+	{ "date-iso", ee_parseISODate, genISODate, NULL },
+	{ "time-24hr", ee_parseTime24hr, genTime24hr, NULL },
+	{ "time-12hr", ee_parseTime12hr, genTime12hr, NULL },
+	{ "ipv4", ee_parseIPv4, genIPv4, NULL },
+	{ "ipv6", ee_parseIPv6, genIPv6, NULL },
+	{ "mac48", ee_parseMAC, genMAC, NULL },
+	{ "cidr", ee_parseCIDR, genCIDR, NULL },
+	{ "number", ee_parseNumber, genNumber, NULL },
+	{ "quoted-string", ee_parseQuotedString, genQuotedString, NULL },
+	{ "char-to", ee_parseCharTo, genCharTo, ":" },
+	{ "word", ee_parseWord, genWord, NULL },
+	{ NULL, NULL, NULL, NULL }
+};
+
+
+static void
+benchParsers(void)
+{
+	char name[64];
+	char buf[128];
+	int i, run;
+	unsigned j, nFailed;
+	unsigned long long bytes;
+	es_size_t offs;
+	es_str_t *ed;
+	struct ee_value *value;
+
+	for(i = 0 ; parsers[i].name != NULL ; ++i) {
+		snprintf(name, sizeof(name), "parse:%s", parsers[i].name);
+		if(!selected(name))
+			continue;
+		allocLines(nEvts);
+		for(j = 0 ; j < nEvts ; ++j)
+			addLine(buf, parsers[i].gen(buf, sizeof(buf)));
+		ed = (parsers[i].ed == NULL) ? NULL
+		     : es_newStrFromCStr(parsers[i].ed, strlen(parsers[i].ed));
+		for(run = 0 ; run < NBR_RUNS ; ++run) {
+			nFailed = 0;
+			bytes = 0;
+			startRun();
+			for(j = 0 ; j < nLines ; ++j) {
+				offs = 0;
+				if(parsers[i].parse(ctx, lines[j], &offs, ed, &value) == 0)
+					ee_deleteValue(value);
+				else
+					++nFailed;
+				bytes += offs;
+			}
+			endRun();
+		}
+		report(name, nLines, bytes);
+		if(nFailed > 0)
+			printf("WARNING: %u values not parsed\n", nFailed);
+		if(ed != NULL)
+			es_deleteStr(ed);
+		deleteLines();
+	}
+}
+
+
+/* ---------- decoders ---------- */
+
+static int
+cbGetLine(es_str_t **ln)
+{
+	if(currLine == nLines)
+		return EE_EOF;
+	*ln = es_newStrFromBuf((char*) es_getBufAddr(lines[currLine]),
+			       es_strlen(lines[currLine]));
+	++currLine;
+	return (*ln == NULL) ? EE_NOMEM : 0;
+}
+
+
+static int
+cbNewEvt(struct ee_event *event)
+{
+	++nDecoded;
+	ee_deleteEvent(event);
+	return 0;
+}
+
+
+static unsigned long long
+corpusBytes(void)
+{
+	unsigned long long bytes = 0;
+	unsigned i;
+
+	for(i = 0 ; i < nLines ; ++i)
+		bytes += es_strlen(lines[i]) + 1; /* including the line break */
+	return bytes;
+}
+
+
+static void
+genIntLines(void)
+{
+	struct ee_event *event;
+	struct ee_fieldbucket_listnode *node;
+	unsigned i;
+
+	allocLines(nEvts * 9);
+	for(i = 0 ; i < nEvts ; ++i) {
+		addLine("e:", 2);
+		event = genEvent();
+		for(node = event->fields->root ; node != NULL ; node = node->next) {
+			addLine("f:", 2);
+			es_addStr(&lines[nLines-1], node->field->name);
+			addLine("v:", 2);
+			es_addStr(&lines[nLines-1], node->field->val->val.str);
+		}
+		ee_deleteEvent(event);
+	}
+}
+
+
+static void
+genApacheLines(void)
+{
+	char buf[256];
+	unsigned i;
+	int len;
+
+	allocLines(nEvts);
+	for(i = 0 ; i < nEvts ; ++i) {
+		len = snprintf(buf, sizeof(buf), "10.%u.%u.%u - %s [%02u/Oct/2012:%02u:%02u:%02u +0200] "
+			       "\"GET /img/%u.png HTTP/1.1\" %u %u",
+			       rnd(256), rnd(256), rnd(256), (rnd(2) ? "-" : "frank"),
+			       rnd(28) + 1, rnd(24), rnd(60), rnd(60), rnd(32768),
+			       rnd(2) ? 200 : 404, rnd(32768));
+		addLine(buf, len);
+	}
+}
+
+
+static void
+genKVLines(void)
+{
+	char buf[256];
+	unsigned i;
+	int len;
+
+	allocLines(nEvts);
+	for(i = 0 ; i < nEvts ; ++i) {
+		len = snprintf(buf, sizeof(buf), "host=%s ip=10.%u.%u.%u pid=%u level=info msg=\"%s\"",
+			       hosts[rnd(4)], rnd(256), rnd(256), rnd(256), rnd(32768), msgs[0]);
+		addLine(buf, len);
+	}
+}
+
+
+static struct ee_apache *apache;
+static struct ee_kv *kv;
+static struct ee_csv *csv;
+
+static int
+decApache(ee_ctx dctx, int (*getLine)(es_str_t **ln),
+	  int (*newEvt)(struct ee_event *event), es_str_t **errMsg)
+{
+	return ee_apacheDec(dctx, getLine, newEvt, errMsg, apache);
+}
+
+static int
+decKV(ee_ctx dctx, int (*getLine)(es_str_t **ln),
+      int (*newEvt)(struct ee_event *event), es_str_t **errMsg)
+{
+	return ee_kvDec(dctx, getLine, newEvt, errMsg, kv);
+}
+
+static int
+decCSV(ee_ctx dctx, int (*getLine)(es_str_t **ln),
+       int (*newEvt)(struct ee_event *event), es_str_t **errMsg)
+{
+	return ee_csvDec(dctx, getLine, newEvt, errMsg, csv);
+}
+
+
+static void
+benchDecoder(char *name, int (*dec)(ee_ctx ctx, int (*cbGetLine)(es_str_t **ln),
+				    int (*cbNewEvt)(struct ee_event *event),
+				    es_str_t **errMsg))
+{
+	es_str_t *errMsg;
+	int run;
+
+	for(run = 0 ; run < NBR_RUNS ; ++run) {
+		currLine = nDecoded = 0;
+		startRun();
+		if(dec(ctx, cbGetLine, cbNewEvt, &errMsg) != 0)
+			errout("decoder failed");
+		endRun();
+	}
+	report(name, nDecoded, corpusBytes());
+}
+
+
+static void
+benchDecoders(void)
+{
+	es_str_t *str;
+
+	if(selected("dec:int")) {
+		genIntLines();
+		benchDecoder("dec:int", ee_intDec);
+		deleteLines();
+	}
+	if(selected("dec:json")) {
+		genEncodedLines(ee_fmtEventToJSON);
+		benchDecoder("dec:json", ee_jsonDec);
+		deleteLines();
+	}
+	if(selected("dec:apache")) {
+		genApacheLines();
+		str = es_newStrFromCStr("host,ident,user,date,request,status,bytes", 41);
+		apache = ee_newApache(ctx);
+		ee_apacheNameList(ctx, apache, str);
+		benchDecoder("dec:apache", decApache);
+		ee_deleteApache(apache);
+		es_deleteStr(str);
+		deleteLines();
+	}
+	if(selected("dec:syslog")) {
+		genEncodedLines(ee_fmtEventToRFC5424);
+		benchDecoder("dec:syslog", ee_syslogSDDec);
+		deleteLines();
+	}
+	if(selected("dec:kv")) {
+		genKVLines();
+		kv = ee_newKV(ctx);
+		benchDecoder("dec:kv", decKV);
+		ee_deleteKV(kv);
+		deleteLines();
+	}
+	if(selected("dec:csv")) {
+		genEncodedLines(fmtCSV);
+		csv = ee_newCSV(ctx, csvCols, ',', EE_CSV_BACKSLASH_ESC);
+		benchDecoder("dec:csv", decCSV);
+		ee_deleteCSV(csv);
+		deleteLines();
+	}
+}
+
+
+/* ---------- normalizer ---------- */
+
+/* Rule shapes; each rule gets its own number, so all rules differ in
+ * some literal text after the first fields.
+ */
+static char *ruleShapes[] = {
+	"%%host:word%% %%prog:word%%: job%u finished after %%t:number%% s",
+	"%%n:number%% %%prog:word%% queue%u size %%s:number%%",
+	"%%ip:ipv4%% %%user:word%% login%u ok from %%src:word%%",
+	"%%date:date-rfc3164%% %%host:word%% %%prog:word%%[%%pid:number%%]: msg%u %%a:word%%"
+};
+
+static int
+genNormLine(char *buf, size_t size, unsigned rule)
+{
+	switch(rule % 4) {
+	case 0:
+		return snprintf(buf, size, "%s cron: job%u finished after %u s",
+				hosts[rnd(4)], rule, rnd(32768));
+	case 1:
+		return snprintf(buf, size, "%u postfix queue%u size %u",
+				rnd(32768), rule, rnd(32768));
+	case 2:
+		return snprintf(buf, size, "10.%u.%u.%u joe login%u ok from %s",
+				rnd(256), rnd(256), rnd(256), rule, hosts[rnd(4)]);
+	default:
+		return snprintf(buf, size, "Oct %2u %02u:%02u:%02u %s app[%u]: msg%u done",
+				rnd(28) + 1, rnd(24), rnd(60), rnd(60), hosts[rnd(4)],
+				rnd(32768), rule);
+	}
+}
+
+
+static struct ee_normalizer *norm;
+
+static int
+decNorm(ee_ctx dctx, int (*getLine)(es_str_t **ln),
+	int (*newEvt)(struct ee_event *event), es_str_t **errMsg)
+{
+	return ee_normDec(dctx, getLine, newEvt, errMsg, norm);
+}
+
+
+/* the time per message must not depend on the number of rules */
+static void
+benchNormalizer(void)
+{
+	static unsigned nRules[] = { 50, 5000, 0 };
+	char name[64];
+	char buf[256];
+	unsigned i, j;
+
+	for(i = 0 ; nRules[i] != 0 ; ++i) {
+		snprintf(name, sizeof(name), "norm:%u", nRules[i]);
+		if(!selected(name))
+			continue;
+		if((norm = ee_newNormalizer(ctx)) == NULL)
+			errout("could not create normalizer");
+		for(j = 0 ; j < nRules[i] ; ++j) {
+			snprintf(buf, sizeof(buf), ruleShapes[j % 4], j);
+			if(ee_addRule(norm, buf, NULL) != 0)
+				errout("could not add rule");
+		}
+		allocLines(nEvts);
+		for(j = 0 ; j < nEvts ; ++j)
+			addLine(buf, genNormLine(buf, sizeof(buf), rnd(nRules[i])));
+		benchDecoder(name, decNorm);
+		ee_deleteNormalizer(norm);
+		deleteLines();
+	}
+}
+
+
+/* ---------- encoders ---------- */
+
+static struct {
+	char *name;
+	int (*fmt)(struct ee_event *event, es_str_t **str);
+} encoders[] = {
+	{ "enc:syslog", ee_fmtEventToRFC5424 },
+	{ "enc:json", ee_fmtEventToJSON },
+	{ "enc:xml", ee_fmtEventToXML },
+	{ "enc:csv", fmtCSV },
+	{ "enc:binary", ee_fmtEventToBinary },
+	{ NULL, NULL }
+};
+
+
+static void
+benchEncoders(void)
+{
+	struct ee_event **events;
+	es_str_t *str;
+	unsigned long long bytes;
+	unsigned j;
+	int i, run;
+
+	for(i = 0 ; encoders[i].name != NULL ; ++i) {
+		if(!selected(encoders[i].name))
+			continue;
+		events = genEvents();
+		for(run = 0 ; run < NBR_RUNS ; ++run) {
+			bytes = 0;
+			startRun();
+			for(j = 0 ; j < nEvts ; ++j) {
+				if(encoders[i].fmt(events[j], &str) != 0)
+					errout("encoder failed");
+				bytes += es_strlen(str);
+				es_deleteStr(str);
+			}
+			endRun();
+		}
+		report(encoders[i].name, nEvts, bytes);
+		deleteEvents(events);
+	}
+}
+
+
+/* Run a group of benchmarks in a child process, so that the peak RSS it
+ * reports does not include what the groups before it used.
+ */
+static void
+runGroup(void (*group)(void))
+{
+	pid_t pid;
+	int status;
+
+	fflush(stdout);
+	if((pid = fork()) == -1)
+		errout("could not fork benchmark group");
+	if(pid == 0) {
+		group();
+		fflush(stdout);
+		_exit(0);
+	}
+	if(waitpid(pid, &status, 0) != pid || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+		errout("benchmark group failed");
+}
+
+
+int main(int argc, char *argv[])
+{
+	if(argc > 1 && (nEvts = atoi(argv[1])) == 0)
+		errout("usage: benchmark [nbrEvents [name]]");
+	if(argc > 2)
+		filter = argv[2];
+
+	if((ctx = ee_initCtx()) == NULL)
+		errout("Could not initialize libee context");
+	csvCols = es_newStrFromCStr("host,ip,pid,msg", 15);
+#ifndef __GLIBC__
+	printf("note: allocation counting not supported on this platform\n");
+#endif
+	printf("%u events per benchmark, best of %d runs\n", nEvts, NBR_RUNS);
+
+	runGroup(benchParsers);
+	runGroup(benchDecoders);
+	runGroup(benchNormalizer);
+	runGroup(benchEncoders);
+
+	es_deleteStr(csvCols);
+	ee_exitCtx(ctx);
+	return 0;
+}
@@ -0,0 +1,223 @@
+/**
+ * @file binary1.c
+ * @brief A very basic test for the binary event format.
+ *
+ *//*
+ * Libee - An Event Expression Library inspired by CEE
+ * Copyright 2012 by Rainer Gerhards and Adiscon GmbH.
+ *
+ * This file is part of libee.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * A copy of the LGPL v2.1 can be found in the file "COPYING" in this distribution.
+ */
+#include "config.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <libestr.h>
+#include "libee/libee.h"
+#include "libee/binary.h"
+#include "libee/view.h"
+
+#define SPOOLFILE "binary1.spool"
+
+static ee_ctx ctx;
+static char *expected = "[cee@115 event.tags=\"tag,remote\" host=\"srv1\" msg=\"a \\\"quoted\\\" text\" tag=\"x\"]";
+
+void errout(char *errmsg)
+{
+	fprintf(stderr, "%s\n", errmsg);
+	exit(1);
+}
+
+/* check that the string representation of event is as expected */
+static void
+chkEvent(struct ee_event *event, char *expected)
+{
+	es_str_t *out;
+	char *cstr;
+
+	ee_fmtEventToRFC5424(event, &out);
+	cstr = es_str2cstr(out, NULL);
+	if(strcmp(cstr, expected)) {
+		fprintf(stderr, "expected '%s'\nbut got  '%s'\n", expected, cstr);
+		exit(1);
+	}
+	free(cstr);
+	es_deleteStr(out);
+}
+
+
+/* write the spool to a file and check it via event views */
+static void
+chkViews(es_str_t *spool)
+{
+	FILE *fp;
+	struct ee_spool *sp;
+	struct ee_eventview view;
+	struct ee_viewfield vf;
+	struct ee_binvalue val;
+	struct ee_event *event;
+	ee_fieldref ref;
+	es_str_t *tag;
+	void *cookie;
+	int nEvents = 0;
+	int nFields;
+
+	if((fp = fopen(SPOOLFILE, "wb")) == NULL)
+		errout("could not create spool file");
+	fwrite(es_getBufAddr(spool), 1, es_strlen(spool), fp);
+	fwrite("EB", 1, 2, fp); /* partial record, as if writer crashed */
+	fclose(fp);
+
+	if((sp = ee_openSpool(ctx, SPOOLFILE)) == NULL)
+		errout("could not open spool");
+	ref = ee_compileFieldPath(ctx, "msg");
+	tag = es_newStrFromCStr("remote", 6);
+	while(ee_spoolGetNextView(sp, &view) == 0) {
+		++nEvents;
+		if(   ee_viewGetField(&view, ref, &vf) != 0
+		   || ee_viewGetValue(&vf, 0, &val) != 0
+		   || val.type != EE_BIN_VAL_STR || val.len != 15
+		   || memcmp(val.str, "a \"quoted\" text", 15))
+			errout("view field msg is wrong");
+		if(ee_viewGetValue(&vf, 1, &val) != EE_NOTFOUND)
+			errout("view field msg has too many values");
+		if(!ee_viewHasTag(&view, tag))
+			errout("view tag missing");
+		nFields = 0;
+		cookie = NULL;
+		while(ee_viewGetNextField(&view, &cookie, &vf) == 0) {
+			if(nFields++ == 2 && (vf.lenName != 3 || memcmp(vf.name, "tag", 3)))
+				errout("view field iteration is wrong");
+		}
+		if(nFields != 3)
+			errout("wrong number of fields in view");
+		event = ee_newEventFromView(&view);
+		chkEvent(event, expected);
+		ee_deleteEvent(event);
+	}
+	if(nEvents != 2)
+		errout("wrong number of events in spool");
+	es_deleteStr(tag);
+	ee_deleteFieldref(ref);
+	ee_closeSpool(sp);
+	remove(SPOOLFILE);
+}
+
+
+int main(void)
+{
+	struct ee_event *event, *copy;
+	struct ee_field *field;
+	struct ee_value *val;
+	es_str_t *bin, *spool, *str;
+	struct ee_binrec rec;
+	unsigned char *name;
+	es_size_t lenName;
+	size_t used;
+
+	if((ctx = ee_initCtx()) == NULL)
+		errout("Could not initialize libee context");
+	if((event = ee_newEvent(ctx)) == NULL)
+		errout("could not create event");
+	ee_addStrFieldToEvent(event, "host", es_newStrFromCStr("srv1", 4));
+	ee_addStrFieldToEvent(event, "msg", es_newStrFromCStr("a \"quoted\" text", 15));
+	ee_addStrFieldToEvent(event, "tag", es_newStrFromCStr("x", 1));
+	str = es_newStrFromCStr("tag", 3);
+	ee_addTagToEvent(event, str);
+	es_deleteStr(str);
+	str = es_newStrFromCStr("remote", 6);
+	ee_addTagToEvent(event, str);
+	es_deleteStr(str);
+
+	if(ee_fmtEventToBinary(event, &bin) != 0)
+		errout("could not encode event");
+
+	/* the name "tag" is used by a tag and a field, so must appear once */
+	if(ee_binParseRecord(es_getBufAddr(bin), es_strlen(bin), &rec) != 0)
+		errout("could not parse record");
+	if(rec.nNames != 4 || rec.nTags != 2 || rec.nFields != 3)
+		errout("record counts are wrong");
+	if(   ee_binGetName(&rec, 1, &name, &lenName) != 0
+	   || lenName != 6 || memcmp(name, "remote", 6))
+		errout("name dictionary is wrong");
+
+	/* build a "spool" of two records and read it back */
+	spool = es_strdup(bin);
+	es_addStr(&spool, bin);
+	if((copy = ee_newEventFromBinary(ctx, es_getBufAddr(spool), es_strlen(spool), &used)) == NULL)
+		errout("could not decode event");
+	if(used != es_strlen(bin))
+		errout("wrong record length used");
+	chkEvent(copy, expected);
+	str = es_newStrFromCStr("remote", 6);
+	if(!ee_EventHasTag(copy, str))
+		errout("tag missing after decoding");
+	es_deleteStr(str);
+	ee_deleteEvent(copy);
+	if((copy = ee_newEventFromBinary(ctx, es_getBufAddr(spool) + used,
+					 es_strlen(spool) - used, NULL)) == NULL)
+		errout("could not decode second event");
+	chkEvent(copy, expected);
+	ee_deleteEvent(copy);
+
+	/* read the spool back via views */
+	chkViews(spool);
+
+	/* incomplete records must be detected */
+	if(ee_binParseRecord(es_getBufAddr(bin), es_strlen(bin) - 1, &rec) != EE_EOF)
+		errout("truncated record not detected");
+	es_getBufAddr(bin)[8] = 0x7f; /* claim excessive number of names */
+	if(ee_newEventFromBinary(ctx, es_getBufAddr(bin), es_strlen(bin), NULL) != NULL)
+		errout("malformed record not detected");
+	es_deleteStr(bin);
+	es_deleteStr(spool);
+
+	/* numbers and multiple values */
+	ee_deleteEvent(event);
+	event = ee_newEvent(ctx);
+	field = ee_newField(ctx);
+	str = es_newStrFromCStr("n", 1);
+	ee_nameField(field, str);
+	es_deleteStr(str);
+	val = ee_newValue(ctx);
+	ee_setNbrValue(val, -1234567890123LL);
+	ee_addValueToField(field, val);
+	val = ee_newValue(ctx);
+	ee_setNbrValue(val, 42);
+	ee_addValueToField(field, val);
+	ee_addFieldToEvent(event, field);
+	if(ee_fmtEventToBinary(event, &bin) != 0)
+		errout("could not encode numbers");
+	if((copy = ee_newEventFromBinary(ctx, es_getBufAddr(bin), es_strlen(bin), NULL)) == NULL)
+		errout("could not decode numbers");
+	str = es_newStrFromCStr("n", 1);
+	field = ee_getEventField(copy, str);
+	es_deleteStr(str);
+	if(   field == NULL || field->nVals != 2
+	   || field->val->valtype != ee_valtype_nbr
+	   || field->val->val.number != -1234567890123LL
+	   || field->valroot->val->val.number != 42)
+		errout("numbers not correctly decoded");
+	es_deleteStr(bin);
+	ee_deleteEvent(copy);
+	ee_deleteEvent(event);
+
+	ee_exitCtx(ctx);
+	return 0;
+}
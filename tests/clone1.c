@@ -0,0 +1,113 @@
+/**
+ * @file clone1.c
+ * @brief A very basic test for event cloning and copy-on-write.
+ *
+ *//*
+ * Libee - An Event Expression Library inspired by CEE
+ * Copyright 2012 by Rainer Gerhards and Adiscon GmbH.
+ *
+ * This file is part of libee.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * A copy of the LGPL v2.1 can be found in the file "COPYING" in this distribution.
+ */
+#include "config.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <libestr.h>
+#include "libee/libee.h"
+
+static ee_ctx ctx;
+
+void errout(char *errmsg)
+{
+	fprintf(stderr, "%s\n", errmsg);
+	exit(1);
+}
+
+/* check that the string representation of event is as expected */
+static void
+chkEvent(struct ee_event *event, char *expected)
+{
+	es_str_t *out;
+	char *cstr;
+
+	ee_fmtEventToRFC5424(event, &out);
+	cstr = es_str2cstr(out, NULL);
+	if(strcmp(cstr, expected)) {
+		fprintf(stderr, "expected '%s'\nbut got  '%s'\n", expected, cstr);
+		exit(1);
+	}
+	free(cstr);
+	es_deleteStr(out);
+}
+
+
+int main(void)
+{
+	struct ee_event *orig, *clone;
+	struct ee_field *field;
+	struct ee_value *val;
+	es_str_t *name;
+
+	if((ctx = ee_initCtx()) == NULL)
+		errout("Could not initialize libee context");
+	if((orig = ee_newEvent(ctx)) == NULL)
+		errout("could not create event");
+	ee_addStrFieldToEvent(orig, "host", es_newStrFromCStr("srv1", 4));
+	ee_addStrFieldToEvent(orig, "msg", es_newStrFromCStr("test", 4));
+
+	if((clone = ee_cloneEvent(orig)) == NULL)
+		errout("could not clone event");
+	if(clone->fields != orig->fields)
+		errout("clone does not share fields");
+
+	/* add a field to the clone only */
+	ee_addStrFieldToEvent(clone, "out", es_newStrFromCStr("file", 4));
+	chkEvent(orig, "[cee@115 host=\"srv1\" msg=\"test\"]");
+	chkEvent(clone, "[cee@115 host=\"srv1\" msg=\"test\" out=\"file\"]");
+
+	/* replace a value in the original only */
+	name = es_newStrFromCStr("msg", 3);
+	if(ee_getEventField(orig, name) != ee_getEventField(clone, name))
+		errout("unmodified field is not shared");
+	/* a shared field must not be changed in place */
+	val = ee_newValue(ctx);
+	ee_setStrValue(val, es_newStrFromCStr("changed", 7));
+	if(ee_replaceValueInField(ee_getEventField(orig, name), val, 0) != EE_EINVAL)
+		errout("shared field was changed");
+	if(ee_addValueToField(ee_getEventField(orig, name), val) != EE_EINVAL)
+		errout("value was added to shared field");
+	ee_deleteValue(val);
+	chkEvent(orig, "[cee@115 host=\"srv1\" msg=\"test\"]");
+	if((field = ee_getEventFieldForUpdate(orig, name)) == NULL)
+		errout("could not obtain field for update");
+	val = ee_newValue(ctx);
+	ee_setStrValue(val, es_newStrFromCStr("changed", 7));
+	ee_replaceValueInField(field, val, 0);
+	chkEvent(orig, "[cee@115 host=\"srv1\" msg=\"changed\"]");
+	chkEvent(clone, "[cee@115 host=\"srv1\" msg=\"test\" out=\"file\"]");
+	es_deleteStr(name);
+
+	/* delete the original first - the clone must survive */
+	ee_deleteEvent(orig);
+	chkEvent(clone, "[cee@115 host=\"srv1\" msg=\"test\" out=\"file\"]");
+	ee_deleteEvent(clone);
+
+	ee_exitCtx(ctx);
+	return 0;
+}
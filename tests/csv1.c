@@ -0,0 +1,182 @@
+/**
+ * @file csv1.c
+ * @brief A basic test for the CSV decoder.
+ *
+ *//*
+ * Libee - An Event Expression Library inspired by CEE
+ * Copyright 2012 by Rainer Gerhards and Adiscon GmbH.
+ *
+ * This file is part of libee.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * A copy of the LGPL v2.1 can be found in the file "COPYING" in this distribution.
+ */
+#include "config.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <libestr.h>
+#include "libee/libee.h"
+#include "libee/csv.h"
+
+static ee_ctx ctx;
+
+/* records and the resulting JSON for columns a,b,c */
+static struct {
+	char *in;
+	char *json;
+} tests[] = {
+	{ "1,2,3", "{\"a\": \"1\", \"b\": \"2\", \"c\": \"3\"}" },
+	{ "\"x,y\",\"say \"\"hi\"\"\",", "{\"a\": \"x,y\", \"b\": \"say \\\"hi\\\"\"}" },
+	{ ",only b,,ignored\r", "{\"b\": \"only b\"}" },
+	{ "\"a long quoted field with a \"\"quote\"\" in it\"",
+	  "{\"a\": \"a long quoted field with a \\\"quote\\\" in it\"}" },
+	{ "", "{}" },
+	{ NULL, NULL }
+};
+
+/* input for ee_csvDec() */
+static char *lines[] = {
+	"1,\"two",
+	"lines\",3",
+	"4,5,6",
+	"x\"y,\"three \"\"q\"\"",
+	"",
+	"lines\",z",
+	NULL
+};
+static int currLn = 0;
+static int nEvents = 0;
+
+void errout(char *errmsg)
+{
+	fprintf(stderr, "%s\n", errmsg);
+	exit(1);
+}
+
+static int
+cbGetLine(es_str_t **ln)
+{
+	if(lines[currLn] == NULL)
+		return EE_EOF;
+	*ln = es_newStrFromCStr(lines[currLn], strlen(lines[currLn]));
+	++currLn;
+	return 0;
+}
+
+static int
+cbNewEvt(struct ee_event *event)
+{
+	es_str_t *out;
+	char *cstr;
+	char *expected[] = {
+		"{\"a\": \"1\", \"b\": \"two\\nlines\", \"c\": \"3\"}",
+		"{\"a\": \"4\", \"b\": \"5\", \"c\": \"6\"}",
+		"{\"a\": \"x\\\"y\", \"b\": \"three \\\"q\\\"\\n\\nlines\", \"c\": \"z\"}"
+	};
+
+	ee_fmtEventToJSON(event, &out);
+	cstr = es_str2cstr(out, NULL);
+	if(nEvents > 2 || strcmp(cstr, expected[nEvents])) {
+		fprintf(stderr, "ee_csvDec() event %d is '%s'\n", nEvents, cstr);
+		exit(1);
+	}
+	++nEvents;
+	free(cstr);
+	es_deleteStr(out);
+	ee_deleteEvent(event);
+	return 0;
+}
+
+
+int main(void)
+{
+	struct ee_csv *csv;
+	struct ee_event *event;
+	ee_ctx ctx2;
+	es_str_t *cols, *str, *out, *out2, *errMsg;
+	char *cstr;
+	int i;
+
+	if((ctx = ee_initCtx()) == NULL)
+		errout("Could not initialize libee context");
+	cols = es_newStrFromCStr("a,b,c", 5);
+	if((csv = ee_newCSV(ctx, cols, ',', 0)) == NULL)
+		errout("could not create csv decoder");
+
+	for(i = 0 ; tests[i].in != NULL ; ++i) {
+		str = es_newStrFromCStr(tests[i].in, strlen(tests[i].in));
+		if((event = ee_newEventFromCSV(csv, str)) == NULL) {
+			fprintf(stderr, "'%s' could not be decoded\n", tests[i].in);
+			exit(1);
+		}
+		ee_fmtEventToJSON(event, &out);
+		cstr = es_str2cstr(out, NULL);
+		if(strcmp(cstr, tests[i].json)) {
+			fprintf(stderr, "'%s': expected '%s' but got '%s'\n", tests[i].in,
+				tests[i].json, cstr);
+			exit(1);
+		}
+		free(cstr);
+		es_deleteStr(out);
+		ee_deleteEvent(event);
+		es_deleteStr(str);
+	}
+
+	str = es_newStrFromCStr("1,\"open", 7);
+	if(ee_newEventFromCSV(csv, str) != NULL)
+		errout("incomplete record was decoded");
+	es_deleteStr(str);
+
+	/* the decoder must be used with its own context */
+	if((ctx2 = ee_initCtx()) == NULL)
+		errout("Could not initialize libee context");
+	if(ee_csvDec(ctx2, cbGetLine, cbNewEvt, &errMsg, csv) != EE_EINVAL)
+		errout("ee_csvDec() accepted another context");
+	es_deleteStr(errMsg);
+	ee_exitCtx(ctx2);
+
+	if(ee_csvDec(ctx, cbGetLine, cbNewEvt, &errMsg, csv) != 0 || nEvents != 3)
+		errout("ee_csvDec() failed");
+	ee_deleteCSV(csv);
+
+	/* what the encoder writes must be read back */
+	if((csv = ee_newCSV(ctx, cols, ',', EE_CSV_BACKSLASH_ESC)) == NULL)
+		errout("could not create csv decoder");
+	event = ee_newEventFromJSON(ctx, "{\"a\": \"x \\\"y\\\" /z\\\\\", \"b\": \"line\\nbreak\\ttab\"}");
+	if(event == NULL)
+		errout("could not create event");
+	ee_fmtEventToCSV(event, &out, cols);
+	ee_fmtEventToJSON(event, &out2);
+	ee_deleteEvent(event);
+	if((event = ee_newEventFromCSV(csv, out)) == NULL)
+		errout("encoder output could not be decoded");
+	es_deleteStr(out);
+	ee_fmtEventToJSON(event, &out);
+	if(es_strcmp(out, out2)) {
+		cstr = es_str2cstr(out, NULL);
+		fprintf(stderr, "round trip failed: '%s'\n", cstr);
+		exit(1);
+	}
+	es_deleteStr(out);
+	es_deleteStr(out2);
+	ee_deleteEvent(event);
+	ee_deleteCSV(csv);
+
+	es_deleteStr(cols);
+	ee_exitCtx(ctx);
+	return 0;
+}
@@ -0,0 +1,193 @@
+/**
+ * @file date1.c
+ * @brief A test for the RFC3164 and RFC5424 date parsers.
+ *
+ *//*
+ * Libee - An Event Expression Library inspired by CEE
+ * Copyright 2012 by Rainer Gerhards and Adiscon GmbH.
+ *
+ * This file is part of libee.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * A copy of the LGPL v2.1 can be found in the file "COPYING" in this distribution.
+ */
+#include "config.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <libestr.h>
+#include "libee/libee.h"
+
+static ee_ctx ctx;
+static int nErrs;
+
+void errout(char *errmsg)
+{
+	fprintf(stderr, "%s\n", errmsg);
+	exit(1);
+}
+
+
+/* scan a RFC3164 date; expected used length 0 means no match */
+static void
+check3164(char *s, int used, int month, int day, int hour, int minute, int second, int year)
+{
+	struct ee_timestamp ts;
+	int r;
+
+	r = ee_scanRFC3164Date(ctx, (unsigned char*) s, strlen(s), &ts);
+	if(r != used) {
+		fprintf(stderr, "3164 '%s': expected length %d but got %d\n", s, used, r);
+		++nErrs;
+		return;
+	}
+	if(used == 0)
+		return;
+	if(   ts.timeType != EE_TS_RFC3164 || ts.month != month || ts.day != day
+	   || ts.hour != hour || ts.minute != minute || ts.second != second
+	   || ts.year != year) {
+		fprintf(stderr, "3164 '%s': wrong timestamp %d-%d-%d %d:%d:%d\n", s,
+			ts.year, ts.month, ts.day, ts.hour, ts.minute, ts.second);
+		++nErrs;
+	}
+}
+
+
+/* scan a RFC5424 date; expected used length 0 means no match */
+static void
+check5424(char *s, int used, time_t stamp, int secfrac, int secfracPrecision)
+{
+	struct ee_timestamp ts;
+	int r;
+
+	r = ee_scanRFC5424Date(ctx, (unsigned char*) s, strlen(s), &ts);
+	if(r != used) {
+		fprintf(stderr, "5424 '%s': expected length %d but got %d\n", s, used, r);
+		++nErrs;
+		return;
+	}
+	if(used == 0)
+		return;
+	if(   ts.timeType != EE_TS_RFC5424 || ts.stamp != stamp || ts.secfrac != secfrac
+	   || ts.secfracPrecision != secfracPrecision) {
+		fprintf(stderr, "5424 '%s': wrong timestamp %lld.%d (precision %d)\n", s,
+			(long long) ts.stamp, ts.secfrac, ts.secfracPrecision);
+		++nErrs;
+	}
+}
+
+
+/* call a parser; expected offs 0 means no match */
+static void
+checkParser(char *name, ee_parserFunc parse, char *s, es_size_t offsExpected)
+{
+	es_str_t *str;
+	es_size_t offs = 0;
+	struct ee_value *value = NULL;
+	int r;
+
+	str = es_newStrFromCStr(s, strlen(s));
+	r = parse(ctx, str, &offs, NULL, &value);
+	if(offsExpected == 0) {
+		if(r != EE_WRONGPARSER) {
+			fprintf(stderr, "%s '%s': matched, but should not\n", name, s);
+			++nErrs;
+		}
+	} else if(r != 0 || offs != offsExpected) {
+		fprintf(stderr, "%s '%s': expected offs %u but got %u (r %d)\n", name, s,
+			(unsigned) offsExpected, (unsigned) offs, r);
+		++nErrs;
+	}
+	if(value != NULL)
+		ee_deleteValue(value);
+	es_deleteStr(str);
+}
+
+
+int main(void)
+{
+	static char *months[] = { "Jan", "Feb", "Mar", "Apr", "May", "Jun",
+		"Jul", "Aug", "Sep", "Oct", "Nov", "Dec" };
+	char buf[32];
+	int i;
+
+	if((ctx = ee_initCtx()) == NULL)
+		errout("Could not initialize libee context");
+
+	/* RFC3164: fast path, slow path and the trailing colon */
+	for(i = 0 ; i < 12 ; ++i) {
+		snprintf(buf, sizeof(buf), "%s 11 22:14:15", months[i]);
+		check3164(buf, 15, i + 1, 11, 22, 14, 15, 0);
+	}
+	check3164("Oct  1 22:14:15 host", 15, 10, 1, 22, 14, 15, 0);
+	check3164("Oct 1 22:14:15", 14, 10, 1, 22, 14, 15, 0);
+	check3164("Oct 11 2012 22:14:15", 20, 10, 11, 22, 14, 15, 2012);
+	check3164("Oct 11 22:14:15: msg", 16, 10, 11, 22, 14, 15, 0);
+	/* month names are case-insensitive */
+	check3164("oct 11 22:14:15", 15, 10, 11, 22, 14, 15, 0);
+	check3164("OCT 11 22:14:15", 15, 10, 11, 22, 14, 15, 0);
+	check3164("dec 11 22:14:15", 15, 12, 11, 22, 14, 15, 0);
+	/* invalid and out of range */
+	check3164("Oca 11 22:14:15", 0, 0, 0, 0, 0, 0, 0);
+	check3164("Oc@ 11 22:14:15", 0, 0, 0, 0, 0, 0, 0);
+	check3164("Oct", 0, 0, 0, 0, 0, 0, 0);
+	check3164("Oct 0 22:14:15", 0, 0, 0, 0, 0, 0, 0);
+	check3164("Oct 32 22:14:15", 0, 0, 0, 0, 0, 0, 0);
+	check3164("Oct 11 24:14:15", 0, 0, 0, 0, 0, 0, 0);
+	check3164("Oct 11 22:60:15", 0, 0, 0, 0, 0, 0, 0);
+	check3164("Oct 11 22:14:61", 0, 0, 0, 0, 0, 0, 0);
+	check3164("Oct 11 22:14:150", 0, 0, 0, 0, 0, 0, 0);
+
+	/* same results with the cache */
+	ee_setRFC3164Cache(ctx);
+	check3164("Oct 11 22:14:15", 15, 10, 11, 22, 14, 15, 0);
+	check3164("Oct 11 22:14:15 host", 15, 10, 11, 22, 14, 15, 0);
+	check3164("Oct 11 22:14:150", 0, 0, 0, 0, 0, 0, 0);
+
+	/* RFC5424: fast path, slow path, offsets */
+	check5424("2003-10-11T22:14:15.003Z", 24, 1065910455, 3, 3);
+	check5424("2003-10-11T22:14:15Z host", 20, 1065910455, 0, 0);
+	check5424("2003-08-24T05:14:15.000003-07:00", 32, 1061727255, 3, 6);
+	check5424("1985-04-12T19:20:50.52-04:00", 28, 482196050, 52, 2);
+	check5424("2003-9-1T1:0:0Z", 15, 1062378000, 0, 0);
+	check5424("2003-9-1T1:0:0.5+00:00", 22, 1062378000, 5, 1);
+	/* invalid and out of range */
+	check5424("2003-10-11T22:14:15.Z", 0, 0, 0, 0);
+	check5424("2003-9-1T1:0:0.Z", 0, 0, 0, 0);
+	check5424("2003-10-11T22:14:15", 0, 0, 0, 0);
+	check5424("2003-10-11T22:14:15Zx", 0, 0, 0, 0);
+	check5424("2003-13-11T22:14:15Z", 0, 0, 0, 0);
+	check5424("2003-10-32T22:14:15Z", 0, 0, 0, 0);
+	check5424("2003-10-11T24:14:15Z", 0, 0, 0, 0);
+	check5424("2003-10-11T22:14:15+24:00", 0, 0, 0, 0);
+	check5424("2003-10-11T22:14:15+01:60", 0, 0, 0, 0);
+
+	/* the parsers: the RFC5424 one consumes the space after the date,
+	 * also with a numerical offset, and accepts it at end of string
+	 */
+	checkParser("5424", ee_parseRFC5424Date, "1985-04-12T19:20:50.52-04:00 x", 29);
+	checkParser("5424", ee_parseRFC5424Date, "1985-04-12T19:20:50.52Z x", 24);
+	checkParser("5424", ee_parseRFC5424Date, "2003-08-24T05:14:15.000003-07:00", 32);
+	checkParser("5424", ee_parseRFC5424Date, "2003-10-11T22:14:15.Z x", 0);
+	checkParser("3164", ee_parseRFC3164Date, "Oct 11 22:14:15 x", 15);
+	checkParser("3164", ee_parseRFC3164Date, "oct 11 22:14:15", 15);
+	checkParser("3164", ee_parseRFC3164Date, "Oct 32 22:14:15", 0);
+
+	ee_exitCtx(ctx);
+	if(nErrs > 0)
+		errout("date test failed");
+	return 0;
+}
@@ -0,0 +1,157 @@
+/**
+ * @file fieldref1.c
+ * @brief A basic test for precompiled field references.
+ *
+ *//*
+ * Libee - An Event Expression Library inspired by CEE
+ * Copyright 2012 by Rainer Gerhards and Adiscon GmbH.
+ *
+ * This file is part of libee.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * A copy of the LGPL v2.1 can be found in the file "COPYING" in this distribution.
+ */
+#include "config.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <libestr.h>
+#include "libee/libee.h"
+
+static ee_ctx ctx;
+
+void errout(char *errmsg)
+{
+	fprintf(stderr, "%s\n", errmsg);
+	exit(1);
+}
+
+
+/* look up a reference and check its string value (NULL: not found) */
+static void
+check(struct ee_event *event, ee_fieldref ref, char *expected)
+{
+	es_str_t *str = NULL;
+	char *cstr;
+	int r;
+
+	r = ee_getEventFieldAsStringByRef(event, ref, &str);
+	if(expected == NULL) {
+		if(r != EE_NOTFOUND || ee_getEventFieldByRef(event, ref) != NULL) {
+			fprintf(stderr, "'%s' was found\n", es_str2cstr(ref->name, NULL));
+			exit(1);
+		}
+	} else {
+		if(r != 0 || str == NULL) {
+			fprintf(stderr, "'%s' was not found\n", es_str2cstr(ref->name, NULL));
+			exit(1);
+		}
+		cstr = es_str2cstr(str, NULL);
+		if(strcmp(cstr, expected)) {
+			fprintf(stderr, "'%s': expected '%s' but got '%s'\n",
+				es_str2cstr(ref->name, NULL), expected, cstr);
+			exit(1);
+		}
+		free(cstr);
+	}
+	if(str != NULL)
+		es_deleteStr(str);
+}
+
+
+static void
+addField(struct ee_event *event, char *name, char *val)
+{
+	if(ee_addStrFieldToEvent(event, name, es_newStrFromCStr(val, strlen(val))) != 0)
+		errout("could not add field");
+}
+
+
+int main(void)
+{
+	struct ee_event *event, *clone;
+	struct ee_field *field;
+	struct ee_value *val;
+	es_str_t *fname;
+	ee_fieldref refHost, refMsg, refMissing, refTags;
+	es_str_t *tag;
+	char name[8];
+	int i;
+
+	if((ctx = ee_initCtx()) == NULL)
+		errout("Could not initialize libee context");
+	if(   (refHost = ee_compileFieldPath(ctx, "host")) == NULL
+	   || (refMsg = ee_compileFieldPath(ctx, "msg")) == NULL
+	   || (refMissing = ee_compileFieldPath(ctx, "missing")) == NULL
+	   || (refTags = ee_compileFieldPath(ctx, "event.tags")) == NULL)
+		errout("could not compile field paths");
+	if(refTags->kind != ee_fieldref_tags || refHost->kind != ee_fieldref_field)
+		errout("wrong kind of reference");
+
+	/* small bucket: list search */
+	event = ee_newEvent(ctx);
+	check(event, refHost, NULL);
+	check(event, refTags, NULL);
+	/* an empty tag bucket gives an empty string */
+	if(ee_assignTagbucketToEvent(event, ee_newTagbucket(ctx)) != 0)
+		errout("could not assign tag bucket");
+	check(event, refTags, "");
+	addField(event, "host", "h1");
+	addField(event, "msg", "hello");
+	check(event, refHost, "h1");
+	check(event, refMsg, "hello");
+	check(event, refMissing, NULL);
+	tag = es_newStrFromCStr("t1", 2);
+	ee_addTagToEvent(event, tag);
+	es_deleteStr(tag);
+	check(event, refTags, "t1");
+
+	/* large bucket: hash index, also for fields added later. It is
+	 * built when the fields are added, lookups do not change the bucket.
+	 */
+	for(i = 0 ; i < EE_FIELDBUCKET_HASH_MIN ; ++i) {
+		snprintf(name, sizeof(name), "f%d", i);
+		addField(event, name, "x");
+	}
+	if(event->fields->htab == NULL)
+		errout("hash index was not built when fields were added");
+	check(event, refHost, "h1");
+	check(event, refMissing, NULL);
+	addField(event, "missing", "now here");
+	check(event, refMissing, "now here");
+
+	/* the index follows a field that is copied on write */
+	clone = ee_cloneEvent(event);
+	fname = es_newStrFromCStr("host", 4);
+	if((field = ee_getEventFieldForUpdate(event, fname)) == NULL)
+		errout("could not obtain field for update");
+	val = ee_newValue(ctx);
+	ee_setStrValue(val, es_newStrFromCStr("h2", 2));
+	if(ee_replaceValueInField(field, val, 0) != 0)
+		errout("could not replace value");
+	es_deleteStr(fname);
+	check(event, refHost, "h2");
+	check(clone, refHost, "h1");
+	ee_deleteEvent(clone);
+	ee_deleteEvent(event);
+
+	ee_deleteFieldref(refHost);
+	ee_deleteFieldref(refMsg);
+	ee_deleteFieldref(refMissing);
+	ee_deleteFieldref(refTags);
+	ee_exitCtx(ctx);
+	return 0;
+}
@@ -0,0 +1,213 @@
+/**
+ * @file fieldset1.c
+ * @brief A basic test for fieldsets and events bound to them.
+ *
+ *//*
+ * Libee - An Event Expression Library inspired by CEE
+ * Copyright 2012 by Rainer Gerhards and Adiscon GmbH.
+ *
+ * This file is part of libee.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * A copy of the LGPL v2.1 can be found in the file "COPYING" in this distribution.
+ */
+#include "config.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <libestr.h>
+#include "libee/libee.h"
+#include "libee/csv.h"
+
+static ee_ctx ctx;
+
+void errout(char *errmsg)
+{
+	fprintf(stderr, "%s\n", errmsg);
+	exit(1);
+}
+
+
+/* check the JSON encoding of an event */
+static void
+checkJSON(char *what, struct ee_event *event, char *expected)
+{
+	es_str_t *out;
+	char *cstr;
+
+	if(event == NULL) {
+		fprintf(stderr, "%s: no event\n", what);
+		exit(1);
+	}
+	ee_fmtEventToJSON(event, &out);
+	cstr = es_str2cstr(out, NULL);
+	if(strcmp(cstr, expected)) {
+		fprintf(stderr, "%s: expected '%s' but got '%s'\n", what, expected, cstr);
+		exit(1);
+	}
+	free(cstr);
+	es_deleteStr(out);
+}
+
+
+static void
+addStr(struct ee_event *event, int slot, char *s, int expected)
+{
+	int r;
+
+	if((r = ee_addStrToEventSlot(event, slot, (unsigned char*) s, strlen(s))) != expected) {
+		fprintf(stderr, "adding '%s' to slot %d: expected %d but got %d\n",
+			s, slot, expected, r);
+		exit(1);
+	}
+}
+
+
+/* create the "login" event type: src (ipv4, required), port (number,
+ * optional), user (string, 1 to 2 values), tagged "auth"
+ */
+static struct ee_fieldset*
+newLoginFieldset(void)
+{
+	struct ee_fieldset *fs;
+	struct ee_tagset *ts;
+	es_str_t *tag;
+
+	if((fs = ee_newFieldset(ctx, "login")) == NULL)
+		errout("could not create fieldset");
+	if(   ee_addFieldtypeToSet(fs, ee_newFieldtype(ctx, "src", "ipv4", 1, 1)) != 0
+	   || ee_addFieldtypeToSet(fs, ee_newFieldtype(ctx, "port", "number", 0, 1)) != 0
+	   || ee_addFieldtypeToSet(fs, ee_newFieldtype(ctx, "user", NULL, 1, 2)) != 0)
+		errout("could not add fieldtypes");
+	if(ee_newFieldtype(ctx, "bad", "no-such-type", 0, 1) != NULL)
+		errout("fieldtype with unknown type was created");
+
+	ts = ee_newTagset(ctx);
+	tag = es_newStrFromCStr("auth", 4);
+	if(ts == NULL || ee_addTagToSet(ts, tag) != 0)
+		errout("could not create tagset");
+	es_deleteStr(tag);
+	ee_assignTagsetToFieldset(fs, ts);
+	return fs;
+}
+
+
+int main(void)
+{
+	struct ee_fieldset *fs;
+	struct ee_fieldtype *ft;
+	struct ee_event *event, *clone;
+	struct ee_field *field;
+	struct ee_csv *csv;
+	es_str_t *str;
+	int slotSrc, slotPort, slotUser;
+	char *s;
+
+	if((ctx = ee_initCtx()) == NULL)
+		errout("Could not initialize libee context");
+
+	fs = newLoginFieldset();
+	/* duplicate names are rejected */
+	ft = ee_newFieldtype(ctx, "src", NULL, 0, 1);
+	if(ee_addFieldtypeToSet(fs, ft) != EE_EINVAL)
+		errout("duplicate fieldtype was accepted");
+	ee_deleteFieldtype(ft);
+	if(ee_registerFieldset(ctx, fs) != 0)
+		errout("could not register fieldset");
+	if(ee_findFieldset(ctx, "login") != fs || ee_findFieldset(ctx, "logout") != NULL)
+		errout("registry lookup failed");
+	/* compiled now, so no more fieldtypes */
+	ft = ee_newFieldtype(ctx, "extra", NULL, 0, 1);
+	if(ee_addFieldtypeToSet(fs, ft) != EE_EINVAL)
+		errout("fieldtype was added to compiled fieldset");
+	ee_deleteFieldtype(ft);
+
+	slotSrc = ee_getFieldsetSlot(fs, "src");
+	slotPort = ee_getFieldsetSlot(fs, "port");
+	slotUser = ee_getFieldsetSlot(fs, "user");
+	if(slotSrc != 0 || slotPort != 1 || slotUser != 2 || ee_getFieldsetSlot(fs, "x") != -1)
+		errout("wrong slots");
+
+	if((event = ee_newEventFromFieldset(ee_findFieldset(ctx, "login"))) == NULL)
+		errout("could not create event");
+	str = es_newStrFromCStr("auth", 4);
+	if(!ee_EventHasTag(event, str))
+		errout("event does not carry the tags of the fieldset");
+	es_deleteStr(str);
+	if(ee_validateEvent(event) != EE_NOTFOUND)
+		errout("empty event was valid");
+
+	addStr(event, slotSrc, "10.0.0.1x", EE_WRONGPARSER);
+	addStr(event, slotSrc, "10.0.0.1", 0);
+	addStr(event, slotSrc, "10.0.0.2", EE_TOOMANYVALUES);
+	addStr(event, slotPort, "22", 0);
+	addStr(event, slotUser, "joe", 0);
+	if(ee_validateEvent(event) != 0)
+		errout("complete event was not valid");
+	addStr(event, 3, "x", EE_EINVAL);
+
+	/* fields outside of the schema are still possible */
+	str = es_newStrFromCStr("hello", 5);
+	if(ee_addStrFieldToEvent(event, "msg", str) != 0)
+		errout("could not add field outside of schema");
+
+	/* lookup by name uses the slots */
+	str = es_newStrFromCStr("port", 4);
+	if((field = ee_getEventField(event, str)) == NULL || field != ee_getEventFieldBySlot(event, slotPort))
+		errout("lookup by name failed");
+	es_deleteStr(str);
+	checkJSON("event", event, "{\"src\": \"10.0.0.1\", \"port\": 22, \"user\": \"joe\", "
+		  "\"msg\": \"hello\"}");
+
+	/* clones share the fields until they are modified */
+	if((clone = ee_cloneEvent(event)) == NULL)
+		errout("could not clone event");
+	addStr(clone, slotUser, "root", 0);
+	addStr(clone, slotUser, "admin", EE_TOOMANYVALUES);
+	checkJSON("original", event, "{\"src\": \"10.0.0.1\", \"port\": 22, \"user\": \"joe\", "
+		  "\"msg\": \"hello\"}");
+	checkJSON("clone", clone, "{\"src\": \"10.0.0.1\", \"port\": 22, "
+		  "\"user\": [\"joe\",\"root\"], \"msg\": \"hello\"}");
+	if(ee_getNumFieldVals(ee_getEventFieldBySlot(event, slotUser)) != 1)
+		errout("original was modified via its clone");
+	ee_deleteEvent(clone);
+	ee_deleteEvent(event);
+
+	/* an unbound event has no slots */
+	event = ee_newEvent(ctx);
+	if(ee_validateEvent(event) != EE_EINVAL || ee_getEventFieldBySlot(event, 0) != NULL)
+		errout("unbound event has slots");
+	ee_deleteEvent(event);
+
+	/* the CSV decoder binds its events to the column list */
+	s = "a,b,c";
+	str = es_newStrFromCStr(s, strlen(s));
+	if((csv = ee_newCSV(ctx, str, ',', 0)) == NULL || csv->layout == NULL)
+		errout("could not create csv decoder with layout");
+	es_deleteStr(str);
+	s = "1,,x";
+	str = es_newStrFromCStr(s, strlen(s));
+	event = ee_newEventFromCSV(csv, str);
+	es_deleteStr(str);
+	if(ee_getEventFieldBySlot(event, 2) == NULL || ee_getEventFieldBySlot(event, 1) != NULL)
+		errout("csv fields not in their slots");
+	checkJSON("csv", event, "{\"a\": \"1\", \"c\": \"x\"}");
+	ee_deleteEvent(event);
+	ee_deleteCSV(csv);
+
+	ee_exitCtx(ctx);
+	return 0;
+}
@@ -0,0 +1,300 @@
+/**
+ * @file filter1.c
+ * @brief A basic test for filters evaluated during decoding.
+ *
+ *//*
+ * Libee - An Event Expression Library inspired by CEE
+ * Copyright 2012 by Rainer Gerhards and Adiscon GmbH.
+ *
+ * This file is part of libee.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * A copy of the LGPL v2.1 can be found in the file "COPYING" in this distribution.
+ */
+#include "config.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <libestr.h>
+#include "libee/libee.h"
+#include "libee/int.h"
+#include "libee/apache.h"
+#include "libee/syslog.h"
+#include "libee/kv.h"
+#include "libee/csv.h"
+
+/* private forward definition for decoders without headers */
+int ee_jsonDec(ee_ctx ctx, int (*cbGetLine)(es_str_t **ln),
+              int (*cbNewEvt)(struct ee_event *event),
+	      es_str_t **errMsg);
+
+static ee_ctx ctx;
+static char **lines;
+static int nEvts;
+
+static struct {
+	char *expr;
+	int bAccept;
+} kvTests[] = {
+	{ "", 1 },
+	{ "host=web01", 1 },
+	{ "host=web02", 0 },
+	{ "host!=web02", 1 },
+	{ "path^=/api/", 1 },
+	{ "path^=/apix", 0 },
+	{ "status={200,404}", 1 },
+	{ "status={200,500}", 0 },
+	{ "user={\"x,}\",\"jo e\"}", 1 },
+	{ "user={x\"y,z\"}", 0 },
+	{ "lat<20", 1 },
+	{ "lat>=12.5", 1 },
+	{ "lat>20", 0 },
+	{ "host<20", 0 },
+	{ "user=\"jo e\"", 1 },
+	{ "missing=x", 0 },
+	{ "missing!=x", 0 },
+	{ "  host=web01   lat<=12.5 ", 1 },
+	{ "host=web01 status=200", 0 },
+	{ NULL, 0 }
+};
+
+static struct {
+	char *line;
+	char *expr;
+	int bAccept;
+} dupTests[] = {
+	{ "sev=err sev=err", "sev=err", 1 },
+	{ "sev=err sev=debug", "sev=err", 0 },
+	{ "sev=debug sev=err", "sev=err", 0 },
+	{ "sev=err sev=debug", "sev={err,debug}", 1 },
+	{ "sev=err sev=debug", "sev!=info", 1 },
+	{ "sev=err sev=debug", "sev!=debug", 0 },
+	{ NULL, NULL, 0 }
+};
+
+static char *invalid[] = { "host", "=x", "lat<abc", "status={200", "user=\"jo",
+	"#", "host=\"a\"b", "a={", "a={}", "a={x", "a={x,", "a={\"x}",
+	"a={\"x}\",y", "a={x y}", NULL };
+
+void errout(char *errmsg)
+{
+	fprintf(stderr, "%s\n", errmsg);
+	exit(1);
+}
+
+
+static int
+cbGetLine(es_str_t **ln)
+{
+	if(*lines == NULL)
+		return EE_EOF;
+	*ln = es_newStrFromCStr(*lines, strlen(*lines));
+	++lines;
+	return 0;
+}
+
+
+/* all events that pass the filter have a field "keep" */
+static int
+cbNewEvt(struct ee_event *event)
+{
+	es_str_t *name = es_newStrFromCStr("keep", 4);
+
+	if(ee_getEventField(event, name) == NULL)
+		errout("callback: event should have been rejected");
+	es_deleteStr(name);
+	ee_deleteEvent(event);
+	++nEvts;
+	return 0;
+}
+
+
+/* check if a line is accepted (does not delete the event) */
+static int
+accepted(struct ee_event *event)
+{
+	if(event == NULL)
+		return 0;
+	ee_deleteEvent(event);
+	return 1;
+}
+
+
+static void
+setFilter(char *expr)
+{
+	if(ee_setFilter(ctx, expr) != 0) {
+		fprintf(stderr, "filter '%s' is invalid\n", expr);
+		exit(1);
+	}
+}
+
+
+static void
+decode(char *decoder, int (*dec)(void), char **input, char *expr, int nExpected)
+{
+	int r;
+
+	setFilter(expr);
+	lines = input;
+	nEvts = 0;
+	if((r = dec()) != 0) {
+		fprintf(stderr, "%s: decoder failed with %d\n", decoder, r);
+		exit(1);
+	}
+	if(nEvts != nExpected) {
+		fprintf(stderr, "%s: expected %d events, got %d\n", decoder, nExpected, nEvts);
+		exit(1);
+	}
+}
+
+
+static struct ee_csv *csv;
+static struct ee_apache *apache;
+
+static int
+decInt(void)
+{
+	es_str_t *errMsg = NULL;
+	return ee_intDec(ctx, cbGetLine, cbNewEvt, &errMsg);
+}
+
+static int
+decCSV(void)
+{
+	es_str_t *errMsg = NULL;
+	return ee_csvDec(ctx, cbGetLine, cbNewEvt, &errMsg, csv);
+}
+
+static int
+decApache(void)
+{
+	es_str_t *errMsg = NULL;
+	return ee_apacheDec(ctx, cbGetLine, cbNewEvt, &errMsg, apache);
+}
+
+static int
+decJSON(void)
+{
+	es_str_t *errMsg = NULL;
+	return ee_jsonDec(ctx, cbGetLine, cbNewEvt, &errMsg);
+}
+
+static int
+decSyslog(void)
+{
+	es_str_t *errMsg = NULL;
+	return ee_syslogSDDec(ctx, cbGetLine, cbNewEvt, &errMsg);
+}
+
+
+int main(void)
+{
+	static char *intLines[] = {
+		"e:", "f:keep", "v:1", "f:sev", "v:warn", "v:err",
+		"e:", "f:sev", "v:info", "f:keep", "v:1", "f:more", "v:x",
+		"e:", "f:keep", "v:1", NULL };
+	static char *csvLines[] = {
+		"1,err,\"a", "b\"", "1,info,\"c", "d\"", "1,err,e", NULL };
+	static char *apacheLines[] = {
+		"1 - err", "1 - info", NULL };
+	static char *jsonLines[] = {
+		"{\"keep\": \"1\", \"sev\": \"err\"}",
+		"{\"keep\": \"1\", \"sev\": \"info\"}",
+		"{\"keep\": \"1\", \"sev\": 3}", NULL };
+	static char *syslogLines[] = {
+		"[cee@115 keep=\"1\" sev=\"err\" event.tags=\"t1,t2\"]",
+		"[cee@115 keep=\"1\" sev=\"err\"]",
+		"[cee@115 event.tags=\"t1,t3\" keep=\"1\" sev=\"err\"]",
+		"[cee@115 keep=\"1\" sev=\"info\" event.tags=\"t1\"]", NULL };
+	struct ee_kv *kv;
+	es_str_t *str, *line;
+	char *s;
+	int i;
+
+	if((ctx = ee_initCtx()) == NULL)
+		errout("Could not initialize libee context");
+
+	for(i = 0 ; invalid[i] != NULL ; ++i) {
+		if(ee_setFilter(ctx, invalid[i]) != EE_INVLDFMT) {
+			fprintf(stderr, "filter '%s' should be invalid\n", invalid[i]);
+			exit(1);
+		}
+	}
+
+	if((kv = ee_newKV(ctx)) == NULL)
+		errout("could not create kv decoder");
+	s = "host=web01 status=404 lat=12.5 user=\"jo e\" path=/api/v1";
+	line = es_newStrFromCStr(s, strlen(s));
+	for(i = 0 ; kvTests[i].expr != NULL ; ++i) {
+		setFilter(kvTests[i].expr);
+		if(accepted(ee_newEventFromKV(kv, line)) != kvTests[i].bAccept) {
+			fprintf(stderr, "kv: filter '%s' should %s the event\n", kvTests[i].expr,
+				kvTests[i].bAccept ? "accept" : "reject");
+			exit(1);
+		}
+	}
+	es_deleteStr(line);
+
+	/* a field that occurs more than once must match each time */
+	for(i = 0 ; dupTests[i].line != NULL ; ++i) {
+		setFilter(dupTests[i].expr);
+		line = es_newStrFromCStr(dupTests[i].line, strlen(dupTests[i].line));
+		if(accepted(ee_newEventFromKV(kv, line)) != dupTests[i].bAccept) {
+			fprintf(stderr, "kv: filter '%s' should %s '%s'\n", dupTests[i].expr,
+				dupTests[i].bAccept ? "accept" : "reject", dupTests[i].line);
+			exit(1);
+		}
+		es_deleteStr(line);
+	}
+	ee_deleteKV(kv);
+
+	/* a field is true if any of its values matches */
+	decode("int", decInt, intLines, "sev=err", 1);
+	decode("int", decInt, intLines, "sev!=info keep=1", 1);
+	decode("int", decInt, intLines, "keep=1", 3);
+	decode("int", decInt, intLines, "more=x", 1);
+
+	s = "keep,sev,text";
+	str = es_newStrFromCStr(s, strlen(s));
+	if((csv = ee_newCSV(ctx, str, ',', 0)) == NULL)
+		errout("could not create csv decoder");
+	es_deleteStr(str);
+	/* the second record is rejected before its line break is found */
+	decode("csv", decCSV, csvLines, "sev=err", 2);
+	ee_deleteCSV(csv);
+
+	if((apache = ee_newApache(ctx)) == NULL)
+		errout("could not create apache decoder");
+	s = "keep,ident,sev";
+	str = es_newStrFromCStr(s, strlen(s));
+	ee_apacheNameList(ctx, apache, str);
+	es_deleteStr(str);
+	decode("apache", decApache, apacheLines, "sev=info", 1);
+	ee_deleteApache(apache);
+
+	decode("json", decJSON, jsonLines, "sev={err,3}", 2);
+	decode("syslog", decSyslog, syslogLines, "sev=err #t1 !#t3", 1);
+	decode("syslog", decSyslog, syslogLines, "!#t2", 3);
+
+	/* with a projection, filtered fields need not be decoded */
+	ee_setProjection(ctx, "keep");
+	decode("syslog", decSyslog, syslogLines, "sev=info", 1);
+	decode("json", decJSON, jsonLines, "sev=err", 1);
+
+	ee_exitCtx(ctx);
+	return 0;
+}
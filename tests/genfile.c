@@ -1,11 +1,432 @@
+/**
+ * @file genfile.c
+ * @brief Generates synthetic input for the testbench and benchmarks.
+ *
+ * Without options, the numbers 0 to N-1 are written, one per line (this
+ * is what the tagbucket test uses). With -f, N events are written in
+ * one of the formats libee can decode:
+ *
+ *  - apache:  access log lines, fields as of the -D name list (default
+ *             is the common log format)
+ *  - int:     libee's internal e:/f:/v: format
+ *  - json:    flat JSON objects
+ *  - json-nested: JSON objects with fields grouped into sub-objects
+ *  - syslog:  RFC5424 STRUCTURED-DATA
+ *  - kv:      key=value pairs (logfmt)
+ *  - csv:     CSV as of RFC4180
+ *
+ * The shape of the events is controlled by:
+ *  -n  number of fields per event (default 8)
+ *  -l  average length of values (default 16)
+ *  -e  percentage of characters that need escaping (default 0)
+ *  -m  percentage of fields with multiple values (default 0; int,
+ *      json and syslog only)
+ *  -u  percentage of non-ASCII (UTF-8) characters (default 0)
+ *  -s  seed of the random generator (default 1); the output only
+ *      depends on the options, so it is reproducible
+ *
+ * Usage: genfile [-f format] [-n fields] [-l len] [-e pct] [-m pct]
+ *                [-u pct] [-s seed] [-D apacheNames] N
+ *//*
+ * Libee - An Event Expression Library inspired by CEE
+ * Copyright 2012 by Rainer Gerhards and Adiscon GmbH.
+ *
+ * This file is part of libee.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * A copy of the LGPL v2.1 can be found in the file "COPYING" in this distribution.
+ */
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
 
-int main(int argc, char *argv[])
+enum fmt { f_seq, f_apache, f_int, f_json, f_jsonNested, f_syslog, f_kv, f_csv };
+
+static struct {
+	char *name;
+	enum fmt fmt;
+} formats[] = {
+	{ "apache", f_apache },
+	{ "int", f_int },
+	{ "json", f_json },
+	{ "json-nested", f_jsonNested },
+	{ "syslog", f_syslog },
+	{ "kv", f_kv },
+	{ "csv", f_csv },
+	{ NULL, f_seq }
+};
+
+static enum fmt fmt = f_seq;
+static unsigned nFields = 8;
+static unsigned valLen = 16;
+static unsigned escPct = 0;
+static unsigned multiPct = 0;
+static unsigned utf8Pct = 0;
+static unsigned long seed = 1;
+static char *apacheNames = "host,ident,user,date,request,status,bytes";
+
+/* the characters that are special in at least one of the formats */
+static char escChars[] = "\"\\,]= ";
+static char *utf8Chars[] = { "\xc3\xa4", "\xc3\xa9", "\xe2\x82\xac", "\xe6\x97\xa5",
+			     "\xf0\x9f\x98\x80" };
+static char *fieldNames[] = { "host", "user", "pid", "msg", "app", "status",
+			      "src", "dst", "proto", "bytes", "action", "rule",
+			      "session", "uri", "agent", "level" };
+#define NBR_FIELDNAMES (sizeof(fieldNames) / sizeof(char*))
+#define MAX_VALUES 4
+#define GROUP_SIZE 4
+#define MAX_VALLEN 256
+#define VALBUF_SIZE (4 * (MAX_VALLEN / 2 + MAX_VALLEN + 1))
+
+
+/* a simple LCG, so that the output is the same on all platforms */
+static unsigned
+rnd(unsigned mod)
+{
+	seed = (seed * 1103515245 + 12345) & 0xffffffff;
+	return ((seed >> 16) & 0x7fff) % mod;
+}
+
+
+static char *
+fieldName(unsigned i)
 {
-	int i = 0;
-	while(i < atoi(argv[1])) {
-		printf("%d\n", i++);
+	static char buf[32];
+
+	if(i < NBR_FIELDNAMES)
+		return fieldNames[i];
+	snprintf(buf, sizeof(buf), "field%u", i);
+	return buf;
+}
+
+
+/* generate a raw value (not yet escaped), its length is valLen +/- 50% */
+static size_t
+genValue(char *buf)
+{
+	size_t len, i = 0, n;
+	char *c;
+
+	len = valLen / 2 + rnd(valLen + 1);
+	if(len == 0)
+		len = 1;
+	while(i < len) {
+		if(escPct > 0 && rnd(100) < escPct) {
+			buf[i++] = escChars[rnd(sizeof(escChars) - 1)];
+		} else if(utf8Pct > 0 && rnd(100) < utf8Pct) {
+			c = utf8Chars[rnd(sizeof(utf8Chars) / sizeof(char*))];
+			n = strlen(c);
+			memcpy(buf + i, c, n);
+			i += n;
+		} else {
+			buf[i++] = (rnd(4) == 0) ? '0' + rnd(10) : 'a' + rnd(26);
+		}
 	}
+	return i;
+}
+
+
+static unsigned
+nbrValues(void)
+{
+	if(multiPct > 0 && rnd(100) < multiPct)
+		return 2 + rnd(MAX_VALUES - 1);
 	return 1;
 }
+
+
+/* write a value with the escapes required by the format */
+static void
+putValue(char *buf, size_t len)
+{
+	size_t i;
+	int bQuote = 0;
+
+	if(fmt == f_kv || fmt == f_csv) {
+		for(i = 0 ; i < len && !bQuote ; ++i)
+			if(strchr((fmt == f_kv) ? "\" =\\" : "\",", buf[i]) != NULL)
+				bQuote = 1;
+		if(bQuote)
+			putchar('"');
+	}
+	for(i = 0 ; i < len ; ++i) {
+		switch(fmt) {
+		case f_int:
+			if(buf[i] == '\\')
+				putchar('\\');
+			break;
+		case f_json:
+		case f_jsonNested:
+		case f_kv:
+			if(buf[i] == '"' || buf[i] == '\\')
+				putchar('\\');
+			break;
+		case f_syslog:
+			if(buf[i] == '"' || buf[i] == '\\' || buf[i] == ']' || buf[i] == ',')
+				putchar('\\');
+			break;
+		case f_csv:
+			if(buf[i] == '"')
+				putchar('"');
+			break;
+		default:
+			break;
+		}
+		putchar(buf[i]);
+	}
+	if(bQuote)
+		putchar('"');
+}
+
+
+static void
+genInt(void)
+{
+	char buf[VALBUF_SIZE];
+	unsigned i, j, nVals;
+
+	printf("e:\n");
+	for(i = 0 ; i < nFields ; ++i) {
+		printf("f:%s\n", fieldName(i));
+		nVals = nbrValues();
+		for(j = 0 ; j < nVals ; ++j) {
+			printf("v:");
+			putValue(buf, genValue(buf));
+			putchar('\n');
+		}
+	}
+}
+
+
+static void
+genJSON(void)
+{
+	char buf[VALBUF_SIZE];
+	unsigned i, j, nVals;
+
+	putchar('{');
+	for(i = 0 ; i < nFields ; ++i) {
+		if(fmt == f_jsonNested && i % GROUP_SIZE == 0)
+			printf("%s\"group%u\": {", (i == 0) ? "" : "}, ", i / GROUP_SIZE);
+		else if(i > 0)
+			printf(", ");
+		printf("\"%s\": ", fieldName(i));
+		nVals = nbrValues();
+		if(nVals > 1)
+			putchar('[');
+		for(j = 0 ; j < nVals ; ++j) {
+			if(j > 0)
+				printf(", ");
+			putchar('"');
+			putValue(buf, genValue(buf));
+			putchar('"');
+		}
+		if(nVals > 1)
+			putchar(']');
+	}
+	if(fmt == f_jsonNested && nFields > 0)
+		putchar('}');
+	printf("}\n");
+}
+
+
+static void
+genSyslog(void)
+{
+	char buf[VALBUF_SIZE];
+	unsigned i, j, nVals;
+
+	printf("[cee@115");
+	for(i = 0 ; i < nFields ; ++i) {
+		printf(" %s=\"", fieldName(i));
+		nVals = nbrValues();
+		for(j = 0 ; j < nVals ; ++j) {
+			if(j > 0)
+				putchar(',');
+			putValue(buf, genValue(buf));
+		}
+		putchar('"');
+	}
+	printf("]\n");
+}
+
+
+static void
+genKVorCSV(void)
+{
+	char buf[VALBUF_SIZE];
+	unsigned i;
+
+	for(i = 0 ; i < nFields ; ++i) {
+		if(i > 0)
+			putchar((fmt == f_kv) ? ' ' : ',');
+		if(fmt == f_kv)
+			printf("%s=", fieldName(i));
+		putValue(buf, genValue(buf));
+	}
+	putchar('\n');
+}
+
+
+/* apache has no escapes, so quotes must not be part of a value */
+static size_t
+genApacheValue(char *buf)
+{
+	size_t len, i;
+
+	len = genValue(buf);
+	for(i = 0 ; i < len ; ++i)
+		if(buf[i] == '"')
+			buf[i] = '\'';
+	return len;
+}
+
+
+/* apache fields are generated according to their name */
+static void
+genApacheField(char *name, size_t lenName)
+{
+	static char *months[] = { "Jan", "Feb", "Mar", "Apr", "May", "Jun",
+				  "Jul", "Aug", "Sep", "Oct", "Nov", "Dec" };
+	static char *methods[] = { "GET", "GET", "GET", "POST", "HEAD" };
+	char buf[VALBUF_SIZE];
+
+#	define ISNAME(s) (lenName == sizeof(s) - 1 && !strncmp(name, s, lenName))
+	if(ISNAME("host")) {
+		printf("10.%u.%u.%u", rnd(256), rnd(256), rnd(256));
+	} else if(ISNAME("ident") || ISNAME("user")) {
+		if(rnd(4) == 0)
+			printf("user%u", rnd(1000));
+		else
+			putchar('-');
+	} else if(ISNAME("date")) {
+		printf("[%02u/%s/2012:%02u:%02u:%02u +0200]", rnd(28) + 1, months[rnd(12)],
+		       rnd(24), rnd(60), rnd(60));
+	} else if(ISNAME("request")) {
+		printf("\"%s /", methods[rnd(5)]);
+		fwrite(buf, 1, genApacheValue(buf), stdout);
+		printf(" HTTP/1.1\"");
+	} else if(ISNAME("status")) {
+		printf("%u", (rnd(10) == 0) ? 404 : 200);
+	} else if(ISNAME("bytes")) {
+		printf("%u", rnd(32768));
+	} else {
+		putchar('"');
+		fwrite(buf, 1, genApacheValue(buf), stdout);
+		putchar('"');
+	}
+#	undef ISNAME
+}
+
+
+static void
+genApache(void)
+{
+	char *name = apacheNames;
+	size_t len;
+
+	while(*name) {
+		len = strcspn(name, ", ");
+		if(name != apacheNames)
+			putchar(' ');
+		genApacheField(name, len);
+		name += len;
+		if(*name)
+			++name;
+	}
+	putchar('\n');
+}
+
+
+int main(int argc, char *argv[])
+{
+	int opt;
+	int i, n;
+
+	while((opt = getopt(argc, argv, "f:n:l:e:m:u:s:D:")) != -1) {
+		switch (opt) {
+		case 'f':
+			for(i = 0 ; formats[i].name != NULL ; ++i)
+				if(!strcmp(optarg, formats[i].name))
+					break;
+			if(formats[i].name == NULL) {
+				fprintf(stderr, "genfile: unknown format '%s'\n", optarg);
+				exit(1);
+			}
+			fmt = formats[i].fmt;
+			break;
+		case 'n':
+			nFields = atoi(optarg);
+			break;
+		case 'l':
+			valLen = atoi(optarg);
+			if(valLen > MAX_VALLEN)
+				valLen = MAX_VALLEN; /* keep generated values inside our buffers */
+			break;
+		case 'e':
+			escPct = atoi(optarg);
+			break;
+		case 'm':
+			multiPct = atoi(optarg);
+			break;
+		case 'u':
+			utf8Pct = atoi(optarg);
+			break;
+		case 's':
+			seed = strtoul(optarg, NULL, 10);
+			break;
+		case 'D':
+			apacheNames = optarg;
+			break;
+		default:
+			fprintf(stderr, "usage: genfile [-f format] [-n fields] [-l len] [-e pct] "
+				"[-m pct] [-u pct] [-s seed] [-D apacheNames] N\n");
+			exit(1);
+		}
+	}
+	if(optind >= argc) {
+		fprintf(stderr, "genfile: number of lines/events missing\n");
+		exit(1);
+	}
+	n = atoi(argv[optind]);
+
+	for(i = 0 ; i < n ; ++i) {
+		switch(fmt) {
+		case f_seq:
+			printf("%d\n", i);
+			break;
+		case f_apache:
+			genApache();
+			break;
+		case f_int:
+			genInt();
+			break;
+		case f_json:
+		case f_jsonNested:
+			genJSON();
+			break;
+		case f_syslog:
+			genSyslog();
+			break;
+		case f_kv:
+		case f_csv:
+			genKVorCSV();
+			break;
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,132 @@
+/**
+ * @file kv1.c
+ * @brief A basic test for the key=value decoder.
+ *
+ *//*
+ * Libee - An Event Expression Library inspired by CEE
+ * Copyright 2012 by Rainer Gerhards and Adiscon GmbH.
+ *
+ * This file is part of libee.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * A copy of the LGPL v2.1 can be found in the file "COPYING" in this distribution.
+ */
+#include "config.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <libestr.h>
+#include "libee/libee.h"
+#include "libee/kv.h"
+
+static ee_ctx ctx;
+
+/* separators (NULL for defaults), input line, expected JSON */
+static struct {
+	char *pairSeps;
+	char *kvSeps;
+	char *quotes;
+	char *in;
+	char *json;
+} tests[] = {
+	{ NULL, NULL, NULL,
+	  "level=info msg=\"user logged in\" user=joe",
+	  "{\"level\": \"info\", \"msg\": \"user logged in\", \"user\": \"joe\"}" },
+	{ NULL, NULL, NULL,
+	  "  a=1\tdebug b= c=\"\" =x d=\"say \\\"hi\\\"\\n\"",
+	  "{\"a\": \"1\", \"debug\": \"\", \"b\": \"\", \"c\": \"\", \"d\": \"say \\\"hi\\\"\\n\"}" },
+	{ NULL, NULL, NULL,
+	  "url=http://x/?a=b long=\"0123456789abcdefghijklmnopqrstuvwxyz\" last=0123456789abcdefghij",
+	  "{\"url\": \"http://x/?a=b\", \"long\": \"0123456789abcdefghijklmnopqrstuvwxyz\", "
+	  "\"last\": \"0123456789abcdefghij\"}" },
+	{ ";", ":", "'\"",
+	  "a:1;b:'x y; \"z\"';c:\"it's\"",
+	  "{\"a\": \"1\", \"b\": \"x y; \\\"z\\\"\", \"c\": \"it's\"}" },
+	{ NULL, NULL, NULL, NULL, NULL }
+};
+
+void errout(char *errmsg)
+{
+	fprintf(stderr, "%s\n", errmsg);
+	exit(1);
+}
+
+
+static void
+dbgCB(void *cookie, char __attribute__((unused)) *msg, size_t __attribute__((unused)) lenMsg)
+{
+	++*(int*) cookie;
+}
+
+
+int main(void)
+{
+	struct ee_kv *kv;
+	struct ee_event *event;
+	es_str_t *str, *out;
+	char *cstr;
+	int i;
+	int nDbgMsgs = 0;
+
+	if((ctx = ee_initCtx()) == NULL)
+		errout("Could not initialize libee context");
+
+	for(i = 0 ; tests[i].in != NULL ; ++i) {
+		if((kv = ee_newKV(ctx)) == NULL)
+			errout("could not create kv decoder");
+		if(ee_setKVSeparators(kv, tests[i].pairSeps, tests[i].kvSeps, tests[i].quotes) != 0)
+			errout("could not set separators");
+		str = es_newStrFromCStr(tests[i].in, strlen(tests[i].in));
+		if((event = ee_newEventFromKV(kv, str)) == NULL) {
+			fprintf(stderr, "'%s' could not be decoded\n", tests[i].in);
+			exit(1);
+		}
+		ee_fmtEventToJSON(event, &out);
+		cstr = es_str2cstr(out, NULL);
+		if(strcmp(cstr, tests[i].json)) {
+			fprintf(stderr, "'%s': expected '%s' but got '%s'\n", tests[i].in,
+				tests[i].json, cstr);
+			exit(1);
+		}
+		free(cstr);
+		es_deleteStr(out);
+		ee_deleteEvent(event);
+		es_deleteStr(str);
+		ee_deleteKV(kv);
+	}
+
+	if((kv = ee_newKV(ctx)) == NULL)
+		errout("could not create kv decoder");
+	ee_setDebugCB(ctx, dbgCB, &nDbgMsgs);
+	ee_setDebugLevel(ctx, EE_DBG_ERR);
+	str = es_newStrFromCStr("a=\"open", 7);
+	if(ee_newEventFromKV(kv, str) != NULL)
+		errout("unterminated quoted value was decoded");
+	es_deleteStr(str);
+#ifndef DISABLE_DIAGNOSTICS
+	if(nDbgMsgs != 1)
+		errout("no debug message for unterminated quoted value");
+#endif
+	ee_setDebugCB(ctx, NULL, NULL);
+	if(ee_setKVSeparators(kv, " ", " ", NULL) != EE_EINVAL)
+		errout("overlapping separators were accepted");
+	if(ee_setKVSeparators(kv, "", NULL, NULL) != EE_EINVAL)
+		errout("empty separators were accepted");
+	ee_deleteKV(kv);
+
+	ee_exitCtx(ctx);
+	return 0;
+}
@@ -0,0 +1,137 @@
+/**
+ * @file litmatcher1.c
+ * @brief A basic test for the literal matcher.
+ *//*
+ * Libee - An Event Expression Library inspired by CEE
+ * Copyright 2012 by Rainer Gerhards and Adiscon GmbH.
+ *
+ * This file is part of libee.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * A copy of the LGPL v2.1 can be found in the file "COPYING" in this distribution.
+ */
+#include "config.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <libestr.h>
+#include "libee/libee.h"
+#include "libee/litmatcher.h"
+
+#define NBR_RANDOM_LITS 200
+#define NBR_RANDOM_BUFS 1000
+
+static ee_ctx ctx;
+
+void errout(char *errmsg)
+{
+	fprintf(stderr, "%s\n", errmsg);
+	exit(1);
+}
+
+
+static unsigned
+addLit(struct ee_litmatcher *matcher, char *lit, size_t len)
+{
+	unsigned id;
+
+	if(ee_addLiteralToMatcher(matcher, (unsigned char*) lit, len, &id) != 0)
+		errout("could not add literal");
+	return id;
+}
+
+
+/* check the result of the last scan against a naive search */
+static void
+check(struct ee_litmatcher *matcher, char **lits, size_t *lens, unsigned *ids,
+      unsigned nLits, char *buf, size_t len)
+{
+	unsigned i;
+	size_t offs;
+	int bFound;
+
+	for(i = 0 ; i < nLits ; ++i) {
+		bFound = 0;
+		for(offs = 0 ; !bFound && offs + lens[i] <= len ; ++offs)
+			bFound = !memcmp(buf + offs, lits[i], lens[i]);
+		if(ee_literalFound(matcher, ids[i]) != bFound) {
+			fprintf(stderr, "literal '%.*s' in '%.*s': expected %d\n",
+				(int) lens[i], lits[i], (int) len, buf, bFound);
+			exit(1);
+		}
+	}
+}
+
+
+int main(void)
+{
+	static char *classic[] = { "he", "she", "his", "hers", NULL };
+	static char *texts[] = { "ushers", "his", "h", "", "shhe", NULL };
+	char *lits[NBR_RANDOM_LITS];
+	size_t lens[NBR_RANDOM_LITS];
+	unsigned ids[NBR_RANDOM_LITS];
+	char buf[64];
+	struct ee_litmatcher *matcher;
+	unsigned i, j, n;
+
+	if((ctx = ee_initCtx()) == NULL)
+		errout("Could not initialize libee context");
+	if((matcher = ee_newLitmatcher(ctx)) == NULL)
+		errout("could not create literal matcher");
+	for(n = 0 ; classic[n] != NULL ; ++n) {
+		lits[n] = classic[n];
+		lens[n] = strlen(classic[n]);
+		ids[n] = addLit(matcher, lits[n], lens[n]);
+		if(ids[n] != n)
+			errout("literals not numbered in order");
+	}
+	if(addLit(matcher, "she", 3) != 1 || matcher->nLits != 4)
+		errout("duplicate literal was added");
+	if(ee_compileLitmatcher(matcher) != 0)
+		errout("could not compile literal matcher");
+	for(i = 0 ; texts[i] != NULL ; ++i) {
+		ee_scanLiterals(matcher, (unsigned char*) texts[i], strlen(texts[i]));
+		check(matcher, lits, lens, ids, n, texts[i], strlen(texts[i]));
+	}
+
+	/* literals added after a scan; random texts over a small alphabet
+	 * have many overlapping matches, and the states for short prefixes
+	 * have enough transitions to get a table
+	 */
+	srand(1);
+	for( ; n < NBR_RANDOM_LITS ; ++n) {
+		lens[n] = rand() % 4 + 1;
+		if((lits[n] = malloc(lens[n])) == NULL)
+			errout("out of memory");
+		for(j = 0 ; j < lens[n] ; ++j)
+			lits[n][j] = "abcdefghij"[rand() % 10];
+		ids[n] = addLit(matcher, lits[n], lens[n]);
+	}
+	if(ee_compileLitmatcher(matcher) != 0)
+		errout("could not compile literal matcher");
+	for(i = 0 ; i < NBR_RANDOM_BUFS ; ++i) {
+		for(j = 0 ; j < sizeof(buf) ; ++j)
+			buf[j] = "abcdefghijhs"[rand() % 12];
+		ee_scanLiterals(matcher, (unsigned char*) buf, i % sizeof(buf));
+		check(matcher, lits, lens, ids, NBR_RANDOM_LITS, buf, i % sizeof(buf));
+	}
+
+	for(n = 4 ; n < NBR_RANDOM_LITS ; ++n)
+		free(lits[n]);
+	ee_deleteLitmatcher(matcher);
+	ee_exitCtx(ctx);
+	return 0;
+}
@@ -0,0 +1,164 @@
+/**
+ * @file netaddr1.c
+ * @brief A basic test for the network address parsers.
+ *
+ *//*
+ * Libee - An Event Expression Library inspired by CEE
+ * Copyright 2012 by Rainer Gerhards and Adiscon GmbH.
+ *
+ * This file is part of libee.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * A copy of the LGPL v2.1 can be found in the file "COPYING" in this distribution.
+ */
+#include "config.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <libestr.h>
+#include "libee/libee.h"
+
+static ee_ctx ctx;
+
+/* input, parser, expected canonical form ("" = must not match) */
+static struct {
+	char *in;
+	char *parser;
+	char *expected;
+} tests[] = {
+	{ "2001:db8::1", "ipv6", "2001:db8::1" },
+	{ "2001:0DB8:0000:0000:0000:0000:0000:0001", "ipv6", "2001:db8::1" },
+	{ "::", "ipv6", "::" },
+	{ "::1", "ipv6", "::1" },
+	{ "fe80::", "ipv6", "fe80::" },
+	{ "1:0:0:2:0:0:0:3", "ipv6", "1:0:0:2::3" },
+	{ "1:2:3:4:5:6:7::", "ipv6", "1:2:3:4:5:6:7:0" },
+	{ "::ffff:192.168.1.1", "ipv6", "::ffff:192.168.1.1" },
+	{ "64:ff9b::10.0.0.1", "ipv6", "64:ff9b::a00:1" },
+	{ "1:2:3:4:5:6:7:8:9", "ipv6", "1:2:3:4:5:6:7:8" },
+	{ "1::2::3", "ipv6", "" },
+	{ "1:2:3", "ipv6", "" },
+	{ "12345::", "ipv6", "" },
+	{ "::ffff:1.2.3", "ipv6", "" },
+	{ "00:1A:2b:3c:4D:5e", "mac48", "00:1a:2b:3c:4d:5e" },
+	{ "00-1a-2b-3c-4d-5e", "mac48", "00:1a:2b:3c:4d:5e" },
+	{ "001a.2b3c.4d5e", "mac48", "00:1a:2b:3c:4d:5e" },
+	{ "00:1a-2b:3c:4d:5e", "mac48", "" },
+	{ "00:1a:2b:3c:4d:5", "mac48", "" },
+	{ "10.0.0.0/8", "cidr", "10.0.0.0/8" },
+	{ "2001:db8::/32", "cidr", "2001:db8::/32" },
+	{ "10.0.0.0/33", "cidr", "" },
+	{ "10.0.0.0", "cidr", "" },
+	{ NULL, NULL, NULL }
+};
+
+void errout(char *errmsg)
+{
+	fprintf(stderr, "%s\n", errmsg);
+	exit(1);
+}
+
+
+/* check that value has the expected string representation */
+static void
+chkValue(char *in, struct ee_value *val, char *expected)
+{
+	es_str_t *out;
+	char *cstr;
+
+	out = es_newStr(16);
+	if(ee_addValueAsStr(val, &out) != 0)
+		errout("could not format value");
+	cstr = es_str2cstr(out, NULL);
+	if(strcmp(cstr, expected)) {
+		fprintf(stderr, "'%s': expected '%s' but got '%s'\n", in, expected, cstr);
+		exit(1);
+	}
+	free(cstr);
+	es_deleteStr(out);
+}
+
+
+/* values must survive a trip through the binary format */
+static void
+chkBinary(struct ee_value *val, char *expected)
+{
+	struct ee_event *event, *copy;
+	struct ee_field *field;
+	es_str_t *bin, *name;
+
+	name = es_newStrFromCStr("addr", 4);
+	if((event = ee_newEvent(ctx)) == NULL)
+		errout("could not create event");
+	if((field = ee_newFieldFromNV(ctx, "addr", ee_addRefValue(val))) == NULL)
+		errout("could not create field");
+	ee_addFieldToEvent(event, field);
+	if(ee_fmtEventToBinary(event, &bin) != 0)
+		errout("could not encode event");
+	if((copy = ee_newEventFromBinary(ctx, es_getBufAddr(bin), es_strlen(bin), NULL)) == NULL)
+		errout("could not decode event");
+	if((field = ee_getEventField(copy, name)) == NULL)
+		errout("field missing after decoding");
+	if(field->val->valtype != ee_valtype_net)
+		errout("value is no longer binary after decoding");
+	chkValue("binary", field->val, expected);
+	ee_deleteEvent(copy);
+	ee_deleteEvent(event);
+	es_deleteStr(bin);
+	es_deleteStr(name);
+}
+
+
+int main(void)
+{
+	struct ee_parser *parser;
+	struct ee_value *val;
+	es_str_t *str;
+	es_size_t offs;
+	int i, r;
+
+	if((ctx = ee_initCtx()) == NULL)
+		errout("Could not initialize libee context");
+
+	for(i = 0 ; tests[i].in != NULL ; ++i) {
+		if((parser = ee_findParser(ctx, tests[i].parser)) == NULL)
+			errout("parser not registered");
+		str = es_newStrFromCStr(tests[i].in, strlen(tests[i].in));
+		offs = 0;
+		r = parser->parse(ctx, str, &offs, NULL, &val);
+		if(r == 0 && offs < es_strlen(str) && tests[i].expected[0] == '\0')
+			r = EE_WRONGPARSER; /* only matched a prefix */
+		if(tests[i].expected[0] == '\0') {
+			if(r == 0) {
+				fprintf(stderr, "'%s' must not match %s\n", tests[i].in, tests[i].parser);
+				exit(1);
+			}
+		} else {
+			if(r != 0) {
+				fprintf(stderr, "'%s' does not match %s\n", tests[i].in, tests[i].parser);
+				exit(1);
+			}
+			chkValue(tests[i].in, val, tests[i].expected);
+			chkBinary(val, tests[i].expected);
+		}
+		if(r == 0)
+			ee_deleteValue(val);
+		es_deleteStr(str);
+	}
+
+	ee_exitCtx(ctx);
+	return 0;
+}
@@ -0,0 +1,251 @@
+/**
+ * @file normalizer1.c
+ * @brief A basic test for the normalizer.
+ *
+ *//*
+ * Libee - An Event Expression Library inspired by CEE
+ * Copyright 2012 by Rainer Gerhards and Adiscon GmbH.
+ *
+ * This file is part of libee.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * A copy of the LGPL v2.1 can be found in the file "COPYING" in this distribution.
+ */
+#include "config.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <libestr.h>
+#include "libee/libee.h"
+#include "libee/normalizer.h"
+
+static ee_ctx ctx;
+static char **lines;
+static int nEvts;
+
+static struct {
+	char *sample;
+	char *tags;
+} rules[] = {
+	{ "user %user:word% logged in from %ip:ipv4% port %port:number%", "login,auth" },
+	{ "user %user:word% logged out", "logout" },
+	{ "connection from %host:word%", NULL },
+	{ "connection from %ip:ipv4%", NULL },
+	{ "a %x:word% c", NULL },
+	{ "a %y:word% d", NULL },
+	{ "%-:word% %pct:number%%% done", NULL },
+	{ "list %first:char-to:,%,%rest:word%", NULL },
+	{ "%date:date-rfc3164% %host:word% %msg:quoted-string%", NULL },
+	{ "dup", "t1" },
+	{ "dup", "t2" },
+	{ NULL, NULL }
+};
+
+static struct {
+	char *msg;
+	char *expected;	/* NULL if there is no match */
+} tests[] = {
+	{ "user joe logged in from 10.0.0.1 port 22",
+	  "{\"user\": \"joe\", \"ip\": \"10.0.0.1\", \"port\": 22}" },
+	{ "user joe logged out", "{\"user\": \"joe\"}" },
+	{ "user joe logged", NULL },
+	{ "connection from 10.0.0.1", "{\"ip\": \"10.0.0.1\"}" },
+	{ "connection from 10.0.0.1x", "{\"host\": \"10.0.0.1x\"}" },
+	{ "connection from ", NULL },
+	{ "a b c", "{\"x\": \"b\"}" },
+	{ "a b d", "{\"y\": \"b\"}" },
+	{ "a b e", NULL },
+	{ "job 42% done", "{\"pct\": 42}" },
+	{ "job 42 done", NULL },
+	{ "list x y,z", "{\"first\": \"x y\", \"rest\": \"z\"}" },
+	{ "list x,y z", NULL },
+	{ "list xy,z", "{\"first\": \"xy\", \"rest\": \"z\"}" },
+	{ "Oct 11 22:14:15 srv \"hi there\"",
+	  "{\"date\": \"Oct 11 22:14:15\", \"host\": \"srv\", \"msg\": \"hi there\"}" },
+	{ "dup", "{}" },
+	{ "", NULL },
+	{ NULL, NULL }
+};
+
+static char *invalid[] = { "%x%", "%x:nosuchparser%", "%x:word", "%:word%",
+	"%x:char-to%", "%x:char-to:ab%", NULL };
+
+void errout(char *errmsg)
+{
+	fprintf(stderr, "%s\n", errmsg);
+	exit(1);
+}
+
+
+static char*
+toJSON(struct ee_event *event)
+{
+	es_str_t *out;
+	char *cstr;
+
+	ee_fmtEventToJSON(event, &out);
+	cstr = es_str2cstr(out, NULL);
+	es_deleteStr(out);
+	return cstr;
+}
+
+
+static int
+hasTag(struct ee_event *event, char *tag)
+{
+	es_str_t *str = es_newStrFromCStr(tag, strlen(tag));
+	int r = ee_EventHasTag(event, str);
+	es_deleteStr(str);
+	return r;
+}
+
+
+static int
+cbGetLine(es_str_t **ln)
+{
+	if(*lines == NULL)
+		return EE_EOF;
+	*ln = es_newStrFromCStr(*lines, strlen(*lines));
+	++lines;
+	return 0;
+}
+
+
+static int
+cbNewEvt(struct ee_event *event)
+{
+	static char *expected[] = { "{\"user\": \"joe\"}", "{\"originalmsg\": \"hello\"}" };
+	char *cstr = toJSON(event);
+
+	if(nEvts >= 2 || strcmp(cstr, expected[nEvts])) {
+		fprintf(stderr, "normDec: unexpected event '%s'\n", cstr);
+		exit(1);
+	}
+	free(cstr);
+	ee_deleteEvent(event);
+	++nEvts;
+	return 0;
+}
+
+
+/* with a projection that does not include it, there is no originalmsg */
+static int
+cbNewEvtProjected(struct ee_event *event)
+{
+	es_str_t *name = es_newStrFromCStr("originalmsg", 11);
+
+	if(ee_getEventField(event, name) != NULL)
+		errout("normDec: originalmsg should not be projected");
+	es_deleteStr(name);
+	ee_deleteEvent(event);
+	++nEvts;
+	return 0;
+}
+
+
+int main(void)
+{
+	static char *decLines[] = { "user joe logged out", "hello", NULL };
+	struct ee_normalizer *norm;
+	struct ee_event *event;
+	es_str_t *str, *errMsg;
+	char *cstr;
+	FILE *fp;
+	int i, r;
+
+	if((ctx = ee_initCtx()) == NULL)
+		errout("Could not initialize libee context");
+	if((norm = ee_newNormalizer(ctx)) == NULL)
+		errout("could not create normalizer");
+
+	for(i = 0 ; invalid[i] != NULL ; ++i) {
+		if(ee_addRule(norm, invalid[i], NULL) == 0) {
+			fprintf(stderr, "rule '%s' should be invalid\n", invalid[i]);
+			exit(1);
+		}
+	}
+	for(i = 0 ; rules[i].sample != NULL ; ++i) {
+		if(ee_addRule(norm, rules[i].sample, rules[i].tags) != 0) {
+			fprintf(stderr, "could not add rule '%s'\n", rules[i].sample);
+			exit(1);
+		}
+	}
+	if(norm->nRules != 10)
+		errout("duplicate rule was counted");
+
+	for(i = 0 ; tests[i].msg != NULL ; ++i) {
+		str = es_newStrFromCStr(tests[i].msg, strlen(tests[i].msg));
+		r = ee_normalize(norm, str, &event);
+		es_deleteStr(str);
+		if(tests[i].expected == NULL) {
+			if(r != EE_NOTFOUND || event != NULL) {
+				fprintf(stderr, "'%s' should not match, r=%d\n", tests[i].msg, r);
+				exit(1);
+			}
+			continue;
+		}
+		if(r != 0) {
+			fprintf(stderr, "'%s' did not match, r=%d\n", tests[i].msg, r);
+			exit(1);
+		}
+		cstr = toJSON(event);
+		if(strcmp(cstr, tests[i].expected)) {
+			fprintf(stderr, "'%s': expected '%s' but got '%s'\n", tests[i].msg,
+				tests[i].expected, cstr);
+			exit(1);
+		}
+		free(cstr);
+		if(i == 0 && (!hasTag(event, "login") || !hasTag(event, "auth")))
+			errout("tags of rule were not assigned");
+		if(!strcmp(tests[i].msg, "dup") && (!hasTag(event, "t2") || hasTag(event, "t1")))
+			errout("tags of duplicate rule were not replaced");
+		ee_deleteEvent(event);
+	}
+
+	/* a rule added after messages were normalized (prefilter rebuilt) */
+	if(ee_addRule(norm, "user %user:word% logged in via %how:word%", NULL) != 0)
+		errout("could not add rule");
+	str = es_newStrFromCStr("user joe logged in via ssh", 26);
+	r = ee_normalize(norm, str, &event);
+	es_deleteStr(str);
+	if(r != 0)
+		errout("rule added later did not match");
+	ee_deleteEvent(event);
+	ee_deleteNormalizer(norm);
+
+	/* the same via a rulebase and the decoder interface */
+	if((fp = fopen("normalizer1.rb", "w")) == NULL)
+		errout("could not create rulebase");
+	fprintf(fp, "# a comment\n\nrule=:user %%user:word%% logged out\n");
+	fclose(fp);
+	norm = ee_newNormalizer(ctx);
+	r = ee_loadRulebase(norm, "normalizer1.rb");
+	remove("normalizer1.rb");
+	if(r != 0)
+		errout("could not load rulebase");
+	lines = decLines;
+	if(ee_normDec(ctx, cbGetLine, cbNewEvt, &errMsg, norm) != 0 || nEvts != 2)
+		errout("normalizer decoder failed");
+	ee_setProjection(ctx, "user");
+	lines = decLines;
+	nEvts = 0;
+	if(ee_normDec(ctx, cbGetLine, cbNewEvtProjected, &errMsg, norm) != 0 || nEvts != 2)
+		errout("normalizer decoder failed with projection");
+	ee_deleteNormalizer(norm);
+
+	ee_exitCtx(ctx);
+	return 0;
+}
@@ -0,0 +1,136 @@
+/**
+ * @file number1.c
+ * @brief A basic test for the number parser and number output.
+ *
+ *//*
+ * Libee - An Event Expression Library inspired by CEE
+ * Copyright 2012 by Rainer Gerhards and Adiscon GmbH.
+ *
+ * This file is part of libee.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * A copy of the LGPL v2.1 can be found in the file "COPYING" in this distribution.
+ */
+#include "config.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <locale.h>
+#include <libestr.h>
+#include "libee/libee.h"
+
+static ee_ctx ctx;
+
+/* input, expected value type, expected JSON output */
+static struct {
+	char *in;
+	int valtype;
+	char *json;
+} tests[] = {
+	{ "0", ee_valtype_nbr, "0" },
+	{ "42", ee_valtype_nbr, "42" },
+	{ "-17", ee_valtype_nbr, "-17" },
+	{ "+5", ee_valtype_nbr, "5" },
+	{ "1234567890123456", ee_valtype_nbr, "1234567890123456" },
+	{ "9223372036854775807", ee_valtype_nbr, "9223372036854775807" },
+	{ "-9223372036854775808", ee_valtype_nbr, "-9223372036854775808" },
+	{ "9223372036854775808", ee_valtype_str, "\"9223372036854775808\"" },
+	{ "0.1", ee_valtype_dbl, "0.1" },
+	{ "-2.5e3", ee_valtype_dbl, "-2500" },
+	{ "6.02214076E23", ee_valtype_dbl, "6.02214076e+23" },
+	{ "3.14159265358979323846", ee_valtype_dbl, "3.1415926535897931" },
+	{ "1e999", ee_valtype_str, "\"1e999\"" },
+	{ NULL, 0, NULL }
+};
+
+static char *commaLocales[] = { "de_DE.UTF-8", "de_DE.utf8", "de_DE", "fr_FR.UTF-8",
+	"fr_FR.utf8", "fr_FR", NULL };
+
+void errout(char *errmsg)
+{
+	fprintf(stderr, "%s\n", errmsg);
+	exit(1);
+}
+
+
+int main(void)
+{
+	struct ee_event *event;
+	struct ee_value *val;
+	es_str_t *str, *out;
+	es_size_t offs;
+	char expected[64];
+	char *cstr;
+	int i;
+
+	/* numbers must not depend on the locale of the application, so we
+	 * use one with a decimal comma if there is one
+	 */
+	setlocale(LC_NUMERIC, "");
+	for(i = 0 ; commaLocales[i] != NULL && *localeconv()->decimal_point == '.' ; ++i)
+		setlocale(LC_NUMERIC, commaLocales[i]);
+
+	if((ctx = ee_initCtx()) == NULL)
+		errout("Could not initialize libee context");
+
+	for(i = 0 ; tests[i].in != NULL ; ++i) {
+		str = es_newStrFromCStr(tests[i].in, strlen(tests[i].in));
+		offs = 0;
+		if(ee_parseNumber(ctx, str, &offs, NULL, &val) != 0 || offs != es_strlen(str)) {
+			fprintf(stderr, "'%s' is not parsed as number\n", tests[i].in);
+			exit(1);
+		}
+		if((int) val->valtype != tests[i].valtype) {
+			fprintf(stderr, "'%s' has value type %d, expected %d\n", tests[i].in,
+				(int) val->valtype, tests[i].valtype);
+			exit(1);
+		}
+		if((event = ee_newEvent(ctx)) == NULL)
+			errout("could not create event");
+		ee_addFieldToEvent(event, ee_newFieldFromNV(ctx, "n", val));
+		ee_fmtEventToJSON(event, &out);
+		cstr = es_str2cstr(out, NULL);
+		snprintf(expected, sizeof(expected), "{\"n\": %s}", tests[i].json);
+		if(strcmp(cstr, expected)) {
+			fprintf(stderr, "'%s': expected '%s' but got '%s'\n", tests[i].in,
+				expected, cstr);
+			exit(1);
+		}
+		free(cstr);
+		es_deleteStr(out);
+		ee_deleteEvent(event);
+		es_deleteStr(str);
+	}
+
+	/* only the number itself must be consumed */
+	str = es_newStrFromCStr("12.5.3 x", 8);
+	offs = 0;
+	if(ee_parseNumber(ctx, str, &offs, NULL, &val) != 0 || offs != 4)
+		errout("number prefix not parsed correctly");
+	ee_deleteValue(val);
+	offs = 7;
+	if(ee_parseNumber(ctx, str, &offs, NULL, &val) != EE_WRONGPARSER)
+		errout("non-number parsed as number");
+	es_deleteStr(str);
+
+	/* the same goes for numbers in filters */
+	if(ee_setFilter(ctx, "n<1.5") != 0)
+		errout("numeric filter is invalid");
+	ee_setFilter(ctx, NULL);
+
+	ee_exitCtx(ctx);
+	return 0;
+}
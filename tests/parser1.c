@@ -0,0 +1,183 @@
+/**
+ * @file parser1.c
+ * @brief A test for the parser registry.
+ *
+ *//*
+ * Libee - An Event Expression Library inspired by CEE
+ * Copyright 2012 by Rainer Gerhards and Adiscon GmbH.
+ *
+ * This file is part of libee.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * A copy of the LGPL v2.1 can be found in the file "COPYING" in this distribution.
+ */
+#include "config.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <libestr.h>
+#include "libee/libee.h"
+
+static ee_ctx ctx;
+static int nErrs;
+
+void errout(char *errmsg)
+{
+	fprintf(stderr, "%s\n", errmsg);
+	exit(1);
+}
+
+
+/* matches "xy" only */
+static int
+parseXY(ee_ctx __attribute__((unused)) ctx, es_str_t *str, es_size_t *offs,
+	es_str_t __attribute__((unused)) *ed, struct ee_value **value)
+{
+	if(es_strlen(str) - *offs < 2 || memcmp(es_getBufAddr(str) + *offs, "xy", 2))
+		return EE_WRONGPARSER;
+	*value = ee_newValue(ctx);
+	ee_setNbrValue(*value, 1);
+	*offs += 2;
+	return 0;
+}
+
+
+static int
+parseNothing(ee_ctx __attribute__((unused)) ctx, es_str_t __attribute__((unused)) *str,
+	     es_size_t __attribute__((unused)) *offs, es_str_t __attribute__((unused)) *ed,
+	     struct ee_value __attribute__((unused)) **value)
+{
+	return EE_WRONGPARSER;
+}
+
+
+/* check the first byte set of a parser: accepted must all be in it,
+ * rejected must not
+ */
+static void
+checkBytes(char *name, char *accepted, char *rejected)
+{
+	struct ee_parser *parser;
+
+	if((parser = ee_findParser(ctx, name)) == NULL) {
+		fprintf(stderr, "parser '%s' not found\n", name);
+		++nErrs;
+		return;
+	}
+	for( ; *accepted ; ++accepted)
+		if(!ee_parserAcceptsByte(parser, *accepted)) {
+			fprintf(stderr, "%s does not accept '%c'\n", name, *accepted);
+			++nErrs;
+		}
+	for( ; *rejected ; ++rejected)
+		if(ee_parserAcceptsByte(parser, *rejected)) {
+			fprintf(stderr, "%s accepts '%c'\n", name, *rejected);
+			++nErrs;
+		}
+}
+
+
+static void
+checkMeta(char *name, es_size_t minLen, unsigned flags)
+{
+	struct ee_parser *parser;
+
+	if(   (parser = ee_findParser(ctx, name)) == NULL || parser->minLen != minLen
+	   || parser->flags != flags || parser->probe == NULL || parser->parse == NULL) {
+		fprintf(stderr, "wrong metadata for parser '%s'\n", name);
+		++nErrs;
+	}
+}
+
+
+int main(void)
+{
+	static char *builtins[] = { "date-rfc3164", "date-rfc5424", "date-iso",
+		"time-24hr", "time-12hr", "ipv4", "ipv6", "mac48", "cidr", "number",
+		"quoted-string", "char-to", "word", NULL };
+	struct ee_parser *parser, *xy;
+	struct ee_value *value = NULL;
+	es_str_t *str;
+	es_size_t offs;
+	int i;
+
+	if((ctx = ee_initCtx()) == NULL)
+		errout("Could not initialize libee context");
+
+	/* all built-ins are registered, in this order */
+	parser = ctx->parsers;
+	for(i = 0 ; builtins[i] != NULL ; ++i) {
+		if(parser == NULL || strcmp(parser->name, builtins[i]) || ee_findParser(ctx, builtins[i]) != parser)
+			errout("built-in parsers not registered in order");
+		parser = parser->next;
+	}
+	if(parser != NULL || ee_findParser(ctx, "no-such-parser") != NULL)
+		errout("unexpected parser registered");
+
+	checkMeta("ipv4", 7, 0);
+	checkMeta("date-rfc3164", 11, 0);
+	checkMeta("quoted-string", 2, 0);
+	checkMeta("char-to", 2, EE_PARSER_FLAG_NEEDS_ED);
+	checkMeta("word", 1, EE_PARSER_FLAG_CATCHALL);
+	checkBytes("ipv4", "0189", "a: -");
+	checkBytes("number", "09+-", "a. ");
+	checkBytes("date-rfc3164", "JFMASONDjad", "KXb1 ");
+	checkBytes("time-12hr", "01", "2");
+	checkBytes("ipv6", "09afAF:", "gG. ");
+	checkBytes("quoted-string", "\"", "'a");
+	checkBytes("char-to", " a\"\377", "");
+	checkBytes("word", "a1\"\377", " ");
+
+	/* ee_parserCanMatch() checks the first byte and the minimum length */
+	parser = ee_findParser(ctx, "ipv4");
+	str = es_newStrFromCStr("x 1.2.3.4 1.2.3", 15);
+	if(   ee_parserCanMatch(parser, str, 0) || !ee_parserCanMatch(parser, str, 2)
+	   || ee_parserCanMatch(parser, str, 10) || ee_parserCanMatch(parser, str, 15))
+		errout("ee_parserCanMatch() failed");
+	es_deleteStr(str);
+
+	/* custom parsers are appended to the registry */
+	if((xy = ee_registerParser(ctx, "xy", parseXY, "x", 2, 0)) == NULL)
+		errout("could not register parser");
+	if(ee_findParser(ctx, "xy") != xy || xy->probe != NULL || xy->next != NULL)
+		errout("custom parser not found");
+	checkBytes("xy", "x", "yX");
+	str = es_newStrFromCStr("axy", 3);
+	offs = 1;
+	if(xy->parse(ctx, str, &offs, NULL, &value) != 0 || offs != 3)
+		errout("custom parser did not match");
+	ee_deleteValue(value);
+
+	/* re-registering replaces the parser in place */
+	if(ee_registerParser(ctx, "xy", parseNothing, "^x", 1, EE_PARSER_FLAG_CATCHALL) != xy)
+		errout("parser was not replaced in place");
+	checkBytes("xy", "ay ", "x");
+	offs = 1;
+	if(   xy->parse(ctx, str, &offs, NULL, &value) != EE_WRONGPARSER || offs != 1
+	   || xy->minLen != 1 || xy->flags != EE_PARSER_FLAG_CATCHALL)
+		errout("parser was not replaced");
+	es_deleteStr(str);
+
+	/* built-ins may be replaced, too; the probe is dropped */
+	parser = ee_findParser(ctx, "number");
+	if(ee_registerParser(ctx, "number", parseXY, "x", 2, 0) != parser || parser->probe != NULL)
+		errout("built-in parser was not replaced");
+
+	ee_exitCtx(ctx);
+	if(nErrs > 0)
+		errout("parser test failed");
+	return 0;
+}
@@ -0,0 +1,187 @@
+/**
+ * @file probe1.c
+ * @brief A test for the probes of the built-in parsers.
+ *
+ * For each built-in parser and a set of inputs, the probe and the
+ * parser must agree on the match and the value.
+ *
+ *//*
+ * Libee - An Event Expression Library inspired by CEE
+ * Copyright 2012 by Rainer Gerhards and Adiscon GmbH.
+ *
+ * This file is part of libee.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * A copy of the LGPL v2.1 can be found in the file "COPYING" in this distribution.
+ */
+#include "config.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <libestr.h>
+#include "libee/libee.h"
+
+static ee_ctx ctx;
+static int nErrs;
+
+void errout(char *errmsg)
+{
+	fprintf(stderr, "%s\n", errmsg);
+	exit(1);
+}
+
+
+static char*
+valueAsStr(struct ee_value *value)
+{
+	es_str_t *str = es_newStr(16);
+	char *cstr;
+
+	ee_addValueAsStr(value, &str);
+	cstr = es_str2cstr(str, NULL);
+	es_deleteStr(str);
+	return cstr;
+}
+
+
+/* probe and parse s with the parser, and compare the results */
+static void
+checkParser(struct ee_parser *parser, char *s, es_str_t *ed)
+{
+	es_str_t *str;
+	struct ee_probe probe;
+	struct ee_value *valProbe = NULL, *valParse = NULL;
+	es_size_t len, offs = 0, offsExpected;
+	char *cstrProbe = NULL, *cstrParse = NULL;
+	int r;
+
+	str = es_newStrFromCStr(s, strlen(s));
+	len = parser->probe(ctx, (unsigned char*) s, strlen(s), ed, &probe);
+	r = parser->parse(ctx, str, &offs, ed, &valParse);
+	if(len == 0) {
+		if(r != EE_WRONGPARSER || offs != 0) {
+			fprintf(stderr, "%s '%s': parser matched, probe did not\n", parser->name, s);
+			++nErrs;
+		}
+		goto done;
+	}
+	/* the RFC5424 parser also consumes the space after the date */
+	offsExpected = len;
+	if(!strcmp(parser->name, "date-rfc5424") && len < strlen(s))
+		++offsExpected;
+	if(r != 0 || offs != offsExpected) {
+		fprintf(stderr, "%s '%s': probe matched %u, parser %u (r %d)\n", parser->name, s,
+			(unsigned) len, (unsigned) offs, r);
+		++nErrs;
+		goto done;
+	}
+	if(   ee_newValueFromProbe(ctx, (unsigned char*) s, &probe, &valProbe) != 0
+	   || valProbe->valtype != valParse->valtype) {
+		fprintf(stderr, "%s '%s': value types differ\n", parser->name, s);
+		++nErrs;
+		goto done;
+	}
+	cstrProbe = valueAsStr(valProbe);
+	cstrParse = valueAsStr(valParse);
+	/* ...and keeps it in the value */
+	if(offsExpected > len && cstrParse[len] == ' ')
+		cstrParse[len] = '\0';
+	if(strcmp(cstrProbe, cstrParse)) {
+		fprintf(stderr, "%s '%s': probe value '%s', parser value '%s'\n", parser->name, s,
+			cstrProbe, cstrParse);
+		++nErrs;
+	}
+
+done:
+	free(cstrProbe);
+	free(cstrParse);
+	if(valProbe != NULL)
+		ee_deleteValue(valProbe);
+	if(valParse != NULL)
+		ee_deleteValue(valParse);
+	es_deleteStr(str);
+}
+
+
+/* probe s and return the probe result; the match length must be len */
+static struct ee_probe*
+probe(char *name, char *s, es_size_t len)
+{
+	static struct ee_probe pr;
+	struct ee_parser *parser = ee_findParser(ctx, name);
+
+	if(parser->probe(ctx, (unsigned char*) s, strlen(s), NULL, &pr) != len) {
+		fprintf(stderr, "%s '%s': probe did not match %u characters\n", name, s,
+			(unsigned) len);
+		exit(1);
+	}
+	return &pr;
+}
+
+
+int main(void)
+{
+	static char *inputs[] = { " x", "x", "1", "1.2.3.4", "10.0.0.1 x", "256.1.1.1",
+		"1.2.3", "42", "-17 x", "+3.25", "1e3", "12x", "99999999999999999999",
+		"fe80::1", "::ffff:1.2.3.4", "1::2::3", "00:1a:2b:3c:4d:5e", "00-1A-2B-3C-4D-5E",
+		"10.0.0.0/8", "10.0.0.0/33", "2001:db8::/32", "\"quoted str\" x",
+		"\"unterminated", "Oct 11 22:14:15 x", "oct 1 22:14:15",
+		"2003-10-11T22:14:15.003Z x", "2003-08-24T05:14:15.000003-07:00",
+		"2003-10-11", "2003-10-11 x", "22:14:15", "12:14:15", "1:14:15",
+		"word x", "a,b", "x,", ",", NULL };
+	struct ee_parser *parser;
+	struct ee_probe *pr;
+	es_str_t *ed;
+	int i;
+
+	if((ctx = ee_initCtx()) == NULL)
+		errout("Could not initialize libee context");
+	ed = es_newStrFromCStr(",", 1);
+
+	for(parser = ctx->parsers ; parser != NULL ; parser = parser->next) {
+		if(parser->probe == NULL)
+			errout("built-in parser without probe");
+		for(i = 0 ; inputs[i] != NULL ; ++i)
+			checkParser(parser, inputs[i],
+				    (parser->flags & EE_PARSER_FLAG_NEEDS_ED) ? ed : NULL);
+	}
+
+	/* binary values */
+	pr = probe("ipv4", "10.1.2.3 x", 8);
+	if(pr->type != EE_PROBE_IPV4 || pr->v.ipv4 != 0x0a010203)
+		errout("wrong ipv4 probe value");
+	pr = probe("number", "-42", 3);
+	if(pr->type != EE_PROBE_NBR || pr->v.nbr != -42)
+		errout("wrong number probe value");
+	pr = probe("number", "-1.5e2", 6);
+	if(pr->type != EE_PROBE_DBL || pr->v.dbl != -150.0)
+		errout("wrong double probe value");
+	pr = probe("date-rfc3164", "Oct 11 22:14:15", 15);
+	if(pr->type != EE_PROBE_TS || pr->v.ts.month != 10 || pr->v.ts.second != 15)
+		errout("wrong timestamp probe value");
+	pr = probe("quoted-string", "\"a b\" c", 5);
+	if(pr->type != EE_PROBE_STR || pr->offsVal != 1 || pr->lenVal != 3)
+		errout("wrong quoted string probe value");
+	pr = probe("ipv6", "::1", 3);
+	if(pr->type != EE_PROBE_NET)
+		errout("wrong ipv6 probe value");
+
+	es_deleteStr(ed);
+	ee_exitCtx(ctx);
+	if(nErrs > 0)
+		errout("probe test failed");
+	return 0;
+}
@@ -0,0 +1,173 @@
+/**
+ * @file projection1.c
+ * @brief A basic test for decoding with a projection set.
+ *
+ *//*
+ * Libee - An Event Expression Library inspired by CEE
+ * Copyright 2012 by Rainer Gerhards and Adiscon GmbH.
+ *
+ * This file is part of libee.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * A copy of the LGPL v2.1 can be found in the file "COPYING" in this distribution.
+ */
+#include "config.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <libestr.h>
+#include "libee/libee.h"
+#include "libee/binary.h"
+#include "libee/int.h"
+#include "libee/apache.h"
+#include "libee/syslog.h"
+#include "libee/kv.h"
+#include "libee/csv.h"
+
+#define EXPECTED "{\"host\": \"h1\", \"msg\": \"hello\"}"
+
+static ee_ctx ctx;
+static char **lines;
+static int nEvts;
+
+void errout(char *errmsg)
+{
+	fprintf(stderr, "%s\n", errmsg);
+	exit(1);
+}
+
+
+/* check the event and destruct it */
+static void
+check(char *decoder, struct ee_event *event)
+{
+	es_str_t *out;
+	char *cstr;
+
+	if(event == NULL) {
+		fprintf(stderr, "%s: event could not be decoded\n", decoder);
+		exit(1);
+	}
+	ee_fmtEventToJSON(event, &out);
+	cstr = es_str2cstr(out, NULL);
+	if(strcmp(cstr, EXPECTED)) {
+		fprintf(stderr, "%s: expected '%s' but got '%s'\n", decoder, EXPECTED, cstr);
+		exit(1);
+	}
+	free(cstr);
+	es_deleteStr(out);
+	ee_deleteEvent(event);
+}
+
+
+static int
+cbGetLine(es_str_t **ln)
+{
+	if(*lines == NULL)
+		return EE_EOF;
+	*ln = es_newStrFromCStr(*lines, strlen(*lines));
+	++lines;
+	return 0;
+}
+
+
+static int
+cbNewEvt(struct ee_event *event)
+{
+	check("callback", event);
+	++nEvts;
+	return 0;
+}
+
+
+int main(void)
+{
+	static char *intLines[] = { "e:", "f:user", "v:joe", "f:host", "v:h1",
+		"f:pid", "v:1", "v:2", "f:msg", "v:hello", NULL };
+	static char *apacheLines[] = { "1.2.3.4 h1 - [01/Jan/2012:00:00:00 +0100] \"hello\" 200", NULL };
+	struct ee_event *event;
+	struct ee_kv *kv;
+	struct ee_csv *csv;
+	struct ee_apache *apache;
+	es_str_t *str, *bin, *errMsg;
+	char *s;
+
+	if((ctx = ee_initCtx()) == NULL)
+		errout("Could not initialize libee context");
+	if(ee_setProjection(ctx, "msg,,host,missing") != 0)
+		errout("could not set projection");
+
+	check("json", ee_newEventFromJSON(ctx,
+		"{\"user\": \"joe\", \"host\": \"h1\", \"x\": {\"msg\": 1}, \"msg\": \"hello\"}"));
+
+	s = "[cee@115 user=\"j\\\"oe\" host=\"h1\" msg=\"hello\"][x@1 msg=\"no\"]";
+	str = es_newStrFromCStr(s, strlen(s));
+	check("syslog", ee_newEventFromRFC5424(ctx, str));
+	es_deleteStr(str);
+
+	if((kv = ee_newKV(ctx)) == NULL)
+		errout("could not create kv decoder");
+	s = "user=\"joe x\" host=h1 pid msg=hello";
+	str = es_newStrFromCStr(s, strlen(s));
+	check("kv", ee_newEventFromKV(kv, str));
+	es_deleteStr(str);
+	ee_deleteKV(kv);
+
+	s = "user,host,pid,msg";
+	str = es_newStrFromCStr(s, strlen(s));
+	if((csv = ee_newCSV(ctx, str, ',', 0)) == NULL)
+		errout("could not create csv decoder");
+	es_deleteStr(str);
+	s = "\"joe, jr\",h1,1,hello,extra";
+	str = es_newStrFromCStr(s, strlen(s));
+	check("csv", ee_newEventFromCSV(csv, str));
+	es_deleteStr(str);
+	ee_deleteCSV(csv);
+
+	/* binary: encode all fields, then decode with the projection */
+	ee_setProjection(ctx, NULL);
+	str = es_newStrFromCStr("user=joe host=h1 msg=hello", 26);
+	kv = ee_newKV(ctx);
+	event = ee_newEventFromKV(kv, str);
+	es_deleteStr(str);
+	ee_deleteKV(kv);
+	ee_fmtEventToBinary(event, &bin);
+	ee_deleteEvent(event);
+	ee_setProjection(ctx, "host,msg");
+	check("binary", ee_newEventFromBinary(ctx, es_getBufAddr(bin), es_strlen(bin), NULL));
+	es_deleteStr(bin);
+
+	lines = intLines;
+	if(ee_intDec(ctx, cbGetLine, cbNewEvt, &errMsg) != 0)
+		errout("int decoder failed");
+
+	if((apache = ee_newApache(ctx)) == NULL)
+		errout("could not create apache decoder");
+	s = "ip,host,ident,date,msg,status";
+	str = es_newStrFromCStr(s, strlen(s));
+	ee_apacheNameList(ctx, apache, str);
+	es_deleteStr(str);
+	lines = apacheLines;
+	if(ee_apacheDec(ctx, cbGetLine, cbNewEvt, &errMsg, apache) != 0)
+		errout("apache decoder failed");
+	ee_deleteApache(apache);
+
+	if(nEvts != 2)
+		errout("callback was not called for all events");
+
+	ee_exitCtx(ctx);
+	return 0;
+}
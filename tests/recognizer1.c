@@ -0,0 +1,154 @@
+/**
+ * @file recognizer1.c
+ * @brief A test for the recognizer.
+ *
+ *//*
+ * Libee - An Event Expression Library inspired by CEE
+ * Copyright 2012 by Rainer Gerhards and Adiscon GmbH.
+ *
+ * This file is part of libee.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * A copy of the LGPL v2.1 can be found in the file "COPYING" in this distribution.
+ */
+#include "config.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <libestr.h>
+#include "libee/libee.h"
+#include "libee/recognizer.h"
+
+static ee_ctx ctx;
+static int nErrs;
+
+void errout(char *errmsg)
+{
+	fprintf(stderr, "%s\n", errmsg);
+	exit(1);
+}
+
+
+/* recognize the value at offs; parser NULL means nothing must match */
+static void
+check(struct ee_recognizer *recognizer, char *s, es_size_t offs, char *parser,
+      es_size_t offsExpected, int valtype)
+{
+	es_str_t *str;
+	struct ee_parser *found = NULL;
+	struct ee_value *value = NULL;
+	int r;
+
+	str = es_newStrFromCStr(s, strlen(s));
+	r = ee_recognize(recognizer, str, &offs, &found, &value);
+	if(parser == NULL) {
+		if(r != EE_WRONGPARSER || value != NULL) {
+			fprintf(stderr, "'%s' was recognized as %s\n", s, found->name);
+			++nErrs;
+		}
+	} else if(r != 0 || strcmp(found->name, parser) || offs != offsExpected
+		  || value == NULL || (int) value->valtype != valtype) {
+		fprintf(stderr, "'%s': expected %s up to %u, got r %d, %s up to %u\n", s,
+			parser, (unsigned) offsExpected, r, (r == 0) ? found->name : "-",
+			(unsigned) offs);
+		++nErrs;
+	}
+	if(value != NULL)
+		ee_deleteValue(value);
+	es_deleteStr(str);
+}
+
+
+/* the parser that is tried first for byte c */
+static char*
+firstCand(struct ee_recognizer *recognizer, unsigned char c)
+{
+	return recognizer->cands[recognizer->slots[c * recognizer->nCands]].parser->name;
+}
+
+
+int main(void)
+{
+	struct ee_recognizer *recognizer;
+	es_str_t *str;
+	es_size_t offs;
+	char names[256];
+	int i;
+
+	if((ctx = ee_initCtx()) == NULL)
+		errout("Could not initialize libee context");
+
+	/* all parsers, but char-to (needs extra data) */
+	if((recognizer = ee_newRecognizer(ctx, NULL)) == NULL)
+		errout("could not create recognizer");
+	check(recognizer, "1.2.3.4", 0, "ipv4", 7, ee_valtype_str);
+	check(recognizer, "x 42 y", 2, "number", 4, ee_valtype_nbr);
+	check(recognizer, "-4.5", 0, "number", 4, ee_valtype_dbl);
+	check(recognizer, "fe80::1 x", 0, "ipv6", 7, ee_valtype_net);
+	check(recognizer, "10.0.0.0/8", 0, "cidr", 10, ee_valtype_net);
+	check(recognizer, "\"a b\" c", 0, "quoted-string", 5, ee_valtype_str);
+	check(recognizer, "2003-10-11T22:14:15Z", 0, "date-rfc5424", 20, ee_valtype_str);
+	check(recognizer, "hello world", 0, "word", 5, ee_valtype_str);
+	/* a match must end at a space or the end of the string */
+	check(recognizer, "42x", 0, "word", 3, ee_valtype_str);
+	check(recognizer, " x", 0, NULL, 0, 0);
+	check(recognizer, "x", 1, NULL, 0, 0);
+
+	/* without a value */
+	str = es_newStrFromCStr("42 x", 4);
+	offs = 0;
+	if(ee_recognize(recognizer, str, &offs, NULL, NULL) != 0 || offs != 2)
+		errout("recognizing without value failed");
+	es_deleteStr(str);
+	ee_deleteRecognizer(recognizer);
+
+	/* unknown names and parsers that need extra data are rejected */
+	if(   ee_newRecognizer(ctx, "number,nosuchparser") != NULL
+	   || ee_newRecognizer(ctx, "char-to") != NULL)
+		errout("invalid recognizer was created");
+
+	/* names given more than once are only used once */
+	names[0] = '\0';
+	for(i = 0 ; i < 40 ; ++i)
+		strcat(names, i == 0 ? "word" : ",word");
+	if((recognizer = ee_newRecognizer(ctx, names)) == NULL || recognizer->nCands != 1)
+		errout("duplicate names were not merged");
+	check(recognizer, "abc", 0, "word", 3, ee_valtype_str);
+	ee_deleteRecognizer(recognizer);
+
+	/* candidates are ordered by hit rate, but catch-all ones stay last */
+	if((recognizer = ee_newRecognizer(ctx, "word,number,ipv4")) == NULL)
+		errout("could not create recognizer");
+	if(strcmp(firstCand(recognizer, '1'), "number"))
+		errout("wrong initial order");
+	check(recognizer, "1.2.3.4", 0, "ipv4", 7, ee_valtype_str);
+	if(strcmp(firstCand(recognizer, '1'), "ipv4"))
+		errout("candidates not reordered by hits");
+	check(recognizer, "42", 0, "number", 2, ee_valtype_nbr);
+	check(recognizer, "1x", 0, "word", 2, ee_valtype_str);
+	check(recognizer, "1x", 0, "word", 2, ee_valtype_str);
+	check(recognizer, "1x", 0, "word", 2, ee_valtype_str);
+	if(recognizer->slots['1' * recognizer->nCands + 2] != 0)
+		errout("catch-all candidate was moved before specific ones");
+	check(recognizer, "x", 0, "word", 1, ee_valtype_str);
+	check(recognizer, "-", 0, "word", 1, ee_valtype_str);
+	ee_deleteRecognizer(recognizer);
+
+	ee_exitCtx(ctx);
+	if(nErrs > 0)
+		errout("recognizer test failed");
+	return 0;
+}
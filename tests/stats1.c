@@ -0,0 +1,136 @@
+/**
+ * @file stats1.c
+ * @brief A basic test for the statistics counters.
+ *
+ * If libee was built without --enable-stats, only the API is checked.
+ *//*
+ * Libee - An Event Expression Library inspired by CEE
+ * Copyright 2012 by Rainer Gerhards and Adiscon GmbH.
+ *
+ * This file is part of libee.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * A copy of the LGPL v2.1 can be found in the file "COPYING" in this distribution.
+ */
+#include "config.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <libestr.h>
+#include "libee/libee.h"
+#include "libee/kv.h"
+
+static ee_ctx ctx;
+
+void errout(char *errmsg)
+{
+	fprintf(stderr, "%s\n", errmsg);
+	exit(1);
+}
+
+
+static void
+check(char *what, unsigned long long val, unsigned long long expected)
+{
+	if(val != expected) {
+		fprintf(stderr, "%s: expected %llu but got %llu\n", what, expected, val);
+		exit(1);
+	}
+}
+
+
+int main(void)
+{
+	struct ee_stats stats;
+	struct ee_event *event, *clone;
+	struct ee_value *value;
+	struct ee_kv *kv;
+	es_str_t *str, *out;
+	es_size_t offs;
+	char longVal[400];
+
+	if((ctx = ee_initCtx()) == NULL)
+		errout("Could not initialize libee context");
+
+	if(strcmp(ee_getStatsParserName(ee_stp_IPv4), "ipv4"))
+		errout("wrong parser name");
+	if(ee_getStatsParserName(EE_STATS_NPARSERS) != NULL)
+		errout("parser name for invalid index");
+	if(ee_getStats(ctx, &stats) == EE_NOTFOUND) {
+		check("eventsCreated (disabled)", stats.eventsCreated, 0);
+		ee_exitCtx(ctx);
+		return 0;
+	}
+
+	/* parsers: one hit, one miss */
+	str = es_newStrFromCStr("10.0.0.1 hello", 14);
+	offs = 0;
+	if(ee_parseIPv4(ctx, str, &offs, NULL, &value) != 0)
+		errout("ipv4 not parsed");
+	ee_deleteValue(value);
+	if(ee_parseIPv4(ctx, str, &offs, NULL, &value) != EE_WRONGPARSER)
+		errout("ipv4 parser matched a space");
+	++offs;
+	if(ee_parseWord(ctx, str, &offs, NULL, &value) != 0)
+		errout("word not parsed");
+	ee_deleteValue(value);
+	es_deleteStr(str);
+	ee_getStats(ctx, &stats);
+	check("ipv4 hits", stats.parsers[ee_stp_IPv4].hits, 1);
+	check("ipv4 misses", stats.parsers[ee_stp_IPv4].misses, 1);
+	check("word hits", stats.parsers[ee_stp_Word].hits, 1);
+	check("valuesAlloced", stats.valuesAlloced, 2);
+	check("bytesCopied", stats.bytesCopied, 13);
+
+	/* events and encoders */
+	ee_resetStats(ctx);
+	if((event = ee_newEvent(ctx)) == NULL)
+		errout("could not create event");
+	memset(longVal, 'x', sizeof(longVal));
+	str = es_newStrFromCStr(longVal, sizeof(longVal));
+	if(ee_addStrFieldToEvent(event, "long", str) != 0)
+		errout("could not add field");
+	if((clone = ee_cloneEvent(event)) == NULL)
+		errout("could not clone event");
+	ee_fmtEventToJSON(clone, &out);
+	es_deleteStr(out);
+	ee_deleteEvent(clone);
+	ee_getStats(ctx, &stats);
+	check("eventsCreated", stats.eventsCreated, 2);
+	check("eventsDeleted", stats.eventsDeleted, 1);
+	check("fieldsAlloced", stats.fieldsAlloced, 1);
+	check("eventsEncoded", stats.eventsEncoded, 1);
+	check("encBufGrows", stats.encBufGrows, 1);
+	ee_deleteEvent(event);
+
+	/* decoders */
+	ee_resetStats(ctx);
+	if((kv = ee_newKV(ctx)) == NULL)
+		errout("could not create kv decoder");
+	str = es_newStrFromCStr("a=1 b=xyz", 9);
+	if((event = ee_newEventFromKV(kv, str)) == NULL)
+		errout("could not decode event");
+	ee_deleteEvent(event);
+	es_deleteStr(str);
+	ee_deleteKV(kv);
+	ee_getStats(ctx, &stats);
+	check("eventsDecoded", stats.eventsDecoded, 1);
+	check("fieldsAlloced", stats.fieldsAlloced, 2);
+	check("bytesCopied", stats.bytesCopied, 4);
+
+	ee_exitCtx(ctx);
+	return 0;
+}
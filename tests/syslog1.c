@@ -0,0 +1,110 @@
+/**
+ * @file syslog1.c
+ * @brief A basic test for the RFC5424 structured data decoder.
+ *
+ *//*
+ * Libee - An Event Expression Library inspired by CEE
+ * Copyright 2012 by Rainer Gerhards and Adiscon GmbH.
+ *
+ * This file is part of libee.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * A copy of the LGPL v2.1 can be found in the file "COPYING" in this distribution.
+ */
+#include "config.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <libestr.h>
+#include "libee/libee.h"
+
+static ee_ctx ctx;
+
+/* structured data and what the syslog encoder makes of the resulting event */
+static struct {
+	char *in;
+	char *out;
+} tests[] = {
+	{ "[cee@115 event.tags=\"t1,t2\" host=\"srv1\" msg=\"a \\\"quoted\\\" \\\\ text\\]\"]",
+	  "[cee@115 event.tags=\"t1,t2\" host=\"srv1\" msg=\"a \\\"quoted\\\" \\\\ text\\]\"]" },
+	{ "[cee@115 list=\"a,b,,c\" single=\"a\\,b\" empty=\"\"]",
+	  "[cee@115 list=\"a,b,,c\" single=\"a\\,b\" empty=\"\"]" },
+	{ "[cee@115 nl=\"x\\ny\" raw=\"C:\\temp\"] the message",
+	  "[cee@115 nl=\"x\\ny\" raw=\"C:\\\\temp\"]" },
+	{ "[exampleSDID@32473 iut=\"3\"][cee@115 a=\"1\"]",
+	  "[cee@115 exampleSDID@32473.iut=\"3\" a=\"1\"]" },
+	{ "- no structured data", "[cee@115]" },
+	{ NULL, NULL }
+};
+
+/* invalid structured data */
+static char *invalid[] = {
+	"[cee@115 a=\"1\"",
+	"[cee@115 a=\"1]",
+	"[cee@115 a=1]",
+	"[ a=\"1\"]",
+	"no sd",
+	NULL
+};
+
+void errout(char *errmsg)
+{
+	fprintf(stderr, "%s\n", errmsg);
+	exit(1);
+}
+
+
+int main(void)
+{
+	struct ee_event *event;
+	es_str_t *str, *out;
+	char *cstr;
+	int i;
+
+	if((ctx = ee_initCtx()) == NULL)
+		errout("Could not initialize libee context");
+
+	for(i = 0 ; tests[i].in != NULL ; ++i) {
+		str = es_newStrFromCStr(tests[i].in, strlen(tests[i].in));
+		if((event = ee_newEventFromRFC5424(ctx, str)) == NULL) {
+			fprintf(stderr, "'%s' could not be decoded\n", tests[i].in);
+			exit(1);
+		}
+		ee_fmtEventToRFC5424(event, &out);
+		cstr = es_str2cstr(out, NULL);
+		if(strcmp(cstr, tests[i].out)) {
+			fprintf(stderr, "'%s': expected '%s' but got '%s'\n", tests[i].in,
+				tests[i].out, cstr);
+			exit(1);
+		}
+		free(cstr);
+		es_deleteStr(out);
+		ee_deleteEvent(event);
+		es_deleteStr(str);
+	}
+
+	for(i = 0 ; invalid[i] != NULL ; ++i) {
+		str = es_newStrFromCStr(invalid[i], strlen(invalid[i]));
+		if((event = ee_newEventFromRFC5424(ctx, str)) != NULL) {
+			fprintf(stderr, "invalid '%s' was decoded\n", invalid[i]);
+			exit(1);
+		}
+		es_deleteStr(str);
+	}
+
+	ee_exitCtx(ctx);
+	return 0;
+}
@@ -31,17 +31,12 @@
 #include <stdlib.h>
 #include <string.h>
 #include <getopt.h>
+#include <libestr.h>
 #include "config.h"
 #include "libee/libee.h"
 
 static ee_ctx ctx;
 
-void
-TagOutputCB(void __attribute__((unused)) *cookie, char *tagname)
-{
-	printf("%s\n", tagname);
-}
-
 void
 dbgCallBack(void __attribute__((unused)) *cookie, char *msg,
 	    size_t __attribute__((unused)) lenMsg)
@@ -56,12 +51,48 @@ void errout(char *errmsg)
 }
 
 
+/* check that a tag bucket shared by two events is copied on write
+ * and the other event keeps seeing the original bucket.
+ */
+static void
+checkCOW(struct ee_tagbucket *tagbucket)
+{
+	struct ee_event *e1, *e2;
+	struct ee_tagbucket *tb1, *tb2;
+	es_str_t *newtag;
+
+	if((e1 = ee_newEvent(ctx)) == NULL || (e2 = ee_newEvent(ctx)) == NULL)
+		errout("could not create events");
+	ee_assignTagbucketToEvent(e1, ee_addRefTagbucket(tagbucket));
+	ee_assignTagbucketToEvent(e2, ee_addRefTagbucket(tagbucket));
+
+	newtag = es_newStrFromCStr("cow-test", 8);
+	if(ee_addTagToEvent(e1, newtag) != 0)
+		errout("could not add tag to event with shared bucket");
+	ee_EventGetTagbucket(e1, &tb1);
+	ee_EventGetTagbucket(e2, &tb2);
+	if(tb1 == tagbucket || tb2 != tagbucket)
+		errout("shared tag bucket was not copied on write");
+	if(!ee_EventHasTag(e1, newtag))
+		errout("tag missing from modified event");
+	if(ee_EventHasTag(e2, newtag) || ee_TagbucketHasTag(tagbucket, newtag))
+		errout("tag added to one event is visible in shared bucket");
+
+	es_deleteStr(newtag);
+	ee_deleteEvent(e1);
+	ee_deleteEvent(e2);
+}
+
+
 int main(int argc, char *argv[])
 {
 	int opt;
 	FILE *fpIn = stdin;
 	char lnbuf[1024];
 	struct ee_tagbucket *tagbucket;
+	void *cookie = NULL;
+	es_str_t *tag;
+	char *cstr;
 
 	while((opt = getopt(argc, argv, "i:")) != -1) {
 		switch (opt) {
@@ -98,11 +129,21 @@ int main(int argc, char *argv[])
 	while(!feof(fpIn)) {
 		if(fgets(lnbuf, sizeof(lnbuf), fpIn) != NULL) {
 			lnbuf[strlen(lnbuf)-1] = '\0'; /* strip '\n' */
-			ee_addTagToBucket(tagbucket, lnbuf);
+			ee_addTagToBucket(tagbucket,
+				es_newStrFromCStr(lnbuf, strlen(lnbuf)));
 		}
 	}
 
-	ee_iterateOverBucketTags(tagbucket, TagOutputCB, NULL);
+	checkCOW(tagbucket);
+
+	do {
+		ee_TagbucketGetNextTag(tagbucket, &cookie, &tag);
+		if(cookie != NULL) {
+			cstr = es_str2cstr(tag, NULL);
+			printf("%s\n", cstr);
+			free(cstr);
+		}
+	} while(cookie != NULL);
 	ee_deleteTagbucket(tagbucket);
 
 	ee_exitCtx(ctx);